@@ -0,0 +1,628 @@
+/*
+ *  Interactive i/o scheduler.
+ *
+ *  A deadline derivative aimed at eMMC/SD storage on handheld devices,
+ *  where a long stream of background writeback (package installs, dexopt,
+ *  media scanning) sits in front of the reads a foreground app is blocked
+ *  on. Requests are sorted into three classes when they are allocated:
+ *
+ *    interactive - synchronous reads from a foreground submitter, i.e. one
+ *                  whose io priority class is not idle and, with blkio
+ *                  cgroups enabled, that lives in the root blkio cgroup
+ *    sync        - all other synchronous requests
+ *    async       - asynchronous writes
+ *
+ *  Each class has its own fifo with a soft expiry time. Expired requests
+ *  are dispatched first, otherwise classes are served in the order above.
+ *  While there has been interactive activity within the last
+ *  interactive_window msecs, async writes are limited to async_budget_kb
+ *  per async_window msecs, and on non-rotational queues async writes are
+ *  held back for idle_window msecs after an interactive read completes,
+ *  so a dependent read does not land behind a large write. We never idle
+ *  on rotational media and never idle the sync classes.
+ *
+ *  Dispatch latency, the time from insertion to dispatch, is accounted
+ *  per class in power of two microsecond buckets and can be read from
+ *  /sys/block/<dev>/queue/iosched/latency_hist. Writing to that file
+ *  resets the counters.
+ *
+ *  A simple way to exercise the scheduler is a loop device backed by a
+ *  file on the eMMC, with one fio job doing buffered sequential writes
+ *  in the background and another doing 4k random reads:
+ *
+ *    losetup /dev/block/loop0 /data/local/tmp/backing.img
+ *    echo interactive > /sys/block/loop0/queue/scheduler
+ *    fio --name=bg --filename=/dev/block/loop0 --rw=write --bs=128k \
+ *        --size=256m --ioengine=sync --end_fsync=1 &
+ *    fio --name=fg --filename=/dev/block/loop0 --rw=randread --bs=4k \
+ *        --size=256m --direct=1 --runtime=30
+ *
+ *  and compare the fg completion latency percentiles and latency_hist
+ *  against deadline and cfq. The null_blk driver works equally well where
+ *  it is available.
+ */
+#include <linux/kernel.h>
+#include <linux/fs.h>
+#include <linux/blkdev.h>
+#include <linux/elevator.h>
+#include <linux/bio.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/init.h>
+#include <linux/compiler.h>
+#include <linux/rbtree.h>
+#include <linux/ioprio.h>
+#include <linux/iocontext.h>
+#include <linux/ktime.h>
+#include "blk-cgroup.h"
+
+enum {
+	IOS_INTERACTIVE,
+	IOS_SYNC,
+	IOS_ASYNC,
+	IOS_NR_CLASSES,
+};
+
+static const char * const ios_class_name[IOS_NR_CLASSES] = {
+	"interactive", "sync", "async",
+};
+
+static const int interactive_expire = HZ / 10;	/* max time before an interactive read is submitted */
+static const int sync_expire = HZ / 2;		/* ditto for other sync requests */
+static const int async_expire = 2 * HZ;		/* ditto for async writes, these limits are SOFT! */
+static const int async_budget_kb = 2048;	/* async writes allowed per async_window ... */
+static const int async_window = HZ / 10;	/* ... while interactive reads are around */
+static const int interactive_window = HZ / 2;	/* how long an interactive read counts as "around" */
+static const int idle_window = HZ / 100;	/* hold async writes after an interactive read */
+
+#define IOS_HIST_BUCKETS	16
+#define IOS_HIST_SHIFT		6		/* first bucket is < 64us */
+
+struct interactive_data {
+	struct request_queue *queue;
+
+	/*
+	 * requests are present on both sort_list (for front merges) and
+	 * on the fifo_list of their class
+	 */
+	struct rb_root sort_list[2];
+	struct list_head fifo_list[IOS_NR_CLASSES];
+
+	/*
+	 * async write budget, in sectors, and when it is next refilled
+	 */
+	int budget;
+	unsigned long budget_refill;
+
+	unsigned long last_interactive;	/* last interactive request seen */
+	unsigned long idle_until;	/* async writes held back until */
+
+	struct timer_list kick_timer;
+	struct work_struct unplug_work;
+
+	unsigned long hist[IOS_NR_CLASSES][IOS_HIST_BUCKETS];
+
+	/*
+	 * settings that change how the i/o scheduler behaves
+	 */
+	int fifo_expire[IOS_NR_CLASSES];
+	int async_budget_kb;
+	int async_window;
+	int interactive_window;
+	int idle_window;
+	int front_merges;
+};
+
+#define RQ_CLASS(rq)		((int)(unsigned long)(rq)->elv.priv[0] - 1)
+#define RQ_SET_CLASS(rq, c)	((rq)->elv.priv[0] = (void *)(unsigned long)((c) + 1))
+#define RQ_ADD_TIME(rq)		((unsigned long)(rq)->elv.priv[1])
+#define RQ_SET_ADD_TIME(rq, t)	((rq)->elv.priv[1] = (void *)(unsigned long)(t))
+
+static inline unsigned long ios_now_us(void)
+{
+	return (unsigned long)ktime_to_us(ktime_get());
+}
+
+static inline struct rb_root *
+ios_rb_root(struct interactive_data *id, struct request *rq)
+{
+	return &id->sort_list[rq_data_dir(rq)];
+}
+
+/*
+ * Is the submitter of @bio in the foreground? Only the ioprio class and
+ * blkio cgroup are considered, a process can opt out of the interactive
+ * class with ionice -c3.
+ */
+static bool ios_foreground(struct bio *bio)
+{
+	struct io_context *ioc = current->io_context;
+	int prio = bio ? bio_prio(bio) : 0;
+	bool fg = true;
+
+	if (!ioprio_valid(prio) && ioc)
+		prio = ioc->ioprio;
+	if (IOPRIO_PRIO_CLASS(prio) == IOPRIO_CLASS_IDLE)
+		return false;
+
+#ifdef CONFIG_BLK_CGROUP
+	rcu_read_lock();
+	fg = bio_blkcg(bio) == &blkcg_root;
+	rcu_read_unlock();
+#endif
+	return fg;
+}
+
+static int ios_classify(struct request *rq, struct bio *bio)
+{
+	if (!rq_is_sync(rq))
+		return IOS_ASYNC;
+	if (rq_data_dir(rq) == READ && ios_foreground(bio))
+		return IOS_INTERACTIVE;
+	return IOS_SYNC;
+}
+
+/*
+ * called in the context of the submitter, classify the request
+ */
+static int ios_set_request(struct request_queue *q, struct request *rq,
+			   struct bio *bio, gfp_t gfp_mask)
+{
+	RQ_SET_CLASS(rq, ios_classify(rq, bio));
+	return 0;
+}
+
+/*
+ * add rq to rbtree and fifo
+ */
+static void ios_add_request(struct request_queue *q, struct request *rq)
+{
+	struct interactive_data *id = q->elevator->elevator_data;
+	int class;
+
+	/*
+	 * requests allocated while the queue was bypassing the elevator
+	 * never went through ios_set_request()
+	 */
+	if (!(rq->cmd_flags & REQ_ELVPRIV))
+		RQ_SET_CLASS(rq, rq_is_sync(rq) ? IOS_SYNC : IOS_ASYNC);
+	class = RQ_CLASS(rq);
+
+	if (class == IOS_INTERACTIVE)
+		id->last_interactive = jiffies;
+
+	elv_rb_add(ios_rb_root(id, rq), rq);
+
+	/*
+	 * set expire time and add to fifo list
+	 */
+	RQ_SET_ADD_TIME(rq, ios_now_us());
+	rq_set_fifo_time(rq, jiffies + id->fifo_expire[class]);
+	list_add_tail(&rq->queuelist, &id->fifo_list[class]);
+}
+
+/*
+ * remove rq from rbtree and fifo.
+ */
+static void ios_remove_request(struct request_queue *q, struct request *rq)
+{
+	struct interactive_data *id = q->elevator->elevator_data;
+
+	rq_fifo_clear(rq);
+	elv_rb_del(ios_rb_root(id, rq), rq);
+}
+
+static int
+ios_merge(struct request_queue *q, struct request **req, struct bio *bio)
+{
+	struct interactive_data *id = q->elevator->elevator_data;
+	struct request *__rq;
+
+	/*
+	 * check for front merge
+	 */
+	if (id->front_merges) {
+		sector_t sector = bio_end_sector(bio);
+
+		__rq = elv_rb_find(&id->sort_list[bio_data_dir(bio)], sector);
+		if (__rq) {
+			BUG_ON(sector != blk_rq_pos(__rq));
+
+			if (elv_rq_merge_ok(__rq, bio)) {
+				*req = __rq;
+				return ELEVATOR_FRONT_MERGE;
+			}
+		}
+	}
+
+	return ELEVATOR_NO_MERGE;
+}
+
+static void ios_merged_request(struct request_queue *q,
+			       struct request *req, int type)
+{
+	struct interactive_data *id = q->elevator->elevator_data;
+
+	/*
+	 * if the merge was a front merge, we need to reposition request
+	 */
+	if (type == ELEVATOR_FRONT_MERGE) {
+		elv_rb_del(ios_rb_root(id, req), req);
+		elv_rb_add(ios_rb_root(id, req), req);
+	}
+}
+
+static void
+ios_merged_requests(struct request_queue *q, struct request *req,
+		    struct request *next)
+{
+	if (!list_empty(&req->queuelist) && !list_empty(&next->queuelist)) {
+		/*
+		 * the merged request is served in the better of the two
+		 * classes, so a foreground read is never demoted
+		 */
+		if (RQ_CLASS(next) < RQ_CLASS(req)) {
+			RQ_SET_CLASS(req, RQ_CLASS(next));
+			list_move(&req->queuelist, &next->queuelist);
+			rq_set_fifo_time(req, rq_fifo_time(next));
+			RQ_SET_ADD_TIME(req, RQ_ADD_TIME(next));
+		} else if (RQ_CLASS(next) == RQ_CLASS(req) &&
+			   time_before(rq_fifo_time(next), rq_fifo_time(req))) {
+			list_move(&req->queuelist, &next->queuelist);
+			rq_set_fifo_time(req, rq_fifo_time(next));
+			RQ_SET_ADD_TIME(req, RQ_ADD_TIME(next));
+		}
+	}
+
+	/*
+	 * kill knowledge of next, this one is a goner
+	 */
+	ios_remove_request(q, next);
+}
+
+static void ios_account_dispatch(struct interactive_data *id,
+				 struct request *rq)
+{
+	unsigned long delta = ios_now_us() - RQ_ADD_TIME(rq);
+	int bucket = fls_long(delta >> IOS_HIST_SHIFT);
+
+	if (bucket >= IOS_HIST_BUCKETS)
+		bucket = IOS_HIST_BUCKETS - 1;
+	id->hist[RQ_CLASS(rq)][bucket]++;
+}
+
+/*
+ * move request from sort list to dispatch queue.
+ */
+static void ios_move_to_dispatch(struct interactive_data *id,
+				 struct request *rq)
+{
+	struct request_queue *q = rq->q;
+
+	if (RQ_CLASS(rq) == IOS_ASYNC)
+		id->budget -= blk_rq_sectors(rq);
+
+	ios_account_dispatch(id, rq);
+	ios_remove_request(q, rq);
+	elv_dispatch_add_tail(q, rq);
+}
+
+/*
+ * ios_check_fifo returns 1 if the oldest request of @class has expired.
+ */
+static inline int ios_check_fifo(struct interactive_data *id, int class)
+{
+	struct request *rq;
+
+	if (list_empty(&id->fifo_list[class]))
+		return 0;
+
+	rq = rq_entry_fifo(id->fifo_list[class].next);
+	return time_after_eq(jiffies, rq_fifo_time(rq));
+}
+
+static void ios_arm_kick(struct interactive_data *id, unsigned long when)
+{
+	if (!timer_pending(&id->kick_timer) ||
+	    time_before(when, id->kick_timer.expires))
+		mod_timer(&id->kick_timer, when);
+}
+
+/*
+ * May an async write go to the driver now? If not, make sure the queue is
+ * run again once it may.
+ */
+static int ios_async_allowed(struct interactive_data *id)
+{
+	unsigned long now = jiffies;
+
+	if (time_after(now, id->last_interactive + id->interactive_window))
+		return 1;
+
+	if (time_before(now, id->idle_until)) {
+		ios_arm_kick(id, id->idle_until);
+		return 0;
+	}
+
+	if (time_after_eq(now, id->budget_refill)) {
+		id->budget = id->async_budget_kb << 1;
+		id->budget_refill = now + id->async_window;
+	}
+
+	if (id->budget > 0)
+		return 1;
+
+	ios_arm_kick(id, id->budget_refill);
+	return 0;
+}
+
+/*
+ * ios_dispatch_requests dispatches expired requests first and otherwise
+ * picks the oldest request of the best non-empty class, subject to the
+ * async write budget.
+ */
+static int ios_dispatch_requests(struct request_queue *q, int force)
+{
+	struct interactive_data *id = q->elevator->elevator_data;
+	struct request *rq;
+	int class;
+
+	for (class = 0; class < IOS_NR_CLASSES; class++)
+		if (ios_check_fifo(id, class))
+			goto dispatch_request;
+
+	for (class = 0; class < IOS_NR_CLASSES; class++) {
+		if (list_empty(&id->fifo_list[class]))
+			continue;
+		if (class == IOS_ASYNC && !force && !ios_async_allowed(id))
+			return 0;
+		goto dispatch_request;
+	}
+
+	return 0;
+
+dispatch_request:
+	rq = rq_entry_fifo(id->fifo_list[class].next);
+	ios_move_to_dispatch(id, rq);
+
+	return 1;
+}
+
+static void ios_completed_request(struct request_queue *q, struct request *rq)
+{
+	struct interactive_data *id = q->elevator->elevator_data;
+
+	/*
+	 * only requests that went through the elevator carry a class
+	 */
+	if (!(rq->cmd_flags & REQ_ELVPRIV) || RQ_CLASS(rq) != IOS_INTERACTIVE)
+		return;
+
+	if (blk_queue_nonrot(q) && id->idle_window)
+		id->idle_until = jiffies + id->idle_window;
+}
+
+static void ios_kick_queue(struct work_struct *work)
+{
+	struct interactive_data *id =
+		container_of(work, struct interactive_data, unplug_work);
+	struct request_queue *q = id->queue;
+
+	spin_lock_irq(q->queue_lock);
+	__blk_run_queue(q);
+	spin_unlock_irq(q->queue_lock);
+}
+
+static void ios_kick_timer(unsigned long data)
+{
+	struct interactive_data *id = (struct interactive_data *) data;
+
+	kblockd_schedule_work(id->queue, &id->unplug_work);
+}
+
+static void ios_exit_queue(struct elevator_queue *e)
+{
+	struct interactive_data *id = e->elevator_data;
+	int class;
+
+	del_timer_sync(&id->kick_timer);
+	cancel_work_sync(&id->unplug_work);
+
+	for (class = 0; class < IOS_NR_CLASSES; class++)
+		BUG_ON(!list_empty(&id->fifo_list[class]));
+
+	kfree(id);
+}
+
+/*
+ * initialize elevator private data (interactive_data).
+ */
+static int ios_init_queue(struct request_queue *q, struct elevator_type *e)
+{
+	struct interactive_data *id;
+	struct elevator_queue *eq;
+	int class;
+
+	eq = elevator_alloc(q, e);
+	if (!eq)
+		return -ENOMEM;
+
+	id = kmalloc_node(sizeof(*id), GFP_KERNEL | __GFP_ZERO, q->node);
+	if (!id) {
+		kobject_put(&eq->kobj);
+		return -ENOMEM;
+	}
+	eq->elevator_data = id;
+
+	id->queue = q;
+	for (class = 0; class < IOS_NR_CLASSES; class++)
+		INIT_LIST_HEAD(&id->fifo_list[class]);
+	id->sort_list[READ] = RB_ROOT;
+	id->sort_list[WRITE] = RB_ROOT;
+	id->fifo_expire[IOS_INTERACTIVE] = interactive_expire;
+	id->fifo_expire[IOS_SYNC] = sync_expire;
+	id->fifo_expire[IOS_ASYNC] = async_expire;
+	id->async_budget_kb = async_budget_kb;
+	id->async_window = async_window;
+	id->interactive_window = interactive_window;
+	id->idle_window = idle_window;
+	id->front_merges = 1;
+	id->last_interactive = jiffies - interactive_window - 1;
+	id->idle_until = jiffies;
+	id->budget_refill = jiffies;
+
+	setup_timer(&id->kick_timer, ios_kick_timer, (unsigned long) id);
+	INIT_WORK(&id->unplug_work, ios_kick_queue);
+
+	spin_lock_irq(q->queue_lock);
+	q->elevator = eq;
+	spin_unlock_irq(q->queue_lock);
+	return 0;
+}
+
+/*
+ * sysfs parts below
+ */
+
+static ssize_t
+ios_var_show(int var, char *page)
+{
+	return sprintf(page, "%d\n", var);
+}
+
+static ssize_t
+ios_var_store(int *var, const char *page, size_t count)
+{
+	char *p = (char *) page;
+
+	*var = simple_strtol(p, &p, 10);
+	return count;
+}
+
+#define SHOW_FUNCTION(__FUNC, __VAR, __CONV)				\
+static ssize_t __FUNC(struct elevator_queue *e, char *page)		\
+{									\
+	struct interactive_data *id = e->elevator_data;			\
+	int __data = __VAR;						\
+	if (__CONV)							\
+		__data = jiffies_to_msecs(__data);			\
+	return ios_var_show(__data, (page));				\
+}
+SHOW_FUNCTION(ios_interactive_expire_show, id->fifo_expire[IOS_INTERACTIVE], 1);
+SHOW_FUNCTION(ios_sync_expire_show, id->fifo_expire[IOS_SYNC], 1);
+SHOW_FUNCTION(ios_async_expire_show, id->fifo_expire[IOS_ASYNC], 1);
+SHOW_FUNCTION(ios_async_budget_kb_show, id->async_budget_kb, 0);
+SHOW_FUNCTION(ios_async_window_show, id->async_window, 1);
+SHOW_FUNCTION(ios_interactive_window_show, id->interactive_window, 1);
+SHOW_FUNCTION(ios_idle_window_show, id->idle_window, 1);
+SHOW_FUNCTION(ios_front_merges_show, id->front_merges, 0);
+#undef SHOW_FUNCTION
+
+#define STORE_FUNCTION(__FUNC, __PTR, MIN, MAX, __CONV)			\
+static ssize_t __FUNC(struct elevator_queue *e, const char *page, size_t count)	\
+{									\
+	struct interactive_data *id = e->elevator_data;			\
+	int __data;							\
+	int ret = ios_var_store(&__data, (page), count);		\
+	if (__data < (MIN))						\
+		__data = (MIN);						\
+	else if (__data > (MAX))					\
+		__data = (MAX);						\
+	if (__CONV)							\
+		*(__PTR) = msecs_to_jiffies(__data);			\
+	else								\
+		*(__PTR) = __data;					\
+	return ret;							\
+}
+STORE_FUNCTION(ios_interactive_expire_store, &id->fifo_expire[IOS_INTERACTIVE], 0, INT_MAX, 1);
+STORE_FUNCTION(ios_sync_expire_store, &id->fifo_expire[IOS_SYNC], 0, INT_MAX, 1);
+STORE_FUNCTION(ios_async_expire_store, &id->fifo_expire[IOS_ASYNC], 0, INT_MAX, 1);
+STORE_FUNCTION(ios_async_budget_kb_store, &id->async_budget_kb, 1, INT_MAX >> 1, 0);
+STORE_FUNCTION(ios_async_window_store, &id->async_window, 1, INT_MAX, 1);
+STORE_FUNCTION(ios_interactive_window_store, &id->interactive_window, 0, INT_MAX, 1);
+STORE_FUNCTION(ios_idle_window_store, &id->idle_window, 0, 1000, 1);
+STORE_FUNCTION(ios_front_merges_store, &id->front_merges, 0, 1, 0);
+#undef STORE_FUNCTION
+
+static ssize_t ios_latency_hist_show(struct elevator_queue *e, char *page)
+{
+	struct interactive_data *id = e->elevator_data;
+	ssize_t len = 0;
+	int class, i;
+
+	len += sprintf(page + len, "%-12s", "usecs<");
+	for (i = 0; i < IOS_HIST_BUCKETS - 1; i++)
+		len += sprintf(page + len, " %lu", 1UL << (i + IOS_HIST_SHIFT));
+	len += sprintf(page + len, " inf\n");
+
+	for (class = 0; class < IOS_NR_CLASSES; class++) {
+		len += sprintf(page + len, "%-12s", ios_class_name[class]);
+		for (i = 0; i < IOS_HIST_BUCKETS; i++)
+			len += sprintf(page + len, " %lu", id->hist[class][i]);
+		len += sprintf(page + len, "\n");
+	}
+
+	return len;
+}
+
+static ssize_t ios_latency_hist_store(struct elevator_queue *e,
+				      const char *page, size_t count)
+{
+	struct interactive_data *id = e->elevator_data;
+
+	memset(id->hist, 0, sizeof(id->hist));
+	return count;
+}
+
+#define IOS_ATTR(name) \
+	__ATTR(name, S_IRUGO|S_IWUSR, ios_##name##_show, \
+				      ios_##name##_store)
+
+static struct elv_fs_entry ios_attrs[] = {
+	IOS_ATTR(interactive_expire),
+	IOS_ATTR(sync_expire),
+	IOS_ATTR(async_expire),
+	IOS_ATTR(async_budget_kb),
+	IOS_ATTR(async_window),
+	IOS_ATTR(interactive_window),
+	IOS_ATTR(idle_window),
+	IOS_ATTR(front_merges),
+	IOS_ATTR(latency_hist),
+	__ATTR_NULL
+};
+
+static struct elevator_type iosched_interactive = {
+	.ops = {
+		.elevator_merge_fn = 		ios_merge,
+		.elevator_merged_fn =		ios_merged_request,
+		.elevator_merge_req_fn =	ios_merged_requests,
+		.elevator_dispatch_fn =		ios_dispatch_requests,
+		.elevator_add_req_fn =		ios_add_request,
+		.elevator_completed_req_fn =	ios_completed_request,
+		.elevator_former_req_fn =	elv_rb_former_request,
+		.elevator_latter_req_fn =	elv_rb_latter_request,
+		.elevator_set_req_fn =		ios_set_request,
+		.elevator_init_fn =		ios_init_queue,
+		.elevator_exit_fn =		ios_exit_queue,
+	},
+
+	.elevator_attrs = ios_attrs,
+	.elevator_name = "interactive",
+	.elevator_owner = THIS_MODULE,
+};
+
+static int __init interactive_init(void)
+{
+	return elv_register(&iosched_interactive);
+}
+
+static void __exit interactive_exit(void)
+{
+	elv_unregister(&iosched_interactive);
+}
+
+module_init(interactive_init);
+module_exit(interactive_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("interactive IO scheduler");
@@ -318,24 +318,24 @@ int mt_config_gdma(int channel, struct mt_gdma_conf *config, DMA_CONF_FLAG flag)
 
 			/*setup security channel */
 			if (config->sec){
-				pr_notice("1:ChSEC:%x\n",readl(DMA_GDMA_SEC_EN));
+				pr_debug("1:ChSEC:%x\n",readl(DMA_GDMA_SEC_EN));
 				mt_reg_sync_writel((DMA_SEC_EN_BIT|readl(DMA_GDMA_SEC_EN)), DMA_GDMA_SEC_EN);
-				pr_notice("2:ChSEC:%x\n",readl(DMA_GDMA_SEC_EN));
+				pr_debug("2:ChSEC:%x\n",readl(DMA_GDMA_SEC_EN));
 			} else {
-				pr_notice("1:ChSEC:%x\n",readl(DMA_GDMA_SEC_EN));
+				pr_debug("1:ChSEC:%x\n",readl(DMA_GDMA_SEC_EN));
 				mt_reg_sync_writel(((~DMA_SEC_EN_BIT)&readl(DMA_GDMA_SEC_EN)), DMA_GDMA_SEC_EN);
-				pr_notice("2:ChSEC:%x\n",readl(DMA_GDMA_SEC_EN));
+				pr_debug("2:ChSEC:%x\n",readl(DMA_GDMA_SEC_EN));
 			}
 
 			/*setup domain_cfg */
 			if (config->domain){
-				pr_notice("1:Domain_cfg:%x\n",readl(DMA_GDMA_SEC_EN));
+				pr_debug("1:Domain_cfg:%x\n",readl(DMA_GDMA_SEC_EN));
 				mt_reg_sync_writel(((config->domain << 1) | readl(DMA_GDMA_SEC_EN)), DMA_GDMA_SEC_EN);
-				pr_notice("2:Domain_cfg:%x\n",readl(DMA_GDMA_SEC_EN));
+				pr_debug("2:Domain_cfg:%x\n",readl(DMA_GDMA_SEC_EN));
 			} else {
-				pr_notice("1:Domain_cfg:%x\n",readl(DMA_GDMA_SEC_EN));
+				pr_debug("1:Domain_cfg:%x\n",readl(DMA_GDMA_SEC_EN));
 				mt_reg_sync_writel((0x1 & readl(DMA_GDMA_SEC_EN)), DMA_GDMA_SEC_EN);
-				pr_notice("2:Domain_cfg:%x\n",readl(DMA_GDMA_SEC_EN));
+				pr_debug("2:Domain_cfg:%x\n",readl(DMA_GDMA_SEC_EN));
 			}
 
 			if (config->wpen) {
@@ -0,0 +1,770 @@
+/*
+ * dmaengine memcpy/sg provider on top of the CQDMA driver.
+ *
+ * A single channel queues descriptors and runs them one at a time. Each
+ * descriptor is split into segments the hardware can take in one go. The
+ * CQDMA engine is only held while a descriptor runs, so the legacy mt_*_gdma
+ * users still get it in between. When the engine is busy, missing or
+ * disabled through the "backend" attribute, the descriptor is copied by the
+ * CPU from a work item instead. Completion goes through the same tasklet
+ * in both cases, so clients cannot tell the two backends apart.
+ */
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/slab.h>
+#include <linux/sizes.h>
+#include <linux/spinlock.h>
+#include <linux/interrupt.h>
+#include <linux/workqueue.h>
+#include <linux/completion.h>
+#include <linux/platform_device.h>
+#include <linux/dmaengine.h>
+#include <linux/dma-mapping.h>
+#include <linux/scatterlist.h>
+#include <linux/highmem.h>
+#include <linux/ktime.h>
+#include <linux/delay.h>
+#include <asm/cacheflush.h>
+#include <asm/outercache.h>
+#include <mach/dma.h>
+
+/* below MAX_TRANSFER_LEN1 of the engine, page aligned for the CPU path */
+#define CQDMA_SEG_MAX		(SZ_512K)
+
+#define CQDMA_BENCH_MAX_LEN	(SZ_4M)
+#define CQDMA_BENCH_ITERS	(16)
+#define CQDMA_BENCH_TIMEOUT	(5000)	/* ms */
+
+struct cqdma_seg {
+	dma_addr_t src;
+	dma_addr_t dst;
+	size_t len;
+};
+
+struct cqdma_desc {
+	struct dma_async_tx_descriptor tx;
+	struct list_head node;
+	/* whole buffers of a memcpy, for the unmap on completion */
+	dma_addr_t src;
+	dma_addr_t dst;
+	size_t len;
+	bool unmap;
+	unsigned int cur;
+	unsigned int nr_segs;
+	struct cqdma_seg segs[0];
+};
+
+struct cqdma_dmaengine {
+	struct dma_device dma;
+	struct dma_chan chan;
+	struct platform_device *pdev;
+
+	spinlock_t lock;
+	struct list_head submitted;
+	struct list_head issued;
+	struct list_head done;
+	struct cqdma_desc *active;
+	int hw_ch;		/* engine held while active runs on it, -1 otherwise */
+	bool hw_done;		/* segment finished, set from the CQDMA isr */
+	bool force_cpu;
+
+	struct tasklet_struct tasklet;
+	struct work_struct cpu_work;
+
+	unsigned long nr_hw;
+	unsigned long nr_cpu;
+	char bench_result[128];
+};
+
+static struct cqdma_dmaengine *cqdma_de;
+
+static inline struct cqdma_desc *to_cqdma_desc(struct dma_async_tx_descriptor *tx)
+{
+	return container_of(tx, struct cqdma_desc, tx);
+}
+
+/*
+ * Backends. Apart from the isr callback and the CPU copy itself, these run
+ * with de->lock held.
+ */
+static void cqdma_hw_isr_cb(void *data)
+{
+	struct cqdma_dmaengine *de = data;
+
+	spin_lock(&de->lock);
+	de->hw_done = true;
+	spin_unlock(&de->lock);
+
+	tasklet_schedule(&de->tasklet);
+}
+
+static int cqdma_hw_program(struct cqdma_dmaengine *de)
+{
+	struct cqdma_seg *seg = &de->active->segs[de->active->cur];
+	struct mt_gdma_conf conf;
+	int ret;
+
+	memset(&conf, 0, sizeof(conf));
+	conf.count = seg->len;
+	conf.src = seg->src;
+	conf.dst = seg->dst;
+	conf.iten = DMA_TRUE;
+	conf.isr_cb = cqdma_hw_isr_cb;
+	conf.data = de;
+	conf.burst = DMA_CON_BURST_SINGLE;
+	conf.dfix = DMA_FALSE;
+	conf.sfix = DMA_FALSE;
+	conf.sec = DMA_FALSE;
+
+	ret = mt_config_gdma(de->hw_ch, &conf, ALL);
+	if (!ret)
+		ret = mt_start_gdma(de->hw_ch);
+
+	return ret;
+}
+
+static void cqdma_hw_release(struct cqdma_dmaengine *de)
+{
+	if (de->hw_ch >= 0) {
+		mt_free_gdma(de->hw_ch);
+		de->hw_ch = -1;
+	}
+}
+
+static void cqdma_complete_active(struct cqdma_dmaengine *de)
+{
+	struct cqdma_desc *desc = de->active;
+
+	de->active = NULL;
+	de->chan.completed_cookie = desc->tx.cookie;
+	list_add_tail(&desc->node, &de->done);
+	tasklet_schedule(&de->tasklet);
+}
+
+static void cqdma_start_next(struct cqdma_dmaengine *de)
+{
+	int ch;
+
+	if (de->active)
+		return;
+
+	if (list_empty(&de->issued) || de->force_cpu) {
+		cqdma_hw_release(de);
+		if (list_empty(&de->issued))
+			return;
+	}
+
+	de->active = list_first_entry(&de->issued, struct cqdma_desc, node);
+	list_del(&de->active->node);
+	de->active->cur = 0;
+
+	if (!de->force_cpu && de->hw_ch < 0) {
+		ch = mt_req_gdma(GDMA_1);
+		de->hw_ch = (ch >= 0) ? ch : -1;
+	}
+
+	if (de->hw_ch >= 0 && !cqdma_hw_program(de)) {
+		de->nr_hw++;
+		return;
+	}
+
+	cqdma_hw_release(de);
+	de->nr_cpu++;
+	schedule_work(&de->cpu_work);
+}
+
+static void cqdma_cpu_copy(struct cqdma_dmaengine *de, struct cqdma_seg *seg)
+{
+	struct device *dev = de->dma.dev;
+	dma_addr_t src = seg->src, dst = seg->dst;
+	size_t len = seg->len;
+
+	while (len) {
+		size_t soff = src & ~PAGE_MASK, doff = dst & ~PAGE_MASK;
+		size_t n = min3(len, PAGE_SIZE - soff, PAGE_SIZE - doff);
+		phys_addr_t dphys = __pfn_to_phys(dma_to_pfn(dev, dst)) + doff;
+		void *s, *d;
+
+		s = kmap_atomic(pfn_to_page(dma_to_pfn(dev, src)));
+		d = kmap_atomic(pfn_to_page(dma_to_pfn(dev, dst)));
+
+		memcpy(d + doff, s + soff, n);
+
+		/* the client mapped dst for the device, write it back past the caches */
+		dmac_flush_range(d + doff, d + doff + n);
+		outer_flush_range(dphys, dphys + n);
+
+		kunmap_atomic(d);
+		kunmap_atomic(s);
+
+		src += n;
+		dst += n;
+		len -= n;
+	}
+}
+
+static void cqdma_cpu_work(struct work_struct *work)
+{
+	struct cqdma_dmaengine *de = container_of(work, struct cqdma_dmaengine, cpu_work);
+	struct cqdma_desc *desc;
+	unsigned long flags;
+
+	spin_lock_irqsave(&de->lock, flags);
+	desc = de->active;
+	spin_unlock_irqrestore(&de->lock, flags);
+
+	if (!desc)
+		return;
+
+	/* active only changes hands here or in the tasklet, never both at once */
+	for (; desc->cur < desc->nr_segs; desc->cur++) {
+		cqdma_cpu_copy(de, &desc->segs[desc->cur]);
+		cond_resched();
+	}
+
+	spin_lock_irqsave(&de->lock, flags);
+	cqdma_complete_active(de);
+	cqdma_start_next(de);
+	spin_unlock_irqrestore(&de->lock, flags);
+}
+
+static void cqdma_desc_unmap(struct cqdma_dmaengine *de, struct cqdma_desc *desc)
+{
+	struct device *dev = de->dma.dev;
+	enum dma_ctrl_flags flags = desc->tx.flags;
+
+	if (!desc->unmap)
+		return;
+
+	if (!(flags & DMA_COMPL_SKIP_DEST_UNMAP)) {
+		if (flags & DMA_COMPL_DEST_UNMAP_SINGLE)
+			dma_unmap_single(dev, desc->dst, desc->len, DMA_FROM_DEVICE);
+		else
+			dma_unmap_page(dev, desc->dst, desc->len, DMA_FROM_DEVICE);
+	}
+
+	if (!(flags & DMA_COMPL_SKIP_SRC_UNMAP)) {
+		if (flags & DMA_COMPL_SRC_UNMAP_SINGLE)
+			dma_unmap_single(dev, desc->src, desc->len, DMA_TO_DEVICE);
+		else
+			dma_unmap_page(dev, desc->src, desc->len, DMA_TO_DEVICE);
+	}
+}
+
+/*
+ * Advances the hardware to the next segment and runs the completion
+ * callbacks of finished descriptors, whichever backend ran them.
+ */
+static void cqdma_tasklet(unsigned long data)
+{
+	struct cqdma_dmaengine *de = (struct cqdma_dmaengine *)data;
+	struct cqdma_desc *desc, *tmp;
+	unsigned long flags;
+	LIST_HEAD(done);
+
+	spin_lock_irqsave(&de->lock, flags);
+	if (de->hw_done) {
+		de->hw_done = false;
+		desc = de->active;
+		if (desc && ++desc->cur < desc->nr_segs) {
+			if (cqdma_hw_program(de)) {
+				/* the rest of this descriptor goes to the CPU */
+				cqdma_hw_release(de);
+				schedule_work(&de->cpu_work);
+			}
+		} else if (desc) {
+			cqdma_complete_active(de);
+			cqdma_start_next(de);
+		}
+	}
+	list_splice_init(&de->done, &done);
+	spin_unlock_irqrestore(&de->lock, flags);
+
+	list_for_each_entry_safe(desc, tmp, &done, node) {
+		list_del(&desc->node);
+		cqdma_desc_unmap(de, desc);
+		if (desc->tx.callback)
+			desc->tx.callback(desc->tx.callback_param);
+		dma_run_dependencies(&desc->tx);
+		kfree(desc);
+	}
+}
+
+/*
+ * dmaengine interface
+ */
+static dma_cookie_t cqdma_tx_submit(struct dma_async_tx_descriptor *tx)
+{
+	struct cqdma_dmaengine *de = cqdma_de;
+	struct dma_chan *chan = tx->chan;
+	dma_cookie_t cookie;
+	unsigned long flags;
+
+	spin_lock_irqsave(&de->lock, flags);
+	cookie = chan->cookie + 1;
+	if (cookie < DMA_MIN_COOKIE)
+		cookie = DMA_MIN_COOKIE;
+	tx->cookie = chan->cookie = cookie;
+	list_add_tail(&to_cqdma_desc(tx)->node, &de->submitted);
+	spin_unlock_irqrestore(&de->lock, flags);
+
+	return cookie;
+}
+
+static struct cqdma_desc *cqdma_desc_alloc(struct dma_chan *chan, unsigned int nr_segs,
+					   unsigned long flags)
+{
+	struct cqdma_desc *desc;
+
+	desc = kzalloc(sizeof(*desc) + nr_segs * sizeof(struct cqdma_seg), GFP_NOWAIT);
+	if (!desc)
+		return NULL;
+
+	dma_async_tx_descriptor_init(&desc->tx, chan);
+	desc->tx.tx_submit = cqdma_tx_submit;
+	desc->tx.flags = flags;
+	desc->nr_segs = nr_segs;
+	INIT_LIST_HEAD(&desc->node);
+
+	return desc;
+}
+
+static struct dma_async_tx_descriptor *cqdma_prep_memcpy(struct dma_chan *chan,
+							  dma_addr_t dest, dma_addr_t src,
+							  size_t len, unsigned long flags)
+{
+	struct cqdma_desc *desc;
+	size_t off, n;
+	unsigned int i;
+
+	if (!len)
+		return NULL;
+
+	desc = cqdma_desc_alloc(chan, DIV_ROUND_UP(len, CQDMA_SEG_MAX), flags);
+	if (!desc)
+		return NULL;
+
+	for (i = 0, off = 0; off < len; i++, off += n) {
+		n = min_t(size_t, len - off, CQDMA_SEG_MAX);
+		desc->segs[i].src = src + off;
+		desc->segs[i].dst = dest + off;
+		desc->segs[i].len = n;
+	}
+
+	desc->src = src;
+	desc->dst = dest;
+	desc->len = len;
+	desc->unmap = true;
+
+	return &desc->tx;
+}
+
+/* splits two sg lists into common segments, only counts them when segs is NULL */
+static unsigned int cqdma_sg_walk(struct scatterlist *dst_sg, unsigned int dst_nents,
+				  struct scatterlist *src_sg, unsigned int src_nents,
+				  struct cqdma_seg *segs)
+{
+	dma_addr_t dst = sg_dma_address(dst_sg), src = sg_dma_address(src_sg);
+	size_t dst_avail = sg_dma_len(dst_sg), src_avail = sg_dma_len(src_sg);
+	unsigned int nr = 0;
+	size_t n;
+
+	for (;;) {
+		if (!dst_avail) {
+			if (--dst_nents == 0 || !(dst_sg = sg_next(dst_sg)))
+				break;
+			dst = sg_dma_address(dst_sg);
+			dst_avail = sg_dma_len(dst_sg);
+			continue;
+		}
+
+		if (!src_avail) {
+			if (--src_nents == 0 || !(src_sg = sg_next(src_sg)))
+				break;
+			src = sg_dma_address(src_sg);
+			src_avail = sg_dma_len(src_sg);
+			continue;
+		}
+
+		n = min_t(size_t, min(dst_avail, src_avail), CQDMA_SEG_MAX);
+		if (segs) {
+			segs[nr].src = src;
+			segs[nr].dst = dst;
+			segs[nr].len = n;
+		}
+		nr++;
+
+		dst += n;
+		src += n;
+		dst_avail -= n;
+		src_avail -= n;
+	}
+
+	return nr;
+}
+
+static struct dma_async_tx_descriptor *cqdma_prep_sg(struct dma_chan *chan,
+						      struct scatterlist *dst_sg,
+						      unsigned int dst_nents,
+						      struct scatterlist *src_sg,
+						      unsigned int src_nents,
+						      unsigned long flags)
+{
+	struct cqdma_desc *desc;
+	unsigned int nr_segs;
+
+	if (!dst_sg || !src_sg || !dst_nents || !src_nents)
+		return NULL;
+
+	nr_segs = cqdma_sg_walk(dst_sg, dst_nents, src_sg, src_nents, NULL);
+	if (!nr_segs)
+		return NULL;
+
+	desc = cqdma_desc_alloc(chan, nr_segs, flags);
+	if (!desc)
+		return NULL;
+
+	cqdma_sg_walk(dst_sg, dst_nents, src_sg, src_nents, desc->segs);
+
+	return &desc->tx;
+}
+
+static void cqdma_issue_pending(struct dma_chan *chan)
+{
+	struct cqdma_dmaengine *de = cqdma_de;
+	unsigned long flags;
+
+	spin_lock_irqsave(&de->lock, flags);
+	list_splice_tail_init(&de->submitted, &de->issued);
+	cqdma_start_next(de);
+	spin_unlock_irqrestore(&de->lock, flags);
+}
+
+static enum dma_status cqdma_tx_status(struct dma_chan *chan, dma_cookie_t cookie,
+				       struct dma_tx_state *txstate)
+{
+	struct cqdma_dmaengine *de = cqdma_de;
+	dma_cookie_t last, used;
+	unsigned long flags;
+
+	spin_lock_irqsave(&de->lock, flags);
+	last = chan->completed_cookie;
+	used = chan->cookie;
+	spin_unlock_irqrestore(&de->lock, flags);
+
+	dma_set_tx_state(txstate, last, used, 0);
+
+	return dma_async_is_complete(cookie, last, used);
+}
+
+/* drops everything not started yet, the running descriptor completes normally */
+static int cqdma_control(struct dma_chan *chan, enum dma_ctrl_cmd cmd, unsigned long arg)
+{
+	struct cqdma_dmaengine *de = cqdma_de;
+	struct cqdma_desc *desc, *tmp;
+	unsigned long flags;
+	LIST_HEAD(drop);
+
+	if (cmd != DMA_TERMINATE_ALL)
+		return -ENXIO;
+
+	spin_lock_irqsave(&de->lock, flags);
+	list_splice_init(&de->submitted, &drop);
+	list_splice_init(&de->issued, &drop);
+	spin_unlock_irqrestore(&de->lock, flags);
+
+	list_for_each_entry_safe(desc, tmp, &drop, node) {
+		list_del(&desc->node);
+		kfree(desc);
+	}
+
+	return 0;
+}
+
+static int cqdma_alloc_chan_resources(struct dma_chan *chan)
+{
+	chan->cookie = DMA_MIN_COOKIE;
+	chan->completed_cookie = DMA_MIN_COOKIE;
+
+	return 1;
+}
+
+static void cqdma_free_chan_resources(struct dma_chan *chan)
+{
+	struct cqdma_dmaengine *de = cqdma_de;
+	int timeout = CQDMA_BENCH_TIMEOUT;
+
+	cqdma_control(chan, DMA_TERMINATE_ALL, 0);
+
+	while (ACCESS_ONCE(de->active) && timeout--)
+		msleep(1);
+
+	if (de->active)
+		pr_err("[CQDMA] dmaengine descriptor still running on release\n");
+
+	tasklet_kill(&de->tasklet);
+}
+
+/*
+ * sysfs: backend selection, statistics and a dmatest-style throughput test
+ */
+static void cqdma_bench_done(void *arg)
+{
+	complete(arg);
+}
+
+static bool cqdma_bench_filter(struct dma_chan *chan, void *param)
+{
+	return chan->device == param;
+}
+
+/*
+ * Runs as an ordinary client: the channel is taken with dma_request_channel(),
+ * so the bench fails with -EBUSY rather than share it with other users, and
+ * only its own descriptors are ever waited on.
+ */
+static int cqdma_bench_run(struct cqdma_dmaengine *de, bool cpu, size_t len,
+			   unsigned int *kbps)
+{
+	struct dma_chan *chan;
+	struct device *dev;
+	struct dma_async_tx_descriptor *tx;
+	unsigned long flags = DMA_CTRL_ACK | DMA_COMPL_SKIP_SRC_UNMAP | DMA_COMPL_SKIP_DEST_UNMAP;
+	DECLARE_COMPLETION_ONSTACK(done);
+	unsigned long src_buf, dst_buf;
+	dma_addr_t src, dst;
+	dma_cookie_t cookie, last = -EINVAL;
+	dma_cap_mask_t mask;
+	bool saved_force_cpu, armed = false;
+	ktime_t start;
+	s64 us;
+	int i, ret = 0;
+
+	dma_cap_zero(mask);
+	dma_cap_set(DMA_MEMCPY, mask);
+	chan = dma_request_channel(mask, cqdma_bench_filter, &de->dma);
+	if (!chan)
+		return -EBUSY;
+	dev = chan->device->dev;
+
+	src_buf = __get_free_pages(GFP_KERNEL, get_order(len));
+	dst_buf = __get_free_pages(GFP_KERNEL, get_order(len));
+	if (!src_buf || !dst_buf) {
+		ret = -ENOMEM;
+		goto out_free;
+	}
+
+	for (i = 0; i < len; i++)
+		((u8 *)src_buf)[i] = (u8)(i ^ (i >> 8));
+	memset((void *)dst_buf, 0, len);
+
+	src = dma_map_single(dev, (void *)src_buf, len, DMA_TO_DEVICE);
+	if (dma_mapping_error(dev, src)) {
+		ret = -ENOMEM;
+		goto out_free;
+	}
+	dst = dma_map_single(dev, (void *)dst_buf, len, DMA_FROM_DEVICE);
+	if (dma_mapping_error(dev, dst)) {
+		ret = -ENOMEM;
+		goto out_unmap_src;
+	}
+
+	spin_lock_irq(&de->lock);
+	saved_force_cpu = de->force_cpu;
+	de->force_cpu = cpu;
+	spin_unlock_irq(&de->lock);
+
+	start = ktime_get();
+	for (i = 0; i < CQDMA_BENCH_ITERS; i++) {
+		bool final = (i == CQDMA_BENCH_ITERS - 1);
+
+		tx = chan->device->device_prep_dma_memcpy(chan, dst, src, len,
+							  final ? (flags | DMA_PREP_INTERRUPT) : flags);
+		if (!tx) {
+			ret = -ENOMEM;
+			break;
+		}
+		if (final) {
+			tx->callback = cqdma_bench_done;
+			tx->callback_param = &done;
+		}
+		cookie = dmaengine_submit(tx);
+		if (dma_submit_error(cookie)) {
+			ret = -EIO;
+			break;
+		}
+		last = cookie;
+		armed = final;
+	}
+	dma_async_issue_pending(chan);
+
+	if (armed && !wait_for_completion_timeout(&done, msecs_to_jiffies(CQDMA_BENCH_TIMEOUT))) {
+		ret = -ETIMEDOUT;
+		/* the callback still points at done, it has to run before we return */
+		pr_warn("[CQDMA] bench copy timed out, waiting for it to finish\n");
+		wait_for_completion(&done);
+	}
+	us = ktime_us_delta(ktime_get(), start);
+
+	/* descriptors complete in order, so the last submitted one covers the rest */
+	if (!armed && !dma_submit_error(last))
+		while (dma_async_is_tx_complete(chan, last, NULL, NULL) != DMA_SUCCESS)
+			msleep(1);
+
+	spin_lock_irq(&de->lock);
+	de->force_cpu = saved_force_cpu;
+	spin_unlock_irq(&de->lock);
+
+	dma_unmap_single(dev, dst, len, DMA_FROM_DEVICE);
+out_unmap_src:
+	dma_unmap_single(dev, src, len, DMA_TO_DEVICE);
+
+	if (!ret && memcmp((void *)src_buf, (void *)dst_buf, len))
+		ret = -EIO;
+
+	if (!ret)
+		*kbps = (unsigned int)div64_s64((s64)len * CQDMA_BENCH_ITERS * 1000000,
+						 max_t(s64, us, 1) * 1024);
+
+out_free:
+	if (src_buf)
+		free_pages(src_buf, get_order(len));
+	if (dst_buf)
+		free_pages(dst_buf, get_order(len));
+	dma_release_channel(chan);
+
+	return ret;
+}
+
+static ssize_t cqdma_backend_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%s\n", cqdma_de->force_cpu ? "cpu" : "auto");
+}
+
+static ssize_t cqdma_backend_store(struct device *dev, struct device_attribute *attr,
+				   const char *buf, size_t count)
+{
+	bool cpu;
+
+	if (sysfs_streq(buf, "cpu"))
+		cpu = true;
+	else if (sysfs_streq(buf, "auto"))
+		cpu = false;
+	else
+		return -EINVAL;
+
+	spin_lock_irq(&cqdma_de->lock);
+	cqdma_de->force_cpu = cpu;
+	spin_unlock_irq(&cqdma_de->lock);
+
+	return count;
+}
+
+static ssize_t cqdma_stats_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "hw: %lu\ncpu: %lu\n", cqdma_de->nr_hw, cqdma_de->nr_cpu);
+}
+
+static ssize_t cqdma_bench_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%s\n", cqdma_de->bench_result);
+}
+
+/* write a buffer size in KB, both backends are measured on the same buffers */
+static ssize_t cqdma_bench_store(struct device *dev, struct device_attribute *attr,
+				 const char *buf, size_t count)
+{
+	unsigned int kb, hw_kbps = 0, cpu_kbps = 0;
+	int hw_ret, cpu_ret;
+	size_t len;
+
+	if (kstrtouint(buf, 10, &kb) || !kb)
+		return -EINVAL;
+
+	len = min_t(size_t, (size_t)kb * SZ_1K, CQDMA_BENCH_MAX_LEN);
+
+	hw_ret = cqdma_bench_run(cqdma_de, false, len, &hw_kbps);
+	cpu_ret = cqdma_bench_run(cqdma_de, true, len, &cpu_kbps);
+
+	snprintf(cqdma_de->bench_result, sizeof(cqdma_de->bench_result),
+		 "len=%zu iters=%d auto=%u KB/s (%d) cpu=%u KB/s (%d)",
+		 len, CQDMA_BENCH_ITERS, hw_kbps, hw_ret, cpu_kbps, cpu_ret);
+	pr_notice("[CQDMA] bench %s\n", cqdma_de->bench_result);
+
+	return count;
+}
+
+static DEVICE_ATTR(backend, 0644, cqdma_backend_show, cqdma_backend_store);
+static DEVICE_ATTR(stats, 0444, cqdma_stats_show, NULL);
+static DEVICE_ATTR(bench, 0644, cqdma_bench_show, cqdma_bench_store);
+
+static int __init cqdma_dmaengine_init(void)
+{
+	struct cqdma_dmaengine *de;
+	struct dma_device *dma;
+	int ret;
+
+	de = kzalloc(sizeof(*de), GFP_KERNEL);
+	if (!de)
+		return -ENOMEM;
+
+	spin_lock_init(&de->lock);
+	INIT_LIST_HEAD(&de->submitted);
+	INIT_LIST_HEAD(&de->issued);
+	INIT_LIST_HEAD(&de->done);
+	de->hw_ch = -1;
+	tasklet_init(&de->tasklet, cqdma_tasklet, (unsigned long)de);
+	INIT_WORK(&de->cpu_work, cqdma_cpu_work);
+
+	de->pdev = platform_device_register_simple("cqdma-dmaengine", -1, NULL, 0);
+	if (IS_ERR(de->pdev)) {
+		ret = PTR_ERR(de->pdev);
+		goto err_free;
+	}
+	de->pdev->dev.coherent_dma_mask = DMA_BIT_MASK(32);
+	de->pdev->dev.dma_mask = &de->pdev->dev.coherent_dma_mask;
+
+	dma = &de->dma;
+	dma_cap_set(DMA_MEMCPY, dma->cap_mask);
+	dma_cap_set(DMA_SG, dma->cap_mask);
+	dma->dev = &de->pdev->dev;
+	dma->device_alloc_chan_resources = cqdma_alloc_chan_resources;
+	dma->device_free_chan_resources = cqdma_free_chan_resources;
+	dma->device_prep_dma_memcpy = cqdma_prep_memcpy;
+	dma->device_prep_dma_sg = cqdma_prep_sg;
+	dma->device_control = cqdma_control;
+	dma->device_tx_status = cqdma_tx_status;
+	dma->device_issue_pending = cqdma_issue_pending;
+
+	INIT_LIST_HEAD(&dma->channels);
+	de->chan.device = dma;
+	list_add_tail(&de->chan.device_node, &dma->channels);
+
+	cqdma_de = de;
+
+	ret = dma_async_device_register(dma);
+	if (ret) {
+		pr_err("[CQDMA] dmaengine register fail, ret %d\n", ret);
+		goto err_unreg;
+	}
+
+	if (device_create_file(&de->pdev->dev, &dev_attr_backend) ||
+	    device_create_file(&de->pdev->dev, &dev_attr_stats) ||
+	    device_create_file(&de->pdev->dev, &dev_attr_bench))
+		pr_err("[CQDMA] dmaengine sysfs files not created\n");
+
+	pr_notice("[CQDMA] dmaengine memcpy provider registered\n");
+
+	return 0;
+
+err_unreg:
+	cqdma_de = NULL;
+	platform_device_unregister(de->pdev);
+err_free:
+	kfree(de);
+	return ret;
+}
+
+/* after init_cqdma(), which is also a late_initcall and linked first */
+late_initcall(cqdma_dmaengine_init);
@@ -47,26 +47,68 @@
 #include <linux/workqueue.h>
 #include <linux/earlysuspend.h>
 
+#define CREATE_TRACE_POINTS
+#include <trace/events/dynamic_boost.h>
+
 struct boost_state {
 	int active;
 	struct delayed_work work;
 };
 
+/*
+ * A named boost request. Active profiles stack with the legacy prio
+ * modes, the highest frequency floor and core count among them wins.
+ */
+struct dboost_profile {
+	const char *name;
+	unsigned int min_freq;		/* kHz, DBOOST_FREQ_MAX for boost */
+	unsigned int min_cores;
+	int duration;			/* ms, used when the caller passes 0 */
+
+	int active;
+	unsigned long start;		/* jiffies when it became active */
+	unsigned int count;
+	u64 total_ms;
+	struct delayed_work work;
+};
+
 struct dynamic_boost {
 	spinlock_t boost_lock;
 	int last_req_mode;
 	wait_queue_head_t wq;
 	struct task_struct *thread;
 	struct boost_state state[PRIO_DEFAULT];
+	struct dboost_profile profile[DBOOST_PROFILE_NUM];
+	unsigned int min_freq;		/* floor applied to the cpufreq policy */
 	atomic_t event;
 };
 
-static struct dynamic_boost dboost;
+static struct dynamic_boost dboost = {
+	.profile = {
+		[DBOOST_TOUCH] = {
+			.name = "touch",
+			.min_freq = DBOOST_FREQ_MAX,
+			.min_cores = NR_CPUS,
+			.duration = 150,
+		},
+		[DBOOST_APP_LAUNCH] = {
+			.name = "app_launch",
+			.min_freq = DBOOST_FREQ_MAX,
+			.min_cores = NR_CPUS,
+			.duration = 2000,
+		},
+		[DBOOST_VIDEO_START] = {
+			.name = "video_start",
+			.min_freq = 1000000,
+			.min_cores = 2,
+			.duration = 1000,
+		},
+	},
+};
 
 struct dboost_input_handle {
 	struct input_handle handle;
 	int duration;
-	int prio_mode;
 };
 
 #define MAX_CORES_NUMBER nr_cpu_ids
@@ -78,6 +120,15 @@ static ssize_t dynamic_boost_store(struct device *dev, struct device_attribute *
 	size_t n);
 static struct device_attribute dynamic_boost_attr = __ATTR(dynamic_boost, 0777,
 	dynamic_boost_show, dynamic_boost_store);
+static ssize_t dboost_profiles_show(struct device *dev, struct device_attribute *attr, char *buf);
+static ssize_t dboost_profiles_store(struct device *dev, struct device_attribute *attr, const char *buf,
+	size_t n);
+static struct device_attribute dboost_profiles_attr = __ATTR(profiles, 0644,
+	dboost_profiles_show, dboost_profiles_store);
+static ssize_t dboost_profile_boost_store(struct device *dev, struct device_attribute *attr, const char *buf,
+	size_t n);
+static struct device_attribute dboost_profile_boost_attr = __ATTR(profile_boost, 0200,
+	NULL, dboost_profile_boost_store);
 static bool isFirst = true;
 //extern void hp_based_cpu_num(int num);
 
@@ -129,6 +180,117 @@ int set_dynamic_boost(int duration, int prio_mode)
 }
 EXPORT_SYMBOL(set_dynamic_boost);
 
+static void dboost_profile_get_locked(struct dboost_profile *p)
+{
+	if (p->active++)
+		return;
+
+	p->start = jiffies;
+	p->count++;
+	trace_dboost_start(p->name, p->min_freq, p->min_cores, p->duration);
+}
+
+static void dboost_profile_put_locked(struct dboost_profile *p)
+{
+	unsigned int held;
+
+	if (p->active <= 0 || --p->active)
+		return;
+
+	held = jiffies_to_msecs(jiffies - p->start);
+	p->total_ms += held;
+	trace_dboost_end(p->name, held);
+}
+
+static void dboost_profile_work(struct work_struct *work)
+{
+	unsigned long flags;
+	struct dboost_profile *p = container_of(work, struct dboost_profile, work.work);
+
+	spin_lock_irqsave(&dboost.boost_lock, flags);
+	dboost_profile_put_locked(p);
+	spin_unlock_irqrestore(&dboost.boost_lock, flags);
+
+	atomic_inc(&dboost.event);
+	wake_up(&dboost.wq);
+}
+
+/*
+ * Request the boost described by a named profile
+ * @profile: One of enum dboost_profile_id.
+ * @duration: How long to keep it, in ms. 0 uses the profile's own
+ *            duration, ON/OFF hold and release it until told otherwise.
+ *
+ * A timed request that finds the profile already running with more than
+ * half of @duration left does not re-arm it, so a stream of input events
+ * does not keep pushing the deadline out.
+*/
+int dynamic_boost_profile(int profile, int duration)
+{
+	unsigned long flags, delay;
+	struct dboost_profile *p;
+
+	if (profile < 0 || profile >= DBOOST_PROFILE_NUM ||
+	    duration > MAX_DURATION || duration < OFF)
+		return -EINVAL;
+
+	p = &dboost.profile[profile];
+
+	spin_lock_irqsave(&dboost.boost_lock, flags);
+	if (!duration)
+		duration = p->duration;
+
+	if (duration == ON) {
+		dboost_profile_get_locked(p);
+	} else if (duration == OFF) {
+		dboost_profile_put_locked(p);
+	} else {
+		delay = msecs_to_jiffies(duration);
+		if (delayed_work_pending(&p->work) &&
+		    time_before(jiffies + delay / 2, p->work.timer.expires)) {
+			spin_unlock_irqrestore(&dboost.boost_lock, flags);
+			return 0;
+		}
+		if (!mod_delayed_work(system_wq, &p->work, delay))
+			dboost_profile_get_locked(p);
+	}
+	spin_unlock_irqrestore(&dboost.boost_lock, flags);
+
+	atomic_inc(&dboost.event);
+	wake_up(&dboost.wq);
+	return 0;
+}
+EXPORT_SYMBOL(dynamic_boost_profile);
+
+/* raise the policy minimum while a profile asks for a frequency floor */
+static int dboost_cpufreq_policy_notifier(struct notifier_block *nb,
+	unsigned long val, void *data)
+{
+	struct cpufreq_policy *policy = data;
+	unsigned int min_freq = ACCESS_ONCE(dboost.min_freq);
+
+	if (val != CPUFREQ_ADJUST || !min_freq)
+		return NOTIFY_OK;
+
+	if (policy->min < min_freq)
+		policy->min = min(min_freq, policy->max);
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block dboost_cpufreq_nb = {
+	.notifier_call = dboost_cpufreq_policy_notifier,
+};
+
+static void dboost_set_min_freq(unsigned int min_freq)
+{
+	if (dboost.min_freq == min_freq)
+		return;
+
+	dboost.min_freq = min_freq;
+	cpufreq_update_policy(0);
+}
+
 static int dboost_dvfs_hotplug_thread(void *ptr)
 {
 #if 0
@@ -138,6 +300,7 @@ static int dboost_dvfs_hotplug_thread(void *ptr)
 #endif
 #endif
 	int max_freq, cores_to_set_b, cores_to_set_l, cores_to_set_sum;
+	unsigned int min_freq;
 	unsigned long flags;
 
 	set_user_nice(current, -10);
@@ -182,10 +345,27 @@ static int dboost_dvfs_hotplug_thread(void *ptr)
 			break;
 		}
 
-		if (max_freq)
+		/* stack the active profiles on top of the prio mode */
+		min_freq = max_freq ? DBOOST_FREQ_MAX : 0;
+		spin_lock_irqsave(&dboost.boost_lock, flags);
+		for (i = 0; i < DBOOST_PROFILE_NUM; i++) {
+			struct dboost_profile *p = &dboost.profile[i];
+
+			if (!p->active)
+				continue;
+			min_freq = max(min_freq, p->min_freq);
+			if (p->min_cores > cores_to_set_l)
+				cores_to_set_l = min(p->min_cores, num_possible_cpus());
+		}
+		spin_unlock_irqrestore(&dboost.boost_lock, flags);
+
+		if (min_freq == DBOOST_FREQ_MAX) {
 			mt_cpufreq_enable_boost();
-		else
+			dboost_set_min_freq(0);
+		} else {
 			mt_cpufreq_disable_boost();
+			dboost_set_min_freq(min_freq);
+		}
 
 		cores_to_set_sum = cores_to_set_b + cores_to_set_l;
 		if (cores_to_set_sum > num_possible_cpus())
@@ -201,6 +381,7 @@ static int dboost_dvfs_hotplug_thread(void *ptr)
 		*/
 
 		dboost.last_req_mode = set_mode;
+		trace_dboost_apply(set_mode, min_freq, cores_to_set_sum, cpufreq_quick_get(0));
 
 		while (!atomic_read(&dboost.event))
 			wait_event(dboost.wq, atomic_read(&dboost.event));
@@ -234,11 +415,108 @@ static ssize_t dynamic_boost_store(struct device *dev, struct device_attribute *
 	return n;
 }
 
+static struct dboost_profile *dboost_find_profile(const char *name)
+{
+	int i;
+
+	for (i = 0; i < DBOOST_PROFILE_NUM; i++)
+		if (!strcmp(dboost.profile[i].name, name))
+			return &dboost.profile[i];
+	return NULL;
+}
+
+static ssize_t dboost_profiles_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	unsigned long flags;
+	int i, len;
+
+	len = snprintf(buf, PAGE_SIZE, "%-12s %9s %9s %8s %6s %8s %10s\n", "profile",
+		"min_freq", "min_cores", "duration", "active", "count", "total_ms");
+
+	spin_lock_irqsave(&dboost.boost_lock, flags);
+	for (i = 0; i < DBOOST_PROFILE_NUM; i++) {
+		struct dboost_profile *p = &dboost.profile[i];
+		char freq[12];
+
+		if (p->min_freq == DBOOST_FREQ_MAX)
+			strcpy(freq, "max");
+		else
+			snprintf(freq, sizeof(freq), "%u", p->min_freq);
+
+		len += snprintf(buf + len, PAGE_SIZE - len, "%-12s %9s %9u %8d %6d %8u %10llu\n",
+			p->name, freq, p->min_cores, p->duration, p->active,
+			p->count, p->total_ms);
+	}
+	spin_unlock_irqrestore(&dboost.boost_lock, flags);
+
+	return len;
+}
+
+/* "<profile> <min_freq kHz|max> <min_cores> <duration ms>" */
+static ssize_t dboost_profiles_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t n)
+{
+	struct dboost_profile *p;
+	char name[16], freq[12];
+	unsigned int min_freq, min_cores;
+	unsigned long flags;
+	int duration;
+
+	if (sscanf(buf, "%15s %11s %u %d", name, freq, &min_cores, &duration) != 4)
+		return -EINVAL;
+	if (duration <= 0 || duration > MAX_DURATION)
+		return -EINVAL;
+
+	p = dboost_find_profile(name);
+	if (!p)
+		return -EINVAL;
+
+	if (!strcmp(freq, "max"))
+		min_freq = DBOOST_FREQ_MAX;
+	else if (kstrtouint(freq, 10, &min_freq))
+		return -EINVAL;
+
+	spin_lock_irqsave(&dboost.boost_lock, flags);
+	p->min_freq = min_freq;
+	p->min_cores = min_cores;
+	p->duration = duration;
+	spin_unlock_irqrestore(&dboost.boost_lock, flags);
+
+	atomic_inc(&dboost.event);
+	wake_up(&dboost.wq);
+	return n;
+}
+
+/* "<profile> [duration ms]" */
+static ssize_t dboost_profile_boost_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t n)
+{
+	struct dboost_profile *p;
+	char name[16];
+	int duration = 0, ret;
+
+	if (sscanf(buf, "%15s %d", name, &duration) < 1)
+		return -EINVAL;
+
+	p = dboost_find_profile(name);
+	if (!p)
+		return -EINVAL;
+
+	ret = dynamic_boost_profile(p - dboost.profile, duration);
+	return ret ? ret : n;
+}
+
 static int dynamic_boost_probe(struct platform_device *dev)
 {
 	int ret_device_file = 0;
 
 	ret_device_file = device_create_file(&(dev->dev), &dynamic_boost_attr);
+	if (ret_device_file)
+		return ret_device_file;
+
+	ret_device_file = device_create_file(&(dev->dev), &dboost_profiles_attr);
+	if (ret_device_file)
+		return ret_device_file;
+
+	ret_device_file = device_create_file(&(dev->dev), &dboost_profile_boost_attr);
 
 	return ret_device_file;
 }
@@ -259,6 +537,15 @@ int dboost_suspend(struct device *dev)
 		dboost.state[i].active = 0;
 		spin_unlock_irqrestore(&dboost.boost_lock, flags);
 	}
+	for (i = 0; i < DBOOST_PROFILE_NUM; ++i) {
+		cancel_delayed_work_sync(&dboost.profile[i].work);
+		spin_lock_irqsave(&dboost.boost_lock, flags);
+		if (dboost.profile[i].active) {
+			dboost.profile[i].active = 1;
+			dboost_profile_put_locked(&dboost.profile[i]);
+		}
+		spin_unlock_irqrestore(&dboost.boost_lock, flags);
+	}
 	atomic_inc(&dboost.event);
 	wake_up(&dboost.wq);
 	return 0;
@@ -288,9 +575,11 @@ static void dboost_input_event(struct input_handle *handle, unsigned int type,
 		unsigned int code, int value)
 {
 	struct dboost_input_handle *in = container_of(handle, struct dboost_input_handle, handle);
-	if ((type == EV_KEY && (code == BTN_TOUCH || code == KEY_POWER)) ||
-		(type == EV_ABS && code == ABS_MT_TRACKING_ID)) {
-		set_dynamic_boost(in->duration, in->prio_mode);
+
+	/* only boost on press or new contact, not on release */
+	if ((type == EV_KEY && (code == BTN_TOUCH || code == KEY_POWER) && value) ||
+		(type == EV_ABS && code == ABS_MT_TRACKING_ID && value >= 0)) {
+		dynamic_boost_profile(DBOOST_TOUCH, in->duration);
 	}
 }
 
@@ -308,9 +597,8 @@ static int dboost_input_connect(struct input_handler *handler,
 	in->handle.handler = handler;
 	in->handle.name = "dynamic_boost";
 
-	/* TODO: the following parameters should be configured through platform data */
-	in->prio_mode = PRIO_MAX_CORES_MAX_FREQ;
-	in->duration = 150;
+	/* the touch profile is tuned through the profiles sysfs node */
+	in->duration = 0;
 
 	error = input_register_handle(&in->handle);
 	if (error)
@@ -410,8 +698,14 @@ static int __init dynamic_boost_init(void)
 		else
 			dboost.state[i].active = 0;
 	}
+	for (i = 0; i < DBOOST_PROFILE_NUM; ++i)
+		INIT_DELAYED_WORK(&dboost.profile[i].work, dboost_profile_work);
 	init_waitqueue_head(&dboost.wq);
 
+	ret = cpufreq_register_notifier(&dboost_cpufreq_nb, CPUFREQ_POLICY_NOTIFIER);
+	if (ret)
+		return ret;
+
 	dboost.thread = kthread_run(dboost_dvfs_hotplug_thread, &dboost, "dynamic_boost");
 	if (IS_ERR(dboost.thread))
 		return -EINVAL;
@@ -443,6 +737,7 @@ static void __exit dynamic_boost_exit(void)
 #endif
 
 	kthread_stop(dboost.thread);
+	cpufreq_unregister_notifier(&dboost_cpufreq_nb, CPUFREQ_POLICY_NOTIFIER);
 }
 
 module_exit(dynamic_boost_exit);
@@ -36,16 +36,12 @@
 #include "hdmiddc.h"
 #include <linux/hdmitx.h>
 #include "hdmihdcp.h"
+#include "hdmiedid_parse.h"
 
 HDMI_SINK_AV_CAP_T _HdmiSinkAvCap;
 static unsigned char _fgHdmiNoEdidCheck = FALSE;
-static unsigned int _u4i_3D_VIC;
-static unsigned int _ui4First_16_NTSC_VIC;
-static unsigned int _ui4First_16_PAL_VIC;
-static unsigned int _ui4First_16_VIC[16];
 static unsigned char _bEdidData[EDID_SIZE];// 4 block 512 Bytes
 static unsigned char aEDIDHeader[EDID_HEADER_LEN] = {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
-static unsigned char aEDIDVSDBHeader[EDID_VSDB_LEN] = {0x03, 0x0c, 0x00};
 
 static unsigned char _bEdidData2[256]=
 {0x00,0xff,0xff,0xff,0xff,0xff,0xff,0x00,0x4d,0xd9,0x02,0xd7,0x01,0x01,0x01,0x01,
@@ -75,6 +71,22 @@ const unsigned char _cFsStr[][7]={{"32khz  "},
                          {"192khz "}};
 unsigned char  cDstStr[50];
 
+// Parse result of the last sink, reused when the same EDID is read back after an HPD bounce.
+// Keyed by the base and first extension block checksums, confirmed by comparing the raw data.
+// rCaps is only written by fgHdmiEdidParse() and is read-only once the entry is valid.
+typedef struct
+{
+  unsigned char fgValid;
+  unsigned short ui2Key;
+  unsigned int u4Len;
+  unsigned int u4Hit;
+  HDMI_EDID_CAPS_T rCaps;
+  unsigned char bEdidData[EDID_SIZE];
+} HDMI_EDID_CACHE_T;
+
+static HDMI_EDID_CAPS_T _rEdidCaps; // last parse
+static HDMI_EDID_CACHE_T _rEdidCache;
+
 BOOL fgIsHdmiNoEDIDCheck(void)
 {
   HDMI_EDID_FUNC();
@@ -297,195 +309,6 @@ unsigned char hdmi_fgreadedid(unsigned char i1noedid)
   return (1);
 }
 
-void vAnalyzeDTD(unsigned short ui2Active, unsigned short ui2HBlanking, unsigned char bFormat, unsigned char fgFirstDTD)
-{
-  unsigned int ui4NTSC =  _HdmiSinkAvCap.ui4_sink_dtd_ntsc_resolution;
-  unsigned int ui4PAL  =  _HdmiSinkAvCap.ui4_sink_dtd_pal_resolution;
-  unsigned int ui41stNTSC =  _HdmiSinkAvCap.ui4_sink_1st_dtd_ntsc_resolution;
-  unsigned int ui41stPAL  =  _HdmiSinkAvCap.ui4_sink_1st_dtd_pal_resolution;
-  HDMI_EDID_FUNC();
-
-  switch(ui2Active)
-  {
-    case  0x5a0: // 480i
-      if(ui2HBlanking == 0x114) //NTSC
-      {
-        if(bFormat == 0) //p-scan
-        {
-          ui4NTSC |= SINK_480P_1440;
-          if(fgFirstDTD)
-          {
-          ui41stNTSC |= SINK_480P_1440;
-          }
-        }
-        else
-        {
-          ui4NTSC |= SINK_480I;
-          if(fgFirstDTD)
-          {
-          ui41stNTSC |= SINK_480I;
-          }
-        }
-      }
-      else if(ui2HBlanking == 0x120) //PAL
-      {
-        if(bFormat == 0) //p-scan
-        {
-          ui4PAL |= SINK_576P_1440;
-          if(fgFirstDTD)
-          {
-          ui41stPAL |= SINK_576P_1440;
-          }
-        }
-        else
-        {
-          ui4PAL |= SINK_576I;
-          if(fgFirstDTD)
-          {
-          ui41stPAL |= SINK_576I;
-          }
-        }
-      }
-      break;
-    case  0x2d0: // 480p
-      if((ui2HBlanking == 0x8a) && (bFormat == 0)) //NTSC, p-scan
-      {
-        ui4NTSC |= SINK_480P;
-        if(fgFirstDTD)
-        {
-        ui41stNTSC |= SINK_480P;
-        }
-      }
-      else if((ui2HBlanking == 0x90) && (bFormat == 0)) //PAL, p-scan
-      {
-        ui4PAL |= SINK_576P;
-        if(fgFirstDTD)
-        {
-        ui41stPAL |= SINK_576P;
-        }
-      }
-      break;
-    case  0x500: // 720p
-      if((ui2HBlanking == 0x172) && (bFormat == 0)) //NTSC, p-scan
-      {
-        ui4NTSC |= SINK_720P60;
-        if(fgFirstDTD)
-        {
-        ui41stNTSC |= SINK_720P60;
-        }
-      }
-      else if((ui2HBlanking == 0x2bc) && (bFormat == 0)) //PAL, p-scan
-      {
-        ui4PAL |= SINK_720P50;
-        if(fgFirstDTD)
-        {
-        ui41stPAL |= SINK_720P50;
-        }
-      }
-      break;
-    case  0x780: // 1080i, 1080P
-      if((ui2HBlanking == 0x118) && (bFormat == 1)) //NTSC, interlace
-      {
-        ui4NTSC |= SINK_1080I60;
-        if(fgFirstDTD)
-        {
-        ui41stNTSC |= SINK_1080I60;
-        }
-      }
-     else if((ui2HBlanking == 0x118) && (bFormat == 0)) //NTSC, Progressive
-      {
-        ui4NTSC |= SINK_1080P60;
-        if(fgFirstDTD)
-        {
-        ui41stNTSC |= SINK_1080P60;
-        }
-      }
-      else if((ui2HBlanking == 0x2d0) && (bFormat == 1)) //PAL, interlace
-      {
-        ui4PAL |= SINK_1080I50;
-        if(fgFirstDTD)
-        {
-        ui41stPAL |= SINK_1080I50;
-        }
-      }
-      else if((ui2HBlanking == 0x2d0) && (bFormat == 0)) //PAL, Progressive
-      {
-        ui4PAL |= SINK_1080P50;
-        if(fgFirstDTD)
-        {
-        ui41stPAL |= SINK_1080P50;
-        }
-      }
-      break;
-  }
-   _HdmiSinkAvCap.ui4_sink_dtd_ntsc_resolution = ui4NTSC;
-   _HdmiSinkAvCap.ui4_sink_dtd_pal_resolution = ui4PAL;
-   _HdmiSinkAvCap.ui4_sink_1st_dtd_ntsc_resolution = ui41stNTSC;
-   _HdmiSinkAvCap.ui4_sink_1st_dtd_pal_resolution = ui41stPAL;
-}
-
-unsigned char fgParserEDID(unsigned char *prbData)
-{
-   unsigned char bIdx;
-   unsigned char bTemp=0;
-   unsigned short ui2HActive, ui2HBlanking;
-   HDMI_EDID_FUNC();
-
-   _HdmiSinkAvCap.ui1_Edid_Version=*(prbData+EDID_ADDR_VERSION);
-   _HdmiSinkAvCap.ui1_Edid_Revision=*(prbData+EDID_ADDR_REVISION);
-   _HdmiSinkAvCap.ui1_Display_Horizontal_Size=*(prbData+EDID_IMAGE_HORIZONTAL_SIZE);
-   _HdmiSinkAvCap.ui1_Display_Vertical_Size=*(prbData+EDID_IMAGE_VERTICAL_SIZE);
-
-  // Step 1: check if EDID header pass
-  // ie. EDID[0] ~ EDID[7] = specify header pattern
-  for(bIdx=EDID_ADDR_HEADER; bIdx<(EDID_ADDR_HEADER+EDID_HEADER_LEN); bIdx++)
-  {
-    if(*(prbData+bIdx) != aEDIDHeader[bIdx])
-    {
-      return (FALSE);
-    }
-  }
-
-  // Step 2: Check if EDID checksume pass
-  // ie. value of EDID[0] + ... + [0x7F] = 256*n
-  for(bIdx=0; bIdx<EDID_BLOCK_LEN; bIdx++)
-  {
-     // add the value into checksum
-    bTemp += *(prbData+bIdx);
-   }
-
-  // check if EDID checksume pass
-  if(bTemp)
-  {
-    return (FALSE);
-  }
-  else
-  {
-    _HdmiSinkAvCap.ui2_edid_chksum_and_audio_sup &= ~SINK_BASE_BLK_CHKSUM_ERR;
-  }
-
-  // [3.3] read-back H active line to define EDID resolution
-  for(bIdx=0; bIdx<2; bIdx++)
-  {
-    ui2HActive = (unsigned short) (*(prbData+EDID_ADDR_TIMING_DSPR_1+18*bIdx+OFST_H_ACT_BLA_HI)&0xf0) << 4;
-    ui2HActive |= *(prbData+EDID_ADDR_TIMING_DSPR_1+18*bIdx+OFST_H_ACTIVE_LO);
-    ui2HBlanking = (unsigned short) (*(prbData+EDID_ADDR_TIMING_DSPR_1+18*bIdx+OFST_H_ACT_BLA_HI)&0x0f) << 8;
-    ui2HBlanking |= *(prbData+EDID_ADDR_TIMING_DSPR_1+18*bIdx+OFST_H_BLANKING_LO);
-    bTemp = (*(prbData+EDID_ADDR_TIMING_DSPR_1+18*bIdx+OFST_FLAGS)&0x80)>>7;
-    if(bIdx == 0)
-    {
-      vAnalyzeDTD(ui2HActive, ui2HBlanking, bTemp, TRUE);
-    }
-    else
-    {
-      vAnalyzeDTD(ui2HActive, ui2HBlanking, bTemp, FALSE);
-    }
-  }
-
-  // if go here, ie. parsing EDID data ok !!
-  return (TRUE);
-}
-
 void vSetEdidChkError(void)
 {
   unsigned char bInx;
@@ -540,876 +363,71 @@ void vSetEdidChkError(void)
   _HdmiSinkAvCap.ui1_sink_support_ai = 0;
 }
 
-void vParserCEADataBlock(unsigned char *prData, unsigned char bLen)
+static unsigned int u4EdidDataLen(void)
 {
-  unsigned int ui4CEA_NTSC=0, ui4CEA_PAL=0,ui4OrgCEA_NTSC =0, ui4OrgCEA_PAL=0, ui4NativeCEA_NTSC =0, ui4NativeCEA_PAL=0;
-  unsigned char bTemp, bIdx;
-  unsigned char bLengthSum;
-  unsigned char bType, bNo, bAudCode, bPcmChNum;
-  unsigned char bTemp13,bTemp8,bLatency_offset=0;
-  unsigned char b3D_Multi_present=0,b3D_Structure_7_0=1,b3D_MASK_15_8=1,b3D_MASK_7_0=1,b2D_VIC_order_Index=0;
-  unsigned char i,bTemp14=1,bDataTemp=1;
-  unsigned int ui4Temp=0;
-  unsigned int u23D_MASK_ALL;
-
-  HDMI_EDID_FUNC();
-
-  while(bLen)
-  {
-  	if(bLen>0x80) break;
-    // Step 1: get 1st data block type & total number of this data type
-    bTemp=*prData;
-    bType=bTemp >> 5; // bit[7:5]
-    bNo=bTemp & 0x1F;  // bit[4:0]
-
-    if(bType == 0x02)//Video data block
-    {
-      ui4CEA_NTSC=0;
-      ui4CEA_PAL=0;
-
-      for(bIdx = 0; bIdx < bNo; bIdx++)
-      {
-        if(*(prData+1+bIdx) & 0x80)//Native bit
-        {
-          ui4OrgCEA_NTSC=	ui4CEA_NTSC;
-          ui4OrgCEA_PAL=	ui4CEA_PAL;
-        }
-        switch(*(prData+1+bIdx) & 0x7f)
-        {
-          case  6:
-          ui4CEA_NTSC |= SINK_480I;
-          ui4OrgCEA_NTSC |= SINK_480I;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_NTSC |= SINK_480I;
-          break;
-
-          case  7:
-          ui4CEA_NTSC |= SINK_480I;
-          ui4OrgCEA_NTSC |= SINK_480I;//16:9
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_NTSC |= SINK_480I;
-
-          break;
-          case  2:
-          ui4CEA_NTSC |= SINK_480P;
-          ui4OrgCEA_NTSC |= SINK_480P;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_NTSC |= SINK_480P;
-
-          break;
-          case  3:
-          ui4CEA_NTSC |= SINK_480P;
-          ui4OrgCEA_NTSC |= SINK_480P;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_NTSC |= SINK_480P;
-
-          break;
-          case  14:
-          case  15:
-          ui4CEA_NTSC |= SINK_480P_1440;
-          ui4OrgCEA_NTSC |= SINK_480P_1440;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_NTSC |= SINK_480P_1440;
-
-          break;
-          case  4:
-          ui4CEA_NTSC |= SINK_720P60;
-          ui4OrgCEA_NTSC |= SINK_720P60;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_NTSC |= SINK_720P60;
-
-          break;
-          case  5:
-          ui4CEA_NTSC |= SINK_1080I60;
-          ui4OrgCEA_NTSC |= SINK_1080I60;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_NTSC |= SINK_1080I60;
-          break;
-          case  21:
-          ui4CEA_PAL |= SINK_576I;
-          ui4OrgCEA_PAL |= SINK_576I;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_PAL |= SINK_576I;
-          break;
-
-          case  22:
-          ui4CEA_PAL |= SINK_576I;
-          ui4OrgCEA_PAL |= SINK_576I;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_PAL |= SINK_576I;
-
-          break;
-          case  16:
-          ui4CEA_NTSC |= SINK_1080P60;
-          ui4OrgCEA_NTSC |= SINK_1080P60;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_NTSC |= SINK_1080P60;
-          break;
-
-          case  17:
-          ui4CEA_PAL |= SINK_576P;
-          ui4OrgCEA_PAL |= SINK_576P;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_PAL |= SINK_576P;
-          break;
-
-          case  18:
-          ui4CEA_PAL |= SINK_576P;
-          ui4OrgCEA_PAL |= SINK_576P;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_PAL |= SINK_576P;
-
-          break;
-
-          case  29:
-          case  30:
-          ui4CEA_PAL |= SINK_576P_1440;
-          ui4OrgCEA_PAL |= SINK_576P_1440;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_PAL |= SINK_576P_1440;
-          break;
-
-          case  19:
-          ui4CEA_PAL |= SINK_720P50;
-          ui4OrgCEA_PAL |= SINK_720P50;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_PAL |= SINK_720P50;
-
-          break;
-          case  20:
-          ui4CEA_PAL |= SINK_1080I50;
-          ui4OrgCEA_PAL |= SINK_1080I50;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_PAL |= SINK_1080I50;
-
-          break;
-
-          case  31:
-          ui4CEA_PAL |= SINK_1080P50;
-          ui4OrgCEA_PAL |= SINK_1080P50;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_PAL |= SINK_1080P50;
-          break;
-
-          case  32:
-          ui4CEA_NTSC |= SINK_1080P24;
-          ui4CEA_PAL |= SINK_1080P24;
-          ui4CEA_NTSC |= SINK_1080P23976;
-          ui4CEA_PAL |= SINK_1080P23976;
-          ui4OrgCEA_PAL |= SINK_1080P24;
-          ui4OrgCEA_NTSC |= SINK_1080P23976;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_PAL |= SINK_1080P24;
-
-          break;
-
-          case  33:
-          //ui4CEA_NTSC |= SINK_1080P25;
-          ui4CEA_PAL |= SINK_1080P25;
-          ui4OrgCEA_PAL |= SINK_1080P25;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_PAL |= SINK_1080P25;
-
-          break;
-
-          case  34:
-          ui4CEA_NTSC |= SINK_1080P30;
-          ui4CEA_NTSC |= SINK_1080P2997;
-          ui4CEA_PAL |= SINK_1080P30;
-          ui4CEA_PAL |= SINK_1080P2997;
-          ui4OrgCEA_PAL |= SINK_1080P30;
-          ui4OrgCEA_NTSC |= SINK_1080P2997;
-          if(*(prData+1+bIdx) & 0x80)//Native bit
-          ui4NativeCEA_PAL |= SINK_1080P30;
-          break;
-
-          default:
-          break;
-       }
-
-       if(bIdx<0x10)
-       {
-
-         switch(*(prData+1+bIdx) & 0x7f)
-         {
-          case  6:
-          case  7:
-          ui4Temp= SINK_480I;
-          break;
-          case  2:
-          case  3:
-          ui4Temp= SINK_480P;
-          break;
-          case  14:
-          case  15:
-          ui4Temp= SINK_480P_1440;
-          break;
-          case  4:
-          ui4Temp= SINK_720P60;
-          break;
-          case  5:
-          ui4Temp= SINK_1080I60;
-          break;
-          case  21:
-          case  22:
-          ui4Temp= SINK_576I;
-          break;
-          case  16:
-          ui4Temp= SINK_1080P60;
-          break;
-
-          case  17:
-          case  18:
-          ui4Temp= SINK_576P;
-          break;
-          case  29:
-          case  30:
-          ui4Temp= SINK_576P_1440;
-          break;
-          case  19:
-          ui4Temp= SINK_720P50;
-          break;
-          case  20:
-          ui4Temp= SINK_1080I50;
-          break;
-
-          case  31:
-          ui4Temp= SINK_1080P50;
-          break;
-
-          case  32:
-          ui4Temp|= SINK_1080P24;
-          ui4Temp|= SINK_1080P23976;
-          break;
-
-          case  33:
-          //ui4CEA_NTSC |= SINK_1080P25;
-          ui4Temp= SINK_1080P25;
-          break;
-
-          case  34:
-          ui4Temp|= SINK_1080P30;
-          ui4Temp|= SINK_1080P2997;
-
-          break;
-
-          default:
-          break;
-
-
-         }
-
-       	_ui4First_16_NTSC_VIC |=ui4CEA_NTSC;
-       	_ui4First_16_PAL_VIC |= ui4CEA_PAL;
-       	_ui4First_16_VIC[bIdx]=ui4Temp;
-       }
-
-       if(*(prData+1+bIdx) & 0x80)
-       {
-         ui4OrgCEA_NTSC=	ui4CEA_NTSC&(~ui4OrgCEA_NTSC);
-         ui4OrgCEA_PAL=	ui4CEA_PAL&(~ui4OrgCEA_PAL);
-
-         if(ui4OrgCEA_NTSC)
-         {
-            _HdmiSinkAvCap.ui4_sink_native_ntsc_resolution = ui4OrgCEA_NTSC;
-         }
-         else if(ui4OrgCEA_PAL)
-         {
-           _HdmiSinkAvCap.ui4_sink_native_pal_resolution = ui4OrgCEA_PAL;
-         }
-         else
-         {
-           _HdmiSinkAvCap.ui4_sink_native_ntsc_resolution = 0;
-           _HdmiSinkAvCap.ui4_sink_native_pal_resolution = 0;
-         }
-        }
-      }//for(bIdx = 0; bIdx < bNo; bIdx++)
-
-      _HdmiSinkAvCap.ui4_sink_cea_ntsc_resolution |= ui4CEA_NTSC;
-       _HdmiSinkAvCap.ui4_sink_cea_pal_resolution |= ui4CEA_PAL;
-      _HdmiSinkAvCap.ui4_sink_native_ntsc_resolution |= ui4NativeCEA_NTSC;
-      _HdmiSinkAvCap.ui4_sink_native_pal_resolution |= ui4NativeCEA_PAL;
-
-    }
-    else if(bType == 0x01) // Audio data block
-    {
-       _HdmiSinkAvCap.ui2_edid_chksum_and_audio_sup &= ~(SINK_SAD_NO_EXIST);
-      for(bIdx = 0; bIdx < (bNo/3); bIdx++)
-      {
-        bLengthSum=bIdx*3;
-
-        bAudCode = (*(prData+bLengthSum+1)&0x78)>>3;//get audio code
-
-	if (bAudCode == AVD_DOLBY_PLUS) { /* AVD_DOLBY_PLUS */
-		bPcmChNum = (*(prData + bLengthSum + 1) & 0x07) + 1;
-			if (bPcmChNum >= 2) {
-				_HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[bPcmChNum
-				    - 2] = (*(prData + bLengthSum + 2) & 0x7f);
-			}
-	}
-
-	if ((*(prData + bLengthSum + 3) == 0x1) && (bAudCode == AVD_DOLBY_PLUS))
-		bAudCode = AVD_DOLBY_ATMOS;
-
-	if ((bAudCode >= AVD_LPCM)&& bAudCode <= AVD_WMA) {
-		_HdmiSinkAvCap.ui2_sink_aud_dec |= 	(1<<(bAudCode-1));/* PCM:1 HDMI_SINK_AUDIO_DEC_LPCM AC3:2 HDMI_SINK_AUDIO_DEC_AC3 */
-		/* must support dolby plus if support atmos according to spec */
-		if (bAudCode == AVD_DOLBY_ATMOS)
-			_HdmiSinkAvCap.ui2_sink_aud_dec |= (1 << (AVD_DOLBY_PLUS - 1));
-        }
-
-
-        if(bAudCode == AVD_LPCM) // LPCM
-        {
-          bPcmChNum = (*(prData+bLengthSum+1)&0x07)+1;
-          if(bPcmChNum>=2)
-          {
-          _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[bPcmChNum-2] = (*(prData+bLengthSum+2)&0x7f);
-          _HdmiSinkAvCap.ui1_sink_pcm_bit_size[bPcmChNum-2] = (*(prData+bLengthSum+3)&0x07);
-          }
-
-        }
-
-	if (bAudCode == AVD_AC3) {       /* AVD_AC3 */
-		bPcmChNum = (*(prData + bLengthSum + 1) & 0x07) + 1;
-		if (bPcmChNum >= 2) {
-			_HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[bPcmChNum - 2] =
-			    (*(prData + bLengthSum + 2) & 0x7f);
-		}
-	}
-
-        if(bAudCode == AVD_DST) // DST
-        {
-          bPcmChNum = (*(prData+bLengthSum+1)&0x07)+1;
-          if(bPcmChNum>=2)
-          {
-          _HdmiSinkAvCap.ui1_sink_dst_ch_sampling[bPcmChNum-2] = (*(prData+bLengthSum+2)&0x7f);
-
-          }
-
-        }
-
-        if(bAudCode == AVD_DSD) // DSD
-        {
-          bPcmChNum = (*(prData+bLengthSum+1)&0x07)+1;
-          if(bPcmChNum>=2)
-          {
-          _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[bPcmChNum-2] = (*(prData+bLengthSum+2)&0x7f);
-
-          }
-
-        }
-      }//for(bIdx = 0; bIdx < bNo/3; bIdx++)
-    }
-    else if(bType == 0x04) //speaker allocation tag code, 0x04
-    {
-      _HdmiSinkAvCap.ui1_sink_spk_allocation = *(prData+1)&0x7f;
-    }
-    else if(bType == 0x03) // VDSB exit
-    {
-      for(bTemp=0; bTemp<EDID_VSDB_LEN; bTemp++)
-      {
-        if(*(prData+bTemp+1) != aEDIDVSDBHeader[bTemp])
-        {
-          break;
-        }
-      }
-      // for loop to end, is. VSDB header match
-      if(bTemp==EDID_VSDB_LEN)
-      {
-        vSetSharedInfo(SI_EDID_VSDB_EXIST, TRUE);
-        _HdmiSinkAvCap.b_sink_support_hdmi_mode = TRUE;
-        //Read CEC physis address
-        if(bNo>=5)
-        {
-          _HdmiSinkAvCap.ui2_sink_cec_address =  (*(prData+4)<<8)|(*(prData+5));
-
-        }
-        else
-        {
-          _HdmiSinkAvCap.ui2_sink_cec_address =  0xFFFF;
-        }
-
-        //Read Support AI
-        if(bNo >= 6)
-        {
-          bTemp=*(prData+6);
-          if(bTemp&0x80)
-          {
-            _HdmiSinkAvCap.ui1_sink_support_ai = 1;
-            vSetSharedInfo(SI_HDMI_SUPPORTS_AI, 1);
-
-          }
-          else
-          {
-            _HdmiSinkAvCap.ui1_sink_support_ai = 0;
-            vSetSharedInfo(SI_HDMI_SUPPORTS_AI, 0);
-          }
-
-
-          _HdmiSinkAvCap.u1_sink_support_ai = 	i4SharedInfo(SI_HDMI_SUPPORTS_AI);//kenny add 2010/4/25 for repeater EDID check
-           _HdmiSinkAvCap.e_sink_rgb_color_bit = ((bTemp >>4)&0x07);
-
-            _HdmiSinkAvCap.u1_sink_max_tmds=*(prData+7);
-
-          if(bTemp&0x08)//support YCbCr Deep Color
-          {
-             _HdmiSinkAvCap.e_sink_ycbcr_color_bit = ((bTemp >>4)&0x07);
-          }
-
-        }
-        else
-        {
-          _HdmiSinkAvCap.ui1_sink_support_ai = 0;
-          vSetSharedInfo(SI_HDMI_SUPPORTS_AI, 0);
-        }
-
-		//max tmds clock
-		if(bNo >= 7)
-		{
-			bTemp=*(prData+7);
-		   _HdmiSinkAvCap.ui1_sink_max_tmds_clock = ((unsigned short)bTemp) * 5;
-		//	 _HdmiSinkAvCap.ui1_sink_max_tmds_clock = 190;
-		}
-		else
-		{
-			_HdmiSinkAvCap.ui1_sink_max_tmds_clock = 0;
-		}
-
-        //Read Latency data
-        if(bNo >= 8)
-        {
-          bTemp=*(prData+8);
-         if(bTemp&0x20)
-         _HdmiSinkAvCap.b_sink_hdmi_video_present= 1;
-          else
-         _HdmiSinkAvCap.b_sink_hdmi_video_present= 0;
-		  _HdmiSinkAvCap.ui1_sink_content_cnc = bTemp & 0x0f;
-
-          if(bTemp&0x80) //Latency Present
-          {
-             _HdmiSinkAvCap.ui1_sink_p_latency_present = TRUE;//kenny add 2010/4/25
-          	_HdmiSinkAvCap.ui1_sink_p_video_latency= *(prData+9);
-          	_HdmiSinkAvCap.ui1_sink_p_audio_latency = *(prData+10);
-
-            if(bTemp&0x40)//Interlace Latency present
-            {
-              _HdmiSinkAvCap.ui1_sink_i_latency_present = TRUE;
-              _HdmiSinkAvCap.ui1_sink_i_video_latency= *(prData+11);
-          	  _HdmiSinkAvCap.ui1_sink_i_audio_latency = *(prData+12);
-            }
-
-          }
-
-        _HdmiSinkAvCap.ui1_CNC=bTemp&0x0F;
-
-        }
-
-
-
-      if(bNo >= 8)
-        {
-          bTemp=*(prData+8);
-
-          if(!(bTemp&0x80)) //Latency Present
-          {
-          	bLatency_offset=bLatency_offset+2;
-          }
-          if(!(bTemp&0x40))//Interlace Latency present
-          {
-              bLatency_offset=bLatency_offset+2;
-          }
-
-      }
-      if(bNo >= 13)//kenny add
-      {
-          bTemp=*(prData+13);
-          if(bTemp&0x80)
-           _HdmiSinkAvCap.b_sink_3D_present= 1;
-          else
-          _HdmiSinkAvCap.b_sink_3D_present= 0;
-
-     }
-      if(bNo >= 8)
-        {
-          bTemp8=*(prData+8);
-
-          if(bTemp8&0x20)
-          {
-          }
-      	}
-
-      if(bNo >= (13-bLatency_offset))
-        {
-          bTemp13=*(prData+13-bLatency_offset);
-
-          if(bTemp13&0x80)
-          {
-            _u4i_3D_VIC|=SINK_720P50;
-            _u4i_3D_VIC|=SINK_720P60;
-            _u4i_3D_VIC|=SINK_1080P23976;
-            _u4i_3D_VIC|=SINK_1080P24;
-           _HdmiSinkAvCap.b_sink_3D_present=TRUE;
-          }
-          else
-          _HdmiSinkAvCap.b_sink_3D_present=FALSE;
-      	}
-      else
-       _HdmiSinkAvCap.b_sink_3D_present=FALSE;
-
-       if(bNo >=(13-bLatency_offset))
-        {
-          bTemp13=*(prData+13-bLatency_offset);
-
-         if((bTemp13&0x60)==0x20)
-          {
-            b3D_Multi_present=0x20;
-           }
-         else if((bTemp13&0x60)==0x40)
-          {
-            b3D_Multi_present=0x40;
-          }
-         else
-          {
-             b3D_Multi_present=0x00;
-           }
-         }
-
-         if(bNo >=(14-bLatency_offset))
-        {
-          bTemp14=*(prData+14-bLatency_offset);
-
-         }
-
-
-    if(bNo>(14-bLatency_offset+((bTemp14&0xE0)>>5)))
-    	{
-          if( b3D_Multi_present==0x20)
-               	{
-               	 if(((15-bLatency_offset+((bTemp14&0xE0)>>5))+(bTemp14&0x1F)) >= (15-bLatency_offset+((bTemp14&0xE0)>>5)+2))
-               	  	{
-                          // b3D_Structure_15_8=*(prData+15+((bTemp&0xE0)>>5));
-                           b3D_Structure_7_0=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+1);
-
-               	  	}
-
-               	 if((b3D_Structure_7_0 &0x01)==0x01)//support frame packet
-                            {
-                                   for(i=0;i<0x10;i++)
-                                   {
-                            	_u4i_3D_VIC|=_ui4First_16_VIC[i];
-                            	}
-                           }
-
-                      while(((15-bLatency_offset+((bTemp14&0xE0)>>5))+(bTemp14&0x1F)) >((15-bLatency_offset+((bTemp14&0xE0)>>5))+2+b2D_VIC_order_Index))
-               	       {
-               	          // 2 is 3D_structure
-                       	   bDataTemp=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+2+b2D_VIC_order_Index);
-                       	   if((bDataTemp &0x0F)<0x08)
-                       	   	{
-                       	   	b2D_VIC_order_Index=b2D_VIC_order_Index+1;
-
-                       	   	if((bDataTemp &0x0F)==0x00)// 3D_Structure=0,  support frame packet
-                       	   		{
-                       	   		_u4i_3D_VIC|=_ui4First_16_VIC[((bDataTemp &0xF0)>>4)];
-                       	   		}
-
-                       	   	}
-                       	    else
-                       	    	{
-                       	    	b2D_VIC_order_Index=b2D_VIC_order_Index+2;
-                       	    	}
-                       	    }
-               	  }
-          else if( b3D_Multi_present==0x40)
-                  	{
-                  	 if(((15-bLatency_offset+((bTemp14&0xE0)>>5))+(bTemp14&0x1F)) >= ((15-bLatency_offset+((bTemp14&0xE0)>>5))+4))
-                  	 	{
-                  	 	// 4 is 3D_structure+3D_MASK
-                  	 	//b3D_Structure_15_8=*(prData+15+((bTemp&0xE0)>>5));
-                            b3D_Structure_7_0=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+1);
-                  	       b3D_MASK_15_8=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+2);
-                  	       b3D_MASK_7_0=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+3);
-
-                            if((b3D_Structure_7_0 &0x01)==0x01)//support frame packet
-                            {
-                            	u23D_MASK_ALL=(((unsigned short)(b3D_MASK_15_8))<<8)|((unsigned short)(b3D_MASK_7_0));
-                                   for(i=0;i<0x10;i++)
-                                   {
-                            	if(u23D_MASK_ALL &0x0001)
-                            		{
-                            		_u4i_3D_VIC|=_ui4First_16_VIC[i];
-                            		}
-                            	 u23D_MASK_ALL=u23D_MASK_ALL>>1;
-                                   }
-                            }
-
-                  	 	}
-                       while(((15-bLatency_offset+((bTemp14&0xE0)>>5))+(bTemp14&0x1F)) >(15-bLatency_offset+((bTemp14&0xE0)>>5)+4+b2D_VIC_order_Index))
-                       	{
-                       	   bDataTemp=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+4+b2D_VIC_order_Index);
-                       	   if((bDataTemp &0x0F)<0x08)
-                       	   	{
-                       	   	b2D_VIC_order_Index=b2D_VIC_order_Index+1;
-
-                                   if((bDataTemp &0x0F)==0x00)// 3D_Structure=0
-                       	   		{
-                       	   		_u4i_3D_VIC|=_ui4First_16_VIC[((bDataTemp &0xF0)>>4)];
-                       	   		}
-
-                       	   	}
-                       	    else
-                       	    	{
-                       	    	b2D_VIC_order_Index=b2D_VIC_order_Index+2;
-                       	    	}
-                       	    }
-
-                  	 }
-             else
-              	{
-                           b3D_Structure_7_0=0;
-
-                           while(((15-bLatency_offset+((bTemp14&0xE0)>>5))+(bTemp14&0x1F)) >((15-bLatency_offset+((bTemp14&0xE0)>>5))+b2D_VIC_order_Index))
-                           {
-                       	   bDataTemp=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+b2D_VIC_order_Index);
-                       	   if((bDataTemp &0x0F)<0x08)
-                       	   	{
-                       	   	b2D_VIC_order_Index=b2D_VIC_order_Index+1;
-
-                       	   	if((bDataTemp &0x0F)==0x00)// 3D_Structure=0
-                       	   		{
-                       	   		_u4i_3D_VIC|=_ui4First_16_VIC[((bDataTemp &0xF0)>>4)];
-                       	   		}
-
-                       	   	}
-                       	    else
-                       	    	{
-                       	    	b2D_VIC_order_Index=b2D_VIC_order_Index+2;
-                       	    	}
-                       	    }
-             	        }
-
-             	        }
-                      _HdmiSinkAvCap.ui4_sink_cea_3D_resolution=_u4i_3D_VIC;
-
-
-      }//if(bTemp==EDID_VSDB_LEN)
-      else
-      {
-        //vSetSharedInfo(SI_EDID_VSDB_EXIST, FALSE);
-        //_HdmiSinkAvCap.b_sink_support_hdmi_mode = FALSE;
-
-      }
-
-    }//if(bType == 0x03) // VDSB exit
-    else if(bType == 0x07)//Use Extended Tag
-    {
-    	if(*(prData+1) == 0x05)//Extend Tag code ==0x05
-    	{
-    	  if(*(prData+2)& 0x1)
-    	  {
-    	  	//Suppot xvYcc601
-    	  	_HdmiSinkAvCap.ui2_sink_colorimetry |= SINK_XV_YCC601;
-    	  }
-
-    	  if(*(prData+2)& 0x2)
-    	  {
-    	  	//Suppot xvYcc709
-    	  	_HdmiSinkAvCap.ui2_sink_colorimetry |= SINK_XV_YCC709;
-    	  }
-
-    	  if(*(prData+3)& 0x1)
-    	  {
-    	  	//support Gamut data P0
-    	  	_HdmiSinkAvCap.ui2_sink_colorimetry |= SINK_METADATA0;
-    	  }
-
-    	  if(*(prData+3)& 0x2)
-    	  {
-    	  	//support Gamut data P1
-    	  	_HdmiSinkAvCap.ui2_sink_colorimetry |= SINK_METADATA1;
-    	  }
-
-    	  if(*(prData+3)& 0x4)
-    	  {
-    	  	//support Gamut data P1
-    	  	_HdmiSinkAvCap.ui2_sink_colorimetry |= SINK_METADATA2;
-    	  }
-    	}
-    	else if(*(prData+1) == 0x0)//Extend Tag code ==0x0
-    	{
-          if(*(prData+2)& 0x40)
-          {
-            //support selectable, QS=1
-            _HdmiSinkAvCap.ui2_sink_vcdb_data |= SINK_RGB_SELECTABLE;
-          }
-    	}
-    }
-
-    // re-assign the next data block address
-    prData += (bNo+1);  // '1' means the tag byte
-
-    bLen -= (bNo+1);
-
-  }//while(bLen)
-
-
-  _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[5]|= _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[6];
-  _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[4]|= _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[5];
-  _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[3]|= _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[4];
-  _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[2]|= _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[3];
-  _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[1]|= _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[2];
-  _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[0]|= _HdmiSinkAvCap.ui1_sink_pcm_ch_sampling[1];
-
-  _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[5]|= _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[6];
-  _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[4]|= _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[5];
-  _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[3]|= _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[4];
-  _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[2]|= _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[3];
-  _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[1]|= _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[2];
-  _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[0]|= _HdmiSinkAvCap.ui1_sink_dsd_ch_sampling[1];
-
-  _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[5] |= _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[6];
-  _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[4] |= _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[5];
-  _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[3] |= _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[4];
-  _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[2] |= _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[3];
-  _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[1] |= _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[2];
-  _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[0] |= _HdmiSinkAvCap.ui1_sink_ac3_ch_sampling[1];
-
-  _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[5] |= _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[6];
-  _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[4] |= _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[5];
-  _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[3] |= _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[4];
-  _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[2] |= _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[3];
-  _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[1] |= _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[2];
-  _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[0] |= _HdmiSinkAvCap.ui1_sink_ec3_ch_sampling[1];
-
-  if(_HdmiSinkAvCap.ui2_edid_chksum_and_audio_sup & SINK_EXT_BLK_CHKSUM_ERR)//2007/2/12 for av output chksum error
-  {
-    vSetSharedInfo(SI_EDID_VSDB_EXIST, FALSE);
-    _HdmiSinkAvCap.b_sink_support_hdmi_mode = FALSE;
-  }
+  unsigned int u4Len;
 
+  u4Len = (1 + _bEdidData[EDID_ADDR_EXT_BLOCK_FLAG]) * EDID_BLOCK_LEN;
+  return (u4Len < EDID_SIZE) ? u4Len : EDID_SIZE;
 }
 
-unsigned char fgParserExtEDID(unsigned char *prData)
+static unsigned short u2EdidCacheKey(void)
 {
-  unsigned char bIdx;
-  unsigned char bTemp=0;
-  unsigned short ui2HActive, ui2HBlanking, ui2VBlanking;
-  unsigned char bOfst, *prCEAaddr;
-  HDMI_EDID_FUNC();
+  unsigned short ui2Key = _bEdidData[EDID_BLOCK_LEN - 1];
 
- _HdmiSinkAvCap.ui1_ExtEdid_Revision=*(prData+EXTEDID_ADDR_REVISION);
+  if(_bEdidData[EDID_ADDR_EXT_BLOCK_FLAG] > 0)
+    ui2Key |= (_bEdidData[2 * EDID_BLOCK_LEN - 1] << 8);
 
-  for(bIdx=0; bIdx<EDID_BLOCK_LEN; bIdx++)
-  {
-     // add the value into checksum
-    bTemp += *(prData+bIdx);//i4SharedInfo(wPos+bIdx);
-   }
-
-
-  bTemp  = 0;
-  // check if EDID checksume pass
-  if(bTemp)
-  {
-      return (FALSE);
-  }
-  else
-  {
-     _HdmiSinkAvCap.ui2_edid_chksum_and_audio_sup &=~ SINK_EXT_BLK_CHKSUM_ERR;
-  }
-
-  // Step 1: get the offset value of 1st detail timing description within extension block
-  bOfst=*(prData+EXTEDID_ADDR_OFST_TIME_DSPR);
-
-  if(*(prData+EDID_ADDR_EXTEND_BYTE3) & 0x40)//Support basic audio
-    _HdmiSinkAvCap.ui2_edid_chksum_and_audio_sup &= ~SINK_BASIC_AUDIO_NO_SUP;
-
-  //Max'0528'04, move to here, after read 0x80 ~ 0xFF because it is 0x83...
-  if(*(prData+EDID_ADDR_EXTEND_BYTE3) & 0x20) //receiver support YCbCr 4:4:4
-  {
-  	_HdmiSinkAvCap.ui2_sink_colorimetry |= SINK_YCBCR_444;
-  }
+  return ui2Key;
+}
 
-  if(*(prData+EDID_ADDR_EXTEND_BYTE3) & 0x10)//receiver support YCbCr 4:2:2
-    _HdmiSinkAvCap.ui2_sink_colorimetry |= SINK_YCBCR_422;
+// Publish a parse result to the driver wide sink state.
+static void vEdidApplyCaps(const HDMI_EDID_CAPS_T *prCaps)
+{
+  _HdmiSinkAvCap = prCaps->rSinkAvCap;
+  vSetSharedInfo(SI_EDID_PARSING_RESULT, TRUE);
+  vSetSharedInfo(SI_EDID_VSDB_EXIST, prCaps->fgVsdbExist);
+  vSetSharedInfo(SI_HDMI_SUPPORTS_AI, prCaps->rSinkAvCap.ui1_sink_support_ai);
+}
 
-    _HdmiSinkAvCap.ui2_sink_colorimetry |= SINK_RGB;
-  // Step 3: read-back the pixel clock of each timing descriptor
+static unsigned char fgEdidCacheLookup(void)
+{
+  unsigned int u4Len = u4EdidDataLen();
 
-  // Step 4: read-back V active line to define EDID resolution
-  for(bIdx=0; bIdx<6; bIdx++)
+  if((!_rEdidCache.fgValid) || (_rEdidCache.ui2Key != u2EdidCacheKey()) ||
+     (_rEdidCache.u4Len != u4Len) || memcmp(_rEdidCache.bEdidData, _bEdidData, u4Len))
   {
-    if(((bOfst+18*bIdx) > 109)||(*(prData+bOfst+18*bIdx)==0))
-  {
-      break;
-  }
-    ui2HActive = (unsigned short) (*(prData+bOfst+18*bIdx+OFST_H_ACT_BLA_HI)&0xf0) << 4;
-    ui2HActive |= *(prData+bOfst+18*bIdx+OFST_H_ACTIVE_LO);
-    ui2HBlanking = (unsigned short) (*(prData+bOfst+18*bIdx+OFST_H_ACT_BLA_HI)&0x0f) << 8;
-    ui2HBlanking |= *(prData+bOfst+18*bIdx+OFST_H_BLANKING_LO);
-    ui2VBlanking = (unsigned short) (*(prData+bOfst+18*bIdx+OFST_V_ACTIVE_HI)&0x0f) << 8;
-    ui2VBlanking |= *(prData+bOfst+18*bIdx+OFST_V_BLANKING_LO);
-    bTemp = (*(prData+bOfst+18*bIdx+OFST_FLAGS)&0x80)>>7;
-    vAnalyzeDTD(ui2HActive, ui2HBlanking, bTemp, FALSE);
+    return (FALSE);
   }
 
-  if(*(prData+EXTEDID_ADDR_REVISION) >= 0x03)//for simplay #7-37, #7-36
-  {
-
-    prCEAaddr = prData+4;
-    vParserCEADataBlock(prCEAaddr, bOfst-4);
-  }
+  vEdidApplyCaps(&_rEdidCache.rCaps);
+  _rEdidCache.u4Hit++;
 
-  // if go here, ie. parsing EDID data ok !!
   return (TRUE);
 }
 
-void vParserExtEDIDState(unsigned char *prEdid)
+static void vEdidCacheStore(const HDMI_EDID_CAPS_T *prCaps)
 {
-  unsigned char bTemp;
-  unsigned char *prData;
-  HDMI_EDID_FUNC();
-
-  if(i4SharedInfo(SI_EDID_PARSING_RESULT) == TRUE)
-  {
-    // parsing EDID extension block if it exist
-    for(bTemp=0; bTemp<i4SharedInfo(SI_EDID_EXT_BLOCK_NO); bTemp++)
-    {
-      if((EDID_BLOCK_LEN+bTemp*EDID_BLOCK_LEN) < EDID_SIZE)//for Buffer Overflow error
-      {
-       if(*(prEdid+EDID_BLOCK_LEN+bTemp*EDID_BLOCK_LEN)== 0x02)
-       {
-       	 prData = (prEdid+EDID_BLOCK_LEN+bTemp*EDID_BLOCK_LEN);
-         fgParserExtEDID(prData);
-       }
-       else if(*(prEdid+EDID_BLOCK_LEN+bTemp*EDID_BLOCK_LEN)==0xF0)
-       {
-
-       }
-     }
-     else
-     {
-
-     }
-    }
-  }
+  unsigned int u4Len = u4EdidDataLen();
+
+  _rEdidCache.fgValid = FALSE;
+  _rEdidCache.ui2Key = u2EdidCacheKey();
+  _rEdidCache.u4Len = u4Len;
+  _rEdidCache.u4Hit = 0;
+  memcpy(_rEdidCache.bEdidData, _bEdidData, u4Len);
+  _rEdidCache.rCaps = *prCaps;
+  _rEdidCache.fgValid = TRUE;
 }
 
 void hdmi_checkedid(unsigned char i1noedid)
 {
   unsigned char bTemp;
   unsigned char bRetryCount= 40;
-  unsigned char i;
+  unsigned char fgParserOk = FALSE;
   HDMI_EDID_FUNC();
 
   vClearEdidInfo();
 
-   for(i=0;i<0x10;i++)
-    _ui4First_16_VIC[i] =0;
-
-   _ui4First_16_NTSC_VIC =0;
-   _ui4First_16_PAL_VIC=0;
-   _u4i_3D_VIC=0;
    _HdmiSinkAvCap.b_sink_hdmi_video_present=FALSE;
    _HdmiSinkAvCap.b_sink_3D_present=FALSE;
    _HdmiSinkAvCap.ui4_sink_cea_3D_resolution=0;
@@ -1419,18 +437,22 @@ void hdmi_checkedid(unsigned char i1noedid)
   {
     if(hdmi_fgreadedid(i1noedid) == TRUE)
     {
-      if(fgParserEDID(&_bEdidData[0])==TRUE)
+      if((i1noedid == EXTERNAL_EDID) && (fgEdidCacheLookup() == TRUE))
       {
-        vSetSharedInfo(SI_EDID_PARSING_RESULT, TRUE);
-        _HdmiSinkAvCap.b_sink_edid_ready =TRUE;
-        HDMI_DEF_LOG("[hdmi][edid]parser ok\n");
-        break;
+        HDMI_EDID_LOG("cached, key:%x hit:%d\n", _rEdidCache.ui2Key, _rEdidCache.u4Hit);
+        if (hdmidrv_log_on&hdmiedidlog)
+          vShowEdidInformation();
+        return;
       }
 
-      if(bTemp == bRetryCount-1)
+      fgParserOk = fgHdmiEdidParse(_bEdidData, u4EdidDataLen(), &_rEdidCaps);
+      if(fgParserOk == TRUE)
       {
-        vSetSharedInfo(SI_EDID_PARSING_RESULT, TRUE);
+        HDMI_EDID_LOG("parser ok\n");
+        break;
       }
+
+      // out of retries: keep whatever the extension blocks gave
       if(bTemp == bRetryCount-1)
       {
 
@@ -1463,8 +485,7 @@ void hdmi_checkedid(unsigned char i1noedid)
       msleep(5);
   }
 
-  if((i4SharedInfo(SI_EDID_EXT_BLOCK_NO)*EDID_BLOCK_LEN) < EDID_SIZE)//for Buffer Overflow error
-  vParserExtEDIDState(&_bEdidData[0]);
+  vEdidApplyCaps(&_rEdidCaps);
 
   if(fgIsHdmiNoEDIDCheck())
   {
@@ -1476,6 +497,10 @@ void hdmi_checkedid(unsigned char i1noedid)
         HDMI_DEF_LOG("[hdmi]edid err,force to err edid 1\n");
         vSetEdidChkError();
     }
+    else if((i1noedid == EXTERNAL_EDID) && fgParserOk && (!fgIsHdmiNoEDIDCheck()))
+    {
+        vEdidCacheStore(&_rEdidCaps);
+    }
 
     if (hdmidrv_log_on&hdmiedidlog)
     {
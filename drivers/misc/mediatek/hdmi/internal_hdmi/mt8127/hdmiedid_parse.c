@@ -0,0 +1,1093 @@
+// Pure EDID parser, see hdmiedid_parse.h. The parsing rules are the ones hdmiedid.c
+// used to apply directly on _HdmiSinkAvCap; they now write to the HDMI_EDID_CAPS_T
+// the caller passes in, and every read is bounded by the buffer length.
+
+#include "hdmiedid_parse.h"
+
+#ifndef TRUE
+#define TRUE  1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+// The 3D fields of a VSDB are walked with offsets taken from the block itself, so the
+// block is copied into a zero padded scratch which those offsets cannot run out of.
+#define EDID_VSDB_SCRATCH_LEN       64
+
+static const unsigned char aEDIDHeader[EDID_HEADER_LEN] = {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+static const unsigned char aEDIDVSDBHeader[EDID_VSDB_LEN] = {0x03, 0x0c, 0x00};
+
+// Working state of one parse, on the caller's stack.
+typedef struct
+{
+  HDMI_SINK_AV_CAP_T *prCap;
+  HDMI_EDID_CAPS_T *prCaps;
+  unsigned int u4_3D_VIC;
+  unsigned int ui4First_16_VIC[16];
+} HDMI_EDID_PARSE_T;
+
+static void vEdidCapsInit(HDMI_EDID_CAPS_T *prCaps)
+{
+  static const HDMI_EDID_CAPS_T rZero;
+  HDMI_SINK_AV_CAP_T *prCap = &prCaps->rSinkAvCap;
+
+  *prCaps = rZero;
+  prCap->ui1_sink_pcm_ch_sampling[0] = 0x07;
+  prCap->ui1_sink_pcm_bit_size[0] = 0x07;
+  prCap->e_sink_rgb_color_bit = HDMI_SINK_NO_DEEP_COLOR;
+  prCap->e_sink_ycbcr_color_bit = HDMI_SINK_NO_DEEP_COLOR;
+  prCap->ui2_edid_chksum_and_audio_sup = (SINK_BASIC_AUDIO_NO_SUP|SINK_SAD_NO_EXIST|SINK_BASE_BLK_CHKSUM_ERR|SINK_EXT_BLK_CHKSUM_ERR);
+  prCap->ui2_sink_cec_address = 0xffff;
+}
+
+static void vAnalyzeDTD(HDMI_SINK_AV_CAP_T *prCap, unsigned short ui2Active, unsigned short ui2HBlanking, unsigned char bFormat, unsigned char fgFirstDTD)
+{
+  unsigned int ui4NTSC =  prCap->ui4_sink_dtd_ntsc_resolution;
+  unsigned int ui4PAL  =  prCap->ui4_sink_dtd_pal_resolution;
+  unsigned int ui41stNTSC =  prCap->ui4_sink_1st_dtd_ntsc_resolution;
+  unsigned int ui41stPAL  =  prCap->ui4_sink_1st_dtd_pal_resolution;
+
+  switch(ui2Active)
+  {
+    case  0x5a0: // 480i
+      if(ui2HBlanking == 0x114) //NTSC
+      {
+        if(bFormat == 0) //p-scan
+        {
+          ui4NTSC |= SINK_480P_1440;
+          if(fgFirstDTD)
+          {
+          ui41stNTSC |= SINK_480P_1440;
+          }
+        }
+        else
+        {
+          ui4NTSC |= SINK_480I;
+          if(fgFirstDTD)
+          {
+          ui41stNTSC |= SINK_480I;
+          }
+        }
+      }
+      else if(ui2HBlanking == 0x120) //PAL
+      {
+        if(bFormat == 0) //p-scan
+        {
+          ui4PAL |= SINK_576P_1440;
+          if(fgFirstDTD)
+          {
+          ui41stPAL |= SINK_576P_1440;
+          }
+        }
+        else
+        {
+          ui4PAL |= SINK_576I;
+          if(fgFirstDTD)
+          {
+          ui41stPAL |= SINK_576I;
+          }
+        }
+      }
+      break;
+    case  0x2d0: // 480p
+      if((ui2HBlanking == 0x8a) && (bFormat == 0)) //NTSC, p-scan
+      {
+        ui4NTSC |= SINK_480P;
+        if(fgFirstDTD)
+        {
+        ui41stNTSC |= SINK_480P;
+        }
+      }
+      else if((ui2HBlanking == 0x90) && (bFormat == 0)) //PAL, p-scan
+      {
+        ui4PAL |= SINK_576P;
+        if(fgFirstDTD)
+        {
+        ui41stPAL |= SINK_576P;
+        }
+      }
+      break;
+    case  0x500: // 720p
+      if((ui2HBlanking == 0x172) && (bFormat == 0)) //NTSC, p-scan
+      {
+        ui4NTSC |= SINK_720P60;
+        if(fgFirstDTD)
+        {
+        ui41stNTSC |= SINK_720P60;
+        }
+      }
+      else if((ui2HBlanking == 0x2bc) && (bFormat == 0)) //PAL, p-scan
+      {
+        ui4PAL |= SINK_720P50;
+        if(fgFirstDTD)
+        {
+        ui41stPAL |= SINK_720P50;
+        }
+      }
+      break;
+    case  0x780: // 1080i, 1080P
+      if((ui2HBlanking == 0x118) && (bFormat == 1)) //NTSC, interlace
+      {
+        ui4NTSC |= SINK_1080I60;
+        if(fgFirstDTD)
+        {
+        ui41stNTSC |= SINK_1080I60;
+        }
+      }
+     else if((ui2HBlanking == 0x118) && (bFormat == 0)) //NTSC, Progressive
+      {
+        ui4NTSC |= SINK_1080P60;
+        if(fgFirstDTD)
+        {
+        ui41stNTSC |= SINK_1080P60;
+        }
+      }
+      else if((ui2HBlanking == 0x2d0) && (bFormat == 1)) //PAL, interlace
+      {
+        ui4PAL |= SINK_1080I50;
+        if(fgFirstDTD)
+        {
+        ui41stPAL |= SINK_1080I50;
+        }
+      }
+      else if((ui2HBlanking == 0x2d0) && (bFormat == 0)) //PAL, Progressive
+      {
+        ui4PAL |= SINK_1080P50;
+        if(fgFirstDTD)
+        {
+        ui41stPAL |= SINK_1080P50;
+        }
+      }
+      break;
+  }
+   prCap->ui4_sink_dtd_ntsc_resolution = ui4NTSC;
+   prCap->ui4_sink_dtd_pal_resolution = ui4PAL;
+   prCap->ui4_sink_1st_dtd_ntsc_resolution = ui41stNTSC;
+   prCap->ui4_sink_1st_dtd_pal_resolution = ui41stPAL;
+}
+
+static unsigned char fgParserEDID(HDMI_SINK_AV_CAP_T *prCap, const unsigned char *prbData)
+{
+   unsigned char bIdx;
+   unsigned char bTemp=0;
+   unsigned short ui2HActive, ui2HBlanking;
+
+   prCap->ui1_Edid_Version=*(prbData+EDID_ADDR_VERSION);
+   prCap->ui1_Edid_Revision=*(prbData+EDID_ADDR_REVISION);
+   prCap->ui1_Display_Horizontal_Size=*(prbData+EDID_IMAGE_HORIZONTAL_SIZE);
+   prCap->ui1_Display_Vertical_Size=*(prbData+EDID_IMAGE_VERTICAL_SIZE);
+
+  // Step 1: check if EDID header pass
+  // ie. EDID[0] ~ EDID[7] = specify header pattern
+  for(bIdx=EDID_ADDR_HEADER; bIdx<(EDID_ADDR_HEADER+EDID_HEADER_LEN); bIdx++)
+  {
+    if(*(prbData+bIdx) != aEDIDHeader[bIdx])
+    {
+      return (FALSE);
+    }
+  }
+
+  // Step 2: Check if EDID checksume pass
+  // ie. value of EDID[0] + ... + [0x7F] = 256*n
+  for(bIdx=0; bIdx<EDID_BLOCK_LEN; bIdx++)
+  {
+     // add the value into checksum
+    bTemp += *(prbData+bIdx);
+   }
+
+  // check if EDID checksume pass
+  if(bTemp)
+  {
+    return (FALSE);
+  }
+  else
+  {
+    prCap->ui2_edid_chksum_and_audio_sup &= ~SINK_BASE_BLK_CHKSUM_ERR;
+  }
+
+  // [3.3] read-back H active line to define EDID resolution
+  for(bIdx=0; bIdx<2; bIdx++)
+  {
+    ui2HActive = (unsigned short) (*(prbData+EDID_ADDR_TIMING_DSPR_1+18*bIdx+OFST_H_ACT_BLA_HI)&0xf0) << 4;
+    ui2HActive |= *(prbData+EDID_ADDR_TIMING_DSPR_1+18*bIdx+OFST_H_ACTIVE_LO);
+    ui2HBlanking = (unsigned short) (*(prbData+EDID_ADDR_TIMING_DSPR_1+18*bIdx+OFST_H_ACT_BLA_HI)&0x0f) << 8;
+    ui2HBlanking |= *(prbData+EDID_ADDR_TIMING_DSPR_1+18*bIdx+OFST_H_BLANKING_LO);
+    bTemp = (*(prbData+EDID_ADDR_TIMING_DSPR_1+18*bIdx+OFST_FLAGS)&0x80)>>7;
+    if(bIdx == 0)
+    {
+      vAnalyzeDTD(prCap, ui2HActive, ui2HBlanking, bTemp, TRUE);
+    }
+    else
+    {
+      vAnalyzeDTD(prCap, ui2HActive, ui2HBlanking, bTemp, FALSE);
+    }
+  }
+
+  // if go here, ie. parsing EDID data ok !!
+  return (TRUE);
+}
+
+static void vParserVSDB(HDMI_EDID_PARSE_T *prParse, const unsigned char *prData, unsigned char bNo)
+{
+  HDMI_SINK_AV_CAP_T *prCap = prParse->prCap;
+  unsigned char bTemp;
+  unsigned char bTemp13,bTemp8,bLatency_offset=0;
+  unsigned char b3D_Multi_present=0,b3D_Structure_7_0=1,b3D_MASK_15_8=1,b3D_MASK_7_0=1,b2D_VIC_order_Index=0;
+  unsigned char i,bTemp14=1,bDataTemp=1;
+  unsigned int u23D_MASK_ALL;
+
+      for(bTemp=0; bTemp<EDID_VSDB_LEN; bTemp++)
+      {
+        if(*(prData+bTemp+1) != aEDIDVSDBHeader[bTemp])
+        {
+          return;
+        }
+      }
+
+      // for loop to end, ie. VSDB header match
+      {
+        prParse->prCaps->fgVsdbExist = TRUE;
+        prCap->b_sink_support_hdmi_mode = TRUE;
+        //Read CEC physis address
+        if(bNo>=5)
+        {
+          prCap->ui2_sink_cec_address =  (*(prData+4)<<8)|(*(prData+5));
+
+        }
+        else
+        {
+          prCap->ui2_sink_cec_address =  0xFFFF;
+        }
+
+        //Read Support AI
+        if(bNo >= 6)
+        {
+          bTemp=*(prData+6);
+          if(bTemp&0x80)
+          {
+            prCap->ui1_sink_support_ai = 1;
+
+          }
+          else
+          {
+            prCap->ui1_sink_support_ai = 0;
+          }
+
+
+          prCap->u1_sink_support_ai = 	prCap->ui1_sink_support_ai;//kenny add 2010/4/25 for repeater EDID check
+           prCap->e_sink_rgb_color_bit = ((bTemp >>4)&0x07);
+
+            prCap->u1_sink_max_tmds=*(prData+7);
+
+          if(bTemp&0x08)//support YCbCr Deep Color
+          {
+             prCap->e_sink_ycbcr_color_bit = ((bTemp >>4)&0x07);
+          }
+
+        }
+        else
+        {
+          prCap->ui1_sink_support_ai = 0;
+        }
+
+		//max tmds clock
+		if(bNo >= 7)
+		{
+			bTemp=*(prData+7);
+		   prCap->ui1_sink_max_tmds_clock = ((unsigned short)bTemp) * 5;
+		//	 prCap->ui1_sink_max_tmds_clock = 190;
+		}
+		else
+		{
+			prCap->ui1_sink_max_tmds_clock = 0;
+		}
+
+        //Read Latency data
+        if(bNo >= 8)
+        {
+          bTemp=*(prData+8);
+         if(bTemp&0x20)
+         prCap->b_sink_hdmi_video_present= 1;
+          else
+         prCap->b_sink_hdmi_video_present= 0;
+		  prCap->ui1_sink_content_cnc = bTemp & 0x0f;
+
+          if(bTemp&0x80) //Latency Present
+          {
+             prCap->ui1_sink_p_latency_present = TRUE;//kenny add 2010/4/25
+          	prCap->ui1_sink_p_video_latency= *(prData+9);
+          	prCap->ui1_sink_p_audio_latency = *(prData+10);
+
+            if(bTemp&0x40)//Interlace Latency present
+            {
+              prCap->ui1_sink_i_latency_present = TRUE;
+              prCap->ui1_sink_i_video_latency= *(prData+11);
+          	  prCap->ui1_sink_i_audio_latency = *(prData+12);
+            }
+
+          }
+
+        prCap->ui1_CNC=bTemp&0x0F;
+
+        }
+
+
+
+      if(bNo >= 8)
+        {
+          bTemp=*(prData+8);
+
+          if(!(bTemp&0x80)) //Latency Present
+          {
+          	bLatency_offset=bLatency_offset+2;
+          }
+          if(!(bTemp&0x40))//Interlace Latency present
+          {
+              bLatency_offset=bLatency_offset+2;
+          }
+
+      }
+      if(bNo >= 13)//kenny add
+      {
+          bTemp=*(prData+13);
+          if(bTemp&0x80)
+           prCap->b_sink_3D_present= 1;
+          else
+          prCap->b_sink_3D_present= 0;
+
+     }
+      if(bNo >= 8)
+        {
+          bTemp8=*(prData+8);
+
+          if(bTemp8&0x20)
+          {
+          }
+      	}
+
+      if(bNo >= (13-bLatency_offset))
+        {
+          bTemp13=*(prData+13-bLatency_offset);
+
+          if(bTemp13&0x80)
+          {
+            prParse->u4_3D_VIC|=SINK_720P50;
+            prParse->u4_3D_VIC|=SINK_720P60;
+            prParse->u4_3D_VIC|=SINK_1080P23976;
+            prParse->u4_3D_VIC|=SINK_1080P24;
+           prCap->b_sink_3D_present=TRUE;
+          }
+          else
+          prCap->b_sink_3D_present=FALSE;
+      	}
+      else
+       prCap->b_sink_3D_present=FALSE;
+
+      if(bNo >=(13-bLatency_offset))
+        {
+          bTemp13=*(prData+13-bLatency_offset);
+
+         if((bTemp13&0x60)==0x20)
+          {
+            b3D_Multi_present=0x20;
+           }
+         else if((bTemp13&0x60)==0x40)
+          {
+            b3D_Multi_present=0x40;
+          }
+         else
+          {
+             b3D_Multi_present=0x00;
+           }
+         }
+
+         if(bNo >=(14-bLatency_offset))
+        {
+          bTemp14=*(prData+14-bLatency_offset);
+
+         }
+
+
+    if(bNo>(14-bLatency_offset+((bTemp14&0xE0)>>5)))
+    	{
+          if( b3D_Multi_present==0x20)
+               	{
+               	 if(((15-bLatency_offset+((bTemp14&0xE0)>>5))+(bTemp14&0x1F)) >= (15-bLatency_offset+((bTemp14&0xE0)>>5)+2))
+               	  	{
+                          // b3D_Structure_15_8=*(prData+15+((bTemp&0xE0)>>5));
+                           b3D_Structure_7_0=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+1);
+
+               	  	}
+
+               	 if((b3D_Structure_7_0 &0x01)==0x01)//support frame packet
+                            {
+                                   for(i=0;i<0x10;i++)
+                                   {
+                            	prParse->u4_3D_VIC|=prParse->ui4First_16_VIC[i];
+                            	}
+                           }
+
+                      while(((15-bLatency_offset+((bTemp14&0xE0)>>5))+(bTemp14&0x1F)) >((15-bLatency_offset+((bTemp14&0xE0)>>5))+2+b2D_VIC_order_Index))
+               	       {
+               	          // 2 is 3D_structure
+                       	   bDataTemp=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+2+b2D_VIC_order_Index);
+                       	   if((bDataTemp &0x0F)<0x08)
+                       	   	{
+                       	   	b2D_VIC_order_Index=b2D_VIC_order_Index+1;
+
+                       	   	if((bDataTemp &0x0F)==0x00)// 3D_Structure=0,  support frame packet
+                       	   		{
+                       	   		prParse->u4_3D_VIC|=prParse->ui4First_16_VIC[((bDataTemp &0xF0)>>4)];
+                       	   		}
+
+                       	   	}
+                       	    else
+                       	    	{
+                       	    	b2D_VIC_order_Index=b2D_VIC_order_Index+2;
+                       	    	}
+                       	    }
+               	  }
+          else if( b3D_Multi_present==0x40)
+                  	{
+                  	 if(((15-bLatency_offset+((bTemp14&0xE0)>>5))+(bTemp14&0x1F)) >= ((15-bLatency_offset+((bTemp14&0xE0)>>5))+4))
+                  	 	{
+                  	 	// 4 is 3D_structure+3D_MASK
+                  	 	//b3D_Structure_15_8=*(prData+15+((bTemp&0xE0)>>5));
+                            b3D_Structure_7_0=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+1);
+                  	       b3D_MASK_15_8=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+2);
+                  	       b3D_MASK_7_0=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+3);
+
+                            if((b3D_Structure_7_0 &0x01)==0x01)//support frame packet
+                            {
+                            	u23D_MASK_ALL=(((unsigned short)(b3D_MASK_15_8))<<8)|((unsigned short)(b3D_MASK_7_0));
+                                   for(i=0;i<0x10;i++)
+                                   {
+                            	if(u23D_MASK_ALL &0x0001)
+                            		{
+                            		prParse->u4_3D_VIC|=prParse->ui4First_16_VIC[i];
+                            		}
+                            	 u23D_MASK_ALL=u23D_MASK_ALL>>1;
+                                   }
+                            }
+
+                  	 	}
+                       while(((15-bLatency_offset+((bTemp14&0xE0)>>5))+(bTemp14&0x1F)) >(15-bLatency_offset+((bTemp14&0xE0)>>5)+4+b2D_VIC_order_Index))
+                       	{
+                       	   bDataTemp=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+4+b2D_VIC_order_Index);
+                       	   if((bDataTemp &0x0F)<0x08)
+                       	   	{
+                       	   	b2D_VIC_order_Index=b2D_VIC_order_Index+1;
+
+                                   if((bDataTemp &0x0F)==0x00)// 3D_Structure=0
+                       	   		{
+                       	   		prParse->u4_3D_VIC|=prParse->ui4First_16_VIC[((bDataTemp &0xF0)>>4)];
+                       	   		}
+
+                       	   	}
+                       	    else
+                       	    	{
+                       	    	b2D_VIC_order_Index=b2D_VIC_order_Index+2;
+                       	    	}
+                       	    }
+
+                  	 }
+             else
+              	{
+                           b3D_Structure_7_0=0;
+
+                           while(((15-bLatency_offset+((bTemp14&0xE0)>>5))+(bTemp14&0x1F)) >((15-bLatency_offset+((bTemp14&0xE0)>>5))+b2D_VIC_order_Index))
+                           {
+                       	   bDataTemp=*(prData+15-bLatency_offset+((bTemp14&0xE0)>>5)+b2D_VIC_order_Index);
+                       	   if((bDataTemp &0x0F)<0x08)
+                       	   	{
+                       	   	b2D_VIC_order_Index=b2D_VIC_order_Index+1;
+
+                       	   	if((bDataTemp &0x0F)==0x00)// 3D_Structure=0
+                       	   		{
+                       	   		prParse->u4_3D_VIC|=prParse->ui4First_16_VIC[((bDataTemp &0xF0)>>4)];
+                       	   		}
+
+                       	   	}
+                       	    else
+                       	    	{
+                       	    	b2D_VIC_order_Index=b2D_VIC_order_Index+2;
+                       	    	}
+                       	    }
+             	        }
+
+             	        }
+                      prCap->ui4_sink_cea_3D_resolution=prParse->u4_3D_VIC;
+      }
+}
+
+static void vParserCEADataBlock(HDMI_EDID_PARSE_T *prParse, const unsigned char *prData, unsigned char bLen)
+{
+  HDMI_SINK_AV_CAP_T *prCap = prParse->prCap;
+  unsigned int ui4CEA_NTSC=0, ui4CEA_PAL=0,ui4OrgCEA_NTSC =0, ui4OrgCEA_PAL=0, ui4NativeCEA_NTSC =0, ui4NativeCEA_PAL=0;
+  unsigned char bTemp, bIdx;
+  unsigned char bLengthSum;
+  unsigned char bType, bNo, bAudCode, bPcmChNum;
+  unsigned char bVsdb[EDID_VSDB_SCRATCH_LEN];
+  unsigned int ui4Temp=0;
+
+  while(bLen)
+  {
+  	if(bLen>0x80) break;
+    // Step 1: get 1st data block type & total number of this data type
+    bTemp=*prData;
+    bType=bTemp >> 5; // bit[7:5]
+    bNo=bTemp & 0x1F;  // bit[4:0]
+    if((bNo+1) > bLen) break; // truncated data block
+
+    if(bType == 0x02)//Video data block
+    {
+      ui4CEA_NTSC=0;
+      ui4CEA_PAL=0;
+
+      for(bIdx = 0; bIdx < bNo; bIdx++)
+      {
+        if(*(prData+1+bIdx) & 0x80)//Native bit
+        {
+          ui4OrgCEA_NTSC=	ui4CEA_NTSC;
+          ui4OrgCEA_PAL=	ui4CEA_PAL;
+        }
+        switch(*(prData+1+bIdx) & 0x7f)
+        {
+          case  6:
+          ui4CEA_NTSC |= SINK_480I;
+          ui4OrgCEA_NTSC |= SINK_480I;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_NTSC |= SINK_480I;
+          break;
+
+          case  7:
+          ui4CEA_NTSC |= SINK_480I;
+          ui4OrgCEA_NTSC |= SINK_480I;//16:9
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_NTSC |= SINK_480I;
+
+          break;
+          case  2:
+          ui4CEA_NTSC |= SINK_480P;
+          ui4OrgCEA_NTSC |= SINK_480P;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_NTSC |= SINK_480P;
+
+          break;
+          case  3:
+          ui4CEA_NTSC |= SINK_480P;
+          ui4OrgCEA_NTSC |= SINK_480P;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_NTSC |= SINK_480P;
+
+          break;
+          case  14:
+          case  15:
+          ui4CEA_NTSC |= SINK_480P_1440;
+          ui4OrgCEA_NTSC |= SINK_480P_1440;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_NTSC |= SINK_480P_1440;
+
+          break;
+          case  4:
+          ui4CEA_NTSC |= SINK_720P60;
+          ui4OrgCEA_NTSC |= SINK_720P60;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_NTSC |= SINK_720P60;
+
+          break;
+          case  5:
+          ui4CEA_NTSC |= SINK_1080I60;
+          ui4OrgCEA_NTSC |= SINK_1080I60;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_NTSC |= SINK_1080I60;
+          break;
+          case  21:
+          ui4CEA_PAL |= SINK_576I;
+          ui4OrgCEA_PAL |= SINK_576I;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_PAL |= SINK_576I;
+          break;
+
+          case  22:
+          ui4CEA_PAL |= SINK_576I;
+          ui4OrgCEA_PAL |= SINK_576I;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_PAL |= SINK_576I;
+
+          break;
+          case  16:
+          ui4CEA_NTSC |= SINK_1080P60;
+          ui4OrgCEA_NTSC |= SINK_1080P60;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_NTSC |= SINK_1080P60;
+          break;
+
+          case  17:
+          ui4CEA_PAL |= SINK_576P;
+          ui4OrgCEA_PAL |= SINK_576P;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_PAL |= SINK_576P;
+          break;
+
+          case  18:
+          ui4CEA_PAL |= SINK_576P;
+          ui4OrgCEA_PAL |= SINK_576P;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_PAL |= SINK_576P;
+
+          break;
+
+          case  29:
+          case  30:
+          ui4CEA_PAL |= SINK_576P_1440;
+          ui4OrgCEA_PAL |= SINK_576P_1440;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_PAL |= SINK_576P_1440;
+          break;
+
+          case  19:
+          ui4CEA_PAL |= SINK_720P50;
+          ui4OrgCEA_PAL |= SINK_720P50;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_PAL |= SINK_720P50;
+
+          break;
+          case  20:
+          ui4CEA_PAL |= SINK_1080I50;
+          ui4OrgCEA_PAL |= SINK_1080I50;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_PAL |= SINK_1080I50;
+
+          break;
+
+          case  31:
+          ui4CEA_PAL |= SINK_1080P50;
+          ui4OrgCEA_PAL |= SINK_1080P50;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_PAL |= SINK_1080P50;
+          break;
+
+          case  32:
+          ui4CEA_NTSC |= SINK_1080P24;
+          ui4CEA_PAL |= SINK_1080P24;
+          ui4CEA_NTSC |= SINK_1080P23976;
+          ui4CEA_PAL |= SINK_1080P23976;
+          ui4OrgCEA_PAL |= SINK_1080P24;
+          ui4OrgCEA_NTSC |= SINK_1080P23976;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_PAL |= SINK_1080P24;
+
+          break;
+
+          case  33:
+          //ui4CEA_NTSC |= SINK_1080P25;
+          ui4CEA_PAL |= SINK_1080P25;
+          ui4OrgCEA_PAL |= SINK_1080P25;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_PAL |= SINK_1080P25;
+
+          break;
+
+          case  34:
+          ui4CEA_NTSC |= SINK_1080P30;
+          ui4CEA_NTSC |= SINK_1080P2997;
+          ui4CEA_PAL |= SINK_1080P30;
+          ui4CEA_PAL |= SINK_1080P2997;
+          ui4OrgCEA_PAL |= SINK_1080P30;
+          ui4OrgCEA_NTSC |= SINK_1080P2997;
+          if(*(prData+1+bIdx) & 0x80)//Native bit
+          ui4NativeCEA_PAL |= SINK_1080P30;
+          break;
+
+          default:
+          break;
+       }
+
+       if(bIdx<0x10)
+       {
+
+         switch(*(prData+1+bIdx) & 0x7f)
+         {
+          case  6:
+          case  7:
+          ui4Temp= SINK_480I;
+          break;
+          case  2:
+          case  3:
+          ui4Temp= SINK_480P;
+          break;
+          case  14:
+          case  15:
+          ui4Temp= SINK_480P_1440;
+          break;
+          case  4:
+          ui4Temp= SINK_720P60;
+          break;
+          case  5:
+          ui4Temp= SINK_1080I60;
+          break;
+          case  21:
+          case  22:
+          ui4Temp= SINK_576I;
+          break;
+          case  16:
+          ui4Temp= SINK_1080P60;
+          break;
+
+          case  17:
+          case  18:
+          ui4Temp= SINK_576P;
+          break;
+          case  29:
+          case  30:
+          ui4Temp= SINK_576P_1440;
+          break;
+          case  19:
+          ui4Temp= SINK_720P50;
+          break;
+          case  20:
+          ui4Temp= SINK_1080I50;
+          break;
+
+          case  31:
+          ui4Temp= SINK_1080P50;
+          break;
+
+          case  32:
+          ui4Temp|= SINK_1080P24;
+          ui4Temp|= SINK_1080P23976;
+          break;
+
+          case  33:
+          //ui4CEA_NTSC |= SINK_1080P25;
+          ui4Temp= SINK_1080P25;
+          break;
+
+          case  34:
+          ui4Temp|= SINK_1080P30;
+          ui4Temp|= SINK_1080P2997;
+
+          break;
+
+          default:
+          break;
+
+
+         }
+
+       	prParse->ui4First_16_VIC[bIdx]=ui4Temp;
+       }
+
+       if(*(prData+1+bIdx) & 0x80)
+       {
+         ui4OrgCEA_NTSC=	ui4CEA_NTSC&(~ui4OrgCEA_NTSC);
+         ui4OrgCEA_PAL=	ui4CEA_PAL&(~ui4OrgCEA_PAL);
+
+         if(ui4OrgCEA_NTSC)
+         {
+            prCap->ui4_sink_native_ntsc_resolution = ui4OrgCEA_NTSC;
+         }
+         else if(ui4OrgCEA_PAL)
+         {
+           prCap->ui4_sink_native_pal_resolution = ui4OrgCEA_PAL;
+         }
+         else
+         {
+           prCap->ui4_sink_native_ntsc_resolution = 0;
+           prCap->ui4_sink_native_pal_resolution = 0;
+         }
+        }
+      }//for(bIdx = 0; bIdx < bNo; bIdx++)
+
+      prCap->ui4_sink_cea_ntsc_resolution |= ui4CEA_NTSC;
+       prCap->ui4_sink_cea_pal_resolution |= ui4CEA_PAL;
+      prCap->ui4_sink_native_ntsc_resolution |= ui4NativeCEA_NTSC;
+      prCap->ui4_sink_native_pal_resolution |= ui4NativeCEA_PAL;
+
+    }
+    else if(bType == 0x01) // Audio data block
+    {
+       prCap->ui2_edid_chksum_and_audio_sup &= ~(SINK_SAD_NO_EXIST);
+      for(bIdx = 0; bIdx < (bNo/3); bIdx++)
+      {
+        bLengthSum=bIdx*3;
+
+        bAudCode = (*(prData+bLengthSum+1)&0x78)>>3;//get audio code
+
+	if (bAudCode == AVD_DOLBY_PLUS) { /* AVD_DOLBY_PLUS */
+		bPcmChNum = (*(prData + bLengthSum + 1) & 0x07) + 1;
+			if (bPcmChNum >= 2) {
+				prCap->ui1_sink_ec3_ch_sampling[bPcmChNum
+				    - 2] = (*(prData + bLengthSum + 2) & 0x7f);
+			}
+	}
+
+	if ((*(prData + bLengthSum + 3) == 0x1) && (bAudCode == AVD_DOLBY_PLUS))
+		bAudCode = AVD_DOLBY_ATMOS;
+
+	if ((bAudCode >= AVD_LPCM)&& bAudCode <= AVD_WMA) {
+		prCap->ui2_sink_aud_dec |= 	(1<<(bAudCode-1));/* PCM:1 HDMI_SINK_AUDIO_DEC_LPCM AC3:2 HDMI_SINK_AUDIO_DEC_AC3 */
+		/* must support dolby plus if support atmos according to spec */
+		if (bAudCode == AVD_DOLBY_ATMOS)
+			prCap->ui2_sink_aud_dec |= (1 << (AVD_DOLBY_PLUS - 1));
+        }
+
+
+        if(bAudCode == AVD_LPCM) // LPCM
+        {
+          bPcmChNum = (*(prData+bLengthSum+1)&0x07)+1;
+          if(bPcmChNum>=2)
+          {
+          prCap->ui1_sink_pcm_ch_sampling[bPcmChNum-2] = (*(prData+bLengthSum+2)&0x7f);
+          prCap->ui1_sink_pcm_bit_size[bPcmChNum-2] = (*(prData+bLengthSum+3)&0x07);
+          }
+
+        }
+
+	if (bAudCode == AVD_AC3) {       /* AVD_AC3 */
+		bPcmChNum = (*(prData + bLengthSum + 1) & 0x07) + 1;
+		if (bPcmChNum >= 2) {
+			prCap->ui1_sink_ac3_ch_sampling[bPcmChNum - 2] =
+			    (*(prData + bLengthSum + 2) & 0x7f);
+		}
+	}
+
+        if(bAudCode == AVD_DST) // DST
+        {
+          bPcmChNum = (*(prData+bLengthSum+1)&0x07)+1;
+          if(bPcmChNum>=2)
+          {
+          prCap->ui1_sink_dst_ch_sampling[bPcmChNum-2] = (*(prData+bLengthSum+2)&0x7f);
+
+          }
+
+        }
+
+        if(bAudCode == AVD_DSD) // DSD
+        {
+          bPcmChNum = (*(prData+bLengthSum+1)&0x07)+1;
+          if(bPcmChNum>=2)
+          {
+          prCap->ui1_sink_dsd_ch_sampling[bPcmChNum-2] = (*(prData+bLengthSum+2)&0x7f);
+
+          }
+
+        }
+      }//for(bIdx = 0; bIdx < bNo/3; bIdx++)
+    }
+    else if((bType == 0x04) && (bNo >= 1)) //speaker allocation tag code, 0x04
+    {
+      prCap->ui1_sink_spk_allocation = *(prData+1)&0x7f;
+    }
+    else if(bType == 0x03) // VDSB exit
+    {
+      for(bIdx = 0; bIdx < EDID_VSDB_SCRATCH_LEN; bIdx++)
+        bVsdb[bIdx] = (bIdx <= bNo) ? *(prData+bIdx) : 0;
+      vParserVSDB(prParse, bVsdb, bNo);
+    }//if(bType == 0x03) // VDSB exit
+    else if((bType == 0x07) && (bNo >= 2))//Use Extended Tag
+    {
+    	if((*(prData+1) == 0x05) && (bNo >= 3))//Extend Tag code ==0x05
+    	{
+    	  if(*(prData+2)& 0x1)
+    	  {
+    	  	//Suppot xvYcc601
+    	  	prCap->ui2_sink_colorimetry |= SINK_XV_YCC601;
+    	  }
+
+    	  if(*(prData+2)& 0x2)
+    	  {
+    	  	//Suppot xvYcc709
+    	  	prCap->ui2_sink_colorimetry |= SINK_XV_YCC709;
+    	  }
+
+    	  if(*(prData+3)& 0x1)
+    	  {
+    	  	//support Gamut data P0
+    	  	prCap->ui2_sink_colorimetry |= SINK_METADATA0;
+    	  }
+
+    	  if(*(prData+3)& 0x2)
+    	  {
+    	  	//support Gamut data P1
+    	  	prCap->ui2_sink_colorimetry |= SINK_METADATA1;
+    	  }
+
+    	  if(*(prData+3)& 0x4)
+    	  {
+    	  	//support Gamut data P1
+    	  	prCap->ui2_sink_colorimetry |= SINK_METADATA2;
+    	  }
+    	}
+    	else if(*(prData+1) == 0x0)//Extend Tag code ==0x0
+    	{
+          if(*(prData+2)& 0x40)
+          {
+            //support selectable, QS=1
+            prCap->ui2_sink_vcdb_data |= SINK_RGB_SELECTABLE;
+          }
+    	}
+    }
+
+    // re-assign the next data block address
+    prData += (bNo+1);  // '1' means the tag byte
+
+    bLen -= (bNo+1);
+
+  }//while(bLen)
+
+
+  prCap->ui1_sink_pcm_ch_sampling[5]|= prCap->ui1_sink_pcm_ch_sampling[6];
+  prCap->ui1_sink_pcm_ch_sampling[4]|= prCap->ui1_sink_pcm_ch_sampling[5];
+  prCap->ui1_sink_pcm_ch_sampling[3]|= prCap->ui1_sink_pcm_ch_sampling[4];
+  prCap->ui1_sink_pcm_ch_sampling[2]|= prCap->ui1_sink_pcm_ch_sampling[3];
+  prCap->ui1_sink_pcm_ch_sampling[1]|= prCap->ui1_sink_pcm_ch_sampling[2];
+  prCap->ui1_sink_pcm_ch_sampling[0]|= prCap->ui1_sink_pcm_ch_sampling[1];
+
+  prCap->ui1_sink_dsd_ch_sampling[5]|= prCap->ui1_sink_dsd_ch_sampling[6];
+  prCap->ui1_sink_dsd_ch_sampling[4]|= prCap->ui1_sink_dsd_ch_sampling[5];
+  prCap->ui1_sink_dsd_ch_sampling[3]|= prCap->ui1_sink_dsd_ch_sampling[4];
+  prCap->ui1_sink_dsd_ch_sampling[2]|= prCap->ui1_sink_dsd_ch_sampling[3];
+  prCap->ui1_sink_dsd_ch_sampling[1]|= prCap->ui1_sink_dsd_ch_sampling[2];
+  prCap->ui1_sink_dsd_ch_sampling[0]|= prCap->ui1_sink_dsd_ch_sampling[1];
+
+  prCap->ui1_sink_ac3_ch_sampling[5] |= prCap->ui1_sink_ac3_ch_sampling[6];
+  prCap->ui1_sink_ac3_ch_sampling[4] |= prCap->ui1_sink_ac3_ch_sampling[5];
+  prCap->ui1_sink_ac3_ch_sampling[3] |= prCap->ui1_sink_ac3_ch_sampling[4];
+  prCap->ui1_sink_ac3_ch_sampling[2] |= prCap->ui1_sink_ac3_ch_sampling[3];
+  prCap->ui1_sink_ac3_ch_sampling[1] |= prCap->ui1_sink_ac3_ch_sampling[2];
+  prCap->ui1_sink_ac3_ch_sampling[0] |= prCap->ui1_sink_ac3_ch_sampling[1];
+
+  prCap->ui1_sink_ec3_ch_sampling[5] |= prCap->ui1_sink_ec3_ch_sampling[6];
+  prCap->ui1_sink_ec3_ch_sampling[4] |= prCap->ui1_sink_ec3_ch_sampling[5];
+  prCap->ui1_sink_ec3_ch_sampling[3] |= prCap->ui1_sink_ec3_ch_sampling[4];
+  prCap->ui1_sink_ec3_ch_sampling[2] |= prCap->ui1_sink_ec3_ch_sampling[3];
+  prCap->ui1_sink_ec3_ch_sampling[1] |= prCap->ui1_sink_ec3_ch_sampling[2];
+  prCap->ui1_sink_ec3_ch_sampling[0] |= prCap->ui1_sink_ec3_ch_sampling[1];
+
+  if(prCap->ui2_edid_chksum_and_audio_sup & SINK_EXT_BLK_CHKSUM_ERR)//2007/2/12 for av output chksum error
+  {
+    prParse->prCaps->fgVsdbExist = FALSE;
+    prCap->b_sink_support_hdmi_mode = FALSE;
+  }
+
+}
+
+
+static unsigned char fgParserExtEDID(HDMI_EDID_PARSE_T *prParse, const unsigned char *prData)
+{
+  HDMI_SINK_AV_CAP_T *prCap = prParse->prCap;
+  unsigned char bIdx;
+  unsigned char bTemp=0;
+  unsigned short ui2HActive, ui2HBlanking, ui2VBlanking;
+  unsigned char bOfst;
+  const unsigned char *prCEAaddr;
+
+ prCap->ui1_ExtEdid_Revision=*(prData+EXTEDID_ADDR_REVISION);
+
+  for(bIdx=0; bIdx<EDID_BLOCK_LEN; bIdx++)
+  {
+     // add the value into checksum
+    bTemp += *(prData+bIdx);//i4SharedInfo(wPos+bIdx);
+   }
+
+
+  bTemp  = 0;
+  // check if EDID checksume pass
+  if(bTemp)
+  {
+      return (FALSE);
+  }
+  else
+  {
+     prCap->ui2_edid_chksum_and_audio_sup &=~ SINK_EXT_BLK_CHKSUM_ERR;
+  }
+
+  // Step 1: get the offset value of 1st detail timing description within extension block
+  bOfst=*(prData+EXTEDID_ADDR_OFST_TIME_DSPR);
+
+  if(*(prData+EDID_ADDR_EXTEND_BYTE3) & 0x40)//Support basic audio
+    prCap->ui2_edid_chksum_and_audio_sup &= ~SINK_BASIC_AUDIO_NO_SUP;
+
+  //Max'0528'04, move to here, after read 0x80 ~ 0xFF because it is 0x83...
+  if(*(prData+EDID_ADDR_EXTEND_BYTE3) & 0x20) //receiver support YCbCr 4:4:4
+  {
+  	prCap->ui2_sink_colorimetry |= SINK_YCBCR_444;
+  }
+
+  if(*(prData+EDID_ADDR_EXTEND_BYTE3) & 0x10)//receiver support YCbCr 4:2:2
+    prCap->ui2_sink_colorimetry |= SINK_YCBCR_422;
+
+  prCap->ui2_sink_colorimetry |= SINK_RGB;
+  // Step 3: read-back the pixel clock of each timing descriptor
+
+  // Step 4: read-back V active line to define EDID resolution
+  for(bIdx=0; bIdx<6; bIdx++)
+  {
+    if(((bOfst+18*bIdx) > 109)||(*(prData+bOfst+18*bIdx)==0))
+  {
+      break;
+  }
+    ui2HActive = (unsigned short) (*(prData+bOfst+18*bIdx+OFST_H_ACT_BLA_HI)&0xf0) << 4;
+    ui2HActive |= *(prData+bOfst+18*bIdx+OFST_H_ACTIVE_LO);
+    ui2HBlanking = (unsigned short) (*(prData+bOfst+18*bIdx+OFST_H_ACT_BLA_HI)&0x0f) << 8;
+    ui2HBlanking |= *(prData+bOfst+18*bIdx+OFST_H_BLANKING_LO);
+    ui2VBlanking = (unsigned short) (*(prData+bOfst+18*bIdx+OFST_V_ACTIVE_HI)&0x0f) << 8;
+    ui2VBlanking |= *(prData+bOfst+18*bIdx+OFST_V_BLANKING_LO);
+    bTemp = (*(prData+bOfst+18*bIdx+OFST_FLAGS)&0x80)>>7;
+    vAnalyzeDTD(prCap, ui2HActive, ui2HBlanking, bTemp, FALSE);
+  }
+
+  // data blocks sit between byte 4 and the first DTD, which must be inside the block
+  if((*(prData+EXTEDID_ADDR_REVISION) >= 0x03) && (bOfst >= 4) && (bOfst < EDID_BLOCK_LEN))//for simplay #7-37, #7-36
+  {
+
+    prCEAaddr = prData+4;
+    vParserCEADataBlock(prParse, prCEAaddr, bOfst-4);
+  }
+
+  // if go here, ie. parsing EDID data ok !!
+  return (TRUE);
+}
+
+unsigned char fgHdmiEdidParse(const unsigned char *prEdid, unsigned int u4Len, HDMI_EDID_CAPS_T *prCaps)
+{
+  HDMI_EDID_PARSE_T rParse;
+  const unsigned char *prData;
+  unsigned char bExtBlockNo;
+  unsigned char bIdx;
+  unsigned char fgBaseOk;
+
+  vEdidCapsInit(prCaps);
+  rParse.prCap = &prCaps->rSinkAvCap;
+  rParse.prCaps = prCaps;
+  rParse.u4_3D_VIC = 0;
+  for(bIdx=0; bIdx<16; bIdx++)
+    rParse.ui4First_16_VIC[bIdx] = 0;
+
+  if(u4Len > EDID_PARSE_MAX_LEN)
+    u4Len = EDID_PARSE_MAX_LEN;
+  if(u4Len < EDID_BLOCK_LEN)
+    return (FALSE);
+
+  fgBaseOk = fgParserEDID(rParse.prCap, prEdid);
+  if(fgBaseOk)
+    rParse.prCap->b_sink_edid_ready = TRUE;
+
+  // parsing EDID extension block if it exist, as far as the buffer goes
+  bExtBlockNo = *(prEdid+EDID_ADDR_EXT_BLOCK_FLAG);
+  for(bIdx=1; bIdx<=bExtBlockNo; bIdx++)
+  {
+    if((bIdx+1)*EDID_BLOCK_LEN > u4Len)
+      break;
+
+    prData = prEdid+bIdx*EDID_BLOCK_LEN;
+    if(*(prData+EXTEDID_ADDR_TAG) == 0x02)
+      fgParserExtEDID(&rParse, prData);
+    prCaps->ui1ExtBlockNo = bIdx;
+  }
+
+  return (fgBaseOk);
+}
@@ -0,0 +1,25 @@
+#ifndef __hdmiedid_parse_h__
+#define __hdmiedid_parse_h__
+
+// EDID parser split out of hdmiedid.c. It only works on the buffer it is given and
+// the struct it fills: no globals, no shared info, no allocation and no kernel calls,
+// so the same file builds in userspace (tools/testing/hdmi_edid).
+
+#include <linux/hdmitx.h>
+
+#define EDID_PARSE_MAX_LEN          512 // 4 blocks, same as EDID_SIZE
+
+typedef struct
+{
+  HDMI_SINK_AV_CAP_T rSinkAvCap;
+  unsigned char fgVsdbExist;    // HDMI VSDB found, for SI_EDID_VSDB_EXIST
+  unsigned char ui1ExtBlockNo;  // extension blocks actually walked
+} HDMI_EDID_CAPS_T;
+
+// Parse u4Len bytes of raw EDID into *prCaps, which is fully rewritten.
+// Returns TRUE when the base block header and checksum are good. The extension
+// blocks are parsed either way, like the driver did after its last retry.
+extern unsigned char fgHdmiEdidParse(const unsigned char *prEdid, unsigned int u4Len,
+                                     HDMI_EDID_CAPS_T *prCaps);
+
+#endif
@@ -21,6 +21,9 @@ typedef struct {
  *  EXPORT FUNCTIONS
  **************************************************************************/    
 void sha1( const unsigned char *input, int ilen, unsigned char output[20] );
+void hash_starts( sha1_ctx *ctx );
+void hash_update( sha1_ctx *ctx, const unsigned char *input, int ilen );
+void hash_finish( sha1_ctx *ctx, unsigned char output[20] );
 
 
 #endif
@@ -9,6 +9,35 @@ typedef struct
 }
 bgn;
 
+/**************************************************************************
+ *  MONTGOMERY CONTEXT
+ **************************************************************************/
+#define BGN_MONT_MAX_BITS       2048
+#define BGN_MONT_MAX_LIMBS      (BGN_MONT_MAX_BITS / (8 * sizeof(unsigned long)))
+#define BGN_MONT_MAX_WS         6
+/* W[1] and the odd window values W[2^(ws-1)] .. W[2^ws - 1] */
+#define BGN_MONT_TBL_SIZE       ((1 << (BGN_MONT_MAX_WS - 1)) + 1)
+
+/*
+ * Fixed size modulus context for bgn_mont_exp_bin(). N, its Montgomery
+ * constant and R^2 mod N are set up once per key by bgn_mont_setup(), the
+ * scratch space below keeps the exponentiation itself allocation free, so
+ * a context must not be used by two exponentiations at the same time.
+ */
+typedef struct
+{
+    int n;                                              /* limbs in N, 0 = not set up */
+    unsigned long mm;                                   /* -N^-1 mod 2^biL */
+    unsigned long N[BGN_MONT_MAX_LIMBS];
+    unsigned long RR[BGN_MONT_MAX_LIMBS + 1];           /* R^2 mod N */
+
+    /* scratch */
+    unsigned long X[BGN_MONT_MAX_LIMBS + 1];
+    unsigned long T[2 * BGN_MONT_MAX_LIMBS + 2];
+    unsigned long W[BGN_MONT_TBL_SIZE][BGN_MONT_MAX_LIMBS + 1];
+}
+bgn_mont;
+
 
 /**************************************************************************
  *  EXPORT FUNCTIONS
@@ -17,6 +46,9 @@ int bgn_read_bin( bgn *X, const unsigned char *buf, int buflen );
 int bgn_write_bin( const bgn *X, unsigned char *buf, int buflen );
 int bgn_read_str( bgn *X, int radix, const char *s, int length );
 int bgn_exp_mod( bgn *X, const bgn *E, const bgn *N, bgn *_RR );
+int bgn_mont_setup( bgn_mont *M, const bgn *N );
+int bgn_mont_exp_bin( bgn_mont *M, const bgn *E, const unsigned char *ibuf, int ilen,
+    unsigned char *obuf, int olen );
 
 
 /**************************************************************************
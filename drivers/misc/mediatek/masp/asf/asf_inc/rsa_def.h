@@ -36,6 +36,9 @@ typedef struct
     bgn RP;
     bgn RQ;          
     /* keys } */    
+
+    /* montgomery context of N, see bgn_mont_setup() */
+    bgn_mont MN;
 }
 rsa_ctx;
 
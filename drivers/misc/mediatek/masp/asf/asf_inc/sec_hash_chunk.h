@@ -0,0 +1,35 @@
+#ifndef SEC_HASH_CHUNK_H
+#define SEC_HASH_CHUNK_H
+
+#include <linux/types.h>
+
+/**************************************************************************
+ *  RETURN VALUE
+ **************************************************************************/
+/* the parallel path can not handle this request, use sec_hash() instead */
+#define SEC_HASH_CHUNK_FALLBACK     1
+
+/**************************************************************************
+ *  TYPEDEF
+ **************************************************************************/
+/* read len bytes at image offset off into buf, return 0 on success */
+typedef int (*sec_hash_chunk_read_fn)(void *priv, u64 off, unsigned char *buf, unsigned int len);
+
+/**************************************************************************
+ *  EXPORT FUNCTIONS
+ **************************************************************************/
+/*
+ * Compute the chunked image hash used by sign format v4:
+ *
+ *   H = hash(chunk[0]), then H = hash(H || hash(chunk[i])) for each i > 0
+ *
+ * Chunks are read in order by the caller while the per chunk hashes are
+ * computed on all online cpus through the crypto shash API. Returns 0 on
+ * success, SEC_HASH_CHUNK_FALLBACK if the sequential path has to be used
+ * and a negative value on read or hash failure.
+ */
+int sec_hash_by_chunk_parallel(sec_hash_chunk_read_fn read, void *priv,
+    u64 off, u64 len, unsigned int chunk_size,
+    unsigned char *hash_buf, unsigned int hash_len);
+
+#endif /* SEC_HASH_CHUNK_H */
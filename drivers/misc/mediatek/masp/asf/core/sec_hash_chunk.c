@@ -0,0 +1,417 @@
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/mutex.h>
+#include <linux/workqueue.h>
+#include <linux/completion.h>
+#include <linux/cpumask.h>
+#include <linux/ktime.h>
+#include <linux/err.h>
+#include <crypto/hash.h>
+#include "sec_hash_chunk.h"
+#include "sec_wrapper.h"
+#include "sec_log.h"
+
+/**************************************************************************
+ *  MODULE NAME
+ **************************************************************************/
+#define MOD                         "HASH_CHUNK"
+
+/**************************************************************************
+ *  INTERNAL DEFINITION
+ **************************************************************************/
+/* sec_hash() is SHA-1, the shash path is only used when it agrees */
+#define HASH_CHUNK_ALG              "sha1"
+#define HASH_CHUNK_DIGEST_LEN       20
+/* read buffers in flight, each one chunk_size bytes */
+#define HASH_CHUNK_MAX_SLOTS        8
+#define HASH_CHUNK_MAX_SIZE         (1024 * 1024)
+
+/* self-test image: a few full chunks and a short tail */
+#define HASH_CHUNK_TEST_CHUNK       (16 * 1024)
+#define HASH_CHUNK_TEST_LEN         (12 * HASH_CHUNK_TEST_CHUNK + 1234)
+
+enum {
+    HASH_CHUNK_UNTESTED,
+    HASH_CHUNK_READY,
+    HASH_CHUNK_DISABLED,
+};
+
+struct hash_chunk_slot {
+    struct work_struct work;
+    struct completion done;
+    struct shash_desc *desc;
+    unsigned char *buf;
+    unsigned int len;
+    int err;
+    unsigned char digest[HASH_CHUNK_DIGEST_LEN];
+};
+
+struct hash_chunk_kat {
+    const char *msg;
+    unsigned char digest[HASH_CHUNK_DIGEST_LEN];
+};
+
+/**************************************************************************
+ *  GLOBAL VARIABLE
+ **************************************************************************/
+static DEFINE_MUTEX(hash_chunk_lock);
+static int hash_chunk_state = HASH_CHUNK_UNTESTED;
+static struct crypto_shash *hash_chunk_tfm;
+
+/* FIPS 180-2 appendix A known answers */
+static const struct hash_chunk_kat hash_chunk_kats[] =
+{
+    {
+        "",
+        { 0xda, 0x39, 0xa3, 0xee, 0x5e, 0x6b, 0x4b, 0x0d, 0x32, 0x55,
+          0xbf, 0xef, 0x95, 0x60, 0x18, 0x90, 0xaf, 0xd8, 0x07, 0x09 }
+    },
+    {
+        "abc",
+        { 0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+          0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d }
+    },
+    {
+        "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+        { 0x84, 0x98, 0x3e, 0x44, 0x1c, 0x3b, 0xd2, 0x6e, 0xba, 0xae,
+          0x4a, 0xa1, 0xf9, 0x51, 0x29, 0xe5, 0xe5, 0x46, 0x70, 0xf1 }
+    },
+};
+
+/**************************************************************************
+ *  INTERNAL FUNCTIONS
+ **************************************************************************/
+static struct shash_desc *hash_chunk_alloc_desc(struct crypto_shash *tfm)
+{
+    struct shash_desc *desc;
+
+    desc = kmalloc(sizeof(*desc) + crypto_shash_descsize(tfm), GFP_KERNEL);
+    if (NULL == desc)
+    {
+        return NULL;
+    }
+
+    desc->tfm = tfm;
+    desc->flags = 0;
+
+    return desc;
+}
+
+static void hash_chunk_work(struct work_struct *work)
+{
+    struct hash_chunk_slot *slot = container_of(work, struct hash_chunk_slot, work);
+
+    slot->err = crypto_shash_digest(slot->desc, slot->buf, slot->len, slot->digest);
+    complete(&slot->done);
+}
+
+/* fold one chunk hash into the running image hash */
+static int hash_chunk_fold(struct shash_desc *desc, unsigned char *chain,
+    const unsigned char *leaf, bool first)
+{
+    unsigned char comb[HASH_CHUNK_DIGEST_LEN * 2];
+
+    if (first)
+    {
+        memcpy(chain, leaf, HASH_CHUNK_DIGEST_LEN);
+        return 0;
+    }
+
+    memcpy(comb, chain, HASH_CHUNK_DIGEST_LEN);
+    memcpy(comb + HASH_CHUNK_DIGEST_LEN, leaf, HASH_CHUNK_DIGEST_LEN);
+
+    return crypto_shash_digest(desc, comb, sizeof(comb), chain);
+}
+
+static void hash_chunk_free_slots(struct hash_chunk_slot *slots, unsigned int nslots)
+{
+    unsigned int i;
+
+    for (i = 0; i < nslots; i++)
+    {
+        kfree(slots[i].desc);
+        kfree(slots[i].buf);
+    }
+    kfree(slots);
+}
+
+/*
+ * Reads happen in the calling thread, in image order, into a ring of
+ * nslots buffers. Every filled buffer is hashed by a work item on the
+ * unbound workqueue while the next one is read, and the chunk hashes are
+ * folded into the image hash in order as the oldest buffer is recycled.
+ */
+static int hash_chunk_run(struct crypto_shash *tfm, sec_hash_chunk_read_fn read,
+    void *priv, u64 off, u64 len, unsigned int chunk_size, unsigned char *hash_buf)
+{
+    struct hash_chunk_slot *slots;
+    struct shash_desc *desc;
+    unsigned int nslots;
+    unsigned int i;
+    unsigned long issued = 0;
+    unsigned long folded = 0;
+    u64 left = len;
+    int ret = 0;
+
+    nslots = min_t(unsigned int, 2 * num_online_cpus(), HASH_CHUNK_MAX_SLOTS);
+
+    desc = hash_chunk_alloc_desc(tfm);
+    slots = kcalloc(nslots, sizeof(*slots), GFP_KERNEL);
+    if (NULL == desc || NULL == slots)
+    {
+        kfree(desc);
+        kfree(slots);
+        return SEC_HASH_CHUNK_FALLBACK;
+    }
+
+    /* take as many read buffers as we can get, two are enough to overlap */
+    for (i = 0; i < nslots; i++)
+    {
+        slots[i].buf = kmalloc(chunk_size, GFP_KERNEL | __GFP_NOWARN);
+        slots[i].desc = hash_chunk_alloc_desc(tfm);
+        if (NULL == slots[i].buf || NULL == slots[i].desc)
+        {
+            kfree(slots[i].buf);
+            kfree(slots[i].desc);
+            slots[i].buf = NULL;
+            slots[i].desc = NULL;
+            break;
+        }
+        INIT_WORK(&slots[i].work, hash_chunk_work);
+    }
+    nslots = i;
+
+    if (nslots < 2)
+    {
+        ret = SEC_HASH_CHUNK_FALLBACK;
+        goto _out;
+    }
+
+    while (left || folded < issued)
+    {
+        struct hash_chunk_slot *slot;
+
+        if (left && issued - folded < nslots)
+        {
+            unsigned int n = (left >= chunk_size) ? chunk_size : (unsigned int)left;
+
+            slot = &slots[issued % nslots];
+            if (0 != read(priv, off, slot->buf, n))
+            {
+                SMSG(true,"[%s] read image content fail, read offset = '0x%llx'\n",MOD,off);
+                ret = -1;
+                /* stop issuing, but wait for the chunks in flight */
+                left = 0;
+                continue;
+            }
+
+            slot->len = n;
+            init_completion(&slot->done);
+            queue_work(system_unbound_wq, &slot->work);
+
+            issued++;
+            off += n;
+            left -= n;
+            continue;
+        }
+
+        slot = &slots[folded % nslots];
+        wait_for_completion(&slot->done);
+
+        if (0 == ret && 0 != slot->err)
+        {
+            SMSG(true,"[%s] hash fail, chunk %lu\n",MOD,folded);
+            ret = -2;
+        }
+        if (0 == ret && 0 != hash_chunk_fold(desc, hash_buf, slot->digest, 0 == folded))
+        {
+            SMSG(true,"[%s] hash fail, chunk %lu (compose)\n",MOD,folded);
+            ret = -3;
+        }
+        folded++;
+    }
+
+    for (i = 0; i < nslots; i++)
+    {
+        flush_work(&slots[i].work);
+    }
+
+_out:
+    hash_chunk_free_slots(slots, nslots);
+    kfree(desc);
+
+    return ret;
+}
+
+/* the original sequential algorithm on top of sec_hash() */
+static int hash_chunk_ref(const unsigned char *img, unsigned int len,
+    unsigned int chunk_size, unsigned char *hash_buf)
+{
+    unsigned char comb[HASH_CHUNK_DIGEST_LEN * 2];
+    unsigned int pos = 0;
+
+    while (pos < len)
+    {
+        unsigned int n = min(len - pos, chunk_size);
+
+        if (0 != sec_hash((unsigned char *)img + pos, n, comb + HASH_CHUNK_DIGEST_LEN, HASH_CHUNK_DIGEST_LEN))
+        {
+            return -1;
+        }
+
+        if (0 == pos)
+        {
+            memcpy(hash_buf, comb + HASH_CHUNK_DIGEST_LEN, HASH_CHUNK_DIGEST_LEN);
+        }
+        else
+        {
+            memcpy(comb, hash_buf, HASH_CHUNK_DIGEST_LEN);
+            if (0 != sec_hash(comb, sizeof(comb), hash_buf, HASH_CHUNK_DIGEST_LEN))
+            {
+                return -1;
+            }
+        }
+        pos += n;
+    }
+
+    return 0;
+}
+
+static int hash_chunk_mem_read(void *priv, u64 off, unsigned char *buf, unsigned int len)
+{
+    memcpy(buf, (unsigned char *)priv + off, len);
+    return 0;
+}
+
+/*
+ * Check both sec_hash() and the shash transform against the known answers,
+ * then make sure the pipeline produces the same image hash as the
+ * sequential code and log how long each one took.
+ */
+static int hash_chunk_selftest(struct crypto_shash *tfm)
+{
+    unsigned char ref[HASH_CHUNK_DIGEST_LEN];
+    unsigned char par[HASH_CHUNK_DIGEST_LEN];
+    struct shash_desc *desc;
+    unsigned char *img;
+    ktime_t t0, t1, t2;
+    unsigned int i;
+    int ret = -1;
+
+    desc = hash_chunk_alloc_desc(tfm);
+    img = vmalloc(HASH_CHUNK_TEST_LEN);
+    if (NULL == desc || NULL == img)
+    {
+        goto _out;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(hash_chunk_kats); i++)
+    {
+        const struct hash_chunk_kat *kat = &hash_chunk_kats[i];
+        unsigned int n = strlen(kat->msg);
+
+        if (0 != sec_hash((unsigned char *)kat->msg, n, ref, HASH_CHUNK_DIGEST_LEN) ||
+            0 != memcmp(ref, kat->digest, HASH_CHUNK_DIGEST_LEN))
+        {
+            SMSG(true,"[%s] sec_hash known answer %d mismatch\n",MOD,i);
+            goto _out;
+        }
+
+        if (0 != crypto_shash_digest(desc, kat->msg, n, par) ||
+            0 != memcmp(par, kat->digest, HASH_CHUNK_DIGEST_LEN))
+        {
+            SMSG(true,"[%s] %s known answer %d mismatch\n",MOD,crypto_shash_driver_name(tfm),i);
+            goto _out;
+        }
+    }
+
+    for (i = 0; i < HASH_CHUNK_TEST_LEN; i++)
+    {
+        img[i] = (unsigned char)(i * 131 + (i >> 8));
+    }
+
+    t0 = ktime_get();
+    if (0 != hash_chunk_ref(img, HASH_CHUNK_TEST_LEN, HASH_CHUNK_TEST_CHUNK, ref))
+    {
+        goto _out;
+    }
+    t1 = ktime_get();
+    if (0 != hash_chunk_run(tfm, hash_chunk_mem_read, img, 0, HASH_CHUNK_TEST_LEN, HASH_CHUNK_TEST_CHUNK, par))
+    {
+        goto _out;
+    }
+    t2 = ktime_get();
+
+    if (0 != memcmp(ref, par, HASH_CHUNK_DIGEST_LEN))
+    {
+        SMSG(true,"[%s] chunked hash mismatch\n",MOD);
+        goto _out;
+    }
+
+    SMSG(true,"[%s] %s self-test pass, %d bytes: sequential %lld us, parallel %lld us (%d cpus)\n",MOD,
+        crypto_shash_driver_name(tfm), HASH_CHUNK_TEST_LEN,
+        ktime_to_us(ktime_sub(t1, t0)), ktime_to_us(ktime_sub(t2, t1)), num_online_cpus());
+    ret = 0;
+
+_out:
+    vfree(img);
+    kfree(desc);
+
+    return ret;
+}
+
+static struct crypto_shash *hash_chunk_get_tfm(void)
+{
+    struct crypto_shash *tfm;
+
+    mutex_lock(&hash_chunk_lock);
+    if (HASH_CHUNK_UNTESTED == hash_chunk_state)
+    {
+        hash_chunk_state = HASH_CHUNK_DISABLED;
+
+        tfm = crypto_alloc_shash(HASH_CHUNK_ALG, 0, 0);
+        if (IS_ERR(tfm))
+        {
+            SMSG(true,"[%s] no %s transform (%ld), using sequential hash\n",MOD,HASH_CHUNK_ALG,PTR_ERR(tfm));
+        }
+        else if (0 != hash_chunk_selftest(tfm))
+        {
+            SMSG(true,"[%s] self-test fail, using sequential hash\n",MOD);
+            crypto_free_shash(tfm);
+        }
+        else
+        {
+            hash_chunk_tfm = tfm;
+            hash_chunk_state = HASH_CHUNK_READY;
+        }
+    }
+    mutex_unlock(&hash_chunk_lock);
+
+    return (HASH_CHUNK_READY == hash_chunk_state) ? hash_chunk_tfm : NULL;
+}
+
+/**************************************************************************
+ *  EXPORT FUNCTIONS
+ **************************************************************************/
+int sec_hash_by_chunk_parallel(sec_hash_chunk_read_fn read, void *priv,
+    u64 off, u64 len, unsigned int chunk_size,
+    unsigned char *hash_buf, unsigned int hash_len)
+{
+    struct crypto_shash *tfm;
+
+    /* a single chunk has nothing to overlap */
+    if (HASH_CHUNK_DIGEST_LEN != hash_len || 0 == chunk_size ||
+        chunk_size > HASH_CHUNK_MAX_SIZE || len <= chunk_size)
+    {
+        return SEC_HASH_CHUNK_FALLBACK;
+    }
+
+    tfm = hash_chunk_get_tfm();
+    if (NULL == tfm)
+    {
+        return SEC_HASH_CHUNK_FALLBACK;
+    }
+
+    return hash_chunk_run(tfm, read, priv, off, len, chunk_size, hash_buf);
+}
@@ -6,6 +6,7 @@
 #include "sec_boot_lib.h"
 #include "sec_wrapper.h"
 #include "sec_mtd_util.h"
+#include "sec_hash_chunk.h"
 #include <mach/sec_osal.h>  
 
 /**************************************************************************
@@ -86,6 +87,19 @@ static int sec_signfmt_image_read_64(ASF_FILE fp, char* part_name, u64 seek_offs
 }
 
 
+struct sec_signfmt_img_src
+{
+    ASF_FILE fd;
+    char *part_name;
+};
+
+static int sec_signfmt_image_read_src(void *priv, u64 off, unsigned char *buf, unsigned int len)
+{
+    struct sec_signfmt_img_src *src = priv;
+
+    return (sec_signfmt_image_read_64(src->fd, src->part_name, off, (char*)buf, len) == len) ? 0 : -1;
+}
+
 static int sec_signfmt_gen_hash_by_chunk_64(ASF_FILE img_fd, char* part_name, u64 img_hash_off, u64 img_hash_len,
     uchar *final_hash_buf, SEC_CRYPTO_HASH_TYPE hash_type, uint32 chunk_size)
 {
@@ -101,6 +115,7 @@ static int sec_signfmt_gen_hash_by_chunk_64(ASF_FILE img_fd, char* part_name, u6
 #endif
     uint32 read_size = 0;
     u64 left_size = 0;
+    struct sec_signfmt_img_src src;
 
     if(!img_hash_len)
     {
@@ -111,6 +126,17 @@ static int sec_signfmt_gen_hash_by_chunk_64(ASF_FILE img_fd, char* part_name, u6
         goto end_error;        
     }
 
+    /* overlap reads with hashing and hash chunks on all cpus if we can */
+    src.fd = img_fd;
+    src.part_name = part_name;
+    ret = sec_hash_by_chunk_parallel(sec_signfmt_image_read_src, &src, img_hash_off, img_hash_len,
+        chunk_size, final_hash_buf, hash_size);
+    if(SEC_HASH_CHUNK_FALLBACK != ret)
+    {
+        return ret;
+    }
+    ret = 0;
+
 #if DUMP_MORE_FOR_DEBUG    
     SMSG(sec_info.bMsg,"[%s] Hash size is %d (0x%x)\n",MOD, hash_size, hash_size);
     SMSG(sec_info.bMsg,"[%s] Offset is %d (0x%llx)\n",MOD, img_hash_off, img_hash_off);
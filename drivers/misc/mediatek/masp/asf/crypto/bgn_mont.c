@@ -0,0 +1,416 @@
+#include "sec_osal_light.h"
+#include <mach/sec_osal.h>
+#include "sec_cust_struct.h"
+#include "bgn_internal.h"
+
+#define MOD "BGN"
+
+/**************************************************************************
+ *  DEBUG DEFINITION
+ **************************************************************************/
+#define SMSG                    printk
+
+/**************************************************************************
+ *  TYPEDEF
+ **************************************************************************/
+typedef unsigned char uchar;
+
+/**************************************************************************
+ *  GLOBAL VARIABLES
+ **************************************************************************/
+/* set when the cross check against bgn_exp_mod() ever failed */
+static int bgn_mont_disabled = 0;
+
+/**************************************************************************
+ *  INTERNAL FUNCTIONS
+ **************************************************************************/
+
+/* compare A (n + 1 limbs) with N (n limbs) */
+static int bgn_mont_cmp( const ulong *A, const ulong *N, int n )
+{
+    int i;
+
+    if( A[n] != 0 )
+    {
+        return 1;
+    }
+
+    for( i = n - 1; i >= 0; i-- )
+    {
+        if( A[i] > N[i] )
+        {
+            return 1;
+        }
+
+        if( A[i] < N[i] )
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* ------------------------------------------------------ */
+/* A = A * B * R^-1 mod N, same steps as montg_mul() but  */
+/* on the fixed size buffers of the context, B has m limbs */
+/* ------------------------------------------------------ */
+static void bgn_mont_mul_n( bgn_mont *M, ulong *A, const ulong *B, int m )
+{
+    int i, n = M->n;
+    ulong u0, u1, *d;
+
+    memset( M->T, 0, (2 * n + 2) * ciL );
+
+    d = M->T;
+
+    for( i = 0; i < n; i++ )
+    {
+        u0 = A[i];
+        u1 = ( d[0] + u0 * B[0] ) * M->mm;
+
+        bgn_mul_hlp( m, (ulong *) B, d, u0 );
+        bgn_mul_hlp( n, M->N, d, u1 );
+
+        *d++ = u0; d[n + 1] = 0;
+    }
+
+    memcpy( A, d, (n + 1) * ciL );
+
+    if( bgn_mont_cmp( A, M->N, n ) >= 0 )
+    {
+        bgn_sub_hlp( n, M->N, A );
+    }
+    else
+    {
+        bgn_sub_hlp( n, A, M->T );
+    }
+}
+
+static void bgn_mont_mul( bgn_mont *M, ulong *A, const ulong *B )
+{
+    bgn_mont_mul_n( M, A, B, M->n );
+}
+
+/* A = A * R^-1 mod N */
+static void bgn_mont_red( bgn_mont *M, ulong *A )
+{
+    ulong z = 1;
+
+    bgn_mont_mul_n( M, A, &z, 1 );
+}
+
+static ulong *bgn_mont_tbl( bgn_mont *M, int ws, int j )
+{
+    if( j == 1 )
+    {
+        return M->W[0];
+    }
+
+    return M->W[1 + j - (1 << (ws - 1))];
+}
+
+static int bgn_mont_check( bgn_mont *M, const bgn *P_N )
+{
+    int ret = 0, len = bgn_size( P_N );
+    uchar in[BGN_MONT_MAX_LIMBS * sizeof(ulong)];
+    uchar ref[BGN_MONT_MAX_LIMBS * sizeof(ulong)];
+    uchar out[BGN_MONT_MAX_LIMBS * sizeof(ulong)];
+    bgn X, E;
+
+    bgn_init( &X );
+    bgn_init( &E );
+
+    /* ------------------------------------------------- */
+    /* an input one byte shorter than N and a 17 bit      */
+    /* exponent exercise both the table and the loop tail */
+    /* ------------------------------------------------- */
+    memset( in, 0x5A, len );
+    in[0] = 0;
+
+    if(0 != (ret = bgn_read_bin( &X, in, len )))
+    {
+        goto _exit;
+    }
+
+    if(0 != (ret = bgn_lset( &E, 0x10001 )))
+    {
+        goto _exit;
+    }
+
+    if(0 != (ret = bgn_exp_mod( &X, &E, P_N, NULL )))
+    {
+        goto _exit;
+    }
+
+    if(0 != (ret = bgn_write_bin( &X, ref, len )))
+    {
+        goto _exit;
+    }
+
+    if(0 != (ret = bgn_mont_exp_bin( M, &E, in, len, out, len )))
+    {
+        goto _exit;
+    }
+
+    if( 0 != memcmp( ref, out, len ) )
+    {
+        SMSG("[%s] montgomery path mismatch, disabled\n", MOD);
+        bgn_mont_disabled = 1;
+        ret = E_BGN_NOT_ACCEPTABLE;
+    }
+
+_exit:
+
+    bgn_free( &X );
+    bgn_free( &E );
+
+    return ret;
+}
+
+/**************************************************************************
+ *  EXPORT FUNCTIONS
+ **************************************************************************/
+
+/* ----------------------------------------------------------- */
+/* cache N, -N^-1 mod 2^biL and R^2 mod N for the given modulus */
+/* the work is only done when N differs from the cached one     */
+/* ----------------------------------------------------------- */
+int bgn_mont_setup( bgn_mont *M, const bgn *P_N )
+{
+    int ret = 0, n, i;
+    bgn RR;
+
+    if( bgn_mont_disabled )
+    {
+        return( E_BGN_NOT_ACCEPTABLE );
+    }
+
+    /* even or non positive moduli are left to bgn_exp_mod() */
+    if( bgn_cmp_int( P_N, 0 ) <= 0 || ( P_N->p[0] & 1 ) == 0 )
+    {
+        return( E_BGN_NOT_ACCEPTABLE );
+    }
+
+    n = C_T_L( bgn_size( P_N ) );
+
+    if( n > BGN_MONT_MAX_LIMBS )
+    {
+        return( E_BGN_NOT_ACCEPTABLE );
+    }
+
+    if( M->n == n && 0 == memcmp( M->N, P_N->p, n * ciL ) )
+    {
+        return 0;
+    }
+
+    M->n = 0;
+
+    bgn_init( &RR );
+
+    if(0 != (ret = bgn_lset( &RR, 1 )))
+    {
+        goto _exit;
+    }
+
+    if(0 != (ret = bgn_shift_l( &RR, n * 2 * biL )))
+    {
+        goto _exit;
+    }
+
+    if(0 != (ret = bgn_mod_bgn( &RR, &RR, P_N )))
+    {
+        goto _exit;
+    }
+
+    memset( M->RR, 0, sizeof( M->RR ) );
+
+    for( i = 0; i < RR.n && i < n; i++ )
+    {
+        M->RR[i] = RR.p[i];
+    }
+
+    memcpy( M->N, P_N->p, n * ciL );
+    montg_init( &M->mm, P_N );
+    M->n = n;
+
+    if(0 != (ret = bgn_mont_check( M, P_N )))
+    {
+        M->n = 0;
+        goto _exit;
+    }
+
+_exit:
+
+    bgn_free( &RR );
+
+    return ret;
+}
+
+/* ----------------------------------------------------------- */
+/* obuf = ibuf ^ E mod N with sliding windows, no allocation   */
+/* ibuf and obuf are big endian, obuf is zero padded to olen   */
+/* ----------------------------------------------------------- */
+int bgn_mont_exp_bin( bgn_mont *M, const bgn *P_E, const uchar *ibuf, int ilen,
+    uchar *obuf, int olen )
+{
+    ulong ei, state, *X = M->X, *W1 = M->W[0];
+    int i, j, n = M->n, ws, wbits;
+    int bs, nbl, nbi;
+
+    if( n == 0 )
+    {
+        return( E_BGN_NOT_ACCEPTABLE );
+    }
+
+    /* ------------------------- */
+    /* big endian input to limbs */
+    /* ------------------------- */
+    while( ilen > 0 && *ibuf == 0 )
+    {
+        ibuf++;
+        ilen--;
+    }
+
+    if( ilen > n * ciL )
+    {
+        return( E_BGN_BAD_INPUT_DATA );
+    }
+
+    memset( W1, 0, (n + 1) * ciL );
+
+    for( i = ilen - 1, j = 0; i >= 0; i--, j++ )
+    {
+        W1[j / ciL] |= ((ulong) ibuf[i]) << ((j % ciL) << 3);
+    }
+
+    if( bgn_mont_cmp( W1, M->N, n ) >= 0 )
+    {
+        return( E_BGN_BAD_INPUT_DATA );
+    }
+
+    i = bgn_msb( P_E );
+    ws = ( i > 671 ) ? 6 : ( i > 239 ) ? 5 : ( i >  79 ) ? 4 : ( i >  23 ) ? 3 : 1;
+
+    /* --------------------- */
+    /* W[1] = A * R mod N    */
+    /* X    = R mod N        */
+    /* --------------------- */
+    bgn_mont_mul( M, W1, M->RR );
+
+    memcpy( X, M->RR, (n + 1) * ciL );
+    bgn_mont_red( M, X );
+
+    /* --------------------- */
+    /* ws > 1                */
+    /* --------------------- */
+    if( ws > 1 )
+    {
+        j = 1 << (ws - 1);
+
+        memcpy( bgn_mont_tbl( M, ws, j ), W1, (n + 1) * ciL );
+
+        for( i = 0; i < ws - 1; i++ )
+        {
+            bgn_mont_mul( M, bgn_mont_tbl( M, ws, j ), bgn_mont_tbl( M, ws, j ) );
+        }
+
+        for( i = j + 1; i < (1 << ws); i++ )
+        {
+            memcpy( bgn_mont_tbl( M, ws, i ), bgn_mont_tbl( M, ws, i - 1 ), (n + 1) * ciL );
+            bgn_mont_mul( M, bgn_mont_tbl( M, ws, i ), W1 );
+        }
+    }
+
+    nbl     = P_E->n;
+    bs      = 0;
+    nbi     = 0;
+    wbits   = 0;
+    state   = 0;
+
+    while( 1 )
+    {
+        if( bs == 0 )
+        {
+            if( nbl-- == 0 )
+            {
+                break;
+            }
+
+            bs = sizeof( ulong ) << 3;
+        }
+
+        bs--;
+
+        ei = (P_E->p[nbl] >> bs) & 1;
+
+        if( ei == 0 && state == 0 )
+        {
+            continue;
+        }
+
+        if( ei == 0 && state == 1 )
+        {
+            bgn_mont_mul( M, X, X );
+            continue;
+        }
+
+        state = 2;
+
+        nbi++;
+        wbits |= (ei << (ws - nbi));
+
+        if( nbi == ws )
+        {
+            for( i = 0; i < ws; i++ )
+            {
+                bgn_mont_mul( M, X, X );
+            }
+
+            bgn_mont_mul( M, X, bgn_mont_tbl( M, ws, wbits ) );
+
+            state--;
+            nbi = 0;
+            wbits = 0;
+        }
+    }
+
+    for( i = 0; i < nbi; i++ )
+    {
+        bgn_mont_mul( M, X, X );
+
+        wbits <<= 1;
+
+        if( (wbits & (1 << ws)) != 0 )
+        {
+            bgn_mont_mul( M, X, W1 );
+        }
+    }
+
+    bgn_mont_red( M, X );
+
+    /* ------------------------- */
+    /* limbs to big endian output */
+    /* ------------------------- */
+    for( i = n * ciL; i > 0; i-- )
+    {
+        if( (uchar)( X[(i - 1) / ciL] >> (((i - 1) % ciL) << 3) ) != 0 )
+        {
+            break;
+        }
+    }
+
+    if( olen < i )
+    {
+        return( E_BGN_BUFFER_TOO_SMALL );
+    }
+
+    memset( obuf, 0, olen );
+
+    for( j = 0; j < i; j++ )
+    {
+        obuf[olen - 1 - j] = (uchar)( X[j / ciL] >> ((j % ciL) << 3) );
+    }
+
+    return 0;
+}
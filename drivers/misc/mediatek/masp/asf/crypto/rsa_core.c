@@ -24,6 +24,8 @@ extern uchar                        sha1sum[];
 rsa_ctx                             rsa;
 uchar                               rsa_ci[RSA_KEY_LEN];
 static unsigned char *rsa_buf = NULL;
+/* 0 = not run yet, 1 = passed, -1 = failed, montgomery path disabled */
+static int rsa_selftest_state = 0;
 
 /**************************************************************************
  *  RSA DEBUG FLAG
@@ -55,10 +57,41 @@ void rsa_init( rsa_ctx *ctx, int pad, int h_id, int (*f_rng)(void *), void *p_rn
 int rsa_pub( rsa_ctx *ctx, const uchar *ip, uchar *op );
 int rsa_pri( rsa_ctx *ctx, const uchar *ip, uchar *op );
 void rsa_free( rsa_ctx *ctx );
+int rsa_selftest( void );
 
 /**************************************************************************
  *  FUNCTIONS
  **************************************************************************/
+
+/* ------------------------------------------------------------------ */
+/* op = ip ^ P_E mod N through ctx->MN, R^2 mod N is only computed    */
+/* when the key changes. returns E_BGN_NOT_ACCEPTABLE when the key    */
+/* can not use this path, or rsa_selftest() failed on the first call, */
+/* and the generic bgn_exp_mod() must be used.                        */
+/* ctx->MN holds scratch space, so like rsa_buf this is not reentrant */
+/* ------------------------------------------------------------------ */
+static int rsa_exp_mont( rsa_ctx *ctx, const bgn *P_E, const uchar *ip, int ilen, uchar *op )
+{
+    int ret = 0;
+
+    if( 0 == rsa_selftest_state )
+    {
+        rsa_selftest_state = rsa_selftest() ? -1 : 1;
+    }
+
+    if( rsa_selftest_state < 0 )
+    {
+        return( E_BGN_NOT_ACCEPTABLE );
+    }
+
+    if(0 != (ret = bgn_mont_setup( &ctx->MN, &ctx->N )))
+    {
+        return ret;
+    }
+
+    return bgn_mont_exp_bin( &ctx->MN, P_E, ip, ilen, op, ctx->len );
+}
+
 void rsa_init( rsa_ctx *ctx, int pad, int h_id,  int (*f_rng)(void *), void *p_rng )
 {
     memset( ctx, 0, sizeof( rsa_ctx ) );
@@ -75,6 +108,24 @@ int rsa_pub( rsa_ctx *ctx, const uchar *ip, uchar *op )
     int ret = 0, olen = 0;
     bgn B;
 
+    /* ============================================================ */
+    /* fast path : fixed size montgomery context cached per key     */
+    /* ============================================================ */
+    if(0 == (ret = rsa_exp_mont( ctx, &ctx->E, ip, RSA_KEY_LEN, op )))
+    {
+        return 0;
+    }
+
+    if( E_BGN_BAD_INPUT_DATA == ret )
+    {
+        return E_RSA_BAD_INPUT_DATA;
+    }
+
+    if( E_BGN_NOT_ACCEPTABLE != ret )
+    {
+        return E_RSA_PUBLIC_FAILED;
+    }
+
     bgn_init( &B );
 
     /* if no RSA pad, input data won't be extended to key length */
@@ -100,7 +151,7 @@ int rsa_pub( rsa_ctx *ctx, const uchar *ip, uchar *op )
     /* => Message = Cipher ^ (&ctx->E) mod (&ctx->N)                */
     /*                                                              */
     /* ============================================================ */
-    if(0 != (ret = bgn_exp_mod( &B, &ctx->E, &ctx->N, &ctx->RN )))
+    if(0 != (ret = bgn_exp_mod( &B, &ctx->E, &ctx->N, NULL )))
     {
         goto _exit;
     }
@@ -133,6 +184,21 @@ int rsa_pri( rsa_ctx *ctx, const uchar *ip, uchar *op )
     int ret = 0, olen = 0;
     bgn B, B1, B2;
 
+    if(0 == (ret = rsa_exp_mont( ctx, &ctx->D, ip, ctx->len, op )))
+    {
+        return 0;
+    }
+
+    if( E_BGN_BAD_INPUT_DATA == ret )
+    {
+        return E_RSA_BAD_INPUT_DATA;
+    }
+
+    if( E_BGN_NOT_ACCEPTABLE != ret )
+    {
+        return E_RSA_PRIVATE_FAILED;
+    }
+
     bgn_init( &B );  
     bgn_init( &B1 ); 
     bgn_init( &B2 );  
@@ -157,7 +223,7 @@ int rsa_pri( rsa_ctx *ctx, const uchar *ip, uchar *op )
     /* => M' = M ^ (&ctx->D) mod (&ctx->N)                          */
     /*                                                              */
     /* ============================================================ */
-    if(0 != (ret = bgn_exp_mod( &B, &ctx->D, &ctx->N, &ctx->RN )))
+    if(0 != (ret = bgn_exp_mod( &B, &ctx->D, &ctx->N, NULL )))
     {
         goto _exit;
     }
@@ -0,0 +1,439 @@
+#include "sec_osal_light.h"
+#include <mach/sec_osal.h>
+#include "sec_cust_struct.h"
+#include "rsa_def.h"
+#include "bgn_internal.h"
+#include "alg_sha1.h"
+
+#define MOD "RSA"
+
+/**************************************************************************
+ *  DEBUG DEFINITION
+ **************************************************************************/
+#define SMSG                    printk
+
+/**************************************************************************
+ *  TYPEDEF
+ **************************************************************************/
+typedef unsigned char uchar;
+
+/* y = x ^ e mod n, all big endian hex, x and y are 'len' bytes wide */
+typedef struct
+{
+    const char *name;
+    int len;
+    const char *n;
+    const char *e;
+    const char *x;
+    const char *y;
+}
+bgn_kat;
+
+/* sha1 of the first 'len' bytes of 00 01 02 .. ff 00 01 .. */
+typedef struct
+{
+    int len;
+    uchar md[SHA1_LEN];
+}
+sha1_kat;
+
+/**************************************************************************
+ *  KNOWN ANSWERS
+ **************************************************************************/
+/* ------------------------------------------------------------- */
+/* moduli that do not fill their top limb or their buffer, and    */
+/* the inputs that fall out of the window loop in odd ways        */
+/* ------------------------------------------------------------- */
+static const bgn_kat bgn_kats[] =
+{
+    {
+        "64 bit modulus, e = 3", 8,
+        "c4b06badfa7576c5",
+        "03",
+        "8338ed48b9c4f771",
+        "03c0f34e2e97bbc5",
+    },
+    {
+        "17 bit modulus, one limb", 4,
+        "01f7bd",
+        "010001",
+        "01b5d3",
+        "2fbe",
+    },
+    {
+        "521 bit modulus, partial top limb", 66,
+        "0142708783d55899f364f71af8d72ee2d18cd49f93bd69b906e3cc798bc1fea9"
+        "e9fffb7e85ec28bde8ff23e8c5ffeb53825f08b7c28568279da55efb4f12f114"
+        "c653",
+        "010001",
+        "ffc73434d07d124938463ca801a0053f793b0a57de7b5b02ae2b9862d728b471"
+        "1e11c2214e3cbc19ac02d7a7da701cd368631e7da68b4c750b08c0f3a4004a1e"
+        "de",
+        "4b409713b6209b2d4f37c2a78b5e80a928bce448164c327b4e2e66ea75765bc7"
+        "d754b1db2bde1ee471bf33b7b69e1e4de8d1262030aa7731605f495eb6a1d81d"
+        "27",
+    },
+    {
+        "1016 bit modulus in a 128 byte buffer", 128,
+        "ec60a1b288e39fc99439722f3c8d3c527891ac17bbef0c47aeea6c2dfd948db4"
+        "1c6ef487b4e748ab7a0f1c853b8d7e65a25d08246cdcf521b0c1ce8b3036385d"
+        "b13f1de1aa46f2e4778083abd23827651fc92e936bf8f41750424cf29ae75860"
+        "d26ec9e52c69bf9e685f66e603f569089eb497db810d0c1f7125f36a7f0749",
+        "010001",
+        "37d39972acd0a175376520e8794d165145682e15db35c318bd571f90b4dbb928"
+        "ba7c2beaede2223df60574e95b1c7b5c95cb8795220eb8820395a7a59d303450"
+        "16620118db4b33ad5ef50748d9bb994de2636d39bb36b7345fc6a81494719004"
+        "5b26cff833e2",
+        "598ec8215d99ce4878660fe812bce629e52a2354428e6caa3bb3985509d66b60"
+        "a229e4f0d9811fbc9e6990da071705044810534928ba622b2d59ab02df8bbd74"
+        "aed6f60a752e1b668efb81e1ffecb01a469095046fdfb3d8804cbb2f96004ce6"
+        "3a2d5d484d559c5d76e8dda0a48cb3f00efa85bc23e168308da2636e9079a7",
+    },
+    {
+        "1024 bit modulus, 1024 bit exponent", 128,
+        "ac499e56d9636405d35dd378afd9c85286d097023d2fcf57e7201b85cffdae5e"
+        "274ed209f3b304f198efeed673f9318e903f76f1d1e762863b2c6a20da6435bb"
+        "d4ff2714f5b1935b80d6107526542209369e6266c7cee675b64906cebe8befc5"
+        "2b4993cd8c423d0b1291cb186de31dce91d7ec6f8e0ab1993339caf94e9d763f",
+        "e02894d99c143ea7bc3f825fbd33da551b27a96e27eabeffec4e182a8446c93b"
+        "20fb7a390b174c0067e39aeb11f1d7a3430af7aa5f1f5b73010877b4e6ffdf5a"
+        "9f40bf25b9613b150acef59f2570fdaed1f58f70a9fccdf5abba408e13788e90"
+        "338a8285abd329a2eb1e39738770f15763f4476ee64e85cbec185371c0bdb8c2",
+        "23b1d7c2d4711f675b859a1bb1d1dd903aef21401a2076f2755fb38e57c180b0"
+        "a631e2081de1b9a13581e3b53e7c47838257b019503789b4040e1670d125a41b"
+        "2be378fb84b3a1b9d7616cfe436aaf2cd92c0667c6b3c15449d7b9c90e9f41be"
+        "eafda6d09be980b7ecf80566e65ef3744260d0beba37f58cb58d1f7f114f373f",
+        "74dde3f7f6d05694a824060e200449b6290db59aaafd0b2bdf6c7065ea3ba6dc"
+        "76930e33a2cccd82b9dfa7c93b2995facb41858914798be38c984617847414c4"
+        "a3dd9659e0745adda2af1f9c086ccff2361f7daa353f653b0be1d83d4201dc98"
+        "47ac7f4c39694d93fabfa12f5a2147e5e95b4b9abb9d843e80c8bd85719c55ef",
+    },
+    {
+        "1024 bit modulus, sparse exponent", 128,
+        "d62d53c243fe22d73007da54942c3870c21c79ca96f9b2da59564b4206585108"
+        "8ff73f6e200ad8417498facbf73d5abb14b1cfd3e91557896db83b4dffc7fd97"
+        "450e86e185360e074a90b719aeb07db6b6a9f52b87b2e525c13db3cf43d91532"
+        "30c7cc28c722f3d2816cb8eacac9ead3224bff798711b1b713b0064b0e3f3125",
+        "0100000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000"
+        "01",
+        "b008dfa714f101f2b6478e86c3f88ffe709651cfa588678577fdd35e67e85878"
+        "88d416dc6963a277db708caa13d24f9c36e1d1f8545f54576ca1a442f2fd956e"
+        "28dbcd8f276c3ac2b4ad09a26c2ec81e78ecef9bb839307ba9d2db7f1f718841"
+        "2a3c63920373b57a35f8a012cbdd5091c1a0752ac941e467f8d375943e4decc7",
+        "7aacaddea20554651624bbb39a1b3d22694b0e83164954546cef4f0b9909587d"
+        "0a446b195e2ae03ea314d27cb91dd1ff4fd087648e67c4dfd6e41941869987b7"
+        "542115609e817fb63b93393034a87bb187f175d8c9cf45a56032501448e22a73"
+        "877b733bf5cb69ee6ddb3adc0a6aa724c764722c86e1e145407cf38f1121b740",
+    },
+    {
+        "x = 0", 128,
+        "d62d53c243fe22d73007da54942c3870c21c79ca96f9b2da59564b4206585108"
+        "8ff73f6e200ad8417498facbf73d5abb14b1cfd3e91557896db83b4dffc7fd97"
+        "450e86e185360e074a90b719aeb07db6b6a9f52b87b2e525c13db3cf43d91532"
+        "30c7cc28c722f3d2816cb8eacac9ead3224bff798711b1b713b0064b0e3f3125",
+        "010001",
+        "00",
+        "00",
+    },
+    {
+        "x = 1", 128,
+        "d62d53c243fe22d73007da54942c3870c21c79ca96f9b2da59564b4206585108"
+        "8ff73f6e200ad8417498facbf73d5abb14b1cfd3e91557896db83b4dffc7fd97"
+        "450e86e185360e074a90b719aeb07db6b6a9f52b87b2e525c13db3cf43d91532"
+        "30c7cc28c722f3d2816cb8eacac9ead3224bff798711b1b713b0064b0e3f3125",
+        "010001",
+        "01",
+        "01",
+    },
+    {
+        "2048 bit modulus, e = 65537", 256,
+        "a9ebc0edcd0da086d6e1d6d4630c1f8232a53d845664e5e62c379c6570f382e8"
+        "e2f59bd97c3043a5f661b9cdf0368d5fd97500782dc218b872b434e5b68ba7e9"
+        "00a9f9d6caef9ec0bb4363ef46454d0fbd93f9c8c22a9b21e4bd2ae9803b2381"
+        "8926d080a2ed667b2814d177465515b86c8adbe0a587b774d653a3cdc9311072"
+        "628a32feebda546e541a3dca8a21e145ee672155c5512b011e17955888f87e64"
+        "db5bab7f81074200b28a76ad4e61e9b99158dac94d1ccca2147f1554fba7f00e"
+        "6aaf1f2e1c38f8c96d07461ca6a5ec9c38617b0ccde34f85631d754ee6783d73"
+        "b091740ee3492c90f19bc2407c7fc269ef00f994e6f4aaf8d5b5e1a478bc95ab",
+        "010001",
+        "23eb5a8e0c7f9c279d2737d09131e21b9ca194e21b4ecdb9b71fb6a396201139"
+        "bca4babff9b418211c24158edc97983f30451e7ffc53ea13ae7b420f9161669b"
+        "969c538cf1b88e0634fcccfff6b0cf85de89571d5414e517095fcdb889dd2baf"
+        "35115b196407fdf240a85e3735d31b611f9fbf1516d2c27a77ca92e6029c593e"
+        "6bfa3658ee497c4feb7cc9ab4e28f7101cd33c3ee731f8b0b0bb2fb22832df94"
+        "9fc517f72d92b435710c7f80c924265720a136164cb5010a657f4ece3bbbd584"
+        "92cd9b5306d2ad9d6d7483316b8e860254fbcf7ae38e9475cb73c5f71f5227e2"
+        "181f949278024d2145be899488311b458db4bc8178304bfaa0235802ec1850c1",
+        "7fb13db299a44a4a7af3133073b78b929f5a1781dbe5bc9ed12746b4b361ed37"
+        "089b657078b9fbe0400a45f00940f24a01ae7281b6e931c298b01bac5501f25c"
+        "156a0929786d33de8c85a9cbce7443c8926a465e5d7b04e0e20622944baaf831"
+        "27328fe64f2ccca2b2523d0f855dff52a380947cbc40f0e0dbd730753c751d58"
+        "f0eedb212b5ba899215d19326c046ef6cfb707ec1f9879304b4c2a788b0565fc"
+        "acef8af36487b78d0f6f3b1985ece133be3652eb141c93b13c2b02da939398f0"
+        "81941eb120e1ef8e59a978195d76d819d1bb6240074957cdfe87c60e6fbe39c3"
+        "32b0701ee9857942f8df4609ff2b81353855194004f81446243ce243f2c04e57",
+    },
+    {
+        "2048 bit modulus, x = N - 1, e = 3", 256,
+        "a9ebc0edcd0da086d6e1d6d4630c1f8232a53d845664e5e62c379c6570f382e8"
+        "e2f59bd97c3043a5f661b9cdf0368d5fd97500782dc218b872b434e5b68ba7e9"
+        "00a9f9d6caef9ec0bb4363ef46454d0fbd93f9c8c22a9b21e4bd2ae9803b2381"
+        "8926d080a2ed667b2814d177465515b86c8adbe0a587b774d653a3cdc9311072"
+        "628a32feebda546e541a3dca8a21e145ee672155c5512b011e17955888f87e64"
+        "db5bab7f81074200b28a76ad4e61e9b99158dac94d1ccca2147f1554fba7f00e"
+        "6aaf1f2e1c38f8c96d07461ca6a5ec9c38617b0ccde34f85631d754ee6783d73"
+        "b091740ee3492c90f19bc2407c7fc269ef00f994e6f4aaf8d5b5e1a478bc95ab",
+        "03",
+        "a9ebc0edcd0da086d6e1d6d4630c1f8232a53d845664e5e62c379c6570f382e8"
+        "e2f59bd97c3043a5f661b9cdf0368d5fd97500782dc218b872b434e5b68ba7e9"
+        "00a9f9d6caef9ec0bb4363ef46454d0fbd93f9c8c22a9b21e4bd2ae9803b2381"
+        "8926d080a2ed667b2814d177465515b86c8adbe0a587b774d653a3cdc9311072"
+        "628a32feebda546e541a3dca8a21e145ee672155c5512b011e17955888f87e64"
+        "db5bab7f81074200b28a76ad4e61e9b99158dac94d1ccca2147f1554fba7f00e"
+        "6aaf1f2e1c38f8c96d07461ca6a5ec9c38617b0ccde34f85631d754ee6783d73"
+        "b091740ee3492c90f19bc2407c7fc269ef00f994e6f4aaf8d5b5e1a478bc95aa",
+        "a9ebc0edcd0da086d6e1d6d4630c1f8232a53d845664e5e62c379c6570f382e8"
+        "e2f59bd97c3043a5f661b9cdf0368d5fd97500782dc218b872b434e5b68ba7e9"
+        "00a9f9d6caef9ec0bb4363ef46454d0fbd93f9c8c22a9b21e4bd2ae9803b2381"
+        "8926d080a2ed667b2814d177465515b86c8adbe0a587b774d653a3cdc9311072"
+        "628a32feebda546e541a3dca8a21e145ee672155c5512b011e17955888f87e64"
+        "db5bab7f81074200b28a76ad4e61e9b99158dac94d1ccca2147f1554fba7f00e"
+        "6aaf1f2e1c38f8c96d07461ca6a5ec9c38617b0ccde34f85631d754ee6783d73"
+        "b091740ee3492c90f19bc2407c7fc269ef00f994e6f4aaf8d5b5e1a478bc95aa",
+    },
+};
+
+/* ------------------------------------------------------------- */
+/* message lengths around the 55/56 byte padding split and the    */
+/* 64 byte block size, fed whole and in uneven pieces             */
+/* ------------------------------------------------------------- */
+static const sha1_kat sha1_kats[] =
+{
+    {    0, {0xda, 0x39, 0xa3, 0xee, 0x5e, 0x6b, 0x4b, 0x0d, 0x32, 0x55,
+               0xbf, 0xef, 0x95, 0x60, 0x18, 0x90, 0xaf, 0xd8, 0x07, 0x09 } },
+    {    3, {0x0c, 0x7a, 0x62, 0x3f, 0xd2, 0xbb, 0xc0, 0x5b, 0x06, 0x42,
+               0x3b, 0xe3, 0x59, 0xe4, 0x02, 0x1d, 0x36, 0xe7, 0x21, 0xad } },
+    {   55, {0x8a, 0xe2, 0xd4, 0x67, 0x29, 0xcf, 0xe6, 0x8f, 0xf9, 0x27,
+               0xaf, 0x5e, 0xec, 0x9c, 0x7d, 0x1b, 0x66, 0xd6, 0x5a, 0xc2 } },
+    {   56, {0x63, 0x6e, 0x2e, 0xc6, 0x98, 0xda, 0xc9, 0x03, 0x49, 0x8e,
+               0x64, 0x8b, 0xd2, 0xf3, 0xaf, 0x64, 0x1d, 0x3c, 0x88, 0xcb } },
+    {   63, {0x6d, 0x94, 0x2d, 0xa0, 0xc4, 0x39, 0x2b, 0x12, 0x35, 0x28,
+               0xf2, 0x90, 0x5c, 0x71, 0x3a, 0x3c, 0xe2, 0x83, 0x64, 0xbd } },
+    {   64, {0xc6, 0x13, 0x8d, 0x51, 0x4f, 0xfa, 0x21, 0x35, 0xbf, 0xce,
+               0x0e, 0xd0, 0xb8, 0xfa, 0xc6, 0x56, 0x69, 0x91, 0x7e, 0xc7 } },
+    {   65, {0x69, 0xbd, 0x72, 0x8a, 0xd6, 0xe1, 0x3c, 0xd7, 0x6f, 0xf1,
+               0x97, 0x51, 0xfd, 0xe4, 0x27, 0xb0, 0x0e, 0x39, 0x57, 0x46 } },
+    {  119, {0x41, 0xc8, 0x9d, 0x06, 0x00, 0x1b, 0xab, 0x4a, 0xb7, 0x87,
+               0x36, 0xb4, 0x4e, 0xfe, 0x7c, 0xe1, 0x8c, 0xe6, 0xae, 0x08 } },
+    {  120, {0xd3, 0xdb, 0xd6, 0x53, 0xbd, 0x85, 0x97, 0xb7, 0x47, 0x53,
+               0x21, 0xb6, 0x0a, 0x36, 0x89, 0x12, 0x78, 0xe6, 0xa0, 0x4a } },
+    {  128, {0xe6, 0x43, 0x4b, 0xc4, 0x01, 0xf9, 0x86, 0x03, 0xd7, 0xed,
+               0xa5, 0x04, 0x79, 0x0c, 0x98, 0xc6, 0x73, 0x85, 0xd5, 0x35 } },
+    { 1000, {0xaf, 0x0b, 0x19, 0x1c, 0x2d, 0xe4, 0x6f, 0xe1, 0x3f, 0xe0,
+               0x90, 0x8f, 0x5a, 0x6a, 0x4e, 0x90, 0xe0, 0xca, 0xfc, 0x46 } },
+};
+
+static const int sha1_splits[] = { 1, 7, 55, 63, 64, 65 };
+
+#define KAT_MAX_LEN             (BGN_MONT_MAX_BITS / 8)
+#define SHA1_KAT_MAX_LEN        1000
+
+/**************************************************************************
+ *  INTERNAL FUNCTIONS
+ **************************************************************************/
+static int rsa_selftest_read( bgn *X, const char *s, uchar *buf, int len )
+{
+    int ret = 0;
+
+    if(0 != (ret = bgn_read_str( X, 16, s, strlen( s ) )))
+    {
+        return ret;
+    }
+
+    if( buf != NULL )
+    {
+        ret = bgn_write_bin( X, buf, len );
+    }
+
+    return ret;
+}
+
+/* ------------------------------------------------------------- */
+/* run one vector through bgn_exp_mod() and bgn_mont_exp_bin()    */
+/* ------------------------------------------------------------- */
+static int rsa_selftest_bgn( const bgn_kat *k, bgn_mont *M, uchar *x, uchar *y, uchar *out )
+{
+    int ret = 0;
+    bgn N, E, X;
+
+    bgn_init( &N );
+    bgn_init( &E );
+    bgn_init( &X );
+
+    if(0 != (ret = rsa_selftest_read( &N, k->n, NULL, 0 )) ||
+       0 != (ret = rsa_selftest_read( &E, k->e, NULL, 0 )) ||
+       0 != (ret = rsa_selftest_read( &X, k->x, x, k->len )))
+    {
+        goto _exit;
+    }
+
+    if(0 != (ret = rsa_selftest_read( &X, k->y, y, k->len )))
+    {
+        goto _exit;
+    }
+
+    /* generic path */
+    if(0 != (ret = bgn_read_bin( &X, x, k->len )) ||
+       0 != (ret = bgn_exp_mod( &X, &E, &N, NULL )) ||
+       0 != (ret = bgn_write_bin( &X, out, k->len )))
+    {
+        goto _exit;
+    }
+
+    if( 0 != memcmp( out, y, k->len ) )
+    {
+        SMSG("[%s] self-test '%s': bgn_exp_mod mismatch\n", MOD, k->name);
+        ret = E_BGN_NOT_ACCEPTABLE;
+        goto _exit;
+    }
+
+    /* montgomery path, from the zero padded input buffer */
+    if(0 != (ret = bgn_mont_setup( M, &N )) ||
+       0 != (ret = bgn_mont_exp_bin( M, &E, x, k->len, out, k->len )))
+    {
+        goto _exit;
+    }
+
+    if( 0 != memcmp( out, y, k->len ) )
+    {
+        SMSG("[%s] self-test '%s': montgomery mismatch\n", MOD, k->name);
+        ret = E_BGN_NOT_ACCEPTABLE;
+    }
+
+_exit:
+
+    if( 0 != ret )
+    {
+        SMSG("[%s] self-test '%s' failed (%d)\n", MOD, k->name, ret);
+    }
+
+    bgn_free( &N );
+    bgn_free( &E );
+    bgn_free( &X );
+
+    return ret;
+}
+
+/* ------------------------------------------------------------- */
+/* one shot sha1() and hash_update() in pieces of every split     */
+/* ------------------------------------------------------------- */
+static int rsa_selftest_sha1( const sha1_kat *k, const uchar *msg )
+{
+    uchar md[SHA1_LEN];
+    sha1_ctx ctx;
+    int i, off, step;
+
+    sha1( msg, k->len, md );
+
+    if( 0 != memcmp( md, k->md, SHA1_LEN ) )
+    {
+        SMSG("[%s] self-test sha1 len %d: mismatch\n", MOD, k->len);
+        return -1;
+    }
+
+    for( i = 0; i < sizeof( sha1_splits ) / sizeof( sha1_splits[0] ); i++ )
+    {
+        hash_starts( &ctx );
+
+        for( off = 0; off < k->len; off += step )
+        {
+            step = min( sha1_splits[i], k->len - off );
+            hash_update( &ctx, msg + off, step );
+        }
+
+        hash_finish( &ctx, md );
+
+        if( 0 != memcmp( md, k->md, SHA1_LEN ) )
+        {
+            SMSG("[%s] self-test sha1 len %d in %d byte updates: mismatch\n",
+                MOD, k->len, sha1_splits[i]);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**************************************************************************
+ *  EXPORT FUNCTIONS
+ **************************************************************************/
+
+/* ------------------------------------------------------------- */
+/* known answer tests for the RSA exponentiation paths and sha1   */
+/* returns 0 only when every bignum vector passed on both paths   */
+/* and every sha1 vector passed                                   */
+/* ------------------------------------------------------------- */
+int rsa_selftest( void )
+{
+    int ret = 0, i, fail = 0;
+    uchar *buf;
+    bgn_mont *M;
+
+    buf = (uchar *) osal_kmalloc( 3 * KAT_MAX_LEN + SHA1_KAT_MAX_LEN );
+    M = (bgn_mont *) osal_kmalloc( sizeof( bgn_mont ) );
+
+    if( buf == NULL || M == NULL )
+    {
+        ret = 1;
+        goto _exit;
+    }
+
+    memset( M, 0, sizeof( bgn_mont ) );
+
+    for( i = 0; i < sizeof( bgn_kats ) / sizeof( bgn_kats[0] ); i++ )
+    {
+        if( 0 != rsa_selftest_bgn( &bgn_kats[i], M, buf, buf + KAT_MAX_LEN,
+            buf + 2 * KAT_MAX_LEN ) )
+        {
+            ret = E_BGN_NOT_ACCEPTABLE;
+        }
+    }
+
+    for( i = 0; i < SHA1_KAT_MAX_LEN; i++ )
+    {
+        buf[i] = (uchar) i;
+    }
+
+    for( i = 0; i < sizeof( sha1_kats ) / sizeof( sha1_kats[0] ); i++ )
+    {
+        if( 0 != rsa_selftest_sha1( &sha1_kats[i], buf ) )
+        {
+            fail++;
+        }
+    }
+
+    SMSG("[%s] self-test: bignum %s, sha1 %d of %d failed\n", MOD,
+        ret ? "failed" : "passed", fail,
+        (int)( sizeof( sha1_kats ) / sizeof( sha1_kats[0] ) ));
+
+    /* sha1 is part of every verification, it fails the self-test too */
+    if( 0 != fail && 0 == ret )
+    {
+        ret = E_BGN_NOT_ACCEPTABLE;
+    }
+
+_exit:
+
+    if( buf != NULL )
+    {
+        osal_kfree( buf );
+    }
+
+    if( M != NULL )
+    {
+        osal_kfree( M );
+    }
+
+    return ret;
+}
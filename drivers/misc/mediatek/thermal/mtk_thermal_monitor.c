@@ -23,6 +23,7 @@
 #include <linux/mutex.h>
 #include <linux/bug.h>
 #include <linux/workqueue.h>
+#include <linux/jiffies.h>
 #include <linux/slab.h>
 #include <mach/mtk_thermal_monitor.h>
 #include <mach/mt_storage_logger.h>
@@ -64,6 +65,27 @@
 #define MSMA_MAX_HT     (1000000)
 #define MSMA_MIN_HT     (-275000)
 
+/**
+ *  Adaptive polling: the registered polling_delay is the interval used near a trip point.
+ *  Away from the trips it is stretched by one base interval per MTM_ADAPT_STEP_TEMP, up to
+ *  g_mtm_adapt_max_delay; when heating it is shortened so that a trip is sampled at least
+ *  4 times before it can be crossed, down to MTM_ADAPT_MIN_DELAY.
+ *  Within MTM_ADAPT_HYST_TEMP of any trip the registered interval is always used.
+ */
+#define MTM_ADAPT_HYST_TEMP     (3000)
+#define MTM_ADAPT_STEP_TEMP     (5000)
+#define MTM_ADAPT_MIN_DELAY     (100)
+#define MTM_ADAPT_MIN_SAMPLE    (50)	/* ms, samples closer than this do not update the rate */
+
+/**
+ *  Temperature histogram: bucket 0 is below MTM_HIST_BASE_TEMP, the last one is at or above
+ *  MTM_HIST_BASE_TEMP + (MTM_HIST_BUCKETS - 2) * MTM_HIST_STEP_TEMP.
+ *  Buckets accumulate milliseconds, not samples, since the sampling interval varies.
+ */
+#define MTM_HIST_BUCKETS        (12)
+#define MTM_HIST_BASE_TEMP      (25000)
+#define MTM_HIST_STEP_TEMP      (5000)
+
 struct mtk_thermal_cooler_data {
 	struct thermal_zone_device *tz;
 	struct thermal_cooling_device_ops *ops;
@@ -74,6 +96,7 @@ struct mtk_thermal_cooler_data {
 	int threshold[MTK_THERMAL_MONITOR_COOLER_MAX_EXTRA_CONDITIONS];
 	int exit_threshold;
 	int id;
+	unsigned long last_state;	/* last state passed to the client, lock by MTM_COOLER_LOCK */
 };
 
 struct mtk_thermal_tz_data {
@@ -89,6 +112,22 @@ struct mtk_thermal_tz_data {
 #endif
 	long fake_temp;		/* to store the Tfake, range from -275000 to MAX positive of int...-275000 is a special number to turn off Tfake */
 	struct mutex ma_lock;	/* protect moving avg. vars... */
+
+	/* adaptive polling and histogram, lock by tz->lock (held around .get_temp) */
+	int base_delay;		/* polling delay requested by the client */
+	int adapt_delay;	/* polling delay last set by adaptive polling, 0 if none */
+	long last_temp;
+	unsigned long last_sample;	/* jiffies, 0 before the first sample */
+	long rate_temp;
+	unsigned long rate_sample;
+	long rate;		/* mC per second */
+	u64 hist_ms[MTM_HIST_BUCKETS];
+
+	/* throttle residency, lock by MTM_COOLER_LOCK */
+	int nr_throttling;	/* bound coolers in a non-zero state */
+	unsigned int throttle_count;
+	unsigned long throttle_start;
+	u64 throttle_ms;
 };
 
 struct proc_dir_entry * mtk_thermal_get_proc_drv_therm_dir_entry(void);
@@ -122,6 +161,9 @@ static int nWifi_throughput;
 /* For enabling time based thermal protection under phone call+AP suspend scenario. */
 static int g_mtm_phone_call_ongoing;
 
+static int g_mtm_adapt_enable = 1;
+static int g_mtm_adapt_max_delay = 10000;	/* ms */
+
 static DEFINE_MUTEX(MTM_COOLER_LOCK);
 static DEFINE_MUTEX(MTM_SYSINFO_LOCK);
 static DEFINE_MUTEX(MTM_COOLER_PROC_DIR_LOCK);
@@ -1281,6 +1323,35 @@ static int _mtkthermal_tz_read(struct seq_file *m, void *v)
 				/* print Tfake only when fake_temp > -275000 */
 				seq_printf(m, "Tfake=%d\n", fake_temp);
 			}
+
+			{
+				u64 hist_ms[MTM_HIST_BUCKETS], throttle_ms;
+				unsigned int throttle_count;
+				int polling, base, i;
+				long rate;
+
+				mutex_lock(&tz->lock);
+				polling = tz->polling_delay;
+				base = tzdata->adapt_delay ? tzdata->base_delay : polling;
+				rate = tzdata->rate;
+				memcpy(hist_ms, tzdata->hist_ms, sizeof(hist_ms));
+				mutex_unlock(&tz->lock);
+
+				mutex_lock(&MTM_COOLER_LOCK);
+				throttle_count = tzdata->throttle_count;
+				throttle_ms = tzdata->throttle_ms;
+				if (tzdata->nr_throttling)
+					throttle_ms += jiffies_to_msecs(jiffies - tzdata->throttle_start);
+				mutex_unlock(&MTM_COOLER_LOCK);
+
+				seq_printf(m, "polling=%d base=%d rate=%ld\n", polling, base, rate);
+				seq_printf(m, "throttle_count=%u throttle_ms=%llu\n", throttle_count,
+					   throttle_ms);
+				seq_puts(m, "hist_ms=");
+				for (i = 0; i < MTM_HIST_BUCKETS; i++)
+					seq_printf(m, "%llu ", hist_ms[i]);
+				seq_puts(m, "\n");
+			}
 		}
 	}
 
@@ -1579,6 +1650,58 @@ static const struct file_operations _mtm_scen_call_fops = {
 	.release = single_release,
 };
 
+/* Read */
+static int _mtm_adapt_polling_read(struct seq_file *m, void *v)
+{
+	seq_printf(m, "%d %d\n", g_mtm_adapt_enable, g_mtm_adapt_max_delay);
+
+	return 0;
+}
+
+/* Write: "<enable> [max_delay_ms]" */
+static ssize_t _mtm_adapt_polling_write(struct file *file, const char __user *buffer,
+					size_t count, loff_t *data)
+{
+	int len = 0, enable = 0, max_delay = 0, num;
+	char desc[32];
+
+	len = (count < (sizeof(desc) - 1)) ? count : (sizeof(desc) - 1);
+	if (copy_from_user(desc, buffer, len)) {
+		return 0;
+	}
+	desc[len] = '\0';
+
+	num = sscanf(desc, "%d %d", &enable, &max_delay);
+	if (num < 1 || (enable != 0 && enable != 1))
+		return -EINVAL;
+
+	if (num == 2) {
+		if (max_delay < MTM_ADAPT_MIN_DELAY || max_delay > 60000)
+			return -EINVAL;
+		g_mtm_adapt_max_delay = max_delay;
+	}
+	g_mtm_adapt_enable = enable;
+
+	THRML_LOG("%s enable: %d max_delay: %d\n", __func__, g_mtm_adapt_enable,
+		  g_mtm_adapt_max_delay);
+
+	return count;
+}
+
+static int _mtm_adapt_polling_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, _mtm_adapt_polling_read, NULL);
+}
+
+static const struct file_operations _mtm_adapt_polling_fops = {
+	.owner = THIS_MODULE,
+	.open = _mtm_adapt_polling_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.write = _mtm_adapt_polling_write,
+	.release = single_release,
+};
+
 
 /* Init */
 static int __init mtkthermal_init(void)
@@ -1621,6 +1744,19 @@ static int __init mtkthermal_init(void)
 #endif
     }
 
+	entry =
+	    proc_create("mtm_adapt_polling", S_IRUGO | S_IWUSR | S_IWGRP, dir_entry,
+			&_mtm_adapt_polling_fops);
+	if (!entry) {
+		THRML_ERROR_LOG("%s Can not create mtm_adapt_polling\n", __func__);
+	} else {
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 10, 0)
+		proc_set_user(entry, 0, 1000);
+#else
+		entry->gid = 1000;
+#endif
+	}
+
 	/* create /proc/cooler folder */
 	/* WARNING! This is not gauranteed to be invoked before mtk_ts_cpu's functions... */
 	proc_cooler_dir_entry =
@@ -1810,6 +1946,105 @@ static int mtk_thermal_wrapper_unbind
 	return ret;
 }
 
+static int _mtm_hist_bucket(long temp)
+{
+	long idx;
+
+	if (temp < MTM_HIST_BASE_TEMP)
+		return 0;
+
+	idx = 1 + (temp - MTM_HIST_BASE_TEMP) / MTM_HIST_STEP_TEMP;
+	return (idx < MTM_HIST_BUCKETS) ? (int)idx : (MTM_HIST_BUCKETS - 1);
+}
+
+/*
+ * Called with thermal->lock held for every valid sample. Accounts the time spent since the
+ * previous sample to its temperature bucket, then picks the next polling interval from the
+ * distance to the nearest trip and the rate of change.
+ */
+static void _mtm_adapt_polling(struct thermal_zone_device *thermal,
+			       struct thermal_zone_device_ops *ops, long temp)
+{
+	struct mtk_thermal_tz_data *tzdata = thermal->devdata;
+	unsigned long now = jiffies;
+	unsigned int dt = 0;
+	long dist = LONG_MAX, dist_up = LONG_MAX;
+	int base, delay, i;
+
+	if (tzdata->last_sample)
+		tzdata->hist_ms[_mtm_hist_bucket(tzdata->last_temp)] +=
+		    jiffies_to_msecs(now - tzdata->last_sample);
+	tzdata->last_temp = temp;
+	tzdata->last_sample = now ? now : 1;
+
+	/* sysfs reads in between polls are too close to give a meaningful rate */
+	if (tzdata->rate_sample) {
+		dt = jiffies_to_msecs(now - tzdata->rate_sample);
+		if (dt >= MTM_ADAPT_MIN_SAMPLE) {
+			tzdata->rate = (temp - tzdata->rate_temp) * 1000 / (long)dt;
+			tzdata->rate_temp = temp;
+			tzdata->rate_sample = now ? now : 1;
+		}
+	} else {
+		tzdata->rate_temp = temp;
+		tzdata->rate_sample = now ? now : 1;
+	}
+
+	/* anything other than our own value was set by the client, take it as the new base */
+	if (thermal->polling_delay != tzdata->adapt_delay)
+		tzdata->base_delay = thermal->polling_delay;
+	base = tzdata->base_delay;
+
+	if (!g_mtm_adapt_enable || base <= 0 || !ops->get_trip_temp) {
+		if (tzdata->adapt_delay)
+			thermal->polling_delay = base;
+		tzdata->adapt_delay = 0;
+		return;
+	}
+
+	for (i = 0; i < thermal->trips; i++) {
+		unsigned long trip_temp;
+		long d;
+
+		if (ops->get_trip_temp(thermal, i, &trip_temp))
+			continue;
+
+		d = (long)trip_temp - temp;
+		if (d > 0 && d < dist_up)
+			dist_up = d;
+		if (abs(d) < dist)
+			dist = abs(d);
+	}
+
+	delay = base;
+	if (dist != LONG_MAX && dist > MTM_ADAPT_HYST_TEMP) {
+		long steps = (dist - MTM_ADAPT_HYST_TEMP) / MTM_ADAPT_STEP_TEMP;
+		long max_delay = (g_mtm_adapt_max_delay > base) ? g_mtm_adapt_max_delay : base;
+
+		delay = (steps >= max_delay / base) ? max_delay : base * (1 + steps);
+	}
+
+	if (tzdata->rate > 0 && dist_up < MSMA_MAX_HT) {
+		long ttt = dist_up * 1000 / tzdata->rate / 4;	/* quarter of time to trip, ms */
+		int min_delay = (base / 4 > MTM_ADAPT_MIN_DELAY) ? base / 4 : MTM_ADAPT_MIN_DELAY;
+
+		if (ttt < delay)
+			delay = (ttt > min_delay) ? (int)ttt : min_delay;
+	}
+
+	/* back off gradually, but react to heating at once */
+	if (delay > thermal->polling_delay && thermal->polling_delay > 0
+	    && delay > thermal->polling_delay * 2)
+		delay = thermal->polling_delay * 2;
+
+	if (delay != thermal->polling_delay)
+		THRML_LOG("[.get_temp] tz: %s temp: %ld rate: %ld dist: %ld polling: %d -> %d\n",
+			  thermal->type, temp, tzdata->rate, dist, thermal->polling_delay, delay);
+
+	thermal->polling_delay = delay;
+	tzdata->adapt_delay = delay;
+}
+
 /*
  * .get_temp wrapper: get the current temperature of the thermal zone.
  */
@@ -1871,6 +2106,7 @@ static int mtk_thermal_wrapper_get_temp
 
 	if (0 == ret) {
 		*temperature = _mtkthermal_update_and_get_sma(thermal->devdata, raw_temp);	/* No strong type cast... */
+		_mtm_adapt_polling(thermal, ops, (long)*temperature);
 	} else {
 		THRML_ERROR_LOG("[.get_temp] tz: %s invalid temp\n", thermal->type);
 		*temperature = nTemperature;
@@ -2324,6 +2560,20 @@ static int mtk_cooling_wrapper_get_cur_state
 }
 
 /* set_cur_state */
+/* lock by MTM_COOLER_LOCK */
+static void _mtm_throttle_account(struct mtk_thermal_tz_data *tzdata, bool throttling)
+{
+	if (throttling) {
+		if (0 == tzdata->nr_throttling++) {
+			tzdata->throttle_start = jiffies;
+			tzdata->throttle_count++;
+		}
+	} else if (0 < tzdata->nr_throttling) {
+		if (0 == --tzdata->nr_throttling)
+			tzdata->throttle_ms += jiffies_to_msecs(jiffies - tzdata->throttle_start);
+	}
+}
+
 static int mtk_cooling_wrapper_set_cur_state
     (struct thermal_cooling_device *cdev, unsigned long state) {
 	struct thermal_cooling_device_ops *ops;
@@ -2418,9 +2668,20 @@ static int mtk_cooling_wrapper_set_cur_state
 	THRML_STORAGE_LOG(THRML_LOGGER_MSG_COOL_STAE, set_cur_state, mcdata->tz->type, mcdata->trip,
 			  cdev->type, state);
 
+	/* the client is already there, nothing to do */
+	if (state == cur_state && state == mcdata->last_state)
+		goto out;
+
 	if (ops->set_cur_state)
 		ret = ops->set_cur_state(cdev, state);
 
+	if (0 == ret) {
+		if (mcdata->tz && ((0 != state) != (0 != mcdata->last_state)))
+			_mtm_throttle_account(mcdata->tz->devdata, 0 != state);
+		mcdata->last_state = state;
+	}
+
+out:
 	/* reset devdata to mcdata */
 	cdev->devdata = mcdata;
 
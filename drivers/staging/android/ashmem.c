@@ -30,7 +30,12 @@
 #include <linux/personality.h>
 #include <linux/bitops.h>
 #include <linux/mutex.h>
+#include <linux/kref.h>
+#include <linux/spinlock.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include <linux/shmem_fs.h>
+#include <linux/vmpressure.h>
 #include "ashmem.h"
 
 #define ASHMEM_NAME_PREFIX "dev/ashmem/"
@@ -39,8 +44,9 @@
 
 /*
  * ashmem_area - anonymous shared memory area
- * Lifecycle: From our parent file's open() until its release()
- * Locking: Protected by `ashmem_mutex'
+ * Lifecycle: From our parent file's open() until its release(), or until
+ *	      the shrinker drops its reference if it is purging at the time
+ * Locking: Protected by its own `mutex'
  * Big Note: Mappings do NOT pin this structure; it dies on close()
  */
 struct ashmem_area {
@@ -49,12 +55,14 @@ struct ashmem_area {
 	struct file *file;		 /* the shmem-based backing file */
 	size_t size;			 /* size of the mapping, in bytes */
 	unsigned long prot_mask;	 /* allowed prot bits, as vm_flags */
+	struct mutex mutex;		 /* protects all of the above */
+	struct kref ref;		 /* file, plus a purging shrinker */
 };
 
 /*
  * ashmem_range - represents an interval of unpinned (evictable) pages
  * Lifecycle: From unpin to pin
- * Locking: Protected by `ashmem_mutex'
+ * Locking: Protected by its area's `mutex'; `lru' also by `ashmem_lru_lock'
  */
 struct ashmem_range {
 	struct list_head lru;		/* entry in LRU list */
@@ -65,18 +73,32 @@ struct ashmem_range {
 	unsigned int purged;		/* ASHMEM_NOT or ASHMEM_WAS_PURGED */
 };
 
-/* LRU list of unpinned pages, protected by ashmem_mutex */
+/* LRU list of unpinned pages, protected by ashmem_lru_lock */
 static LIST_HEAD(ashmem_lru_list);
 
-/* Count of pages on our LRU list, protected by ashmem_mutex */
+/* Count of pages on our LRU list, protected by ashmem_lru_lock */
 static unsigned long lru_count;
 
+/* Count of unpinned pages that were purged, protected by ashmem_lru_lock */
+static unsigned long purged_count;
+
 /*
- * ashmem_mutex - protects the list of and each individual ashmem_area
+ * ashmem_lru_lock - protects the LRU list and the page counts above
+ *
+ * Lock Ordering: asma->mutex -> i_mutex -> i_alloc_sem
+ *		  asma->mutex -> ashmem_lru_lock
  *
- * Lock Ordering: ashmex_mutex -> i_mutex -> i_alloc_sem
+ * The shrinker walks the LRU under ashmem_lru_lock and only ever trylocks
+ * an area's mutex, so it never waits on an area that is busy pinning.
  */
-static DEFINE_MUTEX(ashmem_mutex);
+static DEFINE_SPINLOCK(ashmem_lru_lock);
+
+/* Pages backing areas that have a shmem file */
+static atomic_long_t ashmem_total_pages = ATOMIC_LONG_INIT(0);
+
+/* Pages purged by the shrinker since boot, and areas it had to skip */
+static atomic_long_t ashmem_purged_total = ATOMIC_LONG_INIT(0);
+static atomic_long_t ashmem_shrink_contended = ATOMIC_LONG_INIT(0);
 
 static struct kmem_cache *ashmem_area_cachep __read_mostly;
 static struct kmem_cache *ashmem_range_cachep __read_mostly;
@@ -107,16 +129,33 @@ static struct kmem_cache *ashmem_range_cachep __read_mostly;
 
 static inline void lru_add(struct ashmem_range *range)
 {
+	spin_lock(&ashmem_lru_lock);
 	list_add_tail(&range->lru, &ashmem_lru_list);
 	lru_count += range_size(range);
+	spin_unlock(&ashmem_lru_lock);
 }
 
-static inline void lru_del(struct ashmem_range *range)
+/* Caller must hold ashmem_lru_lock. */
+static inline void __lru_del(struct ashmem_range *range)
 {
 	list_del(&range->lru);
 	lru_count -= range_size(range);
 }
 
+static inline void lru_del(struct ashmem_range *range)
+{
+	spin_lock(&ashmem_lru_lock);
+	__lru_del(range);
+	spin_unlock(&ashmem_lru_lock);
+}
+
+static inline void purged_add(long pages)
+{
+	spin_lock(&ashmem_lru_lock);
+	purged_count += pages;
+	spin_unlock(&ashmem_lru_lock);
+}
+
 /*
  * range_alloc - allocate and initialize a new ashmem_range structure
  *
@@ -126,7 +165,7 @@ static inline void lru_del(struct ashmem_range *range)
  * 'start' - starting page, inclusive
  * 'end' - ending page, inclusive
  *
- * Caller must hold ashmem_mutex.
+ * Caller must hold asma->mutex.
  */
 static int range_alloc(struct ashmem_area *asma,
 		       struct ashmem_range *prev_range, unsigned int purged,
@@ -147,6 +186,8 @@ static int range_alloc(struct ashmem_area *asma,
 
 	if (range_on_lru(range))
 		lru_add(range);
+	else
+		purged_add(range_size(range));
 
 	return 0;
 }
@@ -156,13 +197,15 @@ static void range_del(struct ashmem_range *range)
 	list_del(&range->unpinned);
 	if (range_on_lru(range))
 		lru_del(range);
+	else
+		purged_add(-(long)range_size(range));
 	kmem_cache_free(ashmem_range_cachep, range);
 }
 
 /*
  * range_shrink - shrinks a range
  *
- * Caller must hold ashmem_mutex.
+ * Caller must hold asma->mutex.
  */
 static inline void range_shrink(struct ashmem_range *range,
 				size_t start, size_t end)
@@ -172,8 +215,19 @@ static inline void range_shrink(struct ashmem_range *range,
 	range->pgstart = start;
 	range->pgend = end;
 
+	spin_lock(&ashmem_lru_lock);
 	if (range_on_lru(range))
 		lru_count -= pre - range_size(range);
+	else
+		purged_count -= pre - range_size(range);
+	spin_unlock(&ashmem_lru_lock);
+}
+
+static void ashmem_area_free(struct kref *ref)
+{
+	struct ashmem_area *asma = container_of(ref, struct ashmem_area, ref);
+
+	kmem_cache_free(ashmem_area_cachep, asma);
 }
 
 static int ashmem_open(struct inode *inode, struct file *file)
@@ -190,6 +244,8 @@ static int ashmem_open(struct inode *inode, struct file *file)
 		return -ENOMEM;
 
 	INIT_LIST_HEAD(&asma->unpinned_list);
+	mutex_init(&asma->mutex);
+	kref_init(&asma->ref);
 	memcpy(asma->name, ASHMEM_NAME_PREFIX, ASHMEM_NAME_PREFIX_LEN);
 	asma->prot_mask = PROT_MASK;
 	file->private_data = asma;
@@ -202,14 +258,17 @@ static int ashmem_release(struct inode *ignored, struct file *file)
 	struct ashmem_area *asma = file->private_data;
 	struct ashmem_range *range, *next;
 
-	mutex_lock(&ashmem_mutex);
+	mutex_lock(&asma->mutex);
 	list_for_each_entry_safe(range, next, &asma->unpinned_list, unpinned)
 		range_del(range);
-	mutex_unlock(&ashmem_mutex);
+	mutex_unlock(&asma->mutex);
 
-	if (asma->file)
+	if (asma->file) {
+		atomic_long_sub(PAGE_ALIGN(asma->size) >> PAGE_SHIFT,
+				&ashmem_total_pages);
 		fput(asma->file);
-	kmem_cache_free(ashmem_area_cachep, asma);
+	}
+	kref_put(&asma->ref, ashmem_area_free);
 
 	return 0;
 }
@@ -220,7 +279,7 @@ static ssize_t ashmem_read(struct file *file, char __user *buf,
 	struct ashmem_area *asma = file->private_data;
 	int ret = 0;
 
-        mutex_lock(&ashmem_mutex);
+	mutex_lock(&asma->mutex);
 
 	/* If size is not set, or set to 0, always return EOF. */
 	if (asma->size == 0)
@@ -231,7 +290,7 @@ static ssize_t ashmem_read(struct file *file, char __user *buf,
 		goto out_unlock;
 	}
 
-	mutex_unlock(&ashmem_mutex);
+	mutex_unlock(&asma->mutex);
 
 	/*
 	 * asma and asma->file are used outside the lock here.  We assume
@@ -247,7 +306,7 @@ static ssize_t ashmem_read(struct file *file, char __user *buf,
 	return ret;
 
 out_unlock:
-	mutex_unlock(&ashmem_mutex);
+	mutex_unlock(&asma->mutex);
 	return ret;
 }
 
@@ -256,7 +315,7 @@ static loff_t ashmem_llseek(struct file *file, loff_t offset, int origin)
 	struct ashmem_area *asma = file->private_data;
 	int ret;
 
-	mutex_lock(&ashmem_mutex);
+	mutex_lock(&asma->mutex);
 
 	if (asma->size == 0) {
 		ret = -EINVAL;
@@ -276,7 +335,7 @@ static loff_t ashmem_llseek(struct file *file, loff_t offset, int origin)
 	file->f_pos = asma->file->f_pos;
 
 out:
-	mutex_unlock(&ashmem_mutex);
+	mutex_unlock(&asma->mutex);
 	return ret;
 }
 
@@ -307,7 +366,7 @@ static int ashmem_mmap(struct file *file, struct vm_area_struct *vma)
 	struct ashmem_area *asma = file->private_data;
 	int ret = 0;
 
-	mutex_lock(&ashmem_mutex);
+	mutex_lock(&asma->mutex);
 
 	/* user needs to SET_SIZE before mapping */
 	if (unlikely(!asma->size)) {
@@ -337,6 +396,8 @@ static int ashmem_mmap(struct file *file, struct vm_area_struct *vma)
 			goto out;
 		}
 		asma->file = vmfile;
+		atomic_long_add(PAGE_ALIGN(asma->size) >> PAGE_SHIFT,
+				&ashmem_total_pages);
 		/*
 		 * override mmap operation of the vmfile so that it can't be
 		 * remapped which would lead to creation of a new vma with no
@@ -362,10 +423,67 @@ static int ashmem_mmap(struct file *file, struct vm_area_struct *vma)
 	}
 
 out:
-	mutex_unlock(&ashmem_mutex);
+	mutex_unlock(&asma->mutex);
 	return ret;
 }
 
+static void ashmem_punch(struct ashmem_area *asma, size_t pgstart,
+			 size_t pgend)
+{
+	loff_t start = pgstart * PAGE_SIZE;
+	loff_t end = (pgend + 1) * PAGE_SIZE;
+
+	do_fallocate(asma->file, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+		     start, end - start);
+}
+
+/*
+ * ashmem_purge_area - purge @range, plus as many of its area's other
+ * unpinned ranges still on the LRU as fit in 'nr_to_scan' pages.  Runs of
+ * adjacent ranges are punched out with a single fallocate call.  Returns
+ * the number of pages purged.
+ *
+ * Caller must hold range->asma->mutex and have taken @range off the LRU.
+ */
+static long ashmem_purge_area(struct ashmem_range *range, long nr_to_scan)
+{
+	struct ashmem_area *asma = range->asma;
+	struct ashmem_range *next;
+	size_t run_start = 0, run_end = 0;
+	bool in_run = false;
+	long freed = range_size(range);
+
+	/* the unpinned list is sorted by descending page */
+	list_for_each_entry(next, &asma->unpinned_list, unpinned) {
+		if (next != range) {
+			if (!range_on_lru(next) || freed >= nr_to_scan)
+				continue;
+			lru_del(next);
+			freed += range_size(next);
+		}
+		next->purged = ASHMEM_WAS_PURGED;
+
+		if (in_run && next->pgend + 1 == run_start) {
+			run_start = next->pgstart;
+			continue;
+		}
+
+		if (in_run)
+			ashmem_punch(asma, run_start, run_end);
+		run_start = next->pgstart;
+		run_end = next->pgend;
+		in_run = true;
+	}
+
+	if (in_run)
+		ashmem_punch(asma, run_start, run_end);
+
+	purged_add(freed);
+	atomic_long_add(freed, &ashmem_purged_total);
+
+	return freed;
+}
+
 /*
  * ashmem_shrink - our cache shrinker, called from mm/vmscan.c :: shrink_slab
  *
@@ -378,38 +496,63 @@ out:
  * proceed without risk of deadlock (due to gfp_mask).
  *
  * We approximate LRU via least-recently-unpinned, jettisoning unpinned partial
- * chunks of ashmem regions LRU-wise one-at-a-time until we hit 'nr_to_scan'
- * pages freed.
+ * chunks of ashmem regions LRU-wise until we hit 'nr_to_scan' pages freed.
+ * Areas whose mutex is held by a pinning task are skipped rather than waited
+ * on, so reclaim still makes progress on the rest of the LRU.
+ *
+ * While an area is purged with ashmem_lru_lock dropped, an on-stack cursor
+ * (a range with no area, skipped by other shrinkers) keeps our place in
+ * the LRU, and a reference keeps the area alive past its mutex_unlock().
  */
 static int ashmem_shrink(struct shrinker *s, struct shrink_control *sc)
 {
-	struct ashmem_range *range, *next;
+	struct ashmem_range cursor = { .asma = NULL };
+	struct list_head *pos;
+	long nr_to_scan = sc->nr_to_scan;
 
 	/* We might recurse into filesystem code, so bail out if necessary */
-	if (sc->nr_to_scan && !(sc->gfp_mask & __GFP_FS))
+	if (nr_to_scan && !(sc->gfp_mask & __GFP_FS))
 		return -1;
-	if (!sc->nr_to_scan)
+	if (!nr_to_scan)
 		return lru_count;
 
-	//To avoid deadlock when memory is shortage
-	if (!mutex_trylock(&ashmem_mutex))
-		return -1;
+	spin_lock(&ashmem_lru_lock);
+	pos = ashmem_lru_list.next;
+	while (pos != &ashmem_lru_list && nr_to_scan > 0) {
+		struct ashmem_range *range;
+		struct ashmem_area *asma;
 
-	list_for_each_entry_safe(range, next, &ashmem_lru_list, lru) {
-		loff_t start = range->pgstart * PAGE_SIZE;
-		loff_t end = (range->pgend + 1) * PAGE_SIZE;
+		range = list_entry(pos, struct ashmem_range, lru);
+		asma = range->asma;
+		pos = pos->next;
 
-		do_fallocate(range->asma->file,
-				FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
-				start, end - start);
-		range->purged = ASHMEM_WAS_PURGED;
-		lru_del(range);
+		/* another shrinker's cursor */
+		if (!asma)
+			continue;
 
-		sc->nr_to_scan -= range_size(range);
-		if (sc->nr_to_scan <= 0)
-			break;
+		/*
+		 * the range is still on the LRU, so its area can't have been
+		 * released yet; once we hold the area's mutex it can't be.
+		 */
+		if (!mutex_trylock(&asma->mutex)) {
+			atomic_long_inc(&ashmem_shrink_contended);
+			continue;
+		}
+
+		__lru_del(range);
+		kref_get(&asma->ref);
+		list_add_tail(&cursor.lru, pos);
+		spin_unlock(&ashmem_lru_lock);
+
+		nr_to_scan -= ashmem_purge_area(range, nr_to_scan);
+		mutex_unlock(&asma->mutex);
+		kref_put(&asma->ref, ashmem_area_free);
+
+		spin_lock(&ashmem_lru_lock);
+		pos = cursor.lru.next;
+		list_del(&cursor.lru);
 	}
-	mutex_unlock(&ashmem_mutex);
+	spin_unlock(&ashmem_lru_lock);
 
 	return lru_count;
 }
@@ -419,11 +562,38 @@ static struct shrinker ashmem_shrinker = {
 	.seeks = DEFAULT_SEEKS * 4,
 };
 
+/*
+ * Unpinned ranges are memory their owners already agreed to lose, so under
+ * medium pressure give back a quarter of them and under critical pressure
+ * all of them, ahead of the slab shrinker's proportional share.
+ */
+static int ashmem_vmpressure(struct notifier_block *nb, unsigned long level,
+			     void *data)
+{
+	struct shrink_control sc = {
+		.gfp_mask = GFP_KERNEL,
+	};
+
+	if (level == VMPRESSURE_LOW)
+		return NOTIFY_DONE;
+
+	sc.nr_to_scan = lru_count;
+	if (level == VMPRESSURE_MEDIUM)
+		sc.nr_to_scan /= 4;
+	if (sc.nr_to_scan)
+		ashmem_shrink(&ashmem_shrinker, &sc);
+	return NOTIFY_OK;
+}
+
+static struct notifier_block ashmem_vmpressure_nb = {
+	.notifier_call = ashmem_vmpressure,
+};
+
 static int set_prot_mask(struct ashmem_area *asma, unsigned long prot)
 {
 	int ret = 0;
 
-	mutex_lock(&ashmem_mutex);
+	mutex_lock(&asma->mutex);
 
 	/* the user can only remove, not add, protection bits */
 	if (unlikely((asma->prot_mask & prot) != prot)) {
@@ -438,7 +608,7 @@ static int set_prot_mask(struct ashmem_area *asma, unsigned long prot)
 	asma->prot_mask = prot;
 
 out:
-	mutex_unlock(&ashmem_mutex);
+	mutex_unlock(&asma->mutex);
 	return ret;
 }
 
@@ -449,10 +619,10 @@ static int set_name(struct ashmem_area *asma, void __user *name)
 	char local_name[ASHMEM_NAME_LEN];
 
 	/*
-	 * Holding the ashmem_mutex while doing a copy_from_user might cause
+	 * Holding the asma->mutex while doing a copy_from_user might cause
 	 * an data abort which would try to access mmap_sem. If another
 	 * thread has invoked ashmem_mmap then it will be holding the
-	 * semaphore and will be waiting for ashmem_mutex, there by leading to
+	 * semaphore and will be waiting for asma->mutex, there by leading to
 	 * deadlock. We'll release the mutex  and take the name to a local
 	 * variable that does not need protection and later copy the local
 	 * variable to the structure member with lock held.
@@ -462,14 +632,14 @@ static int set_name(struct ashmem_area *asma, void __user *name)
 		return len;
 	if (len == ASHMEM_NAME_LEN)
 		local_name[ASHMEM_NAME_LEN - 1] = '\0';
-	mutex_lock(&ashmem_mutex);
+	mutex_lock(&asma->mutex);
 	/* cannot change an existing mapping's name */
 	if (unlikely(asma->file))
 		ret = -EINVAL;
 	else
 		strcpy(asma->name + ASHMEM_NAME_PREFIX_LEN, local_name);
 
-	mutex_unlock(&ashmem_mutex);
+	mutex_unlock(&asma->mutex);
 	return ret;
 }
 
@@ -485,7 +655,7 @@ static int get_name(struct ashmem_area *asma, void __user *name)
 	 */
 	char local_name[ASHMEM_NAME_LEN];
 
-	mutex_lock(&ashmem_mutex);
+	mutex_lock(&asma->mutex);
 	if (asma->name[ASHMEM_NAME_PREFIX_LEN] != '\0') {
 
 		/*
@@ -498,7 +668,7 @@ static int get_name(struct ashmem_area *asma, void __user *name)
 		len = sizeof(ASHMEM_NAME_DEF);
 		memcpy(local_name, ASHMEM_NAME_DEF, len);
 	}
-	mutex_unlock(&ashmem_mutex);
+	mutex_unlock(&asma->mutex);
 
 	/*
 	 * Now we are just copying from the stack variable to userland
@@ -513,7 +683,7 @@ static int get_name(struct ashmem_area *asma, void __user *name)
  * ashmem_pin - pin the given ashmem region, returning whether it was
  * previously purged (ASHMEM_WAS_PURGED) or not (ASHMEM_NOT_PURGED).
  *
- * Caller must hold ashmem_mutex.
+ * Caller must hold asma->mutex.
  */
 static int ashmem_pin(struct ashmem_area *asma, size_t pgstart, size_t pgend)
 {
@@ -579,7 +749,7 @@ static int ashmem_pin(struct ashmem_area *asma, size_t pgstart, size_t pgend)
 /*
  * ashmem_unpin - unpin the given range of pages. Returns zero on success.
  *
- * Caller must hold ashmem_mutex.
+ * Caller must hold asma->mutex.
  */
 static int ashmem_unpin(struct ashmem_area *asma, size_t pgstart, size_t pgend)
 {
@@ -614,7 +784,7 @@ restart:
  * ashmem_get_pin_status - Returns ASHMEM_IS_UNPINNED if _any_ pages in the
  * given interval are unpinned and ASHMEM_IS_PINNED otherwise.
  *
- * Caller must hold ashmem_mutex.
+ * Caller must hold asma->mutex.
  */
 static int ashmem_get_pin_status(struct ashmem_area *asma, size_t pgstart,
 				 size_t pgend)
@@ -663,7 +833,7 @@ static int ashmem_pin_unpin(struct ashmem_area *asma, unsigned long cmd,
 	pgstart = pin.offset / PAGE_SIZE;
 	pgend = pgstart + (pin.len / PAGE_SIZE) - 1;
 
-	mutex_lock(&ashmem_mutex);
+	mutex_lock(&asma->mutex);
 
 	switch (cmd) {
 	case ASHMEM_PIN:
@@ -677,7 +847,7 @@ static int ashmem_pin_unpin(struct ashmem_area *asma, unsigned long cmd,
 		break;
 	}
 
-	mutex_unlock(&ashmem_mutex);
+	mutex_unlock(&asma->mutex);
 
 	return ret;
 }
@@ -696,12 +866,12 @@ static long ashmem_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 		break;
 	case ASHMEM_SET_SIZE:
 		ret = -EINVAL;
-        mutex_lock(&ashmem_mutex);
+		mutex_lock(&asma->mutex);
 		if (!asma->file) {
 			ret = 0;
 			asma->size = (size_t) arg;
 		}
-        mutex_unlock(&ashmem_mutex);
+		mutex_unlock(&asma->mutex);
 		break;
 	case ASHMEM_GET_SIZE:
 		ret = asma->size;
@@ -770,6 +940,48 @@ static struct miscdevice ashmem_misc = {
 	.fops = &ashmem_fops,
 };
 
+#ifdef CONFIG_DEBUG_FS
+static int ashmem_stats_show(struct seq_file *s, void *unused)
+{
+	unsigned long unpinned, purged;
+	long total;
+
+	spin_lock(&ashmem_lru_lock);
+	unpinned = lru_count;
+	purged = purged_count;
+	spin_unlock(&ashmem_lru_lock);
+
+	total = atomic_long_read(&ashmem_total_pages);
+
+	seq_printf(s, "pinned_bytes: %lu\n",
+		   (unsigned long)max(total - (long)(unpinned + purged), 0L)
+		   << PAGE_SHIFT);
+	seq_printf(s, "unpinned_bytes: %lu\n", unpinned << PAGE_SHIFT);
+	seq_printf(s, "unpinned_purged_bytes: %lu\n", purged << PAGE_SHIFT);
+	seq_printf(s, "purged_total_bytes: %lu\n",
+		   (unsigned long)atomic_long_read(&ashmem_purged_total)
+		   << PAGE_SHIFT);
+	seq_printf(s, "shrink_contended: %ld\n",
+		   atomic_long_read(&ashmem_shrink_contended));
+
+	return 0;
+}
+
+static int ashmem_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ashmem_stats_show, inode->i_private);
+}
+
+static const struct file_operations ashmem_stats_fops = {
+	.open		= ashmem_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static struct dentry *ashmem_debugfs_stats;
+#endif
+
 static int is_ashmem_file(struct file *file)
 {
 	return (file->f_op == &ashmem_fops);
@@ -802,6 +1014,13 @@ static int __init ashmem_init(void)
 	}
 
 	register_shrinker(&ashmem_shrinker);
+	vmpressure_notifier_register(&ashmem_vmpressure_nb);
+
+#ifdef CONFIG_DEBUG_FS
+	ashmem_debugfs_stats = debugfs_create_file("ashmem_stats", S_IRUGO,
+						   NULL, NULL,
+						   &ashmem_stats_fops);
+#endif
 
 	pr_info("initialized\n");
 
@@ -812,6 +1031,10 @@ static void __exit ashmem_exit(void)
 {
 	int ret;
 
+#ifdef CONFIG_DEBUG_FS
+	debugfs_remove(ashmem_debugfs_stats);
+#endif
+	vmpressure_notifier_unregister(&ashmem_vmpressure_nb);
 	unregister_shrinker(&ashmem_shrinker);
 
 	ret = misc_deregister(&ashmem_misc);
@@ -443,7 +443,18 @@ static void ion_handle_destroy(struct kref *kref)
 	handle->buffer = NULL;
 	handle->client = NULL;
 
-	kfree(handle);
+	/* ion_handle_get_by_id() may still be looking at it */
+	kfree_rcu(handle, rcu);
+}
+
+/* kref_put_mutex() release: called with the client lock held, drops it */
+static void ion_handle_destroy_unlock(struct kref *kref)
+{
+	struct ion_handle *handle = container_of(kref, struct ion_handle, ref);
+	struct ion_client *client = handle->client;
+
+	ion_handle_destroy(kref);
+	mutex_unlock(&client->lock);
 }
 
 struct ion_buffer *ion_handle_buffer(struct ion_handle *handle)
@@ -474,16 +485,12 @@ static int ion_handle_put_nolock(struct ion_handle *handle)
 	return ret;
 }
 
+/* Only takes the client lock when this drops the last reference */
 static int ion_handle_put(struct ion_handle *handle)
 {
 	struct ion_client *client = handle->client;
-	int ret;
-
-	mutex_lock(&client->lock);
-	ret = ion_handle_put_nolock(handle);
-	mutex_unlock(&client->lock);
 
-	return ret;
+	return kref_put_mutex(&handle->ref, ion_handle_destroy_unlock, &client->lock);
 }
 
 /* Must hold the client lock */
@@ -585,14 +592,38 @@ static struct ion_handle *ion_handle_get_by_id_nolock(struct ion_client *client,
 	return ERR_PTR(-EINVAL);
 }
 
+/*
+ * Takes a reference unless the handle is already being destroyed. Its memory
+ * stays valid for the caller's RCU read section, see ion_handle_destroy().
+ */
+static struct ion_handle *ion_handle_tryget(struct ion_handle *handle)
+{
+	int old, ref = atomic_read(&handle->ref.refcount);
+
+	do {
+		if (ref == 0)
+			return ERR_PTR(-EINVAL);
+		if (ref + 1 == 0)
+			return ERR_PTR(-EOVERFLOW);
+		old = ref;
+		ref = atomic_cmpxchg(&handle->ref.refcount, old, old + 1);
+	} while (ref != old);
+
+	return handle;
+}
+
 struct ion_handle *ion_handle_get_by_id(struct ion_client *client,
 					int id)
 {
 	struct ion_handle *handle;
 
-	mutex_lock(&client->lock);
-	handle = ion_handle_get_by_id_nolock(client, id);
-	mutex_unlock(&client->lock);
+	rcu_read_lock();
+	handle = idr_find(&client->idr, id);
+	handle = handle ? ion_handle_tryget(handle) : ERR_PTR(-EINVAL);
+	rcu_read_unlock();
+
+	if (!IS_ERR(handle))
+		atomic_inc(&client->lookup_count);
 
 	return handle;
 }
@@ -959,6 +990,10 @@ static int ion_debug_client_show(struct seq_file *s, void *unused)
 		return 0;
 	}
 
+	seq_printf(s, "lookup:%d import:%d import_hit:%d share:%d\n",
+		   atomic_read(&client->lookup_count), atomic_read(&client->import_count),
+		   atomic_read(&client->import_hit_count), atomic_read(&client->share_count));
+
 	mutex_lock(&client->lock);
 	seq_printf(s, "%16.s %8.s %8.s %8.s\n",
 			"heap_name", "pid", "size", "handle_count");
@@ -1425,23 +1460,14 @@ static struct dma_buf_ops dma_buf_ops = {
 	.kunmap = ion_dma_buf_kunmap,
 };
 
-struct dma_buf *ion_share_dma_buf(struct ion_client *client,
-						struct ion_handle *handle)
+/* the caller holds a reference on handle, so its buffer cannot go away */
+static struct dma_buf *__ion_share_dma_buf(struct ion_client *client,
+					   struct ion_handle *handle)
 {
-	struct ion_buffer *buffer;
+	struct ion_buffer *buffer = handle->buffer;
 	struct dma_buf *dmabuf;
-	bool valid_handle;
 
-	mutex_lock(&client->lock);
-	valid_handle = ion_handle_validate(client, handle);
-	if (!valid_handle) {
-		WARN(1, "%s: invalid handle passed to share.\n", __func__);
-		mutex_unlock(&client->lock);
-		return ERR_PTR(-EINVAL);
-	}
-	buffer = handle->buffer;
 	ion_buffer_get(buffer);
-	mutex_unlock(&client->lock);
 
 	dmabuf = dma_buf_export(buffer, &dma_buf_ops, buffer->size, O_RDWR);
 	if (IS_ERR(dmabuf)) {
@@ -1450,16 +1476,40 @@ struct dma_buf *ion_share_dma_buf(struct ion_client *client,
 		return dmabuf;
 	}
 
+	atomic_inc(&client->share_count);
 	return dmabuf;
 }
+
+struct dma_buf *ion_share_dma_buf(struct ion_client *client,
+						struct ion_handle *handle)
+{
+	bool valid_handle;
+
+	mutex_lock(&client->lock);
+	valid_handle = ion_handle_validate(client, handle);
+	mutex_unlock(&client->lock);
+	if (!valid_handle) {
+		WARN(1, "%s: invalid handle passed to share.\n", __func__);
+		return ERR_PTR(-EINVAL);
+	}
+
+	return __ion_share_dma_buf(client, handle);
+}
 EXPORT_SYMBOL(ion_share_dma_buf);
 
+/*
+ * Handles from userspace were just resolved by ion_handle_get_by_id(), which
+ * already proves they belong to client, so they skip the validation.
+ */
 int __ion_share_dma_buf_fd(struct ion_client *client, struct ion_handle *handle, int from_kern)
 {
 	struct dma_buf *dmabuf;
 	int fd;
 
-	dmabuf = ion_share_dma_buf(client, handle);
+	if (from_kern)
+		dmabuf = ion_share_dma_buf(client, handle);
+	else
+		dmabuf = __ion_share_dma_buf(client, handle);
 	if (IS_ERR(dmabuf)) {
                 IONMSG("%s dmabuf is err 0x%p.\n", __func__, dmabuf);
 		return PTR_ERR(dmabuf);
@@ -1514,6 +1564,7 @@ struct ion_handle *__ion_import_dma_buf(struct ion_client *client, int fd, int f
 	if (!IS_ERR(handle)) {
 		handle = ion_handle_get_check_overflow(handle);
 		mutex_unlock(&client->lock);
+		atomic_inc(&client->import_hit_count);
 		goto end;
 	}
 
@@ -1531,6 +1582,8 @@ struct ion_handle *__ion_import_dma_buf(struct ion_client *client, int fd, int f
 		ion_handle_put(handle);
 		handle = ERR_PTR(ret);
 		IONMSG("ion_import: ion_handle_add fail %d\n", ret);
+	} else {
+		atomic_inc(&client->import_count);
 	}
 
 end:
@@ -1869,6 +1922,25 @@ static const struct file_operations debug_heap_fops = {
 	.release = single_release,
 };
 
+static int ion_debug_heap_pools_show(struct seq_file *s, void *unused)
+{
+	struct ion_heap *heap = s->private;
+
+	return ion_heap_pool_debug_show(heap, s);
+}
+
+static int ion_debug_heap_pools_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ion_debug_heap_pools_show, inode->i_private);
+}
+
+static const struct file_operations debug_heap_pools_fops = {
+	.open = ion_debug_heap_pools_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 #ifdef DEBUG_HEAP_SHRINKER
 static int debug_shrink_set(void *data, u64 val)
 {
@@ -1918,7 +1990,7 @@ void ion_device_add_heap(struct ion_device *dev, struct ion_heap *heap)
 		pr_err("%s: can not add heap with invalid ops struct.\n",
 		       __func__);
 
-	if (heap->flags & ION_HEAP_FLAG_DEFER_FREE)
+	if (heap->flags & (ION_HEAP_FLAG_DEFER_FREE | ION_HEAP_FLAG_DEFER_ZERO))
 		ion_heap_init_deferred_free(heap);
 
 	if ((heap->flags & ION_HEAP_FLAG_DEFER_FREE) || heap->ops->shrink)
@@ -1941,6 +2013,20 @@ void ion_device_add_heap(struct ion_device *dev, struct ion_heap *heap)
 			path, heap->name);
 	}
 
+	if (heap->flags & ION_HEAP_FLAG_DEFER_ZERO) {
+		char debug_name[64];
+
+		snprintf(debug_name, 64, "%s_pools", heap->name);
+		debugfs_create_file(debug_name, 0444, dev->heaps_debug_root,
+				    heap, &debug_heap_pools_fops);
+		snprintf(debug_name, 64, "%s_pool_high_wm", heap->name);
+		debugfs_create_u32(debug_name, 0644, dev->heaps_debug_root,
+				   &heap->pool_high_wm);
+		snprintf(debug_name, 64, "%s_pool_low_wm", heap->name);
+		debugfs_create_u32(debug_name, 0644, dev->heaps_debug_root,
+				   &heap->pool_low_wm);
+	}
+
 #ifdef DEBUG_HEAP_SHRINKER
 	if (heap->shrinker.shrink) {
 		char debug_name[64];
@@ -2069,27 +2155,30 @@ struct ion_handle *ion_drv_get_handle(struct ion_client *client, int user_handle
 {
 	struct ion_handle *handle;
 
-	mutex_lock(&client->lock);
-	if (from_kernel) {
-		handle = kernel_handle;
-
-		if (IS_ERR_OR_NULL(handle) ||
-		    !ion_handle_validate(client, handle))
+	if (!from_kernel) {
+		handle = ion_handle_get_by_id(client, user_handle);
+		if (IS_ERR(handle))
 			goto err;
-		handle = ion_handle_get_check_overflow(handle);
-	} else {
-		handle = ion_handle_get_by_id_nolock(client, user_handle);
+		return handle;
 	}
 
+	mutex_lock(&client->lock);
+	handle = kernel_handle;
+	if (IS_ERR_OR_NULL(handle) ||
+	    !ion_handle_validate(client, handle)) {
+		mutex_unlock(&client->lock);
+		goto err;
+	}
+	handle = ion_handle_get_check_overflow(handle);
+	mutex_unlock(&client->lock);
+
 	if (IS_ERR_OR_NULL(handle))
 		goto err;
 
-	mutex_unlock(&client->lock);
 	return handle;
 err:
 	IONMSG("%s handle invalid, kernel:%d, handle=%p, handle_id=%d\n",
 	       __func__, from_kernel, handle, user_handle);
-	mutex_unlock(&client->lock);
 	return ERR_PTR(-EINVAL);
 }
 
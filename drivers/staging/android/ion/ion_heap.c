@@ -21,7 +21,11 @@
 #include <linux/rtmutex.h>
 #include <linux/sched.h>
 #include <linux/scatterlist.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/swap.h>
 #include <linux/vmalloc.h>
+#include <linux/vmpressure.h>
 #include <linux/mtk_ion.h>
 #include "ion_priv.h"
 
@@ -238,6 +242,213 @@ size_t ion_heap_freelist_shrink(struct ion_heap *heap, size_t size)
 	return _ion_heap_freelist_drain(heap, size, true);
 }
 
+void ion_heap_schedule_clean(struct ion_heap *heap)
+{
+	if (!(heap->flags & ION_HEAP_FLAG_DEFER_ZERO))
+		return;
+	if (atomic_xchg(&heap->clean_pending, 1))
+		return;
+	wake_up(&heap->waitqueue);
+}
+
+/* how long a pressure report keeps the pools trimmed */
+#define ION_PRESSURE_HOLD		HZ
+/* minimum time between two pool history samples */
+#define ION_POOL_SAMPLE_INTERVAL	HZ
+
+static const char * const ion_pressure_name[] = {
+	[ION_PRESSURE_NONE] = "none",
+	[ION_PRESSURE_LOW] = "low",
+	[ION_PRESSURE_MEDIUM] = "medium",
+	[ION_PRESSURE_CRITICAL] = "critical",
+};
+
+void ion_heap_add_pool(struct ion_heap *heap, struct ion_page_pool *pool)
+{
+	plist_add(&pool->list, &heap->pools);
+}
+
+static unsigned long ion_page_pool_pages(struct ion_page_pool *pool)
+{
+	return (unsigned long)(pool->high_count + pool->low_count +
+			       pool->dirty_count) << pool->order;
+}
+
+static unsigned long ion_heap_pool_pages(struct ion_heap *heap)
+{
+	struct ion_page_pool *pool;
+	unsigned long total = 0;
+
+	plist_for_each_entry(pool, &heap->pools, list)
+		total += ion_page_pool_pages(pool);
+	return total;
+}
+
+static int ion_heap_pressure_level(struct ion_heap *heap)
+{
+	int level = atomic_read(&heap->pressure);
+
+	if (level != ION_PRESSURE_NONE &&
+	    time_after(jiffies, heap->pressure_stamp + ION_PRESSURE_HOLD)) {
+		atomic_cmpxchg(&heap->pressure, level, ION_PRESSURE_NONE);
+		level = ION_PRESSURE_NONE;
+	}
+	return level;
+}
+
+void ion_heap_pressure(struct ion_heap *heap, int level)
+{
+	if (!(heap->flags & ION_HEAP_FLAG_DEFER_ZERO))
+		return;
+
+	heap->pressure_stamp = jiffies;
+	if (level > ion_heap_pressure_level(heap))
+		atomic_set(&heap->pressure, level);
+	ion_heap_schedule_clean(heap);
+}
+
+/*
+ * Give pooled pages back to the system until at most @target pages are
+ * left, starting with the highest order pools.
+ */
+static void ion_heap_pool_trim(struct ion_heap *heap, unsigned long target)
+{
+	struct ion_page_pool *pool;
+	unsigned long total = ion_heap_pool_pages(heap);
+
+	list_for_each_entry_reverse(pool, &heap->pools.node_list,
+				    list.node_list) {
+		unsigned long before, nr;
+
+		if (total <= target)
+			break;
+		before = ion_page_pool_pages(pool);
+		nr = min(before, total - target);
+		ion_page_pool_shrink(pool, __GFP_HIGHMEM,
+				     DIV_ROUND_UP(nr, 1 << pool->order));
+		total -= before - ion_page_pool_pages(pool);
+	}
+}
+
+static void ion_heap_pool_sample(struct ion_heap *heap, int level)
+{
+	struct ion_pool_sample *sample;
+	struct ion_page_pool *pool;
+	int i = 0;
+
+	if (!heap->pool_history)
+		return;
+	if (heap->pool_history_head &&
+	    time_before(jiffies, heap->pool_history_stamp +
+				 ION_POOL_SAMPLE_INTERVAL))
+		return;
+
+	mutex_lock(&heap->pool_lock);
+	sample = &heap->pool_history[heap->pool_history_head %
+				     ION_POOL_HISTORY];
+	sample->time = jiffies;
+	sample->level = level;
+	plist_for_each_entry(pool, &heap->pools, list) {
+		if (i == ION_POOL_HISTORY_POOLS)
+			break;
+		sample->pages[i++] = ion_page_pool_pages(pool);
+	}
+	heap->pool_history_head++;
+	heap->pool_history_stamp = jiffies;
+	mutex_unlock(&heap->pool_lock);
+}
+
+/*
+ * Keep the pools between the heap's watermarks: at most pool_high_wm pages
+ * normally, pool_low_wm pages while kswapd is running and nothing at all
+ * once tasks enter direct reclaim, so the memory is back in the system
+ * before the lowmemorykiller has to pick a victim.
+ */
+static void ion_heap_pool_balance(struct ion_heap *heap)
+{
+	int level = ion_heap_pressure_level(heap);
+	unsigned long target;
+
+	switch (level) {
+	case ION_PRESSURE_NONE:
+		target = heap->pool_high_wm;
+		break;
+	case ION_PRESSURE_LOW:
+		target = heap->pool_low_wm;
+		break;
+	default:
+		target = 0;
+		break;
+	}
+
+	ion_heap_pool_trim(heap, target);
+	ion_heap_pool_sample(heap, level);
+}
+
+int ion_heap_pool_debug_show(struct ion_heap *heap, struct seq_file *s)
+{
+	struct ion_page_pool *pool;
+	unsigned int head, n, i;
+	int p;
+
+	seq_printf(s, "watermarks: high %u low %u pages, pressure: %s\n",
+		   heap->pool_high_wm, heap->pool_low_wm,
+		   ion_pressure_name[ion_heap_pressure_level(heap)]);
+	seq_printf(s, "%10s %-8s", "msecs ago", "pressure");
+	p = 0;
+	plist_for_each_entry(pool, &heap->pools, list) {
+		if (p++ == ION_POOL_HISTORY_POOLS)
+			break;
+		seq_printf(s, " order%-4u", pool->order);
+	}
+	seq_printf(s, "\n");
+
+	mutex_lock(&heap->pool_lock);
+	head = heap->pool_history_head;
+	n = min_t(unsigned int, head, ION_POOL_HISTORY);
+	for (i = head - n; i != head; i++) {
+		struct ion_pool_sample *sample =
+			&heap->pool_history[i % ION_POOL_HISTORY];
+
+		seq_printf(s, "%10u %-8s",
+			   jiffies_to_msecs(jiffies - sample->time),
+			   ion_pressure_name[sample->level]);
+		for (p = 0; p < ION_POOL_HISTORY_POOLS && p < heap->pool_count;
+		     p++)
+			seq_printf(s, " %9lu", sample->pages[p]);
+		seq_printf(s, "\n");
+	}
+	mutex_unlock(&heap->pool_lock);
+
+	return 0;
+}
+
+static int ion_heap_init_pools(struct ion_heap *heap)
+{
+	struct ion_page_pool *pool;
+
+	atomic_set(&heap->pressure, ION_PRESSURE_NONE);
+	heap->pool_high_wm = totalram_pages / 16;
+	heap->pool_low_wm = heap->pool_high_wm / 4;
+	mutex_init(&heap->pool_lock);
+	heap->pool_count = 0;
+	plist_for_each_entry(pool, &heap->pools, list)
+		heap->pool_count++;
+
+	heap->pool_history = kcalloc(ION_POOL_HISTORY,
+				     sizeof(struct ion_pool_sample),
+				     GFP_KERNEL);
+	if (!heap->pool_history)
+		return -ENOMEM;
+	return 0;
+}
+
+static bool ion_heap_deferred_work(struct ion_heap *heap)
+{
+	return ion_heap_freelist_size(heap) > 0 ||
+		atomic_read(&heap->clean_pending);
+}
+
 static int ion_heap_deferred_free(void *data)
 {
 	struct ion_heap *heap = data;
@@ -246,11 +457,20 @@ static int ion_heap_deferred_free(void *data)
 		struct ion_buffer *buffer;
 
 		wait_event_freezable(heap->waitqueue,
-				     ion_heap_freelist_size(heap) > 0);
+				     ion_heap_deferred_work(heap));
 
 		spin_lock(&heap->free_lock);
 		if (list_empty(&heap->free_list)) {
 			spin_unlock(&heap->free_lock);
+			/*
+			 * buffers are freed first, they usually leave more
+			 * pages for us to clean
+			 */
+			if (atomic_xchg(&heap->clean_pending, 0)) {
+				if (heap->ops->clean)
+					heap->ops->clean(heap);
+				ion_heap_pool_balance(heap);
+			}
 			continue;
 		}
 		buffer = list_first_entry(&heap->free_list, struct ion_buffer,
@@ -272,6 +492,11 @@ int ion_heap_init_deferred_free(struct ion_heap *heap)
 	heap->free_list_size = 0;
 	spin_lock_init(&heap->free_lock);
 	init_waitqueue_head(&heap->waitqueue);
+	atomic_set(&heap->clean_pending, 0);
+	if ((heap->flags & ION_HEAP_FLAG_DEFER_ZERO) &&
+	    ion_heap_init_pools(heap))
+		pr_warn("%s: no pool history for heap %s\n", __func__,
+			heap->name);
 	heap->task = kthread_run(ion_heap_deferred_free, heap,
 				 "%s", heap->name);
 	sched_setscheduler(heap->task, SCHED_IDLE, &param);
@@ -294,6 +519,14 @@ static int ion_heap_shrink(struct shrinker *shrinker, struct shrink_control *sc)
 	if (to_scan == 0)
 		goto out;
 
+	/*
+	 * let the deferred free thread keep the pools small for a while,
+	 * kswapd is only a hint, direct reclaim means the pools are better
+	 * off in the buddy allocator
+	 */
+	ion_heap_pressure(heap, current_is_kswapd() ? ION_PRESSURE_LOW :
+						      ION_PRESSURE_MEDIUM);
+
 	/*
 	 * shrink the free list first, no point in zeroing the memory if we're
 	 * just going to reclaim it. Also, skip any possible page pooling.
@@ -314,12 +547,54 @@ out:
 	return total;
 }
 
+/*
+ * vmpressure reports come before the shrinkers get called hard, so the pools
+ * start trimming while reclaim is still mostly finding clean page cache.
+ */
+static int ion_heap_vmpressure(struct notifier_block *nb, unsigned long level,
+			       void *data)
+{
+	struct ion_heap *heap = container_of(nb, struct ion_heap, pressure_nb);
+
+	switch (level) {
+	case VMPRESSURE_CRITICAL:
+		ion_heap_pressure(heap, ION_PRESSURE_CRITICAL);
+		break;
+	case VMPRESSURE_MEDIUM:
+		ion_heap_pressure(heap, ION_PRESSURE_MEDIUM);
+		break;
+	default:
+		ion_heap_pressure(heap, ION_PRESSURE_LOW);
+		break;
+	}
+	return NOTIFY_OK;
+}
+
 void ion_heap_init_shrinker(struct ion_heap *heap)
 {
 	heap->shrinker.shrink = ion_heap_shrink;
 	heap->shrinker.seeks = DEFAULT_SEEKS;
 	heap->shrinker.batch = 0;
 	register_shrinker(&heap->shrinker);
+
+	if (heap->flags & ION_HEAP_FLAG_DEFER_ZERO) {
+		heap->pressure_nb.notifier_call = ion_heap_vmpressure;
+		vmpressure_notifier_register(&heap->pressure_nb);
+	}
+}
+
+void ion_heap_exit_shrinker(struct ion_heap *heap)
+{
+	/* both are only set up by ion_heap_init_shrinker() */
+	if (heap->pressure_nb.notifier_call) {
+		vmpressure_notifier_unregister(&heap->pressure_nb);
+		heap->pressure_nb.notifier_call = NULL;
+	}
+
+	if (heap->shrinker.shrink) {
+		unregister_shrinker(&heap->shrinker);
+		heap->shrinker.shrink = NULL;
+	}
 }
 
 struct ion_heap *ion_heap_create(struct ion_platform_heap *heap_data)
@@ -369,6 +644,8 @@ void ion_heap_destroy(struct ion_heap *heap)
 	if (!heap)
 		return;
 
+	ion_heap_exit_shrinker(heap);
+
 	switch (heap->type) {
 	case ION_HEAP_TYPE_SYSTEM_CONTIG:
 		pr_err("%s: Heap type is disabled: %d\n", __func__,
@@ -28,6 +28,19 @@ struct ion_page_pool_item {
 	struct list_head list;
 };
 
+/*
+ * Zero a page and write it back from the cpu caches so it can be handed
+ * to a device. Pool pages are never allocated with __GFP_ZERO, this is the
+ * only place they are cleared.
+ */
+static void ion_page_pool_zero(struct ion_page_pool *pool, struct page *page)
+{
+	size_t size = PAGE_SIZE << pool->order;
+
+	ion_heap_pages_zero(page, size, PAGE_KERNEL);
+	ion_pages_sync_for_device(NULL, page, size, DMA_BIDIRECTIONAL);
+}
+
 static void *ion_page_pool_alloc_pages(struct ion_page_pool *pool)
 {
 	struct page *page = alloc_pages(pool->gfp_mask, pool->order);
@@ -36,8 +49,7 @@ static void *ion_page_pool_alloc_pages(struct ion_page_pool *pool)
                 IONMSG("%s alloc_pages failed page is null.\n", __func__);
 		return NULL;
         }
-	ion_pages_sync_for_device(NULL, page, PAGE_SIZE << pool->order,
-						DMA_BIDIRECTIONAL);
+	ion_page_pool_zero(pool, page);
 	return page;
 }
 
@@ -47,6 +59,19 @@ static void ion_page_pool_free_pages(struct ion_page_pool *pool,
 	__free_pages(page, pool->order);
 }
 
+/* must be called with pool->mutex held */
+static void ion_page_pool_add_clean(struct ion_page_pool *pool,
+				    struct ion_page_pool_item *item)
+{
+	if (PageHighMem(item->page)) {
+		list_add_tail(&item->list, &pool->high_items);
+		pool->high_count++;
+	} else {
+		list_add_tail(&item->list, &pool->low_items);
+		pool->low_count++;
+	}
+}
+
 static int ion_page_pool_add(struct ion_page_pool *pool, struct page *page)
 {
 	struct ion_page_pool_item *item;
@@ -59,35 +84,32 @@ static int ion_page_pool_add(struct ion_page_pool *pool, struct page *page)
 
 	mutex_lock(&pool->mutex);
 	item->page = page;
-	if (PageHighMem(page)) {
-		list_add_tail(&item->list, &pool->high_items);
-		pool->high_count++;
-	} else {
-		list_add_tail(&item->list, &pool->low_items);
-		pool->low_count++;
-	}
+	list_add_tail(&item->list, &pool->dirty_items);
+	pool->dirty_count++;
 	mutex_unlock(&pool->mutex);
 	return 0;
 }
 
-static struct page *ion_page_pool_remove(struct ion_page_pool *pool, bool high)
+static struct ion_page_pool_item *
+ion_page_pool_remove_item(struct ion_page_pool *pool, struct list_head *items,
+			  int *count)
 {
 	struct ion_page_pool_item *item;
-	struct page *page;
-
-	if (high) {
-		BUG_ON(!pool->high_count);
-		item = list_first_entry(&pool->high_items,
-					struct ion_page_pool_item, list);
-		pool->high_count--;
-	} else {
-		BUG_ON(!pool->low_count);
-		item = list_first_entry(&pool->low_items,
-					struct ion_page_pool_item, list);
-		pool->low_count--;
-	}
 
+	BUG_ON(!*count);
+	item = list_first_entry(items, struct ion_page_pool_item, list);
 	list_del(&item->list);
+	(*count)--;
+	return item;
+}
+
+static struct page *ion_page_pool_remove(struct ion_page_pool *pool,
+					 struct list_head *items, int *count)
+{
+	struct ion_page_pool_item *item;
+	struct page *page;
+
+	item = ion_page_pool_remove_item(pool, items, count);
 	page = item->page;
 	kfree(item);
 	return page;
@@ -96,16 +118,34 @@ static struct page *ion_page_pool_remove(struct ion_page_pool *pool, bool high)
 void *ion_page_pool_alloc(struct ion_page_pool *pool)
 {
 	struct page *page = NULL;
+	bool dirty = false;
 
 	BUG_ON(!pool);
 
 	mutex_lock(&pool->mutex);
-	if (pool->high_count)
-		page = ion_page_pool_remove(pool, true);
-	else if (pool->low_count)
-		page = ion_page_pool_remove(pool, false);
+	if (pool->high_count) {
+		page = ion_page_pool_remove(pool, &pool->high_items,
+					    &pool->high_count);
+	} else if (pool->low_count) {
+		page = ion_page_pool_remove(pool, &pool->low_items,
+					    &pool->low_count);
+	} else if (pool->dirty_count) {
+		page = ion_page_pool_remove(pool, &pool->dirty_items,
+					    &pool->dirty_count);
+		dirty = true;
+	}
+	if (!page)
+		pool->miss_count++;
+	else if (dirty)
+		pool->dirty_hits++;
+	else
+		pool->clean_hits++;
 	mutex_unlock(&pool->mutex);
 
+	/* the background cleaner did not get to this one yet */
+	if (dirty)
+		ion_page_pool_zero(pool, page);
+
 	if (!page)
 		page = ion_page_pool_alloc_pages(pool);
 
@@ -121,6 +161,32 @@ void ion_page_pool_free(struct ion_page_pool *pool, struct page *page)
 		ion_page_pool_free_pages(pool, page);
 }
 
+int ion_page_pool_clean(struct ion_page_pool *pool, int nr_to_clean)
+{
+	int cleaned;
+
+	for (cleaned = 0; cleaned < nr_to_clean; cleaned++) {
+		struct ion_page_pool_item *item;
+
+		mutex_lock(&pool->mutex);
+		if (!pool->dirty_count) {
+			mutex_unlock(&pool->mutex);
+			break;
+		}
+		item = ion_page_pool_remove_item(pool, &pool->dirty_items,
+						 &pool->dirty_count);
+		mutex_unlock(&pool->mutex);
+
+		ion_page_pool_zero(pool, item->page);
+
+		mutex_lock(&pool->mutex);
+		ion_page_pool_add_clean(pool, item);
+		mutex_unlock(&pool->mutex);
+	}
+
+	return cleaned;
+}
+
 static int ion_page_pool_total(struct ion_page_pool *pool, bool high)
 {
 	int total = 0;
@@ -128,6 +194,7 @@ static int ion_page_pool_total(struct ion_page_pool *pool, bool high)
 	total += high ? (pool->high_count + pool->low_count) *
 		(1 << pool->order) :
 			pool->low_count * (1 << pool->order);
+	total += pool->dirty_count * (1 << pool->order);
 	return total;
 }
 
@@ -142,11 +209,20 @@ int ion_page_pool_shrink(struct ion_page_pool *pool, gfp_t gfp_mask,
 	for (i = 0; i < nr_to_scan; i++) {
 		struct page *page;
 
+		/*
+		 * dirty pages go first, there is no point in having zeroed
+		 * them just to give them back
+		 */
 		mutex_lock(&pool->mutex);
-		if (pool->low_count) {
-			page = ion_page_pool_remove(pool, false);
+		if (pool->dirty_count) {
+			page = ion_page_pool_remove(pool, &pool->dirty_items,
+						    &pool->dirty_count);
+		} else if (pool->low_count) {
+			page = ion_page_pool_remove(pool, &pool->low_items,
+						    &pool->low_count);
 		} else if (high && pool->high_count) {
-			page = ion_page_pool_remove(pool, true);
+			page = ion_page_pool_remove(pool, &pool->high_items,
+						    &pool->high_count);
 		} else {
 			mutex_unlock(&pool->mutex);
 			break;
@@ -168,9 +244,15 @@ struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order)
         }
 	pool->high_count = 0;
 	pool->low_count = 0;
+	pool->dirty_count = 0;
+	pool->clean_hits = 0;
+	pool->dirty_hits = 0;
+	pool->miss_count = 0;
 	INIT_LIST_HEAD(&pool->low_items);
 	INIT_LIST_HEAD(&pool->high_items);
-	pool->gfp_mask = gfp_mask;
+	INIT_LIST_HEAD(&pool->dirty_items);
+	/* pool pages are zeroed by ion_page_pool_zero() */
+	pool->gfp_mask = gfp_mask & ~__GFP_ZERO;
 	pool->order = order;
 	mutex_init(&pool->mutex);
 	plist_node_init(&pool->list, order);
@@ -22,7 +22,9 @@
 #include <linux/kref.h>
 #include <linux/mm_types.h>
 #include <linux/mutex.h>
+#include <linux/plist.h>
 #include <linux/rbtree.h>
+#include <linux/rcupdate.h>
 #include <linux/sched.h>
 #include <linux/shrinker.h>
 #include <linux/types.h>
@@ -66,10 +68,15 @@ struct ion_device {
  * @display_name:	used for debugging (unique version of @name)
  * @display_serial:	used for debugging (to make display_name unique)
  * @task:		used for debugging
+ * @lookup_count:	handle lookups by id, done without @lock
+ * @import_count:	dma-bufs imported into a new handle
+ * @import_hit_count:	imports that found an existing handle
+ * @share_count:	handles exported as dma-buf
  *
  * A client represents a list of buffers this client may access.
  * The mutex stored here is used to protect both handles tree
  * as well as the handles themselves, and should be held while modifying either.
+ * Lookups by id only need rcu_read_lock(), see ion_handle_get_by_id().
  */
 struct ion_client {
 	struct rb_node node;
@@ -84,6 +91,10 @@ struct ion_client {
 	pid_t pid;
 	struct dentry *debug_root;
     char dbg_name[ION_MM_DBG_NAME_LEN]; //add by K for debug!
+	atomic_t lookup_count;
+	atomic_t import_count;
+	atomic_t import_hit_count;
+	atomic_t share_count;
 };
 
 struct ion_handle_debug {
@@ -101,9 +112,11 @@ struct ion_handle_debug {
  * @node:		node in the client's handle rbtree
  * @kmap_cnt:		count of times this client has mapped to kernel
  * @id:			client-unique id allocated by client->idr
+ * @rcu:		defers the free past lockless lookups in client->idr
  *
  * Modifications to node, map_cnt or mapping should be protected by the
  * lock in the client.  Other fields are never changed after initialization.
+ * The last reference is always dropped with the client lock held.
  */
 struct ion_handle {
 	struct kref ref;
@@ -113,6 +126,7 @@ struct ion_handle {
 	struct rb_node node;
 	unsigned int kmap_cnt;
 	int id;
+	struct rcu_head rcu;
 #if ION_RUNTIME_DEBUGGER
         struct ion_handle_debug dbg; //add by K for debug
 #endif
@@ -187,6 +201,8 @@ void ion_buffer_destroy(struct ion_buffer *buffer);
  * @map_kernel		map memory to the kernel
  * @unmap_kernel	unmap memory to the kernel
  * @map_user		map memory to userspace
+ * @clean		zero and cache maintain pages the heap keeps cached
+ *			for reuse, called from the deferred free thread
  *
  * allocate, phys, and map_user return 0 on success, -errno on error.
  * map_dma and map_kernel return pointer on success, ERR_PTR on
@@ -211,12 +227,14 @@ struct ion_heap_ops {
 			 struct vm_area_struct *vma);
 	int (*shrink)(struct ion_heap *heap, gfp_t gfp_mask, int nr_to_scan);
 	void (*add_freelist) (struct ion_buffer *buffer);
+	void (*clean)(struct ion_heap *heap);
 };
 
 /**
  * heap flags - flags between the heaps and core ion code
  */
 #define ION_HEAP_FLAG_DEFER_FREE (1 << 0)
+#define ION_HEAP_FLAG_DEFER_ZERO (1 << 1)
 
 /**
  * private flags - flags internal to ion
@@ -229,6 +247,33 @@ struct ion_heap_ops {
  */
 #define ION_PRIV_FLAG_SHRINKER_FREE (1 << 0)
 
+struct ion_page_pool;
+
+/**
+ * pool pressure levels, see ion_heap_pressure()
+ */
+enum {
+	ION_PRESSURE_NONE,
+	ION_PRESSURE_LOW,
+	ION_PRESSURE_MEDIUM,
+	ION_PRESSURE_CRITICAL,
+};
+
+#define ION_POOL_HISTORY	64
+#define ION_POOL_HISTORY_POOLS	8
+
+/**
+ * struct ion_pool_sample - pool sizes at a point in time
+ * @time:		jiffies when the sample was taken
+ * @level:		pressure level at that time
+ * @pages:		pages held by each pool, in heap->pools order
+ */
+struct ion_pool_sample {
+	unsigned long time;
+	int level;
+	unsigned long pages[ION_POOL_HISTORY_POOLS];
+};
+
 /**
  * struct ion_heap - represents a heap in the system
  * @node:		rb node to put the heap on the device's tree of heaps
@@ -246,6 +291,18 @@ struct ion_heap_ops {
  * @lock:		protects the free list
  * @waitqueue:		queue to wait on from deferred free thread
  * @task:		task struct of deferred free thread
+ * @clean_pending:	the heap has pooled pages for @task to clean or trim
+ * @pools:		page pools registered with ion_heap_add_pool()
+ * @pool_count:		number of entries on @pools
+ * @pool_high_wm:	pages the pools may hold without memory pressure
+ * @pool_low_wm:	pages the pools may hold while kswapd is running
+ * @pressure:		last pressure level reported for the heap
+ * @pressure_stamp:	jiffies of the last pressure report
+ * @pressure_nb:	feeds system wide vmpressure levels to the heap
+ * @pool_lock:		protects the pool history
+ * @pool_history:	ring of ION_POOL_HISTORY pool size samples
+ * @pool_history_head:	number of samples taken so far
+ * @pool_history_stamp:	jiffies of the last sample
  * @debug_show:		called when heap debug file is read to add any
  *			heap specific debug info to output
  *
@@ -268,6 +325,18 @@ struct ion_heap {
 	spinlock_t free_lock;
 	wait_queue_head_t waitqueue;
 	struct task_struct *task;
+	atomic_t clean_pending;
+	struct plist_head pools;
+	int pool_count;
+	u32 pool_high_wm;
+	u32 pool_low_wm;
+	atomic_t pressure;
+	unsigned long pressure_stamp;
+	struct notifier_block pressure_nb;
+	struct mutex pool_lock;
+	struct ion_pool_sample *pool_history;
+	unsigned int pool_history_head;
+	unsigned long pool_history_stamp;
 	int (*debug_show)(struct ion_heap *heap, struct seq_file *, void *);
 };
 
@@ -333,6 +402,15 @@ int ion_heap_pages_zero(struct page *page, size_t size, pgprot_t pgprot);
  */
 void ion_heap_init_shrinker(struct ion_heap *heap);
 
+/**
+ * ion_heap_exit_shrinker
+ * @heap:		the heap
+ *
+ * Undoes ion_heap_init_shrinker(), including the vmpressure notifier of
+ * ION_HEAP_FLAG_DEFER_ZERO heaps. Called from ion_heap_destroy().
+ */
+void ion_heap_exit_shrinker(struct ion_heap *heap);
+
 /**
  * ion_heap_init_deferred_free -- initialize deferred free functionality
  * @heap:		the heap
@@ -343,6 +421,43 @@ void ion_heap_init_shrinker(struct ion_heap *heap);
  */
 int ion_heap_init_deferred_free(struct ion_heap *heap);
 
+/**
+ * ion_heap_schedule_clean - have the deferred free thread clean the heap
+ * @heap:		the heap
+ *
+ * If a heap sets the ION_HEAP_FLAG_DEFER_ZERO flag, the deferred free
+ * thread is started for it even without ION_HEAP_FLAG_DEFER_FREE and
+ * the heap's clean op is called from it some time after this.
+ */
+void ion_heap_schedule_clean(struct ion_heap *heap);
+
+/**
+ * ion_heap_add_pool - register a page pool with its heap
+ * @heap:		the heap, its pools list must be initialized
+ * @pool:		the pool
+ *
+ * Heaps setting ION_HEAP_FLAG_DEFER_ZERO register their pools so the
+ * deferred free thread can keep them within the heap's watermarks.
+ */
+void ion_heap_add_pool(struct ion_heap *heap, struct ion_page_pool *pool);
+
+/**
+ * ion_heap_pressure - report memory pressure to a heap
+ * @heap:		the heap
+ * @level:		one of ION_PRESSURE_*
+ *
+ * For about a second after this the heap's pools are trimmed to
+ * pool_low_wm for ION_PRESSURE_LOW and emptied for higher levels.
+ */
+void ion_heap_pressure(struct ion_heap *heap, int level);
+
+/**
+ * ion_heap_pool_debug_show - print the pool history of a heap
+ * @heap:		the heap
+ * @s:			seq_file to print to
+ */
+int ion_heap_pool_debug_show(struct ion_heap *heap, struct seq_file *s);
+
 /**
  * ion_heap_freelist_add - add a buffer to the deferred free list
  * @heap:		the heap
@@ -447,6 +562,11 @@ void ion_carveout_free(struct ion_heap *heap, ion_phys_addr_t addr,
  * @low_count:		number of lowmem items in the pool
  * @high_items:		list of highmem items
  * @low_items:		list of lowmem items
+ * @dirty_count:	number of items that still need to be zeroed
+ * @dirty_items:	list of items that still need to be zeroed
+ * @clean_hits:		allocations served from the clean lists
+ * @dirty_hits:		allocations that had to zero a dirty item
+ * @miss_count:		allocations that went to the page allocator
  * @mutex:		lock protecting this struct and especially the count
  *			item list
  * @gfp_mask:		gfp_mask to use from alloc
@@ -457,12 +577,21 @@ void ion_carveout_free(struct ion_heap *heap, ion_phys_addr_t addr,
  * Keeping a pool of pages that is ready for dma, ie any cached mapping have
  * been invalidated from the cache, provides a significant peformance benefit
  * on many systems
+ *
+ * Pages given back with ion_page_pool_free() are dirty and are only moved
+ * to the high/low lists once ion_page_pool_clean() has zeroed them, so
+ * that allocating from a warm pool does not have to touch the memory.
  */
 struct ion_page_pool {
 	int high_count;
 	int low_count;
 	struct list_head high_items;
 	struct list_head low_items;
+	int dirty_count;
+	struct list_head dirty_items;
+	unsigned long clean_hits;
+	unsigned long dirty_hits;
+	unsigned long miss_count;
 	struct mutex mutex;
 	gfp_t gfp_mask;
 	unsigned int order;
@@ -474,6 +603,14 @@ void ion_page_pool_destroy(struct ion_page_pool *);
 void *ion_page_pool_alloc(struct ion_page_pool *);
 void ion_page_pool_free(struct ion_page_pool *, struct page *);
 
+/** ion_page_pool_clean - zero dirty pages in the pool
+ * @pool:		the pool
+ * @nr_to_clean:	maximum number of items to clean
+ *
+ * returns the number of items cleaned
+ */
+int ion_page_pool_clean(struct ion_page_pool *pool, int nr_to_clean);
+
 /** ion_page_pool_shrink - shrinks the size of the memory cached in the pool
  * @pool:		the pool
  * @gfp_mask:		the memory type to reclaim
@@ -206,16 +206,17 @@ static void ion_system_heap_free(struct ion_buffer *buffer)
 	LIST_HEAD(pages);
 	int i;
 
-	/* uncached pages come from the page pools, zero them before returning
-	   for security purposes (other allocations are zerod at alloc time */
-	if (!cached && !(buffer->private_flags & ION_PRIV_FLAG_SHRINKER_FREE))
-		ion_heap_buffer_zero(buffer);
-
+	/* uncached pages go back to the page pools dirty, the deferred free
+	   thread zeroes them for security purposes before they are reused
+	   (other allocations are zeroed at alloc time) */
 	for_each_sg(table->sgl, sg, table->nents, i)
 		free_buffer_page(sys_heap, buffer, sg_page(sg),
 				get_order(sg->length));
 	sg_free_table(table);
 	kfree(table);
+
+	if (!cached && !(buffer->private_flags & ION_PRIV_FLAG_SHRINKER_FREE))
+		ion_heap_schedule_clean(heap);
 }
 
 static struct sg_table *ion_system_heap_map_dma(struct ion_heap *heap,
@@ -247,6 +248,17 @@ static int ion_system_heap_shrink(struct ion_heap *heap, gfp_t gfp_mask,
 	return nr_total;
 }
 
+static void ion_system_heap_clean(struct ion_heap *heap)
+{
+	struct ion_system_heap *sys_heap;
+	int i;
+
+	sys_heap = container_of(heap, struct ion_system_heap, heap);
+
+	for (i = 0; i < num_orders; i++)
+		ion_page_pool_clean(sys_heap->pools[i], INT_MAX);
+}
+
 static struct ion_heap_ops system_heap_ops = {
 	.allocate = ion_system_heap_allocate,
 	.free = ion_system_heap_free,
@@ -256,6 +268,7 @@ static struct ion_heap_ops system_heap_ops = {
 	.unmap_kernel = ion_heap_unmap_kernel,
 	.map_user = ion_heap_map_user,
 	.shrink = ion_system_heap_shrink,
+	.clean = ion_system_heap_clean,
 };
 
 static int ion_system_heap_debug_show(struct ion_heap *heap, struct seq_file *s,
@@ -274,6 +287,9 @@ static int ion_system_heap_debug_show(struct ion_heap *heap, struct seq_file *s,
 		seq_printf(s, "%d order %u lowmem pages in pool = %lu total\n",
 			   pool->low_count, pool->order,
 			   (1 << pool->order) * PAGE_SIZE * pool->low_count);
+		seq_printf(s, "%d order %u dirty pages in pool, hits clean %lu dirty %lu miss %lu\n",
+			   pool->dirty_count, pool->order, pool->clean_hits,
+			   pool->dirty_hits, pool->miss_count);
 	}
 	return 0;
 }
@@ -288,7 +304,8 @@ struct ion_heap *ion_system_heap_create(struct ion_platform_heap *unused)
 		return ERR_PTR(-ENOMEM);
 	heap->heap.ops = &system_heap_ops;
 	heap->heap.type = ION_HEAP_TYPE_SYSTEM;
-	heap->heap.flags = ION_HEAP_FLAG_DEFER_FREE;
+	heap->heap.flags = ION_HEAP_FLAG_DEFER_FREE | ION_HEAP_FLAG_DEFER_ZERO;
+	plist_head_init(&heap->heap.pools);
 	heap->pools = kzalloc(sizeof(struct ion_page_pool *) * num_orders,
 			      GFP_KERNEL);
 	if (!heap->pools)
@@ -303,6 +320,7 @@ struct ion_heap *ion_system_heap_create(struct ion_platform_heap *unused)
 		if (!pool)
 			goto err_create_pool;
 		heap->pools[i] = pool;
+		ion_heap_add_pool(&heap->heap, pool);
 	}
 
 	heap->heap.debug_show = ion_system_heap_debug_show;
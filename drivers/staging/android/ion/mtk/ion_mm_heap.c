@@ -294,18 +294,18 @@ void ion_mm_heap_free(struct ion_buffer *buffer)
 
     mm_heap_total_memory -= buffer->size;
 
-	/* uncached pages come from the page pools, zero them before returning
-	   for security purposes (other allocations are zerod at alloc time */
-	if (!(buffer->private_flags & ION_PRIV_FLAG_SHRINKER_FREE))
-		ion_heap_buffer_zero(buffer);
-
     ion_mm_heap_free_bufferInfo(buffer);
     
+	/* pages go back to the pools dirty, the deferred free thread zeroes
+	   them for security purposes before they are handed out again */
     for_each_sg(table->sgl, sg, table->nents, i)
 		free_buffer_page(sys_heap, buffer, sg_page(sg),
 				get_order(sg->length));
     sg_free_table(table);
     kfree(table);
+
+	if (!(buffer->private_flags & ION_PRIV_FLAG_SHRINKER_FREE))
+		ion_heap_schedule_clean(heap);
 }
 
 struct sg_table *ion_mm_heap_map_dma(struct ion_heap *heap,
@@ -340,6 +340,19 @@ static int ion_mm_heap_shrink(struct ion_heap *heap, gfp_t gfp_mask,
 	return nr_total;
 }
 
+static void ion_mm_heap_clean(struct ion_heap *heap)
+{
+	struct ion_system_heap *sys_heap;
+	int i;
+
+	sys_heap = container_of(heap, struct ion_system_heap, heap);
+
+	for (i = 0; i < num_orders; i++) {
+		ion_page_pool_clean(sys_heap->pools[i], INT_MAX);
+		ion_page_pool_clean(sys_heap->cached_pools[i], INT_MAX);
+	}
+}
+
 static int ion_mm_heap_phys(struct ion_heap *heap,
                             struct ion_buffer *buffer,
                             ion_phys_addr_t *addr, size_t *len)
@@ -393,6 +406,7 @@ static struct ion_heap_ops system_heap_ops = {
     .map_user = ion_heap_map_user,
     .phys = ion_mm_heap_phys,
 	.shrink = ion_mm_heap_shrink,
+	.clean = ion_mm_heap_clean,
     .add_freelist = ion_mm_heap_add_freelist,
 };
 
@@ -415,6 +429,9 @@ static int ion_mm_heap_debug_show(struct ion_heap *heap, struct seq_file *s,
 		ION_PRINT_LOG_OR_SEQ(s, "%d order %u lowmem pages in pool = %lu total\n",
 			   pool->low_count, pool->order,
 			   (1 << pool->order) * PAGE_SIZE * pool->low_count);
+		ION_PRINT_LOG_OR_SEQ(s, "%d order %u dirty pages in pool, hits clean %lu dirty %lu miss %lu\n",
+			   pool->dirty_count, pool->order, pool->clean_hits,
+			   pool->dirty_hits, pool->miss_count);
 
 		pool = sys_heap->cached_pools[i];
 		ION_PRINT_LOG_OR_SEQ(s, "%d order %u highmem pages in cached_pool = %lu total\n",
@@ -423,6 +440,9 @@ static int ion_mm_heap_debug_show(struct ion_heap *heap, struct seq_file *s,
 		ION_PRINT_LOG_OR_SEQ(s, "%d order %u lowmem pages in cached_pool = %lu total\n",
 			   pool->low_count, pool->order,
 			   (1 << pool->order) * PAGE_SIZE * pool->low_count);
+		ION_PRINT_LOG_OR_SEQ(s, "%d order %u dirty pages in cached_pool, hits clean %lu dirty %lu miss %lu\n",
+			   pool->dirty_count, pool->order, pool->clean_hits,
+			   pool->dirty_hits, pool->miss_count);
 	}
     if (heap->flags & ION_HEAP_FLAG_DEFER_FREE)
     {
@@ -677,7 +697,8 @@ struct ion_heap *ion_mm_heap_create(struct ion_platform_heap *unused)
 	heap->heap.ops = &system_heap_ops;
 	heap->heap.type = ION_HEAP_TYPE_MULTIMEDIA;
 	/*heap->heap.flags = ION_HEAP_FLAG_DEFER_FREE;*/
-	heap->heap.flags = 0;
+	heap->heap.flags = ION_HEAP_FLAG_DEFER_ZERO;
+	plist_head_init(&heap->heap.pools);
 	heap->pools = kzalloc(sizeof(struct ion_page_pool *) * num_orders, GFP_KERNEL);
 	if (!heap->pools)
 		goto err_alloc_pools;
@@ -698,11 +719,13 @@ struct ion_heap *ion_mm_heap_create(struct ion_platform_heap *unused)
 		if (!pool)
 			goto err_create_pool;
 		heap->pools[i] = pool;
+		ion_heap_add_pool(&heap->heap, pool);
 		
 		pool = ion_page_pool_create(gfp_flags, orders[i]);
 		if (!pool)
 			goto err_create_pool;
 		heap->cached_pools[i] = pool;
+		ion_heap_add_pool(&heap->heap, pool);
 	}
 
 	heap->heap.debug_show = ion_mm_heap_debug_show;
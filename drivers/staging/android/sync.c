@@ -42,17 +42,63 @@ static int _sync_pt_has_signaled(struct sync_pt *pt);
 static void sync_fence_free(struct kref *kref);
 static void sync_dump(void);
 
+#ifdef CONFIG_DEBUG_FS
+/*
+ * The global timeline and fence lists are only walked by debugfs and
+ * sync_dump(), so don't make every create/release pay for them otherwise.
+ */
 static LIST_HEAD(sync_timeline_list_head);
 static DEFINE_SPINLOCK(sync_timeline_list_lock);
 
 static LIST_HEAD(sync_fence_list_head);
 static DEFINE_SPINLOCK(sync_fence_list_lock);
 
+static void sync_timeline_debug_add(struct sync_timeline *obj)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&sync_timeline_list_lock, flags);
+	list_add_tail(&obj->sync_timeline_list, &sync_timeline_list_head);
+	spin_unlock_irqrestore(&sync_timeline_list_lock, flags);
+}
+
+static void sync_timeline_debug_remove(struct sync_timeline *obj)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&sync_timeline_list_lock, flags);
+	list_del(&obj->sync_timeline_list);
+	spin_unlock_irqrestore(&sync_timeline_list_lock, flags);
+}
+
+static void sync_fence_debug_add(struct sync_fence *fence)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&sync_fence_list_lock, flags);
+	list_add_tail(&fence->sync_fence_list, &sync_fence_list_head);
+	spin_unlock_irqrestore(&sync_fence_list_lock, flags);
+}
+
+static void sync_fence_debug_remove(struct sync_fence *fence)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&sync_fence_list_lock, flags);
+	list_del(&fence->sync_fence_list);
+	spin_unlock_irqrestore(&sync_fence_list_lock, flags);
+}
+#else
+static inline void sync_timeline_debug_add(struct sync_timeline *obj) { }
+static inline void sync_timeline_debug_remove(struct sync_timeline *obj) { }
+static inline void sync_fence_debug_add(struct sync_fence *fence) { }
+static inline void sync_fence_debug_remove(struct sync_fence *fence) { }
+#endif
+
 struct sync_timeline *sync_timeline_create(const struct sync_timeline_ops *ops,
 					   int size, const char *name)
 {
 	struct sync_timeline *obj;
-	unsigned long flags;
 
 	if (size < sizeof(struct sync_timeline))
 		return NULL;
@@ -71,9 +117,7 @@ struct sync_timeline *sync_timeline_create(const struct sync_timeline_ops *ops,
 	INIT_LIST_HEAD(&obj->active_list_head);
 	spin_lock_init(&obj->active_list_lock);
 
-	spin_lock_irqsave(&sync_timeline_list_lock, flags);
-	list_add_tail(&obj->sync_timeline_list, &sync_timeline_list_head);
-	spin_unlock_irqrestore(&sync_timeline_list_lock, flags);
+	sync_timeline_debug_add(obj);
 
 	return obj;
 }
@@ -83,11 +127,8 @@ static void sync_timeline_free(struct kref *kref)
 {
 	struct sync_timeline *obj =
 		container_of(kref, struct sync_timeline, kref);
-	unsigned long flags;
 
-	spin_lock_irqsave(&sync_timeline_list_lock, flags);
-	list_del(&obj->sync_timeline_list);
-	spin_unlock_irqrestore(&sync_timeline_list_lock, flags);
+	sync_timeline_debug_remove(obj);
 
 	if (obj->ops->release_obj)
 		obj->ops->release_obj(obj);
@@ -153,8 +194,14 @@ void sync_timeline_signal(struct sync_timeline *obj)
 
 		if (_sync_pt_has_signaled(pt)) {
 			list_del_init(pos);
-			list_add(&pt->signaled_list, &signaled_pts);
+			list_add_tail(&pt->signaled_list, &signaled_pts);
 			kref_get(&pt->fence->kref);
+		} else if (obj->ops->in_order) {
+			/*
+			 * the active list is sorted by signal order so
+			 * nothing after an unsignaled pt can have signaled
+			 */
+			break;
 		}
 	}
 
@@ -225,8 +272,40 @@ static struct sync_pt *sync_pt_dup(struct sync_pt *pt)
 	return pt->parent->ops->dup(pt);
 }
 
-/* Adds a sync pt to the active queue.  Called when added to a fence */
-static void sync_pt_activate(struct sync_pt *pt)
+/*
+ * Inserts pt into its parent's active list, keeping the list in signal
+ * order.  New pts are almost always the latest on their timeline so the
+ * walk starts at the tail.  Call with pt->parent->active_list_lock held.
+ */
+static void sync_timeline_insert_active(struct sync_timeline *obj,
+					struct sync_pt *pt)
+{
+	struct list_head *pos;
+
+	if (!obj->ops->in_order) {
+		list_add_tail(&pt->active_list, &obj->active_list_head);
+		return;
+	}
+
+	for (pos = obj->active_list_head.prev; pos != &obj->active_list_head;
+	     pos = pos->prev) {
+		struct sync_pt *active_pt =
+			container_of(pos, struct sync_pt, active_list);
+
+		if (obj->ops->compare(active_pt, pt) != 1)
+			break;
+	}
+
+	list_add(&pt->active_list, pos);
+}
+
+/*
+ * Adds a sync pt to the active queue.  Called when added to a fence.
+ *
+ * Returns the pt's status.  If it is non-zero the pt was not queued and
+ * the caller is responsible for passing it to sync_fence_signal_pt().
+ */
+static int sync_pt_activate(struct sync_pt *pt)
 {
 	struct sync_timeline *obj = pt->parent;
 	unsigned long flags;
@@ -238,10 +317,12 @@ static void sync_pt_activate(struct sync_pt *pt)
 	if (err != 0)
 		goto out;
 
-	list_add_tail(&pt->active_list, &obj->active_list_head);
+	sync_timeline_insert_active(obj, pt);
 
 out:
 	spin_unlock_irqrestore(&obj->active_list_lock, flags);
+
+	return err;
 }
 
 static int sync_fence_release(struct inode *inode, struct file *file);
@@ -260,7 +341,6 @@ static const struct file_operations sync_fence_fops = {
 static struct sync_fence *sync_fence_alloc(const char *name)
 {
 	struct sync_fence *fence;
-	unsigned long flags;
 
 	fence = kzalloc(sizeof(struct sync_fence), GFP_KERNEL);
 	if (fence == NULL)
@@ -280,9 +360,7 @@ static struct sync_fence *sync_fence_alloc(const char *name)
 
 	init_waitqueue_head(&fence->wq);
 
-	spin_lock_irqsave(&sync_fence_list_lock, flags);
-	list_add_tail(&fence->sync_fence_list, &sync_fence_list_head);
-	spin_unlock_irqrestore(&sync_fence_list_lock, flags);
+	sync_fence_debug_add(fence);
 
 	return fence;
 
@@ -305,99 +383,89 @@ struct sync_fence *sync_fence_create(const char *name, struct sync_pt *pt)
 
 	pt->fence = fence;
 	list_add(&pt->pt_list, &fence->pt_list_head);
-	sync_pt_activate(pt);
+	atomic_set(&fence->pending, 1);
 
 	/*
-	 * signal the fence in case pt was activated before
+	 * signal the fence in case pt was signaled before
 	 * sync_pt_activate(pt) was called
 	 */
-	sync_fence_signal_pt(pt);
+	if (sync_pt_activate(pt))
+		sync_fence_signal_pt(pt);
 
 	return fence;
 }
 EXPORT_SYMBOL(sync_fence_create);
 
-static int sync_fence_copy_pts(struct sync_fence *dst, struct sync_fence *src)
+static int sync_fence_add_dup_pt(struct sync_fence *dst, struct sync_pt *pt)
 {
-	struct list_head *pos;
+	struct sync_pt *new_pt = sync_pt_dup(pt);
 
-	list_for_each(pos, &src->pt_list_head) {
-		struct sync_pt *orig_pt =
-			container_of(pos, struct sync_pt, pt_list);
-		// [MTK] {{{
-		// rjan Eide <orjan.eide@arm.com>
-		struct sync_pt *new_pt;
-
-		/* Skip already signaled points */
-		if (1 == orig_pt->status)
-			continue;
-		// [MTK] }}}
-
-		new_pt = sync_pt_dup(orig_pt);
-
-		if (new_pt == NULL)
-			return -ENOMEM;
+	if (new_pt == NULL)
+		return -ENOMEM;
 
-		new_pt->fence = dst;
-		list_add(&new_pt->pt_list, &dst->pt_list_head);
-	}
+	new_pt->fence = dst;
+	list_add_tail(&new_pt->pt_list, &dst->pt_list_head);
+	atomic_inc(&dst->pending);
 
 	return 0;
 }
 
-static int sync_fence_merge_pts(struct sync_fence *dst, struct sync_fence *src)
+static struct sync_pt *sync_fence_next_pt(struct sync_fence *fence,
+					  struct sync_pt *pt)
 {
-	struct list_head *src_pos, *dst_pos, *n;
+	// [MTK] {{{
+	// rjan Eide <orjan.eide@arm.com>
+	/* Skip already signaled points */
+	list_for_each_entry_continue(pt, &fence->pt_list_head, pt_list) {
+		if (1 != pt->status)
+			return pt;
+	}
+	// [MTK] }}}
 
-	list_for_each(src_pos, &src->pt_list_head) {
-		struct sync_pt *src_pt =
-			container_of(src_pos, struct sync_pt, pt_list);
-		bool collapsed = false;
+	return NULL;
+}
 
-		// [MTK] {{{
-		// rjan Eide <orjan.eide@arm.com>
-		/* Skip already signaled points */
-		if (1 == src_pt->status)
-			continue;
-		// [MTK] }}}
+/*
+ * Both fences keep their pts sorted by parent timeline with at most one pt
+ * per timeline, so the merge is a single linear pass over the two lists.
+ * Two sync_pts on the same timeline collapse to a single sync_pt that will
+ * signal at the later of the two.  dst ends up sorted the same way.
+ */
+static int sync_fence_merge_pts(struct sync_fence *dst,
+				struct sync_fence *a, struct sync_fence *b)
+{
+	struct sync_pt *a_pt, *b_pt;
+	int err = 0;
 
-		list_for_each_safe(dst_pos, n, &dst->pt_list_head) {
-			struct sync_pt *dst_pt =
-				container_of(dst_pos, struct sync_pt, pt_list);
-			/* collapse two sync_pts on the same timeline
-			 * to a single sync_pt that will signal at
-			 * the later of the two
-			 */
-			if (dst_pt->parent == src_pt->parent) {
-				if (dst_pt->parent->ops->compare(dst_pt, src_pt)
-						 == -1) {
-					struct sync_pt *new_pt =
-						sync_pt_dup(src_pt);
-					if (new_pt == NULL)
-						return -ENOMEM;
-
-					new_pt->fence = dst;
-					list_replace(&dst_pt->pt_list,
-						     &new_pt->pt_list);
-					sync_pt_free(dst_pt);
-				}
-				collapsed = true;
-				break;
-			}
+	a_pt = sync_fence_next_pt(a, list_entry(&a->pt_list_head,
+						struct sync_pt, pt_list));
+	b_pt = sync_fence_next_pt(b, list_entry(&b->pt_list_head,
+						struct sync_pt, pt_list));
+
+	while (a_pt && b_pt && !err) {
+		if (a_pt->parent < b_pt->parent) {
+			err = sync_fence_add_dup_pt(dst, a_pt);
+			a_pt = sync_fence_next_pt(a, a_pt);
+		} else if (a_pt->parent > b_pt->parent) {
+			err = sync_fence_add_dup_pt(dst, b_pt);
+			b_pt = sync_fence_next_pt(b, b_pt);
+		} else {
+			if (a_pt->parent->ops->compare(a_pt, b_pt) == -1)
+				err = sync_fence_add_dup_pt(dst, b_pt);
+			else
+				err = sync_fence_add_dup_pt(dst, a_pt);
+			a_pt = sync_fence_next_pt(a, a_pt);
+			b_pt = sync_fence_next_pt(b, b_pt);
 		}
+	}
 
-		if (!collapsed) {
-			struct sync_pt *new_pt = sync_pt_dup(src_pt);
-
-			if (new_pt == NULL)
-				return -ENOMEM;
+	for (; a_pt && !err; a_pt = sync_fence_next_pt(a, a_pt))
+		err = sync_fence_add_dup_pt(dst, a_pt);
 
-			new_pt->fence = dst;
-			list_add(&new_pt->pt_list, &dst->pt_list_head);
-		}
-	}
+	for (; b_pt && !err; b_pt = sync_fence_next_pt(b, b_pt))
+		err = sync_fence_add_dup_pt(dst, b_pt);
 
-	return 0;
+	return err;
 }
 
 static void sync_fence_detach_pts(struct sync_fence *fence)
@@ -450,42 +518,18 @@ void sync_fence_install(struct sync_fence *fence, int fd)
 }
 EXPORT_SYMBOL(sync_fence_install);
 
-static int sync_fence_get_status(struct sync_fence *fence)
-{
-	struct list_head *pos;
-	int status = 1;
-
-	list_for_each(pos, &fence->pt_list_head) {
-		struct sync_pt *pt = container_of(pos, struct sync_pt, pt_list);
-		int pt_status = pt->status;
-
-		if (pt_status < 0) {
-			status = pt_status;
-			break;
-		} else if (status == 1) {
-			status = pt_status;
-		}
-	}
-
-	return status;
-}
-
 struct sync_fence *sync_fence_merge(const char *name,
 				    struct sync_fence *a, struct sync_fence *b)
 {
 	struct sync_fence *fence;
-	struct list_head *pos;
+	struct sync_pt *pt;
 	int err;
 
 	fence = sync_fence_alloc(name);
 	if (fence == NULL)
 		return NULL;
 
-	err = sync_fence_copy_pts(fence, a);
-	if (err < 0)
-		goto err;
-
-	err = sync_fence_merge_pts(fence, b);
+	err = sync_fence_merge_pts(fence, a, b);
 	if (err < 0)
 		goto err;
 
@@ -493,28 +537,23 @@ struct sync_fence *sync_fence_merge(const char *name,
 	// rjan Eide <orjan.eide@arm.com>
 	/* Make sure there is at least one point in the fence */
 	if (list_empty(&fence->pt_list_head)) {
-		struct sync_pt *orig_pt = list_first_entry(&a->pt_list_head,
-						struct sync_pt, pt_list);
-		struct sync_pt *new_pt = sync_pt_dup(orig_pt);
-
-		new_pt->fence = fence;
-		list_add(&new_pt->pt_list, &fence->pt_list_head);
+		err = sync_fence_add_dup_pt(fence,
+					    list_first_entry(&a->pt_list_head,
+							     struct sync_pt,
+							     pt_list));
+		if (err < 0)
+			goto err;
 	}
 	// [MTK] }}}
 
-	list_for_each(pos, &fence->pt_list_head) {
-		struct sync_pt *pt =
-			container_of(pos, struct sync_pt, pt_list);
-		sync_pt_activate(pt);
-	}
-
 	/*
-	 * signal the fence in case one of it's pts were activated before
-	 * they were activated
+	 * signal the fence for any pts which had already signaled before
+	 * they were activated; the rest are signaled by their timelines.
 	 */
-	sync_fence_signal_pt(list_first_entry(&fence->pt_list_head,
-					      struct sync_pt,
-					      pt_list));
+	list_for_each_entry(pt, &fence->pt_list_head, pt_list) {
+		if (sync_pt_activate(pt))
+			sync_fence_signal_pt(pt);
+	}
 
 	return fence;
 err:
@@ -531,9 +570,15 @@ static void sync_fence_signal_pt(struct sync_pt *pt)
 	struct list_head *pos;
 	struct list_head *n;
 	unsigned long flags;
-	int status;
+	int status = pt->status;
 
-	status = sync_fence_get_status(fence);
+	/*
+	 * every pt reaches here exactly once, either from sync_pt_activate()
+	 * or from sync_timeline_signal(), so the fence has signaled when the
+	 * last pending pt does.  An error on any pt errors the whole fence.
+	 */
+	if (status > 0 && !atomic_dec_and_test(&fence->pending))
+		status = 0;
 
 	spin_lock_irqsave(&fence->waiter_list_lock, flags);
 	/*
@@ -677,7 +722,6 @@ static void sync_fence_free(struct kref *kref)
 static int sync_fence_release(struct inode *inode, struct file *file)
 {
 	struct sync_fence *fence = file->private_data;
-	unsigned long flags;
 
 	/*
 	 * We need to remove all ways to access this fence before droping
@@ -685,9 +729,7 @@ static int sync_fence_release(struct inode *inode, struct file *file)
 	 *
 	 * start with its membership in the global fence list
 	 */
-	spin_lock_irqsave(&sync_fence_list_lock, flags);
-	list_del(&fence->sync_fence_list);
-	spin_unlock_irqrestore(&sync_fence_list_lock, flags);
+	sync_fence_debug_remove(fence);
 
 	/*
 	 * remove its pts from their parents so that sync_timeline_signal()
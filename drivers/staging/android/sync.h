@@ -48,6 +48,9 @@ struct sync_fence;
  *			  to userspace by SYNC_IOC_FENCE_INFO.
  * @timeline_value_str: fill str with the value of the sync_timeline's counter
  * @pt_value_str:	fill str with the value of the sync_pt
+ * @in_order:		set if the timeline's pts always signal in @compare
+ *			  order.  Lets sync_timeline_signal() stop at the
+ *			  first active pt that has not yet signaled.
  */
 struct sync_timeline_ops {
 	const char *driver_name;
@@ -83,6 +86,9 @@ struct sync_timeline_ops {
 
 	/* optional */
 	void (*pt_value_str)(struct sync_pt *pt, char *str, int size);
+
+	/* optional */
+	bool in_order;
 };
 
 /**
@@ -94,8 +100,10 @@ struct sync_timeline_ops {
  * @child_list_head:	list of children sync_pts for this sync_timeline
  * @child_list_lock:	lock protecting @child_list_head, destroyed, and
  *			  sync_pt.status
- * @active_list_head:	list of active (unsignaled/errored) sync_pts
- * @sync_timeline_list:	membership in global sync_timeline_list
+ * @active_list_head:	list of active (unsignaled/errored) sync_pts.  Kept
+ *			  sorted by signal order if ops->in_order is set
+ * @sync_timeline_list:	membership in global sync_timeline_list (debugfs
+ *			  only)
  */
 struct sync_timeline {
 	struct kref		kref;
@@ -148,13 +156,15 @@ struct sync_pt {
  * @kref:		referenace count on fence.
  * @name:		name of sync_fence.  Useful for debugging
  * @pt_list_head:	list of sync_pts in ths fence.  immutable once fence
- *			  is created
+ *			  is created.  Sorted by parent timeline with at most
+ *			  one sync_pt per timeline
+ * @pending:		number of sync_pts that have not yet signaled
  * @waiter_list_head:	list of asynchronous waiters on this fence
  * @waiter_list_lock:	lock protecting @waiter_list_head and @status
  * @status:		1: signaled, 0:active, <0: error
  *
  * @wq:			wait queue for fence signaling
- * @sync_fence_list:	membership in global fence list
+ * @sync_fence_list:	membership in global fence list (debugfs only)
  */
 struct sync_fence {
 	struct file		*file;
@@ -163,6 +173,7 @@ struct sync_fence {
 
 	/* this list is immutable once the fence is created */
 	struct list_head	pt_list_head;
+	atomic_t		pending;
 
 	struct list_head	waiter_list_head;
 	spinlock_t		waiter_list_lock; /* also protects status */
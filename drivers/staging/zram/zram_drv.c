@@ -34,6 +34,11 @@
 #include <linux/vmalloc.h>
 #include <linux/proc_fs.h>
 #include <linux/seq_file.h>
+#ifdef CONFIG_ZRAM_WRITEBACK
+#include <linux/file.h>
+#include <linux/fs.h>
+#include <linux/workqueue.h>
+#endif
 
 #ifdef CONFIG_ZSM
 #include <linux/rbtree.h>
@@ -450,6 +455,97 @@ static int page_zero_filled(void *ptr)
 	return 1;
 }
 
+#ifdef CONFIG_ZRAM_WRITEBACK
+static unsigned long zram_alloc_bd_block(struct zram *zram)
+{
+	unsigned long blk_idx = 1;
+
+	/* Block 0 stays unused so that a handle of 0 still means empty */
+	for (;;) {
+		blk_idx = find_next_zero_bit(zram->bd_bitmap,
+					     zram->nr_bd_pages, blk_idx);
+		if (blk_idx >= zram->nr_bd_pages)
+			return 0;
+		if (!test_and_set_bit(blk_idx, zram->bd_bitmap))
+			return blk_idx;
+	}
+}
+
+static void zram_free_bd_block(struct zram *zram, unsigned long blk_idx)
+{
+	WARN_ON_ONCE(!test_and_clear_bit(blk_idx, zram->bd_bitmap));
+}
+
+static int zram_bd_rw(struct zram *zram, struct page *page,
+		      unsigned long blk_idx, int rw)
+{
+	struct bio *bio;
+	int ret;
+
+	bio = bio_alloc(GFP_NOIO, 1);
+	if (!bio)
+		return -ENOMEM;
+
+	bio->bi_sector = (sector_t)blk_idx << SECTORS_PER_PAGE_SHIFT;
+	bio->bi_bdev = zram->bdev;
+	if (!bio_add_page(bio, page, PAGE_SIZE, 0)) {
+		bio_put(bio);
+		return -EIO;
+	}
+
+	ret = submit_bio_wait(rw, bio);
+	bio_put(bio);
+	return ret;
+}
+
+struct zram_bd_read_work {
+	struct work_struct work;
+	struct zram *zram;
+	struct page *page;
+	unsigned long blk_idx;
+	int ret;
+};
+
+static void zram_bd_read_workfn(struct work_struct *work)
+{
+	struct zram_bd_read_work *rw =
+		container_of(work, struct zram_bd_read_work, work);
+
+	rw->ret = zram_bd_rw(rw->zram, rw->page, rw->blk_idx, READ);
+}
+
+/*
+ * Read back the page written back from @index into a new page. Called
+ * from zram_make_request(), where generic_make_request() would hold the
+ * bio back until we return, so the read is issued from a worker.
+ */
+static struct page *zram_bd_read(struct zram *zram, u32 index)
+{
+	struct zram_bd_read_work rw;
+
+	rw.page = alloc_page(GFP_NOIO);
+	if (!rw.page)
+		return ERR_PTR(-ENOMEM);
+	rw.zram = zram;
+	rw.blk_idx = zram->meta->table[index].handle;
+
+	INIT_WORK_ONSTACK(&rw.work, zram_bd_read_workfn);
+	queue_work(system_unbound_wq, &rw.work);
+	flush_work(&rw.work);
+	destroy_work_on_stack(&rw.work);
+
+	if (rw.ret) {
+		pr_err("Backing device read failed! err=%d, page=%u\n",
+			rw.ret, index);
+		zram_stat64_inc(zram, &zram->stats.failed_reads);
+		__free_page(rw.page);
+		return ERR_PTR(rw.ret);
+	}
+	zram_stat64_inc(zram, &zram->stats.bd_reads);
+	return rw.page;
+}
+#endif
+
 static void zram_free_page(struct zram *zram, size_t index)
 {
 	struct zram_meta *meta = zram->meta;
@@ -457,6 +553,17 @@ static void zram_free_page(struct zram *zram, size_t index)
 	u16 size = meta->table[index].size;
 #ifdef CONFIG_ZSM
 	int ret = 0;
+#endif
+#ifdef CONFIG_ZRAM_WRITEBACK
+	zram_clear_flag(meta, index, ZRAM_IDLE);
+	zram_clear_flag(meta, index, ZRAM_UNDER_WB);
+	if (zram_test_flag(meta, index, ZRAM_WB)) {
+		zram_clear_flag(meta, index, ZRAM_WB);
+		zram_free_bd_block(zram, handle);
+		zram_stat64_sub(zram, &zram->stats.bd_count, 1);
+		meta->table[index].handle = 0;
+		return;
+	}
 #endif
 	if (unlikely(!handle)) {
 		/*
@@ -564,6 +671,26 @@ static int zram_bvec_read(struct zram *zram, struct bio_vec *bvec,
 	struct zram_meta *meta = zram->meta;
 	page = bvec->bv_page;
 
+#ifdef CONFIG_ZRAM_WRITEBACK
+	/* Only the idle bit changes under the read lock */
+	zram_clear_flag(meta, index, ZRAM_IDLE);
+	if (zram_test_flag(meta, index, ZRAM_WB)) {
+		struct page *bd_page = zram_bd_read(zram, index);
+
+		if (IS_ERR(bd_page))
+			return PTR_ERR(bd_page);
+		user_mem = kmap_atomic(page);
+		uncmem = kmap_atomic(bd_page);
+		memcpy(user_mem + bvec->bv_offset, uncmem + offset,
+		       bvec->bv_len);
+		kunmap_atomic(uncmem);
+		kunmap_atomic(user_mem);
+		__free_page(bd_page);
+		flush_dcache_page(page);
+		return 0;
+	}
+#endif
+
 	if (unlikely(!meta->table[index].handle) ||
 			zram_test_flag(meta, index, ZRAM_ZERO)) {
 		handle_zero_page(bvec);
@@ -628,6 +755,20 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 			ret = -ENOMEM;
 			goto out;
 		}
+#ifdef CONFIG_ZRAM_WRITEBACK
+		if (zram_test_flag(meta, index, ZRAM_WB)) {
+			struct page *bd_page = zram_bd_read(zram, index);
+
+			if (IS_ERR(bd_page)) {
+				ret = PTR_ERR(bd_page);
+				goto out;
+			}
+			user_mem = kmap_atomic(bd_page);
+			memcpy(uncmem, user_mem, PAGE_SIZE);
+			kunmap_atomic(user_mem);
+			__free_page(bd_page);
+		} else
+#endif
 		ret = zram_decompress_page(zram, uncmem, index);
 		if (ret)
 			goto out;
@@ -923,6 +1064,22 @@ error:
 	bio_io_error(bio);
 }
 
+#ifdef CONFIG_ZRAM_WRITEBACK
+static void zram_reset_bdev(struct zram *zram)
+{
+	if (!zram->backing_dev)
+		return;
+
+	blkdev_put(zram->bdev, FMODE_READ | FMODE_WRITE | FMODE_EXCL);
+	filp_close(zram->backing_dev, NULL);
+	vfree(zram->bd_bitmap);
+	zram->backing_dev = NULL;
+	zram->bdev = NULL;
+	zram->nr_bd_pages = 0;
+	zram->bd_bitmap = NULL;
+}
+#endif
+
 static void __zram_reset_device(struct zram *zram)
 {
 	size_t index;
@@ -939,12 +1096,19 @@ static void __zram_reset_device(struct zram *zram)
 		unsigned long handle = meta->table[index].handle;
 		if (!handle)
 			continue;
+#ifdef CONFIG_ZRAM_WRITEBACK
+		if (zram_test_flag(meta, index, ZRAM_WB))
+			continue;
+#endif
 
 		zs_free(meta->mem_pool, handle);
 	}
 
 	zram_meta_free(zram->meta);
 	zram->meta = NULL;
+#ifdef CONFIG_ZRAM_WRITEBACK
+	zram_reset_bdev(zram);
+#endif
 	/* Reset stats */
 	memset(&zram->stats, 0, sizeof(zram->stats));
 
@@ -1043,14 +1207,204 @@ void zram_init_device(struct zram *zram, struct zram_meta *meta)
 	pr_debug("Initialization done!\n");
 }
 
+#ifdef CONFIG_ZRAM_WRITEBACK
+/*
+ * Use the block device at @path to write pages back to. Only possible
+ * before the disksize is set, the caller holds init_lock for writing.
+ */
+int zram_set_backing_dev(struct zram *zram, const char *path)
+{
+	struct file *backing_dev;
+	struct block_device *bdev;
+	struct inode *inode;
+	unsigned long nr_pages, *bitmap;
+	int err;
+
+	if (zram->init_done)
+		return -EBUSY;
+
+	backing_dev = filp_open(path, O_RDWR | O_LARGEFILE, 0);
+	if (IS_ERR(backing_dev))
+		return PTR_ERR(backing_dev);
+
+	inode = backing_dev->f_mapping->host;
+	if (!S_ISBLK(inode->i_mode)) {
+		err = -ENOTBLK;
+		goto out_close;
+	}
+
+	bdev = bdgrab(I_BDEV(inode));
+	/* Keep anyone else, including a second zram, off the device */
+	err = blkdev_get(bdev, FMODE_READ | FMODE_WRITE | FMODE_EXCL, zram);
+	if (err < 0)
+		goto out_close;
+
+	nr_pages = i_size_read(inode) >> PAGE_SHIFT;
+	bitmap = vzalloc(BITS_TO_LONGS(nr_pages) * sizeof(long));
+	if (!bitmap) {
+		err = -ENOMEM;
+		goto out_put;
+	}
+
+	err = set_blocksize(bdev, PAGE_SIZE);
+	if (err)
+		goto out_free;
+
+	zram_reset_bdev(zram);
+	zram->backing_dev = backing_dev;
+	zram->bdev = bdev;
+	zram->nr_bd_pages = nr_pages;
+	zram->bd_bitmap = bitmap;
+	pr_info("setup backing device %s, %lu pages\n", path, nr_pages);
+	return 0;
+
+out_free:
+	vfree(bitmap);
+out_put:
+	blkdev_put(bdev, FMODE_READ | FMODE_WRITE | FMODE_EXCL);
+out_close:
+	filp_close(backing_dev, NULL);
+	return err;
+}
+
+/*
+ * Mark every stored page idle. Accessing a page clears the mark again, so
+ * whatever is still idle at the next writeback was left alone since.
+ */
+void zram_mark_idle(struct zram *zram)
+{
+	struct zram_meta *meta = zram->meta;
+	size_t index;
+
+	for (index = 0; index < zram->disksize >> PAGE_SHIFT; index++) {
+		down_write(&zram->lock);
+		spin_lock(&zram->wb_lock);
+		if (meta->table[index].handle &&
+		    !zram_test_flag(meta, index, ZRAM_WB))
+			zram_set_flag(meta, index, ZRAM_IDLE);
+		spin_unlock(&zram->wb_lock);
+		up_write(&zram->lock);
+	}
+}
+
+static bool zram_wb_candidate(struct zram_meta *meta, size_t index,
+			      enum zram_wb_mode mode)
+{
+	if (!meta->table[index].handle ||
+	    zram_test_flag(meta, index, ZRAM_WB))
+		return false;
+	if (mode == ZRAM_WB_HUGE)
+		return meta->table[index].size == PAGE_SIZE;
+	return zram_test_flag(meta, index, ZRAM_IDLE);
+}
+
+/*
+ * Write the pages picked by @mode to the backing device and free their
+ * memory. The device lock is dropped during the I/O; a page that gets
+ * rewritten or freed meanwhile loses its ZRAM_UNDER_WB mark and keeps
+ * living in memory. Every change to a slot is also made under wb_lock,
+ * which is what keeps zram_slot_free_notify() out. The caller holds
+ * init_lock for reading.
+ */
+int zram_writeback(struct zram *zram, enum zram_wb_mode mode)
+{
+	struct zram_meta *meta = zram->meta;
+	unsigned long blk_idx;
+	struct page *page;
+	size_t index;
+	int ret = 0, err;
+
+	if (!zram->init_done || !zram->backing_dev)
+		return -ENODEV;
+
+	page = alloc_page(GFP_KERNEL);
+	if (!page)
+		return -ENOMEM;
+
+	for (index = 0; index < zram->disksize >> PAGE_SHIFT; index++) {
+		down_write(&zram->lock);
+		spin_lock(&zram->wb_lock);
+		if (!zram_wb_candidate(meta, index, mode)) {
+			spin_unlock(&zram->wb_lock);
+			up_write(&zram->lock);
+			continue;
+		}
+		err = zram_decompress_page(zram, page_address(page), index);
+		if (!err)
+			zram_set_flag(meta, index, ZRAM_UNDER_WB);
+		spin_unlock(&zram->wb_lock);
+		up_write(&zram->lock);
+		if (err)
+			continue;
+
+		blk_idx = zram_alloc_bd_block(zram);
+		if (!blk_idx) {
+			ret = -ENOSPC;
+			break;
+		}
+
+		err = zram_bd_rw(zram, page, blk_idx, WRITE);
+		if (err) {
+			zram_free_bd_block(zram, blk_idx);
+			ret = err;
+			break;
+		}
+
+		down_write(&zram->lock);
+		spin_lock(&zram->wb_lock);
+		if (!zram_test_flag(meta, index, ZRAM_UNDER_WB)) {
+			spin_unlock(&zram->wb_lock);
+			up_write(&zram->lock);
+			zram_free_bd_block(zram, blk_idx);
+			continue;
+		}
+		zram_free_page(zram, index);
+		meta->table[index].handle = blk_idx;
+		zram_set_flag(meta, index, ZRAM_WB);
+		spin_unlock(&zram->wb_lock);
+		zram_stat64_inc(zram, &zram->stats.bd_count);
+		zram_stat64_inc(zram, &zram->stats.bd_writes);
+		up_write(&zram->lock);
+
+		cond_resched();
+	}
+
+	/* A failed pass must not leave marks a later pass would trust */
+	if (ret) {
+		down_write(&zram->lock);
+		spin_lock(&zram->wb_lock);
+		zram_clear_flag(meta, index, ZRAM_UNDER_WB);
+		spin_unlock(&zram->wb_lock);
+		up_write(&zram->lock);
+	}
+
+	__free_page(page);
+	return ret;
+}
+#endif
+
 static void zram_slot_free_notify(struct block_device *bdev,
 				unsigned long index)
 {
 	struct zram *zram;
 	zram = bdev->bd_disk->private_data;
+#ifdef CONFIG_ZRAM_WRITEBACK
+	/*
+	 * This runs under the swap lock or from bio completion, so zram->lock
+	 * is out of reach. wb_lock keeps zram_writeback() off the slot; when
+	 * it is busy the slot is left as is and the next write to it frees it.
+	 */
+	if (!spin_trylock(&zram->wb_lock)) {
+		zram_stat64_inc(zram, &zram->stats.missed_free);
+		return;
+	}
+	zram_free_page(zram, index);
+	spin_unlock(&zram->wb_lock);
+#else
 	/* down_write(&zram->lock); */
 	zram_free_page(zram, index);
 	/* up_write(&zram->lock); */
+#endif
 	zram_stat64_inc(zram, &zram->stats.notify_free);
 
 }
@@ -1067,6 +1421,9 @@ static int create_device(struct zram *zram, int device_id)
 	init_rwsem(&zram->lock);
 	init_rwsem(&zram->init_lock);
 	spin_lock_init(&zram->stat64_lock);
+#ifdef CONFIG_ZRAM_WRITEBACK
+	spin_lock_init(&zram->wb_lock);
+#endif
 #ifdef CONFIG_ZSM
 	spin_lock_init(&zram_node_mutex);
 	spin_lock_init(&zram_node4k_mutex);
@@ -1190,6 +1547,17 @@ static int zraminfo_proc_show(struct seq_file *m, void *v)
         	);
 #undef P2K
 #undef B2K
+#ifdef CONFIG_ZRAM_WRITEBACK
+	seq_printf(m,
+	    "BdStored:       %8lu kB\n"
+	    "BdReads:        %8lu kB\n"
+	    "BdWrites:       %8lu kB\n"
+	    "MissedFree:     %8lu kB\n",
+	    (unsigned long)zram_devices->stats.bd_count << (PAGE_SHIFT - 10),
+	    (unsigned long)zram_devices->stats.bd_reads << (PAGE_SHIFT - 10),
+	    (unsigned long)zram_devices->stats.bd_writes << (PAGE_SHIFT - 10),
+	    (unsigned long)zram_devices->stats.missed_free << (PAGE_SHIFT - 10));
+#endif
 	seq_printf(m, "Algorithm: [%s]\n", (zram_comp != NULL)? zram_comp : "LZO");
     }
     return 0;
@@ -62,6 +62,14 @@ static const size_t max_zpage_size = PAGE_SIZE / 4 * 3;
 enum zram_pageflags {
 	/* Page consists entirely of zeros */
 	ZRAM_ZERO,
+#ifdef CONFIG_ZRAM_WRITEBACK
+	/* Not accessed since the last idle marking pass */
+	ZRAM_IDLE,
+	/* Being written to the backing device */
+	ZRAM_UNDER_WB,
+	/* Stored on the backing device, handle is the block index */
+	ZRAM_WB,
+#endif
 
 	__NR_ZRAM_PAGEFLAGS,
 #ifdef CONFIG_ZSM
@@ -96,6 +104,12 @@ struct zram_stats {
 	u64 failed_writes;	/* can happen when memory is too low */
 	u64 invalid_io;		/* non-page-aligned I/O requests */
 	u64 notify_free;	/* no. of swap slot free notifications */
+#ifdef CONFIG_ZRAM_WRITEBACK
+	u64 bd_count;		/* pages stored on the backing device */
+	u64 bd_reads;		/* pages read back from it */
+	u64 bd_writes;		/* pages written back to it */
+	u64 missed_free;	/* slot free notifications skipped on wb_lock */
+#endif
 #ifdef CONFIG_ZSM
 	u64 zsm_saved;          /* saved physical size*/
 	u64 zsm_saved4k;
@@ -131,8 +145,28 @@ struct zram {
 	u64 disksize;	/* bytes */
 
 	struct zram_stats stats;
+#ifdef CONFIG_ZRAM_WRITEBACK
+	/* Set before disksize, under init_lock */
+	struct file *backing_dev;
+	struct block_device *bdev;
+	unsigned long nr_bd_pages;
+	unsigned long *bd_bitmap;	/* blocks in use, block 0 is never used */
+	/*
+	 * Protects the idle/writeback flags and the handle of a slot against
+	 * the swap slot free notifier, which cannot sleep on zram->lock.
+	 */
+	spinlock_t wb_lock;
+#endif
 };
 
+#ifdef CONFIG_ZRAM_WRITEBACK
+/* What /sys/block/zram<id>/writeback writes back */
+enum zram_wb_mode {
+	ZRAM_WB_IDLE,	/* pages left alone since the last idle marking */
+	ZRAM_WB_HUGE,	/* pages stored uncompressed */
+};
+#endif
+
 extern struct zram *zram_devices;
 unsigned int zram_get_num_devices(void);
 #ifdef CONFIG_SYSFS
@@ -143,6 +177,11 @@ extern void zram_reset_device(struct zram *zram);
 extern struct zram_meta *zram_meta_alloc(u64 disksize);
 extern void zram_meta_free(struct zram_meta *meta);
 extern void zram_init_device(struct zram *zram, struct zram_meta *meta);
+#ifdef CONFIG_ZRAM_WRITEBACK
+extern int zram_set_backing_dev(struct zram *zram, const char *path);
+extern void zram_mark_idle(struct zram *zram);
+extern int zram_writeback(struct zram *zram, enum zram_wb_mode mode);
+#endif
 
 /* Type for zram compression/decompression hooks */
 #ifdef CONFIG_ZSM
@@ -170,6 +170,30 @@ static ssize_t fuse_conn_congestion_threshold_write(struct file *file,
 	return ret;
 }
 
+static ssize_t fuse_conn_io_stats_read(struct file *file, char __user *buf,
+				       size_t len, loff_t *ppos)
+{
+	char tmp[160];
+	size_t size;
+	struct fuse_conn *fc;
+
+	fc = fuse_ctl_file_conn_get(file);
+	if (!fc)
+		return 0;
+
+	size = sprintf(tmp, "passthrough_read %llu\n"
+			    "passthrough_write %llu\n"
+			    "forwarded_read %llu\n"
+			    "forwarded_write %llu\n",
+		(unsigned long long)atomic64_read(&fc->passthrough_read_bytes),
+		(unsigned long long)atomic64_read(&fc->passthrough_write_bytes),
+		(unsigned long long)atomic64_read(&fc->forwarded_read_bytes),
+		(unsigned long long)atomic64_read(&fc->forwarded_write_bytes));
+	fuse_conn_put(fc);
+
+	return simple_read_from_buffer(buf, len, ppos, tmp, size);
+}
+
 static const struct file_operations fuse_ctl_abort_ops = {
 	.open = nonseekable_open,
 	.write = fuse_conn_abort_write,
@@ -196,6 +220,12 @@ static const struct file_operations fuse_conn_congestion_threshold_ops = {
 	.llseek = no_llseek,
 };
 
+static const struct file_operations fuse_conn_io_stats_ops = {
+	.open = nonseekable_open,
+	.read = fuse_conn_io_stats_read,
+	.llseek = no_llseek,
+};
+
 static struct dentry *fuse_ctl_add_dentry(struct dentry *parent,
 					  struct fuse_conn *fc,
 					  const char *name,
@@ -260,7 +290,9 @@ int fuse_ctl_add_conn(struct fuse_conn *fc)
 				 1, NULL, &fuse_conn_max_background_ops) ||
 	    !fuse_ctl_add_dentry(parent, fc, "congestion_threshold",
 				 S_IFREG | 0600, 1, NULL,
-				 &fuse_conn_congestion_threshold_ops))
+				 &fuse_conn_congestion_threshold_ops) ||
+	    !fuse_ctl_add_dentry(parent, fc, "io_stats", S_IFREG | 0400, 1,
+				 NULL, &fuse_conn_io_stats_ops))
 		goto err;
 
 	return 0;
@@ -23,8 +23,13 @@
 #include <linux/poll.h>
 #include <linux/workqueue.h>
 
-/** Max number of pages that can be used in a single read request */
-#define FUSE_MAX_PAGES_PER_REQ 32
+#define FUSE_SUPER_MAGIC 0x65735546
+
+/** Default max number of pages that can be used in a single request */
+#define FUSE_DEFAULT_MAX_PAGES_PER_REQ 32
+
+/** Maximum of max_pages received in init_out */
+#define FUSE_MAX_MAX_PAGES 256
 
 /** Bias for fi->writectr, meaning new writepages must not be sent */
 #define FUSE_NOWRITE INT_MIN
@@ -33,7 +38,7 @@
 #define FUSE_NAME_MAX 1024
 
 /** Number of dentries for each connection in the control filesystem */
-#define FUSE_CTL_NUM_DENTRIES 5
+#define FUSE_CTL_NUM_DENTRIES 6
 
 /** If the FUSE_DEFAULT_PERMISSIONS flag is given, the filesystem
     module will check permissions based on the file mode.  Otherwise no
@@ -155,6 +160,9 @@ struct fuse_file {
 
 	/** Has flock been performed on this file? */
 	bool flock:1;
+
+	/** Lower file that read/write/mmap are passed through to, or NULL */
+	struct file *passthrough_filp;
 };
 
 /** One input argument of a request */
@@ -359,6 +367,9 @@ struct fuse_req {
 
 	/** Request is stolen from fuse_file->reserved_req */
 	struct file *stolen_file;
+
+	/** Lower file handed over in an OPEN or CREATE reply */
+	struct file *passthrough_filp;
 };
 
 /**
@@ -393,6 +404,9 @@ struct fuse_conn {
 	/** Maximum write size */
 	unsigned max_write;
 
+	/** Maximum number of pages that can be used in a single request */
+	unsigned max_pages;
+
 	/** Readers of the connection are waiting on this */
 	wait_queue_head_t waitq;
 
@@ -546,6 +560,9 @@ struct fuse_conn {
 	/** Does the filesystem support asynchronous direct-IO submission? */
 	unsigned async_dio:1;
 
+	/** Can read/write/mmap be passed through to a lower file? */
+	unsigned passthrough:1;
+
 	/** The number of requests waiting for completion */
 	atomic_t num_waiting;
 
@@ -587,6 +604,14 @@ struct fuse_conn {
 
 	/** Read/write semaphore to hold when accessing sb. */
 	struct rw_semaphore killsb;
+
+	/** Bytes read and written through a lower file */
+	atomic64_t passthrough_read_bytes;
+	atomic64_t passthrough_write_bytes;
+
+	/** Bytes read and written through the normal fuse path */
+	atomic64_t forwarded_read_bytes;
+	atomic64_t forwarded_write_bytes;
 };
 
 static inline struct fuse_conn *get_fuse_conn_super(struct super_block *sb)
@@ -868,6 +893,24 @@ int fuse_dev_release(struct inode *inode, struct file *file);
 
 void fuse_write_update_size(struct inode *inode, loff_t pos);
 
+/**
+ * Take the lower file from an OPEN or CREATE reply.  Called in the
+ * context of the daemon writing the reply.
+ */
+void fuse_setup_passthrough(struct fuse_conn *fc, struct fuse_req *req);
+
+/**
+ * Drop the lower file of a fuse_file, if any
+ */
+void fuse_passthrough_release(struct fuse_file *ff);
+
+ssize_t fuse_passthrough_aio_read(struct kiocb *iocb, const struct iovec *iov,
+				  unsigned long nr_segs, loff_t pos);
+ssize_t fuse_passthrough_aio_write(struct kiocb *iocb,
+				   const struct iovec *iov,
+				   unsigned long nr_segs, loff_t pos);
+int fuse_passthrough_mmap(struct file *file, struct vm_area_struct *vma);
+
 int fuse_do_setattr(struct inode *inode, struct iattr *attr,
 		    struct file *file);
 
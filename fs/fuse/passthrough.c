@@ -0,0 +1,212 @@
+/*
+  FUSE: Filesystem in Userspace
+
+  Passthrough of read, write and mmap to a lower file supplied by the
+  filesystem daemon at open time.
+
+  This program can be distributed under the terms of the GNU GPL.
+  See the file COPYING.
+*/
+
+#include "fuse_i.h"
+
+#include <linux/file.h>
+#include <linux/aio.h>
+#include <linux/fsnotify.h>
+#include <linux/uio.h>
+
+/*
+ * FMODE_READ and FMODE_WRITE of the fuse file being opened.  fuse_open_in
+ * and fuse_create_in both start with the open flags.
+ */
+static fmode_t fuse_passthrough_open_fmode(struct fuse_req *req)
+{
+	const struct fuse_open_in *open_in = req->in.args[0].value;
+
+	return OPEN_FMODE(open_in->flags) & (FMODE_READ | FMODE_WRITE);
+}
+
+void fuse_setup_passthrough(struct fuse_conn *fc, struct fuse_req *req)
+{
+	struct fuse_open_out *open_out;
+	struct file *passthrough_filp;
+	struct inode *passthrough_inode;
+	int daemon_fd;
+
+	req->passthrough_filp = NULL;
+
+	if (!fc->passthrough)
+		return;
+
+	if (req->in.h.opcode != FUSE_OPEN && req->in.h.opcode != FUSE_CREATE)
+		return;
+
+	/* fuse_open_out is the last argument of both OPEN and CREATE */
+	open_out = req->out.args[req->out.numargs - 1].value;
+	if (!(open_out->open_flags & FOPEN_PASSTHROUGH))
+		return;
+
+	daemon_fd = (int)open_out->padding;
+	if (daemon_fd < 0)
+		return;
+
+	passthrough_filp = fget(daemon_fd);
+	if (!passthrough_filp)
+		return;
+
+	/*
+	 * Only regular files on a non-fuse filesystem, so that a daemon
+	 * can't build an arbitrarily deep stack of passthrough files, and
+	 * only if the daemon opened it for everything the client asked for.
+	 */
+	passthrough_inode = file_inode(passthrough_filp);
+	if (!S_ISREG(passthrough_inode->i_mode) ||
+	    (fuse_passthrough_open_fmode(req) & ~passthrough_filp->f_mode) ||
+	    passthrough_inode->i_sb->s_magic == FUSE_SUPER_MAGIC ||
+	    !passthrough_filp->f_op ||
+	    !passthrough_filp->f_op->aio_read ||
+	    !passthrough_filp->f_op->aio_write) {
+		fput(passthrough_filp);
+		return;
+	}
+
+	req->passthrough_filp = passthrough_filp;
+}
+
+void fuse_passthrough_release(struct fuse_file *ff)
+{
+	if (ff->passthrough_filp) {
+		fput(ff->passthrough_filp);
+		ff->passthrough_filp = NULL;
+	}
+}
+
+static ssize_t fuse_passthrough_do_io(struct kiocb *iocb,
+				      const struct iovec *iov,
+				      unsigned long nr_segs, loff_t pos,
+				      int write)
+{
+	struct fuse_file *ff = iocb->ki_filp->private_data;
+	struct file *passthrough_filp = ff->passthrough_filp;
+	size_t count = iov_length(iov, nr_segs);
+	struct kiocb kiocb;
+	ssize_t ret;
+
+	if (!(passthrough_filp->f_mode & (write ? FMODE_WRITE : FMODE_READ)))
+		return -EBADF;
+
+	ret = rw_verify_area(write ? WRITE : READ, passthrough_filp, &pos,
+			     count);
+	if (ret < 0)
+		return ret;
+
+	init_sync_kiocb(&kiocb, passthrough_filp);
+	kiocb.ki_pos = pos;
+	kiocb.ki_left = count;
+	kiocb.ki_nbytes = count;
+
+	if (write) {
+		file_start_write(passthrough_filp);
+		ret = passthrough_filp->f_op->aio_write(&kiocb, iov, nr_segs,
+							kiocb.ki_pos);
+	} else {
+		ret = passthrough_filp->f_op->aio_read(&kiocb, iov, nr_segs,
+						       kiocb.ki_pos);
+	}
+	if (-EIOCBQUEUED == ret)
+		ret = wait_on_sync_kiocb(&kiocb);
+	if (write)
+		file_end_write(passthrough_filp);
+
+	if (ret > 0) {
+		if (write)
+			fsnotify_modify(passthrough_filp);
+		else
+			fsnotify_access(passthrough_filp);
+	}
+
+	iocb->ki_pos = kiocb.ki_pos;
+
+	return ret;
+}
+
+ssize_t fuse_passthrough_aio_read(struct kiocb *iocb, const struct iovec *iov,
+				  unsigned long nr_segs, loff_t pos)
+{
+	struct fuse_conn *fc = get_fuse_conn(file_inode(iocb->ki_filp));
+	ssize_t ret;
+
+	ret = fuse_passthrough_do_io(iocb, iov, nr_segs, pos, 0);
+	if (ret > 0)
+		atomic64_add(ret, &fc->passthrough_read_bytes);
+
+	return ret;
+}
+
+ssize_t fuse_passthrough_aio_write(struct kiocb *iocb,
+				   const struct iovec *iov,
+				   unsigned long nr_segs, loff_t pos)
+{
+	struct file *file = iocb->ki_filp;
+	struct inode *inode = file_inode(file);
+	struct fuse_conn *fc = get_fuse_conn(inode);
+	ssize_t ret;
+
+	/*
+	 * The lower filesystem does its own locking, but i_mutex keeps
+	 * the fuse inode's size consistent with concurrent writers.
+	 */
+	mutex_lock(&inode->i_mutex);
+	ret = fuse_passthrough_do_io(iocb, iov, nr_segs, pos, 1);
+	if (ret > 0) {
+		fuse_write_update_size(inode, pos + ret);
+		/* pages cached by other, non-passthrough opens are stale */
+		invalidate_mapping_pages(inode->i_mapping,
+					 pos >> PAGE_CACHE_SHIFT,
+					 (pos + ret - 1) >> PAGE_CACHE_SHIFT);
+		atomic64_add(ret, &fc->passthrough_write_bytes);
+	}
+	mutex_unlock(&inode->i_mutex);
+
+	fuse_invalidate_attr(inode);
+
+	return ret;
+}
+
+int fuse_passthrough_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct fuse_file *ff = file->private_data;
+	struct file *passthrough_filp = ff->passthrough_filp;
+	int ret;
+
+	if (!passthrough_filp->f_op->mmap)
+		return -ENODEV;
+
+	if (!(passthrough_filp->f_mode & FMODE_READ))
+		return -EACCES;
+	if (vma->vm_flags & VM_SHARED) {
+		if (!(passthrough_filp->f_mode & FMODE_WRITE)) {
+			if (vma->vm_flags & VM_WRITE)
+				return -EACCES;
+			/* nor may mprotect() make it writable later */
+			vma->vm_flags &= ~VM_MAYWRITE;
+		}
+	}
+
+	/*
+	 * Map the lower file directly; page faults then never reach the
+	 * daemon.  The vma holds its own reference on the lower file.
+	 */
+	vma->vm_file = get_file(passthrough_filp);
+	ret = passthrough_filp->f_op->mmap(passthrough_filp, vma);
+	if (ret) {
+		vma->vm_file = file;
+		fput(passthrough_filp);
+		return ret;
+	}
+
+	file_accessed(file);
+	fput(file);
+
+	return 0;
+}
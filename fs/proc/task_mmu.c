@@ -11,6 +11,8 @@
 #include <linux/rmap.h>
 #include <linux/swap.h>
 #include <linux/swapops.h>
+#include <linux/mm_inline.h>
+#include <linux/ktime.h>
 
 #include <asm/elf.h>
 #include <asm/uaccess.h>
@@ -898,6 +900,205 @@ const struct file_operations proc_clear_refs_operations = {
 	.llseek		= noop_llseek,
 };
 
+#ifdef CONFIG_PROCESS_RECLAIM
+enum reclaim_type {
+	RECLAIM_FILE = 1,
+	RECLAIM_ANON,
+	RECLAIM_ALL,
+};
+
+static const char * const reclaim_type_str[] = {
+	[RECLAIM_FILE]	= "file",
+	[RECLAIM_ANON]	= "anon",
+	[RECLAIM_ALL]	= "all",
+};
+
+/*
+ * State of one /proc/<pid>/reclaim write. The last one is kept in the
+ * file's private data so that reading the same descriptor reports it.
+ */
+struct reclaim_param {
+	struct vm_area_struct *vma;
+	int type;
+	unsigned long nr_to_reclaim;	/* 0 for no budget */
+	unsigned long nr_scanned;
+	unsigned long nr_reclaimed;
+	s64 time_us;
+};
+
+static int reclaim_pte_range(pmd_t *pmd, unsigned long addr,
+			     unsigned long end, struct mm_walk *walk)
+{
+	struct reclaim_param *rp = walk->private;
+	struct vm_area_struct *vma = rp->vma;
+	pte_t *pte, ptent;
+	spinlock_t *ptl;
+	struct page *page;
+	LIST_HEAD(page_list);
+	int isolated;
+
+	split_huge_page_pmd(vma, addr, pmd);
+	if (pmd_trans_unstable(pmd))
+		return 0;
+cont:
+	isolated = 0;
+	pte = pte_offset_map_lock(vma->vm_mm, pmd, addr, &ptl);
+	for (; addr != end; pte++, addr += PAGE_SIZE) {
+		ptent = *pte;
+		if (!pte_present(ptent))
+			continue;
+
+		page = vm_normal_page(vma, addr, ptent);
+		if (!page)
+			continue;
+
+		/* Pages shared with other processes are not ours to drop */
+		if (page_mapcount(page) != 1)
+			continue;
+
+		rp->nr_scanned++;
+		if (isolate_lru_page(page))
+			continue;
+
+		list_add(&page->lru, &page_list);
+		inc_zone_page_state(page, NR_ISOLATED_ANON +
+				    page_is_file_cache(page));
+
+		/* Reclaim in batches, without holding the pte lock */
+		if (++isolated >= SWAP_CLUSTER_MAX) {
+			pte++;
+			addr += PAGE_SIZE;
+			break;
+		}
+	}
+	pte_unmap_unlock(pte - 1, ptl);
+
+	rp->nr_reclaimed += reclaim_pages_from_list(&page_list);
+	if (rp->nr_to_reclaim && rp->nr_reclaimed >= rp->nr_to_reclaim)
+		return 1;
+	if (addr != end)
+		goto cont;
+
+	cond_resched();
+	return 0;
+}
+
+static int reclaim_open(struct inode *inode, struct file *file)
+{
+	file->private_data = kzalloc(sizeof(struct reclaim_param), GFP_KERNEL);
+	if (!file->private_data)
+		return -ENOMEM;
+	return 0;
+}
+
+static int reclaim_release(struct inode *inode, struct file *file)
+{
+	kfree(file->private_data);
+	return 0;
+}
+
+static ssize_t reclaim_read(struct file *file, char __user *buf,
+			    size_t count, loff_t *ppos)
+{
+	struct reclaim_param *last = file->private_data;
+	char buffer[128];
+	int len;
+
+	if (!last->type)
+		return 0;
+
+	len = scnprintf(buffer, sizeof(buffer),
+			"type: %s\nbudget: %lu\nscanned: %lu\nreclaimed: %lu\ntime_us: %lld\n",
+			reclaim_type_str[last->type], last->nr_to_reclaim,
+			last->nr_scanned, last->nr_reclaimed, last->time_us);
+	return simple_read_from_buffer(buf, count, ppos, buffer, len);
+}
+
+/*
+ * Accepts "<anon|file|all> [pages]": reclaim the pages that only this
+ * process maps from its anonymous vmas, its file vmas or both, stopping
+ * once the optional number of pages has been reclaimed.
+ */
+static ssize_t reclaim_write(struct file *file, const char __user *buf,
+			     size_t count, loff_t *ppos)
+{
+	struct reclaim_param rp = { 0, };
+	struct task_struct *task;
+	char buffer[32], type[8];
+	struct mm_struct *mm;
+	struct vm_area_struct *vma;
+	ktime_t start;
+	int i, n;
+
+	memset(buffer, 0, sizeof(buffer));
+	if (count > sizeof(buffer) - 1)
+		count = sizeof(buffer) - 1;
+	if (copy_from_user(buffer, buf, count))
+		return -EFAULT;
+
+	n = sscanf(buffer, "%7s %lu", type, &rp.nr_to_reclaim);
+	if (n < 1)
+		return -EINVAL;
+	for (i = RECLAIM_FILE; i <= RECLAIM_ALL; i++) {
+		if (!strcmp(type, reclaim_type_str[i]))
+			break;
+	}
+	if (i > RECLAIM_ALL)
+		return -EINVAL;
+	rp.type = i;
+
+	task = get_proc_task(file_inode(file));
+	if (!task)
+		return -ESRCH;
+	mm = get_task_mm(task);
+	if (mm) {
+		struct mm_walk reclaim_walk = {
+			.pmd_entry = reclaim_pte_range,
+			.mm = mm,
+			.private = &rp,
+		};
+
+		start = ktime_get();
+		/* Pages still sitting in the pagevecs cannot be isolated */
+		lru_add_drain_all();
+		down_read(&mm->mmap_sem);
+		for (vma = mm->mmap; vma; vma = vma->vm_next) {
+			if (is_vm_hugetlb_page(vma))
+				continue;
+			if (vma->vm_flags & (VM_LOCKED | VM_PFNMAP | VM_IO))
+				continue;
+			if (rp.type == RECLAIM_ANON && vma->vm_file)
+				continue;
+			if (rp.type == RECLAIM_FILE && !vma->vm_file)
+				continue;
+			rp.vma = vma;
+			if (walk_page_range(vma->vm_start, vma->vm_end,
+					    &reclaim_walk))
+				break;
+		}
+		flush_tlb_mm(mm);
+		up_read(&mm->mmap_sem);
+		mmput(mm);
+		rp.time_us = ktime_us_delta(ktime_get(), start);
+	}
+	put_task_struct(task);
+
+	rp.vma = NULL;
+	*(struct reclaim_param *)file->private_data = rp;
+	/* Let the next read on this descriptor start at the new report */
+	*ppos = 0;
+	return count;
+}
+
+const struct file_operations proc_reclaim_operations = {
+	.open		= reclaim_open,
+	.read		= reclaim_read,
+	.write		= reclaim_write,
+	.llseek		= noop_llseek,
+	.release	= reclaim_release,
+};
+#endif
+
 typedef struct {
 	u64 pme;
 } pagemap_entry_t;
@@ -219,6 +219,19 @@ struct vm_region {
 						* this region */
 };
 
+#ifdef CONFIG_SWAP
+/*
+ * Swap readahead feedback, see swapin_readahead(). Updated without locks
+ * under mmap_sem held for read, it is only a heuristic.
+ */
+struct swap_ra_info {
+	atomic_t hits;			/* readahead pages mapped since last swapin */
+	unsigned int win;		/* window used at the last swapin, in pages */
+	unsigned int marked;		/* readahead pages read at the last swapin */
+	unsigned long prev_offset;	/* swap offset of the last swapin */
+};
+#endif
+
 /*
  * This struct defines a memory VMM memory area. There is one of these
  * per VM-area/task.  A VM area is any part of the process virtual memory
@@ -294,6 +307,9 @@ struct vm_area_struct {
 #ifdef CONFIG_NUMA
 	struct mempolicy *vm_policy;	/* NUMA policy for the VMA */
 #endif
+#ifdef CONFIG_SWAP
+	struct swap_ra_info swap_ra;	/* swap readahead feedback */
+#endif
 };
 
 struct core_thread {
@@ -0,0 +1,26 @@
+#ifndef _LINUX_SWAP_SLOTS_H
+#define _LINUX_SWAP_SLOTS_H
+
+#include <linux/swap.h>
+
+/* Swap entries each CPU keeps ready for allocation, and holds for freeing */
+#define SWAP_SLOTS_CACHE_SIZE	64
+
+enum swap_lock_op {
+	SWAP_LOCK_ALLOC,
+	SWAP_LOCK_FREE,
+	SWAP_LOCK_NR,
+};
+
+/* mm/swapfile.c */
+extern int get_swap_pages(int n, swp_entry_t entries[]);
+extern void swapcache_free_entries(swp_entry_t *entries, int n);
+extern bool swap_entry_cache_only(swp_entry_t entry);
+
+/* mm/swap_slots.c */
+extern bool free_swap_slot(swp_entry_t entry);
+extern int drain_swap_slots_caches(void);
+extern void swap_lock_account(enum swap_lock_op op, unsigned int entries,
+			      u64 start);
+
+#endif /* _LINUX_SWAP_SLOTS_H */
@@ -7,6 +7,14 @@
 #include <linux/gfp.h>
 #include <linux/types.h>
 #include <linux/cgroup.h>
+#include <linux/notifier.h>
+
+enum vmpressure_levels {
+	VMPRESSURE_LOW = 0,
+	VMPRESSURE_MEDIUM,
+	VMPRESSURE_CRITICAL,
+	VMPRESSURE_NUM_LEVELS,
+};
 
 struct vmpressure {
 	unsigned long scanned;
@@ -38,10 +46,33 @@ extern int vmpressure_register_event(struct cgroup *cg, struct cftype *cft,
 				     const char *args);
 extern void vmpressure_unregister_event(struct cgroup *cg, struct cftype *cft,
 					struct eventfd_ctx *eventfd);
+#elif defined(CONFIG_VMPRESSURE_GLOBAL)
+extern void vmpressure(gfp_t gfp, struct mem_cgroup *memcg,
+		       unsigned long scanned, unsigned long reclaimed);
+extern void vmpressure_prio(gfp_t gfp, struct mem_cgroup *memcg, int prio);
 #else
 static inline void vmpressure(gfp_t gfp, struct mem_cgroup *memcg,
 			      unsigned long scanned, unsigned long reclaimed) {}
 static inline void vmpressure_prio(gfp_t gfp, struct mem_cgroup *memcg,
 				   int prio) {}
 #endif /* CONFIG_MEMCG */
+
+/*
+ * In-kernel listeners of the system wide pressure level. The notifier
+ * action is the enum vmpressure_levels, the data points to the pressure
+ * in percent as an unsigned long. Called from process context.
+ */
+#ifdef CONFIG_VMPRESSURE_GLOBAL
+extern int vmpressure_notifier_register(struct notifier_block *nb);
+extern int vmpressure_notifier_unregister(struct notifier_block *nb);
+#else
+static inline int vmpressure_notifier_register(struct notifier_block *nb)
+{
+	return 0;
+}
+static inline int vmpressure_notifier_unregister(struct notifier_block *nb)
+{
+	return 0;
+}
+#endif /* CONFIG_VMPRESSURE_GLOBAL */
 #endif /* __LINUX_VMPRESSURE_H */
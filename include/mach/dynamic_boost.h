@@ -19,6 +19,18 @@ enum control{
 	ON = -1
 };
 
+/* named boost profiles, tunable through sysfs */
+enum dboost_profile_id {
+	DBOOST_TOUCH,
+	DBOOST_APP_LAUNCH,
+	DBOOST_VIDEO_START,
+	DBOOST_PROFILE_NUM
+};
+
+/* min_freq value asking for the highest frequency available */
+#define DBOOST_FREQ_MAX		(~0U)
+
 int set_dynamic_boost(int duration, int prio_mode);
+int dynamic_boost_profile(int profile, int duration);
 
 #endif	/* __DYNAMIC_BOOST_H__ */
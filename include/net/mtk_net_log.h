@@ -0,0 +1,55 @@
+#ifndef _NET_MTK_NET_LOG_H
+#define _NET_MTK_NET_LOG_H
+
+#include <linux/mtk_net_log.h>
+
+#ifdef CONFIG_MTK_NET_EVENT_LOG
+
+#include <net/sock.h>
+
+extern unsigned long mtk_net_log_mask;
+
+void __mtk_net_log(unsigned int type, unsigned long ino, unsigned long peer,
+		   unsigned long bytes, int err);
+
+/*
+ * Record a socket event in the binary event ring. Classes that are
+ * switched off cost a single test of mtk_net_log_mask.
+ */
+static inline void mtk_net_log(unsigned int type, unsigned long ino,
+			       unsigned long peer, unsigned long bytes, int err)
+{
+	if (mtk_net_log_mask & (1UL << MTK_NET_EV_CLASS(type)))
+		__mtk_net_log(type, ino, peer, bytes, err);
+}
+
+static inline unsigned long mtk_net_sock_ino(struct socket *sock)
+{
+	return sock ? SOCK_INODE(sock)->i_ino : 0;
+}
+
+static inline unsigned long mtk_net_sk_ino(const struct sock *sk)
+{
+	return sk ? mtk_net_sock_ino(sk->sk_socket) : 0;
+}
+
+#else
+
+static inline void mtk_net_log(unsigned int type, unsigned long ino,
+			       unsigned long peer, unsigned long bytes, int err)
+{
+}
+
+static inline unsigned long mtk_net_sock_ino(struct socket *sock)
+{
+	return 0;
+}
+
+static inline unsigned long mtk_net_sk_ino(const struct sock *sk)
+{
+	return 0;
+}
+
+#endif /* CONFIG_MTK_NET_EVENT_LOG */
+
+#endif /* _NET_MTK_NET_LOG_H */
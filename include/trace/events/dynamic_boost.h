@@ -0,0 +1,77 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM dynamic_boost
+
+#if !defined(_TRACE_DYNAMIC_BOOST_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_DYNAMIC_BOOST_H
+
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(dboost_start,
+	TP_PROTO(const char *name, unsigned int min_freq,
+		 unsigned int min_cores, int duration),
+	TP_ARGS(name, min_freq, min_cores, duration),
+
+	TP_STRUCT__entry(
+	    __string(name, name)
+	    __field(unsigned int, min_freq )
+	    __field(unsigned int, min_cores)
+	    __field(         int, duration )
+	),
+
+	TP_fast_assign(
+	    __assign_str(name, name);
+	    __entry->min_freq = min_freq;
+	    __entry->min_cores = min_cores;
+	    __entry->duration = duration;
+	),
+
+	TP_printk("profile=%s min_freq=%u min_cores=%u duration=%d",
+	      __get_str(name), __entry->min_freq, __entry->min_cores,
+	      __entry->duration)
+);
+
+TRACE_EVENT(dboost_end,
+	TP_PROTO(const char *name, unsigned int held_ms),
+	TP_ARGS(name, held_ms),
+
+	TP_STRUCT__entry(
+	    __string(name, name)
+	    __field(unsigned int, held_ms)
+	),
+
+	TP_fast_assign(
+	    __assign_str(name, name);
+	    __entry->held_ms = held_ms;
+	),
+
+	TP_printk("profile=%s held_ms=%u", __get_str(name), __entry->held_ms)
+);
+
+TRACE_EVENT(dboost_apply,
+	TP_PROTO(int mode, unsigned int min_freq, unsigned int cores,
+		 unsigned int cur_freq),
+	TP_ARGS(mode, min_freq, cores, cur_freq),
+
+	TP_STRUCT__entry(
+	    __field(         int, mode    )
+	    __field(unsigned int, min_freq)
+	    __field(unsigned int, cores   )
+	    __field(unsigned int, cur_freq)
+	),
+
+	TP_fast_assign(
+	    __entry->mode = mode;
+	    __entry->min_freq = min_freq;
+	    __entry->cores = cores;
+	    __entry->cur_freq = cur_freq;
+	),
+
+	TP_printk("mode=%d min_freq=%u cores=%u cur_freq=%u",
+	      __entry->mode, __entry->min_freq, __entry->cores,
+	      __entry->cur_freq)
+);
+
+#endif /* _TRACE_DYNAMIC_BOOST_H */
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
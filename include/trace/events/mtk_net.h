@@ -0,0 +1,42 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM mtk_net
+
+#if !defined(_TRACE_MTK_NET_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_MTK_NET_H
+
+#include <linux/mtk_net_log.h>
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(mtk_net_event,
+
+	TP_PROTO(const struct mtk_net_event *ev),
+
+	TP_ARGS(ev),
+
+	TP_STRUCT__entry(
+		__field(u32, seq)
+		__field(u16, type)
+		__field(u32, ino)
+		__field(u32, peer)
+		__field(u32, bytes)
+		__field(s32, err)
+	),
+
+	TP_fast_assign(
+		__entry->seq	= ev->seq;
+		__entry->type	= ev->type;
+		__entry->ino	= ev->ino;
+		__entry->peer	= ev->peer;
+		__entry->bytes	= ev->bytes;
+		__entry->err	= ev->err;
+	),
+
+	TP_printk("seq=%u type=0x%03x ino=%u peer=%u bytes=%u err=%d",
+		__entry->seq, __entry->type, __entry->ino, __entry->peer,
+		__entry->bytes, __entry->err)
+);
+
+#endif /* _TRACE_MTK_NET_H */
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
@@ -93,6 +93,12 @@
  *
  * 7.22
  *  - add FUSE_ASYNC_DIO
+ *  - add FUSE_PASSTHROUGH and FOPEN_PASSTHROUGH, which gives fuse_open_out.padding
+ *    a meaning
+ *
+ * 7.23
+ *  - add time_gran to fuse_init_out
+ *  - add FUSE_MAX_PAGES, fuse_init_out.max_pages
  */
 
 #ifndef _LINUX_FUSE_H
@@ -128,7 +134,7 @@
 #define FUSE_KERNEL_VERSION 7
 
 /** Minor version number of this interface */
-#define FUSE_KERNEL_MINOR_VERSION 22
+#define FUSE_KERNEL_MINOR_VERSION 23
 
 /** The node ID of the root inode */
 #define FUSE_ROOT_ID 1
@@ -195,10 +201,12 @@ struct fuse_file_lock {
  * FOPEN_DIRECT_IO: bypass page cache for this open file
  * FOPEN_KEEP_CACHE: don't invalidate the data cache on open
  * FOPEN_NONSEEKABLE: the file is not seekable
+ * FOPEN_PASSTHROUGH: read/write/mmap go to the file at fuse_open_out.padding
  */
 #define FOPEN_DIRECT_IO		(1 << 0)
 #define FOPEN_KEEP_CACHE	(1 << 1)
 #define FOPEN_NONSEEKABLE	(1 << 2)
+#define FOPEN_PASSTHROUGH	(1 << 31)
 
 /**
  * INIT request/reply flags
@@ -219,6 +227,10 @@ struct fuse_file_lock {
  * FUSE_DO_READDIRPLUS: do READDIRPLUS (READDIR+LOOKUP in one)
  * FUSE_READDIRPLUS_AUTO: adaptive readdirplus
  * FUSE_ASYNC_DIO: asynchronous direct I/O submission
+ * FUSE_PASSTHROUGH: filesystem can hand back a lower file on open
+ * FUSE_MAX_PAGES: init_out.max_pages contains the max number of req pages.
+ *		   A daemon splicing requests out of /dev/fuse must size its
+ *		   pipe (F_SETPIPE_SZ) to hold max_pages plus the header.
  */
 #define FUSE_ASYNC_READ		(1 << 0)
 #define FUSE_POSIX_LOCKS	(1 << 1)
@@ -236,6 +248,8 @@ struct fuse_file_lock {
 #define FUSE_DO_READDIRPLUS	(1 << 13)
 #define FUSE_READDIRPLUS_AUTO	(1 << 14)
 #define FUSE_ASYNC_DIO		(1 << 15)
+#define FUSE_MAX_PAGES		(1 << 22)
+#define FUSE_PASSTHROUGH	(1 << 31)
 
 /**
  * CUSE INIT request/reply flags
@@ -458,6 +472,10 @@ struct fuse_create_in {
 	uint32_t	padding;
 };
 
+/*
+ * With FOPEN_PASSTHROUGH set in open_flags, padding holds the daemon's file
+ * descriptor for the lower file; otherwise it is ignored.
+ */
 struct fuse_open_out {
 	uint64_t	fh;
 	uint32_t	open_flags;
@@ -556,6 +574,9 @@ struct fuse_init_in {
 	uint32_t	flags;
 };
 
+#define FUSE_COMPAT_INIT_OUT_SIZE 8
+#define FUSE_COMPAT_22_INIT_OUT_SIZE 24
+
 struct fuse_init_out {
 	uint32_t	major;
 	uint32_t	minor;
@@ -564,6 +585,10 @@ struct fuse_init_out {
 	uint16_t	max_background;
 	uint16_t	congestion_threshold;
 	uint32_t	max_write;
+	uint32_t	time_gran;
+	uint16_t	max_pages;
+	uint16_t	padding;
+	uint32_t	unused[8];
 };
 
 #define CUSE_INIT_INFO_MAX 4096
@@ -0,0 +1,63 @@
+#ifndef _UAPI_LINUX_MTK_NET_LOG_H
+#define _UAPI_LINUX_MTK_NET_LOG_H
+
+#include <linux/types.h>
+
+/*
+ * Socket event log records, as read from /proc/mtk_net/raw.
+ *
+ * The event type carries its class in the upper byte so that sampling
+ * and rate limits can be configured per class in /proc/mtk_net/classes.
+ */
+
+enum mtk_net_class {
+	MTK_NET_CLASS_SOCK,		/* socket create/close/accept/bind */
+	MTK_NET_CLASS_UNIX,		/* AF_UNIX connect and peer state */
+	MTK_NET_CLASS_WMEM,		/* senders blocked on send buffer */
+	MTK_NET_CLASS_MAX,
+};
+
+#define MTK_NET_EV(class, nr)		(((class) << 8) | (nr))
+#define MTK_NET_EV_CLASS(type)		((type) >> 8)
+
+enum mtk_net_event_type {
+	MTK_NET_EV_SOCK_CREATE		= MTK_NET_EV(MTK_NET_CLASS_SOCK, 0),
+	MTK_NET_EV_SOCK_CLOSE		= MTK_NET_EV(MTK_NET_CLASS_SOCK, 1),
+	MTK_NET_EV_SOCK_PAIR		= MTK_NET_EV(MTK_NET_CLASS_SOCK, 2),
+	MTK_NET_EV_SOCK_BIND		= MTK_NET_EV(MTK_NET_CLASS_SOCK, 3),
+	MTK_NET_EV_SOCK_ACCEPT		= MTK_NET_EV(MTK_NET_CLASS_SOCK, 4),
+	MTK_NET_EV_FAMILY_REG		= MTK_NET_EV(MTK_NET_CLASS_SOCK, 5),
+	MTK_NET_EV_FAMILY_UNREG		= MTK_NET_EV(MTK_NET_CLASS_SOCK, 6),
+
+	MTK_NET_EV_UNIX_CONNECT		= MTK_NET_EV(MTK_NET_CLASS_UNIX, 0),
+	MTK_NET_EV_UNIX_SEND_PEER_DEAD	= MTK_NET_EV(MTK_NET_CLASS_UNIX, 1),
+	MTK_NET_EV_UNIX_RECV_SHUTDOWN	= MTK_NET_EV(MTK_NET_CLASS_UNIX, 2),
+	MTK_NET_EV_UNIX_RECV_TIMEOUT	= MTK_NET_EV(MTK_NET_CLASS_UNIX, 3),
+	MTK_NET_EV_UNIX_RELEASE_ALIVE	= MTK_NET_EV(MTK_NET_CLASS_UNIX, 4),
+
+	MTK_NET_EV_WMEM_WAIT		= MTK_NET_EV(MTK_NET_CLASS_WMEM, 0),
+	MTK_NET_EV_WMEM_DONE		= MTK_NET_EV(MTK_NET_CLASS_WMEM, 1),
+};
+
+/*
+ * @seq:	position in the ring, starts at 1 and increases by one per
+ *		logged event; gaps seen by a reader mean it was overrun
+ * @ino:	inode number of the socket, 0 if unknown
+ * @peer:	peer socket inode, or the family/port for SOCK_* events
+ * @bytes:	byte count (or queue length) attached to the event
+ * @err:	error or return value of the operation
+ */
+struct mtk_net_event {
+	__u64	ts_ns;
+	__u32	seq;
+	__u32	ino;
+	__u32	peer;
+	__u32	bytes;
+	__s32	err;
+	__u32	pid;
+	__u16	type;
+	__u16	cpu;
+	__u32	reserved;
+};
+
+#endif /* _UAPI_LINUX_MTK_NET_LOG_H */
@@ -109,6 +109,7 @@ extern int extra_free_kbytes;
 extern int min_free_order_shift;
 extern int pid_max_min, pid_max_max;
 extern int percpu_pagelist_fraction;
+extern int percpu_highorder_pages;
 extern int compat_log;
 extern int latencytop_enabled;
 extern int sysctl_nr_open_min, sysctl_nr_open_max;
@@ -142,6 +143,7 @@ static unsigned long dirty_bytes_min = 2 * PAGE_SIZE;
 static int maxolduid = 65535;
 static int minolduid;
 static int min_percpu_pagelist_fract = 8;
+static int max_percpu_highorder_pages = 1024;
 
 static int ngroups_max = NGROUPS_MAX;
 static const int cap_last_cap = CAP_LAST_CAP;
@@ -1306,6 +1308,15 @@ static struct ctl_table vm_table[] = {
 		.proc_handler	= percpu_pagelist_fraction_sysctl_handler,
 		.extra1		= &min_percpu_pagelist_fract,
 	},
+	{
+		.procname	= "percpu_highorder_pages",
+		.data		= &percpu_highorder_pages,
+		.maxlen		= sizeof(percpu_highorder_pages),
+		.mode		= 0644,
+		.proc_handler	= percpu_highorder_pages_sysctl_handler,
+		.extra1		= &zero,
+		.extra2		= &max_percpu_highorder_pages,
+	},
 #ifdef CONFIG_MMU
 	{
 		.procname	= "max_map_count",
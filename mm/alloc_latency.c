@@ -0,0 +1,226 @@
+/*
+ * Page allocator latency histograms
+ *
+ * Every __alloc_pages_nodemask() call is accounted on the local CPU by
+ * order and by the most expensive path it went through, and separately by
+ * gfp class. Latencies go into power of two buckets starting at 1us, which
+ * is enough to tell a UI frame lost in direct reclaim from one lost in
+ * compaction without tracing every allocation.
+ */
+#include <linux/mm.h>
+#include <linux/gfp.h>
+#include <linux/percpu.h>
+#include <linux/cpumask.h>
+#include <linux/irqflags.h>
+#include <linux/string.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/math64.h>
+#include <linux/log2.h>
+#include <linux/init.h>
+#include "internal.h"
+
+/* Bucket b counts latencies below 2^b us, the last one everything above */
+#define ALLOC_LAT_BUCKETS	16
+
+enum alloc_gfp_class {
+	ALLOC_GFP_ATOMIC,	/* cannot sleep */
+	ALLOC_GFP_KERNEL,	/* can sleep, unmovable or reclaimable */
+	ALLOC_GFP_MOVABLE,	/* can sleep, movable: user and page cache */
+	NR_ALLOC_GFP_CLASSES
+};
+
+struct alloc_latency {
+	u32 hist[MAX_ORDER][NR_ALLOC_PATHS][ALLOC_LAT_BUCKETS];
+	u32 class_hist[NR_ALLOC_GFP_CLASSES][ALLOC_LAT_BUCKETS];
+	u32 failed[MAX_ORDER][NR_ALLOC_PATHS];
+	u64 total_ns[MAX_ORDER][NR_ALLOC_PATHS];
+	u64 max_ns[MAX_ORDER][NR_ALLOC_PATHS];
+};
+
+static DEFINE_PER_CPU(struct alloc_latency, alloc_latency);
+
+static const char * const alloc_path_names[] = {
+	[ALLOC_PATH_FAST] = "fast",
+	[ALLOC_PATH_SLOW] = "slow",
+	[ALLOC_PATH_COMPACT] = "compact",
+	[ALLOC_PATH_RECLAIM] = "reclaim",
+	[ALLOC_PATH_OOM] = "oom",
+};
+
+static const char * const alloc_gfp_class_names[] = {
+	[ALLOC_GFP_ATOMIC] = "atomic",
+	[ALLOC_GFP_KERNEL] = "kernel",
+	[ALLOC_GFP_MOVABLE] = "movable",
+};
+
+static enum alloc_gfp_class alloc_gfp_class(gfp_t gfp_mask)
+{
+	if (!(gfp_mask & __GFP_WAIT))
+		return ALLOC_GFP_ATOMIC;
+	if (allocflags_to_migratetype(gfp_mask) == MIGRATE_MOVABLE)
+		return ALLOC_GFP_MOVABLE;
+	return ALLOC_GFP_KERNEL;
+}
+
+static unsigned int alloc_lat_bucket(u64 ns)
+{
+	u64 us = div_u64(ns, NSEC_PER_USEC);
+
+	if (!us)
+		return 0;
+	return min_t(unsigned int, ilog2(us) + 1, ALLOC_LAT_BUCKETS - 1);
+}
+
+/**
+ * alloc_latency_account - account one __alloc_pages_nodemask() call
+ * @gfp_mask: gfp mask of the allocation
+ * @order: order of the allocation
+ * @path: most expensive path the allocation took
+ * @start: alloc_latency_start() value taken on entry
+ * @failed: whether no page was returned
+ */
+void alloc_latency_account(gfp_t gfp_mask, unsigned int order,
+			   enum alloc_path path, u64 start, bool failed)
+{
+	u64 ns = sched_clock() - start;
+	unsigned int bucket = alloc_lat_bucket(ns);
+	struct alloc_latency *lat;
+	unsigned long flags;
+
+	if (order >= MAX_ORDER)
+		return;
+
+	/* Allocations from interrupts would tear the updates below */
+	local_irq_save(flags);
+	lat = this_cpu_ptr(&alloc_latency);
+	lat->hist[order][path][bucket]++;
+	lat->class_hist[alloc_gfp_class(gfp_mask)][bucket]++;
+	lat->total_ns[order][path] += ns;
+	if (ns > lat->max_ns[order][path])
+		lat->max_ns[order][path] = ns;
+	if (failed)
+		lat->failed[order][path]++;
+	local_irq_restore(flags);
+}
+
+static void alloc_lat_print_header(struct seq_file *m, const char *first)
+{
+	char label[16];
+	int b;
+
+	seq_printf(m, "%-14s", first);
+	for (b = 0; b < ALLOC_LAT_BUCKETS; b++) {
+		if (b < ALLOC_LAT_BUCKETS - 1)
+			snprintf(label, sizeof(label), "<%lu", 1UL << b);
+		else
+			snprintf(label, sizeof(label), ">=%lu", 1UL << (b - 1));
+		seq_printf(m, " %9s", label);
+	}
+	seq_putc(m, '\n');
+}
+
+static void alloc_lat_print_row(struct seq_file *m, const u64 *row)
+{
+	int b;
+
+	for (b = 0; b < ALLOC_LAT_BUCKETS; b++)
+		seq_printf(m, " %9llu", row[b]);
+	seq_putc(m, '\n');
+}
+
+static int alloc_latency_show(struct seq_file *m, void *v)
+{
+	u64 row[ALLOC_LAT_BUCKETS];
+	int order, path, class, b, cpu;
+
+	seq_printf(m, "latency buckets in us, rows by order and path\n");
+	alloc_lat_print_header(m, "order path");
+	for (order = 0; order < MAX_ORDER; order++) {
+		for (path = 0; path < NR_ALLOC_PATHS; path++) {
+			u64 count = 0;
+
+			for (b = 0; b < ALLOC_LAT_BUCKETS; b++) {
+				row[b] = 0;
+				for_each_possible_cpu(cpu)
+					row[b] += per_cpu(alloc_latency, cpu).hist[order][path][b];
+				count += row[b];
+			}
+			if (!count)
+				continue;
+			seq_printf(m, "%5d %-8s", order, alloc_path_names[path]);
+			alloc_lat_print_row(m, row);
+		}
+	}
+
+	seq_printf(m, "\nrows by gfp class\n");
+	alloc_lat_print_header(m, "class");
+	for (class = 0; class < NR_ALLOC_GFP_CLASSES; class++) {
+		for (b = 0; b < ALLOC_LAT_BUCKETS; b++) {
+			row[b] = 0;
+			for_each_possible_cpu(cpu)
+				row[b] += per_cpu(alloc_latency, cpu).class_hist[class][b];
+		}
+		seq_printf(m, "%-14s", alloc_gfp_class_names[class]);
+		alloc_lat_print_row(m, row);
+	}
+
+	seq_printf(m, "\n%5s %-8s %10s %10s %10s %10s\n",
+		   "order", "path", "count", "avg_us", "max_us", "failed");
+	for (order = 0; order < MAX_ORDER; order++) {
+		for (path = 0; path < NR_ALLOC_PATHS; path++) {
+			u64 count = 0, total = 0, max = 0, failed = 0;
+
+			for_each_possible_cpu(cpu) {
+				struct alloc_latency *lat =
+					&per_cpu(alloc_latency, cpu);
+
+				for (b = 0; b < ALLOC_LAT_BUCKETS; b++)
+					count += lat->hist[order][path][b];
+				total += lat->total_ns[order][path];
+				max = max(max, lat->max_ns[order][path]);
+				failed += lat->failed[order][path];
+			}
+			if (!count)
+				continue;
+			seq_printf(m, "%5d %-8s %10llu %10llu %10llu %10llu\n",
+				   order, alloc_path_names[path], count,
+				   div64_u64(total, count * NSEC_PER_USEC),
+				   div_u64(max, NSEC_PER_USEC), failed);
+		}
+	}
+	return 0;
+}
+
+static int alloc_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, alloc_latency_show, NULL);
+}
+
+/* Any write clears the histograms, racing allocations may survive it */
+static ssize_t alloc_latency_write(struct file *file, const char __user *buf,
+				   size_t count, loff_t *ppos)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		memset(&per_cpu(alloc_latency, cpu), 0,
+		       sizeof(struct alloc_latency));
+	return count;
+}
+
+static const struct file_operations alloc_latency_fops = {
+	.open		= alloc_latency_open,
+	.read		= seq_read,
+	.write		= alloc_latency_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init alloc_latency_init(void)
+{
+	debugfs_create_file("page_alloc_latency", S_IRUGO | S_IWUSR, NULL,
+			    NULL, &alloc_latency_fops);
+	return 0;
+}
+late_initcall(alloc_latency_init);
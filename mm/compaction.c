@@ -16,6 +16,10 @@
 #include <linux/sysfs.h>
 #include <linux/balloon_compaction.h>
 #include <linux/page-isolation.h>
+#include <linux/kthread.h>
+#include <linux/freezer.h>
+#include <linux/moduleparam.h>
+#include <linux/timer.h>
 #include "internal.h"
 
 #ifdef CONFIG_HAS_EARLYSUSPEND
@@ -339,6 +343,7 @@ isolate_fail:
 	if (blockpfn == end_pfn)
 		update_pageblock_skip(cc, valid_page, total_isolated, false);
 
+	cc->total_free_scanned += nr_scanned;
 	count_compact_events(COMPACTFREE_SCANNED, nr_scanned);
 	if (total_isolated)
 		count_compact_events(COMPACTISOLATED, total_isolated);
@@ -647,6 +652,7 @@ next_pageblock:
 
 	trace_mm_compaction_isolate_migratepages(nr_scanned, nr_isolated);
 
+	cc->total_migrate_scanned += nr_scanned;
 	count_compact_events(COMPACTMIGRATE_SCANNED, nr_scanned);
 	if (nr_isolated)
 		count_compact_events(COMPACTISOLATED, nr_isolated);
@@ -1207,6 +1213,232 @@ int sysctl_extfrag_handler(struct ctl_table *table, int write,
 	return 0;
 }
 
+/*
+ * kcompactd: per node background compaction
+ *
+ * Direct compaction only starts once a high-order allocation has already
+ * failed, and then the caller stalls for it. kcompactd puts high-order
+ * blocks together ahead of time: kswapd wakes it when it goes to sleep
+ * after a high-order request, and a deferrable timer has it check the
+ * fragmentation index of the orders in kcompactd_orders. Compaction runs
+ * asynchronously at the lowest priority and stops as soon as a block of
+ * the wanted order is free, continuing from the cached scanner positions
+ * next time. Like direct compaction, an order is only deferred once a
+ * synchronous pass over the zone failed too: the deferral also holds back
+ * direct compaction, which an async failure alone says little about.
+ */
+
+/* Orders to keep available, as a bitmask: 32K skbs, 64K and 1M ion */
+static unsigned int kcompactd_orders = (1 << 3) | (1 << 4) | (1 << 8);
+module_param_named(kcompactd_orders, kcompactd_orders, uint, S_IRUGO | S_IWUSR);
+
+/* Fragmentation index above which an order gets compacted for */
+static int kcompactd_extfrag_threshold = 500;
+module_param_named(kcompactd_extfrag_threshold, kcompactd_extfrag_threshold,
+		   int, S_IRUGO | S_IWUSR);
+
+/* Period of the fragmentation check, 0 to only compact on kswapd's behalf */
+static unsigned int kcompactd_interval_ms = 1000;
+module_param_named(kcompactd_interval_ms, kcompactd_interval_ms, uint,
+		   S_IRUGO | S_IWUSR);
+
+/* Highest configured order that fails for fragmentation rather than lack of memory */
+static int kcompactd_frag_order(struct zone *zone)
+{
+	int order;
+
+	for (order = MAX_ORDER - 1; order > 0; order--) {
+		if (!(kcompactd_orders & (1U << order)))
+			continue;
+		if (fragmentation_index(zone, order) > kcompactd_extfrag_threshold)
+			return order;
+	}
+	return 0;
+}
+
+static bool kcompactd_zone_suitable(struct zone *zone, int order)
+{
+	return order > 0 && !compaction_deferred(zone, order) &&
+		compaction_suitable(zone, order) == COMPACT_CONTINUE;
+}
+
+static bool kcompactd_node_suitable(pg_data_t *pgdat, int order,
+				    int classzone_idx)
+{
+	int zoneid;
+
+	for (zoneid = 0; zoneid <= classzone_idx; zoneid++) {
+		struct zone *zone = &pgdat->node_zones[zoneid];
+
+		if (populated_zone(zone) && kcompactd_zone_suitable(zone, order))
+			return true;
+	}
+	return false;
+}
+
+static void kcompactd_do_work(pg_data_t *pgdat)
+{
+	int order = pgdat->kcompactd_max_order;
+	int classzone_idx = pgdat->kcompactd_classzone_idx;
+	bool check = pgdat->kcompactd_check;
+	bool woken = false;
+	int zoneid;
+
+	pgdat->kcompactd_max_order = 0;
+	pgdat->kcompactd_classzone_idx = 0;
+	pgdat->kcompactd_check = false;
+	if (check)
+		classzone_idx = MAX_NR_ZONES - 1;
+
+	for (zoneid = 0; zoneid <= classzone_idx; zoneid++) {
+		struct zone *zone = &pgdat->node_zones[zoneid];
+		struct compact_control cc = {
+			.sync = false,
+			.migratetype = MIGRATE_MOVABLE,
+			.zone = zone,
+		};
+		int status;
+
+		if (!populated_zone(zone))
+			continue;
+
+		cc.order = order;
+		if (check)
+			cc.order = max(order, kcompactd_frag_order(zone));
+		if (!kcompactd_zone_suitable(zone, cc.order))
+			continue;
+
+		if (!woken) {
+			count_compact_event(KCOMPACTD_WAKE);
+			woken = true;
+		}
+
+		INIT_LIST_HEAD(&cc.freepages);
+		INIT_LIST_HEAD(&cc.migratepages);
+
+		status = compact_zone(zone, &cc);
+
+		if (status == COMPACT_COMPLETE &&
+		    !zone_watermark_ok(zone, cc.order, low_wmark_pages(zone),
+				       0, 0) && !kthread_should_stop()) {
+			/* async skips unmovable blocks and pages under writeback */
+			cc.sync = true;
+			cc.contended = false;
+			cc.finished_update_free = false;
+			cc.finished_update_migrate = false;
+			status = compact_zone(zone, &cc);
+		}
+
+		if (zone_watermark_ok(zone, cc.order, low_wmark_pages(zone),
+				      0, 0)) {
+			if (cc.order >= zone->compact_order_failed)
+				zone->compact_order_failed = cc.order + 1;
+		} else if (status == COMPACT_COMPLETE && cc.sync) {
+			/* The whole zone was scanned for nothing, back off */
+			defer_compaction(zone, cc.order);
+		}
+
+		count_compact_events(KCOMPACTD_MIGRATE_SCANNED,
+				     cc.total_migrate_scanned);
+		count_compact_events(KCOMPACTD_FREE_SCANNED,
+				     cc.total_free_scanned);
+
+		VM_BUG_ON(!list_empty(&cc.freepages));
+		VM_BUG_ON(!list_empty(&cc.migratepages));
+
+		if (kthread_should_stop())
+			return;
+	}
+}
+
+/**
+ * wakeup_kcompactd - ask the node's kcompactd for blocks of @order
+ * @pgdat: node to compact
+ * @order: order kswapd was woken for
+ * @classzone_idx: highest zone the allocation could use
+ */
+void wakeup_kcompactd(pg_data_t *pgdat, int order, int classzone_idx)
+{
+	if (!order || !pgdat->kcompactd)
+		return;
+
+	if (pgdat->kcompactd_max_order < order)
+		pgdat->kcompactd_max_order = order;
+	if (pgdat->kcompactd_classzone_idx < classzone_idx)
+		pgdat->kcompactd_classzone_idx = classzone_idx;
+
+	if (!waitqueue_active(&pgdat->kcompactd_wait))
+		return;
+	if (!kcompactd_node_suitable(pgdat, order, classzone_idx))
+		return;
+
+	wake_up_interruptible(&pgdat->kcompactd_wait);
+}
+
+static void kcompactd_timer_fn(unsigned long data)
+{
+	pg_data_t *pgdat = (pg_data_t *)data;
+
+	pgdat->kcompactd_check = true;
+	wake_up_interruptible(&pgdat->kcompactd_wait);
+}
+
+static bool kcompactd_work_requested(pg_data_t *pgdat)
+{
+	return pgdat->kcompactd_max_order > 0 || pgdat->kcompactd_check ||
+		kthread_should_stop();
+}
+
+static int kcompactd(void *p)
+{
+	pg_data_t *pgdat = (pg_data_t *)p;
+	const struct cpumask *cpumask = cpumask_of_node(pgdat->node_id);
+	struct timer_list timer;
+
+	if (!cpumask_empty(cpumask))
+		set_cpus_allowed_ptr(current, cpumask);
+
+	set_freezable();
+	set_user_nice(current, 19);
+
+	/* Deferrable, so an idle system is not woken up just to check */
+	setup_deferrable_timer_on_stack(&timer, kcompactd_timer_fn,
+					(unsigned long)pgdat);
+
+	while (!kthread_should_stop()) {
+		if (kcompactd_interval_ms)
+			mod_timer(&timer, jiffies +
+				  msecs_to_jiffies(kcompactd_interval_ms));
+		wait_event_freezable(pgdat->kcompactd_wait,
+				     kcompactd_work_requested(pgdat));
+		if (kthread_should_stop())
+			break;
+		kcompactd_do_work(pgdat);
+	}
+
+	del_timer_sync(&timer);
+	destroy_timer_on_stack(&timer);
+	return 0;
+}
+
+static int __init kcompactd_init(void)
+{
+	int nid;
+
+	for_each_node_state(nid, N_MEMORY) {
+		pg_data_t *pgdat = NODE_DATA(nid);
+
+		pgdat->kcompactd = kthread_run(kcompactd, pgdat,
+					       "kcompactd%d", nid);
+		if (IS_ERR(pgdat->kcompactd)) {
+			pr_err("Failed to start kcompactd on node %d\n", nid);
+			pgdat->kcompactd = NULL;
+		}
+	}
+	return 0;
+}
+subsys_initcall(kcompactd_init);
+
 #if defined(CONFIG_SYSFS) && defined(CONFIG_NUMA)
 ssize_t sysfs_compact_node(struct device *dev,
 			struct device_attribute *attr,
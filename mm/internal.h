@@ -12,6 +12,7 @@
 #define __MM_INTERNAL_H
 
 #include <linux/mm.h>
+#include <linux/sched.h>
 
 void free_pgtables(struct mmu_gather *tlb, struct vm_area_struct *start_vma,
 		unsigned long floor, unsigned long ceiling);
@@ -88,7 +89,6 @@ extern unsigned long highest_memmap_pfn;
 /*
  * in mm/vmscan.c:
  */
-extern int isolate_lru_page(struct page *page);
 extern void putback_lru_page(struct page *page);
 
 /*
@@ -124,6 +124,8 @@ struct compact_control {
 	unsigned long nr_migratepages;	/* Number of pages to migrate */
 	unsigned long free_pfn;		/* isolate_freepages search base */
 	unsigned long migrate_pfn;	/* isolate_migratepages search base */
+	unsigned long total_migrate_scanned;
+	unsigned long total_free_scanned;
 	bool sync;			/* Synchronous migration */
 	bool ignore_skip_hint;		/* Scan blocks even if marked skip */
 	bool finished_update_free;	/* True when the zone cached pfns are
@@ -374,4 +376,34 @@ unsigned long reclaim_clean_pages_from_list(struct zone *zone,
 #define ALLOC_CPUSET		0x40 /* check for correct cpuset */
 #define ALLOC_CMA		0x80 /* allow allocations from CMA areas */
 
+/* How far __alloc_pages_nodemask() had to go, ordered by cost */
+enum alloc_path {
+	ALLOC_PATH_FAST,	/* first get_page_from_freelist() */
+	ALLOC_PATH_SLOW,	/* slowpath without reclaim or compaction */
+	ALLOC_PATH_COMPACT,	/* direct compaction */
+	ALLOC_PATH_RECLAIM,	/* direct reclaim */
+	ALLOC_PATH_OOM,		/* OOM killer */
+	NR_ALLOC_PATHS
+};
+
+#ifdef CONFIG_PAGE_ALLOC_LATENCY
+extern void alloc_latency_account(gfp_t gfp_mask, unsigned int order,
+				  enum alloc_path path, u64 start, bool failed);
+
+static inline u64 alloc_latency_start(void)
+{
+	return sched_clock();
+}
+#else
+static inline void alloc_latency_account(gfp_t gfp_mask, unsigned int order,
+				enum alloc_path path, u64 start, bool failed)
+{
+}
+
+static inline u64 alloc_latency_start(void)
+{
+	return 0;
+}
+#endif
+
 #endif	/* __MM_INTERNAL_H */
@@ -37,6 +37,8 @@
 #include <linux/freezer.h>
 #include <linux/oom.h>
 #include <linux/numa.h>
+#include <linux/math64.h>
+#include <linux/power_supply.h>
 
 #include <asm/tlbflush.h>
 #include "internal.h"
@@ -223,6 +225,29 @@ static unsigned int ksm_thread_pages_to_scan = 100;
 /* Milliseconds ksmd should sleep between batches */
 static unsigned int ksm_thread_sleep_millisecs = 20;
 
+/* Pages ksmd has scanned and merged since boot, and its cpu time doing so */
+static unsigned long ksm_pages_scanned;
+static unsigned long ksm_pages_merged;
+static u64 ksm_scan_ns;
+
+/*
+ * With ksm_autotune set, ksmd picks its own batch size between
+ * ksm_autotune_min_pages and ksm_autotune_max_pages: doubled each period
+ * in which at least KSM_AUTOTUNE_HIGH_YIELD of every thousand pages scanned
+ * got merged, halved when fewer than KSM_AUTOTUNE_LOW_YIELD did, and held
+ * at the minimum while running on battery.
+ */
+#define KSM_AUTOTUNE_PERIOD_MS	1000
+#define KSM_AUTOTUNE_HIGH_YIELD	10
+#define KSM_AUTOTUNE_LOW_YIELD	1
+static unsigned int ksm_autotune;
+static unsigned int ksm_autotune_min_pages = 25;
+static unsigned int ksm_autotune_max_pages = 1600;
+static unsigned int ksm_autotune_pages = 100;
+static unsigned long ksm_autotune_next;
+static unsigned long ksm_autotune_scanned;
+static unsigned long ksm_autotune_merged;
+
 #ifdef CONFIG_NUMA
 /* Zeroed when merging across nodes is not allowed */
 static unsigned int ksm_merge_across_nodes = 1;
@@ -1400,10 +1425,13 @@ static void stable_tree_append(struct rmap_item *rmap_item,
 	rmap_item->address |= STABLE_FLAG;
 	hlist_add_head(&rmap_item->hlist, &stable_node->hlist);
 
-	if (rmap_item->hlist.next)
+	/* only a page that joins an existing ksm page frees memory */
+	if (rmap_item->hlist.next) {
 		ksm_pages_sharing++;
-	else
+		ksm_pages_merged++;
+	} else {
 		ksm_pages_shared++;
+	}
 }
 
 /*
@@ -1731,9 +1759,42 @@ static void ksm_do_scan(unsigned int scan_npages)
 		if (!is_page_scanned(page))
 			cmp_and_merge_page(page, rmap_item);
 		put_page(page);
+		ksm_pages_scanned++;
 	}
 }
 
+/*
+ * Called by ksmd under ksm_thread_mutex after each batch; retunes
+ * ksm_autotune_pages once per KSM_AUTOTUNE_PERIOD_MS.
+ */
+static void ksm_autotune_update(void)
+{
+	unsigned long scanned, merged;
+	unsigned int pages = ksm_autotune_pages;
+
+	if (time_before(jiffies, ksm_autotune_next))
+		return;
+	ksm_autotune_next = jiffies + msecs_to_jiffies(KSM_AUTOTUNE_PERIOD_MS);
+
+	scanned = ksm_pages_scanned - ksm_autotune_scanned;
+	merged = ksm_pages_merged - ksm_autotune_merged;
+	ksm_autotune_scanned = ksm_pages_scanned;
+	ksm_autotune_merged = ksm_pages_merged;
+	if (!scanned)
+		return;
+
+	/* -ENOSYS means no power supply class: treat as mains powered */
+	if (power_supply_is_system_supplied() == 0)
+		pages = ksm_autotune_min_pages;
+	else if (merged * 1000 >= scanned * KSM_AUTOTUNE_HIGH_YIELD)
+		pages = pages * 2;
+	else if (merged * 1000 < scanned * KSM_AUTOTUNE_LOW_YIELD)
+		pages = pages / 2;
+
+	ksm_autotune_pages = clamp(pages, ksm_autotune_min_pages,
+				   ksm_autotune_max_pages);
+}
+
 static int ksmd_should_run(void)
 {
 	return (ksm_run & KSM_RUN_MERGE) && !list_empty(&ksm_mm_head.mm_list);
@@ -1748,8 +1809,16 @@ static int ksm_scan_thread(void *nothing)
 	while (!kthread_should_stop()) {
 		mutex_lock(&ksm_thread_mutex);
 		wait_while_offlining();
-		if (ksmd_should_run())
-			ksm_do_scan(ksm_thread_pages_to_scan);
+		if (ksmd_should_run()) {
+			u64 start = task_sched_runtime(current);
+
+			if (ksm_autotune) {
+				ksm_do_scan(ksm_autotune_pages);
+				ksm_autotune_update();
+			} else
+				ksm_do_scan(ksm_thread_pages_to_scan);
+			ksm_scan_ns += task_sched_runtime(current) - start;
+		}
 		mutex_unlock(&ksm_thread_mutex);
 
 		try_to_freeze();
@@ -1835,9 +1904,15 @@ int __ksm_enter(struct mm_struct *mm)
 	 * But when KSM_RUN_UNMERGE, it's important to insert ahead of its
 	 * scanning cursor, otherwise KSM pages in newly forked mms will be
 	 * missed: then we might as well insert at the end of the list.
+	 *
+	 * When autotuning, insert just ahead of the cursor instead: the
+	 * mms entering are mostly zygote children whose MADV_MERGEABLE heaps
+	 * are the best merge candidates there are, and they do not exec.
 	 */
 	if (ksm_run & KSM_RUN_UNMERGE)
 		list_add_tail(&mm_slot->mm_list, &ksm_mm_head.mm_list);
+	else if (ksm_autotune)
+		list_add(&mm_slot->mm_list, &ksm_scan.mm_slot->mm_list);
 	else
 		list_add_tail(&mm_slot->mm_list, &ksm_scan.mm_slot->mm_list);
 	spin_unlock(&ksm_mmlist_lock);
@@ -2256,6 +2331,110 @@ static ssize_t pages_to_scan_store(struct kobject *kobj,
 }
 KSM_ATTR(pages_to_scan);
 
+static ssize_t autotune_show(struct kobject *kobj,
+			     struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", ksm_autotune);
+}
+
+static ssize_t autotune_store(struct kobject *kobj,
+			      struct kobj_attribute *attr,
+			      const char *buf, size_t count)
+{
+	unsigned long knob;
+	int err;
+
+	err = kstrtoul(buf, 10, &knob);
+	if (err)
+		return err;
+	if (knob > 1)
+		return -EINVAL;
+
+	mutex_lock(&ksm_thread_mutex);
+	if (knob && !ksm_autotune) {
+		ksm_autotune_pages = clamp(ksm_thread_pages_to_scan,
+					   ksm_autotune_min_pages,
+					   ksm_autotune_max_pages);
+		ksm_autotune_next = jiffies;
+		ksm_autotune_scanned = ksm_pages_scanned;
+		ksm_autotune_merged = ksm_pages_merged;
+	}
+	ksm_autotune = knob;
+	mutex_unlock(&ksm_thread_mutex);
+
+	return count;
+}
+KSM_ATTR(autotune);
+
+static ssize_t autotune_min_pages_show(struct kobject *kobj,
+				       struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", ksm_autotune_min_pages);
+}
+
+static ssize_t autotune_min_pages_store(struct kobject *kobj,
+					struct kobj_attribute *attr,
+					const char *buf, size_t count)
+{
+	unsigned long nr_pages;
+	int err;
+
+	err = kstrtoul(buf, 10, &nr_pages);
+	if (err)
+		return err;
+
+	mutex_lock(&ksm_thread_mutex);
+	if (!nr_pages || nr_pages > ksm_autotune_max_pages)
+		err = -EINVAL;
+	else {
+		ksm_autotune_min_pages = nr_pages;
+		ksm_autotune_pages = max(ksm_autotune_pages,
+					 ksm_autotune_min_pages);
+	}
+	mutex_unlock(&ksm_thread_mutex);
+
+	return err ? err : count;
+}
+KSM_ATTR(autotune_min_pages);
+
+static ssize_t autotune_max_pages_show(struct kobject *kobj,
+				       struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", ksm_autotune_max_pages);
+}
+
+static ssize_t autotune_max_pages_store(struct kobject *kobj,
+					struct kobj_attribute *attr,
+					const char *buf, size_t count)
+{
+	unsigned long nr_pages;
+	int err;
+
+	err = kstrtoul(buf, 10, &nr_pages);
+	if (err)
+		return err;
+
+	mutex_lock(&ksm_thread_mutex);
+	if (nr_pages > UINT_MAX || nr_pages < ksm_autotune_min_pages)
+		err = -EINVAL;
+	else {
+		ksm_autotune_max_pages = nr_pages;
+		ksm_autotune_pages = min(ksm_autotune_pages,
+					 ksm_autotune_max_pages);
+	}
+	mutex_unlock(&ksm_thread_mutex);
+
+	return err ? err : count;
+}
+KSM_ATTR(autotune_max_pages);
+
+static ssize_t autotune_pages_show(struct kobject *kobj,
+				   struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", ksm_autotune_pages);
+}
+KSM_ATTR_RO(autotune_pages);
+
 static ssize_t run_show(struct kobject *kobj, struct kobj_attribute *attr,
 			char *buf)
 {
@@ -2407,6 +2586,38 @@ static ssize_t full_scans_show(struct kobject *kobj,
 }
 KSM_ATTR_RO(full_scans);
 
+static ssize_t pages_scanned_show(struct kobject *kobj,
+				  struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%lu\n", ksm_pages_scanned);
+}
+KSM_ATTR_RO(pages_scanned);
+
+static ssize_t pages_merged_show(struct kobject *kobj,
+				 struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%lu\n", ksm_pages_merged);
+}
+KSM_ATTR_RO(pages_merged);
+
+static ssize_t scan_cpu_ms_show(struct kobject *kobj,
+				struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%llu\n", div_u64(ksm_scan_ns, NSEC_PER_MSEC));
+}
+KSM_ATTR_RO(scan_cpu_ms);
+
+/* ksmd cpu time per page merged since boot, in nanoseconds */
+static ssize_t cpu_ns_per_merge_show(struct kobject *kobj,
+				     struct kobj_attribute *attr, char *buf)
+{
+	unsigned long merged = ksm_pages_merged;
+
+	return sprintf(buf, "%llu\n",
+		       merged ? div64_u64(ksm_scan_ns, merged) : 0ULL);
+}
+KSM_ATTR_RO(cpu_ns_per_merge);
+
 static struct attribute *ksm_attrs[] = {
 	&sleep_millisecs_attr.attr,
 	&pages_to_scan_attr.attr,
@@ -2416,6 +2627,14 @@ static struct attribute *ksm_attrs[] = {
 	&pages_unshared_attr.attr,
 	&pages_volatile_attr.attr,
 	&full_scans_attr.attr,
+	&pages_scanned_attr.attr,
+	&pages_merged_attr.attr,
+	&scan_cpu_ms_attr.attr,
+	&cpu_ns_per_merge_attr.attr,
+	&autotune_attr.attr,
+	&autotune_min_pages_attr.attr,
+	&autotune_max_pages_attr.attr,
+	&autotune_pages_attr.attr,
 #ifdef CONFIG_NUMA
 	&merge_across_nodes_attr.attr,
 #endif
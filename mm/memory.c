@@ -3065,7 +3065,7 @@ static int do_swap_page(struct mm_struct *mm, struct vm_area_struct *vma,
 		goto out;
 	}
 	delayacct_set_flag(DELAYACCT_PF_SWAPIN);
-	page = lookup_swap_cache(entry);
+	page = lookup_swap_cache(entry, vma);
 	if (!page) {
 		page = swapin_readahead(entry,
 					GFP_HIGHUSER_MOVABLE, vma, address);
@@ -111,6 +111,12 @@ unsigned long totalreserve_pages __read_mostly;
 unsigned long dirty_balance_reserve __read_mostly;
 
 int percpu_pagelist_fraction;
+
+/*
+ * Pages per order, per zone and per cpu that may sit on the order-1..
+ * PCP_MAX_ORDER per-cpu lists. 0 sends every such free to the buddy lists.
+ */
+int percpu_highorder_pages = 16;
 gfp_t gfp_allowed_mask __read_mostly = GFP_BOOT_MASK;
 
 #ifdef CONFIG_PM_SLEEP
@@ -707,6 +713,74 @@ static void free_pcppages_bulk(struct zone *zone, int count,
 	spin_unlock(&zone->lock);
 }
 
+/*
+ * Blocks on the high-order lists are not in zone->free_area, so the budget
+ * is kept in pages: the larger the order, the fewer blocks are held back.
+ * Boot pagesets have high == 0 and must never hold anything.
+ */
+static inline int pcp_order_high(struct per_cpu_pages *pcp, unsigned int order)
+{
+	int pages = ACCESS_ONCE(percpu_highorder_pages);
+
+	if (!pages || !pcp->high)
+		return 0;
+	return max(pages >> order, 2);
+}
+
+static inline int pcp_order_batch(struct per_cpu_pages *pcp, unsigned int order)
+{
+	return max(pcp_order_high(pcp, order) / 2, 1);
+}
+
+/*
+ * Frees count blocks of the given order from the high-order PCP lists,
+ * the same way free_pcppages_bulk() does for order-0 pages.
+ */
+static void free_pcp_order_bulk(struct zone *zone, unsigned int order,
+				int count, struct per_cpu_pages *pcp)
+{
+	struct list_head *lists = pcp->order_lists[order - 1];
+	int migratetype = 0;
+
+	spin_lock(&zone->lock);
+	zone->all_unreclaimable = 0;
+	zone->pages_scanned = 0;
+
+	pcp->order_count[order - 1] -= count;
+	while (count) {
+		struct page *page;
+		struct list_head *list;
+		int mt;
+
+		do {
+			if (++migratetype == MIGRATE_PCPTYPES)
+				migratetype = 0;
+			list = &lists[migratetype];
+		} while (list_empty(list));
+
+		page = list_entry(list->prev, struct page, lru);
+		list_del(&page->lru);
+		mt = get_freepage_migratetype(page);
+		__free_one_page(page, zone, order, mt);
+		trace_mm_page_pcpu_drain(page, order, mt);
+		if (likely(!is_migrate_isolate_page(page)))
+			__mod_zone_freepage_state(zone, 1 << order, mt);
+		count--;
+	}
+	spin_unlock(&zone->lock);
+}
+
+/* Empties all high-order PCP lists, irqs must be disabled */
+static void drain_pcp_order_lists(struct zone *zone, struct per_cpu_pages *pcp)
+{
+	unsigned int order;
+
+	for (order = 1; order <= PCP_MAX_ORDER; order++)
+		if (pcp->order_count[order - 1])
+			free_pcp_order_bulk(zone, order,
+					    pcp->order_count[order - 1], pcp);
+}
+
 static void free_one_page(struct zone *zone, struct page *page, int order,
 				int migratetype)
 {
@@ -758,7 +832,26 @@ static void __free_pages_ok(struct page *page, unsigned int order)
 	__count_vm_events(PGFREE, 1 << order);
 	migratetype = get_pageblock_migratetype(page);
 	set_freepage_migratetype(page, migratetype);
+	if (order && order <= PCP_MAX_ORDER && migratetype < MIGRATE_PCPTYPES) {
+		struct zone *zone = page_zone(page);
+		struct per_cpu_pages *pcp = &this_cpu_ptr(zone->pageset)->pcp;
+		int high = pcp_order_high(pcp, order);
+
+		if (high) {
+			/* __free_one_page() would have done this on the way in */
+			if (unlikely(PageCompound(page)) &&
+			    unlikely(destroy_compound_page(page, order)))
+				goto out;
+			list_add(&page->lru,
+				 &pcp->order_lists[order - 1][migratetype]);
+			if (++pcp->order_count[order - 1] >= high)
+				free_pcp_order_bulk(zone, order,
+						    pcp_order_batch(pcp, order), pcp);
+			goto out;
+		}
+	}
 	free_one_page(page_zone(page), page, order, migratetype);
+out:
 	local_irq_restore(flags);
 }
 
@@ -1258,6 +1351,7 @@ void drain_zone_pages(struct zone *zone, struct per_cpu_pages *pcp)
 		free_pcppages_bulk(zone, to_drain, pcp);
 		pcp->count -= to_drain;
 	}
+	drain_pcp_order_lists(zone, pcp);
 	local_irq_restore(flags);
 }
 #endif
@@ -1286,6 +1380,7 @@ static void drain_pages(unsigned int cpu)
 			free_pcppages_bulk(zone, pcp->count, pcp);
 			pcp->count = 0;
 		}
+		drain_pcp_order_lists(zone, pcp);
 		local_irq_restore(flags);
 	}
 }
@@ -1328,11 +1423,16 @@ void drain_all_pages(void)
 	for_each_online_cpu(cpu) {
 		bool has_pcps = false;
 		for_each_populated_zone(zone) {
+			int order;
+
 			pcp = per_cpu_ptr(zone->pageset, cpu);
-			if (pcp->pcp.count) {
+			if (pcp->pcp.count)
 				has_pcps = true;
+			for (order = 0; order < PCP_MAX_ORDER; order++)
+				if (pcp->pcp.order_count[order])
+					has_pcps = true;
+			if (has_pcps)
 				break;
-			}
 		}
 		if (has_pcps)
 			cpumask_set_cpu(cpu, &cpus_with_pcps);
@@ -1535,6 +1635,46 @@ int split_free_page(struct page *page)
 	return nr_pages;
 }
 
+/*
+ * Takes an order-1..PCP_MAX_ORDER block off this CPU's lists, refilling
+ * them from the buddy lists in one batch when empty. Returns NULL if the
+ * lists are off for this order or the zone could not refill them.
+ * Interrupts must be disabled.
+ */
+static struct page *rmqueue_pcp_order(struct zone *zone, unsigned int order,
+				      int migratetype, int cold)
+{
+	struct per_cpu_pages *pcp;
+	struct list_head *list;
+	struct page *page;
+
+	if (order > PCP_MAX_ORDER)
+		return NULL;
+	pcp = &this_cpu_ptr(zone->pageset)->pcp;
+	if (!pcp_order_high(pcp, order))
+		return NULL;
+
+	list = &pcp->order_lists[order - 1][migratetype];
+	if (list_empty(list)) {
+		pcp->order_count[order - 1] += rmqueue_bulk(zone, order,
+					pcp_order_batch(pcp, order), list,
+					migratetype, cold);
+		if (unlikely(list_empty(list)))
+			return NULL;
+		__count_vm_event(PCP_REFILL_ORDER0 + order);
+	} else
+		__count_vm_event(PCP_HIT_ORDER0 + order);
+
+	if (cold)
+		page = list_entry(list->prev, struct page, lru);
+	else
+		page = list_entry(list->next, struct page, lru);
+
+	list_del(&page->lru);
+	pcp->order_count[order - 1]--;
+	return page;
+}
+
 /*
  * Really, prep_compound_page() should be called from __rmqueue_bulk().  But
  * we cheat by calling it from here, in the order > 0 path.  Saves a branch
@@ -1563,7 +1703,9 @@ again:
 					migratetype, cold);
 			if (unlikely(list_empty(list)))
 				goto failed;
-		}
+			__count_vm_event(PCP_REFILL_ORDER0);
+		} else
+			__count_vm_event(PCP_HIT_ORDER0);
 
 		if (cold)
 			page = list_entry(list->prev, struct page, lru);
@@ -1573,6 +1715,11 @@ again:
 		list_del(&page->lru);
 		pcp->count--;
 	} else {
+		local_irq_save(flags);
+		page = rmqueue_pcp_order(zone, order, migratetype, cold);
+		if (page)
+			goto out;
+
 		if (unlikely(gfp_flags & __GFP_NOFAIL)) {
 			/*
 			 * __GFP_NOFAIL is not to be used in new code.
@@ -1586,7 +1733,7 @@ again:
 			 */
 			WARN_ON_ONCE(order > 1);
 		}
-		spin_lock_irqsave(&zone->lock, flags);
+		spin_lock(&zone->lock);
 		page = __rmqueue(zone, order, migratetype);
 		spin_unlock(&zone->lock);
 		if (!page)
@@ -1595,6 +1742,7 @@ again:
 					  get_pageblock_migratetype(page));
 	}
 
+out:
 	__count_zone_vm_events(PGALLOC, zone, 1 << order);
 	zone_statistics(preferred_zone, zone, gfp_flags);
 	local_irq_restore(flags);
@@ -2477,7 +2625,7 @@ static inline struct page *
 __alloc_pages_slowpath(gfp_t gfp_mask, unsigned int order,
 	struct zonelist *zonelist, enum zone_type high_zoneidx,
 	nodemask_t *nodemask, struct zone *preferred_zone,
-	int migratetype)
+	int migratetype, enum alloc_path *path)
 {
 	const gfp_t wait = gfp_mask & __GFP_WAIT;
 	struct page *page = NULL;
@@ -2593,6 +2741,8 @@ rebalance:
 	 * Try direct compaction. The first pass is asynchronous. Subsequent
 	 * attempts after direct reclaim are synchronous
 	 */
+	if (order && *path < ALLOC_PATH_COMPACT)
+		*path = ALLOC_PATH_COMPACT;
 	page = __alloc_pages_direct_compact(gfp_mask, order,
 					zonelist, high_zoneidx,
 					nodemask,
@@ -2616,6 +2766,8 @@ rebalance:
 		goto nopage;
 
 	/* Try direct reclaim and then allocating */
+	if (*path < ALLOC_PATH_RECLAIM)
+		*path = ALLOC_PATH_RECLAIM;
 	page = __alloc_pages_direct_reclaim(gfp_mask, order,
 					zonelist, high_zoneidx,
 					nodemask,
@@ -2636,6 +2788,7 @@ rebalance:
 			if ((current->flags & PF_DUMPCORE) &&
 			    !(gfp_mask & __GFP_NOFAIL))
 				goto nopage;
+			*path = ALLOC_PATH_OOM;
 			page = __alloc_pages_may_oom(gfp_mask, order,
 					zonelist, high_zoneidx,
 					nodemask, preferred_zone,
@@ -2746,6 +2899,8 @@ __alloc_pages_nodemask(gfp_t gfp_mask, unsigned int order,
 	unsigned int cpuset_mems_cookie;
 	int alloc_flags = ALLOC_WMARK_LOW|ALLOC_CPUSET;
 	struct mem_cgroup *memcg = NULL;
+	enum alloc_path path = ALLOC_PATH_FAST;
+	u64 alloc_start = alloc_latency_start();
 
 	gfp_mask &= gfp_allowed_mask;
 
@@ -2835,9 +2990,11 @@ retry_cpuset:
 #endif
 		}
 
+		if (path < ALLOC_PATH_SLOW)
+			path = ALLOC_PATH_SLOW;
 		page = __alloc_pages_slowpath(gfp_mask, order,
 				zonelist, high_zoneidx, nodemask,
-				preferred_zone, migratetype);
+				preferred_zone, migratetype, &path);
 	}
 
 
@@ -2927,6 +3084,7 @@ out:
 	if (unlikely(!put_mems_allowed(cpuset_mems_cookie) && !page))
 		goto retry_cpuset;
 
+	alloc_latency_account(gfp_mask, order, path, alloc_start, !page);
 	memcg_kmem_commit_charge(page, memcg, order);
 
 	return page;
@@ -4524,7 +4682,7 @@ static int __meminit zone_batchsize(struct zone *zone)
 static void setup_pageset(struct per_cpu_pageset *p, unsigned long batch)
 {
 	struct per_cpu_pages *pcp;
-	int migratetype;
+	int migratetype, order;
 
 	memset(p, 0, sizeof(*p));
 
@@ -4532,8 +4690,11 @@ static void setup_pageset(struct per_cpu_pageset *p, unsigned long batch)
 	pcp->count = 0;
 	pcp->high = 6 * batch;
 	pcp->batch = max(1UL, 1 * batch);
-	for (migratetype = 0; migratetype < MIGRATE_PCPTYPES; migratetype++)
+	for (migratetype = 0; migratetype < MIGRATE_PCPTYPES; migratetype++) {
 		INIT_LIST_HEAD(&pcp->lists[migratetype]);
+		for (order = 0; order < PCP_MAX_ORDER; order++)
+			INIT_LIST_HEAD(&pcp->order_lists[order][migratetype]);
+	}
 }
 
 /*
@@ -5100,6 +5261,9 @@ static void __paginginit free_area_init_core(struct pglist_data *pgdat,
 #endif
 	init_waitqueue_head(&pgdat->kswapd_wait);
 	init_waitqueue_head(&pgdat->pfmemalloc_wait);
+#ifdef CONFIG_COMPACTION
+	init_waitqueue_head(&pgdat->kcompactd_wait);
+#endif
 	pgdat_page_cgroup_init(pgdat);
 
 	for (j = 0; j < MAX_NR_ZONES; j++) {
@@ -6066,6 +6230,23 @@ int percpu_pagelist_fraction_sysctl_handler(ctl_table *table, int write,
 	return 0;
 }
 
+/*
+ * percpu_highorder_pages - sizes the order-1..PCP_MAX_ORDER per cpu lists.
+ * Whatever they hold beyond the new budget is given back to the buddy
+ * allocator right away.
+ */
+int percpu_highorder_pages_sysctl_handler(ctl_table *table, int write,
+	void __user *buffer, size_t *length, loff_t *ppos)
+{
+	int ret;
+
+	ret = proc_dointvec_minmax(table, write, buffer, length, ppos);
+	if (!write || (ret < 0))
+		return ret;
+	drain_all_pages();
+	return 0;
+}
+
 int hashdist = HASHDIST_DEFAULT;
 
 #ifdef CONFIG_NUMA
@@ -6567,6 +6748,7 @@ static int __meminit __zone_pcp_update(void *data)
 		local_irq_save(flags);
 		if (pcp->count > 0)
 			free_pcppages_bulk(zone, pcp->count, pcp);
+		drain_pcp_order_lists(zone, pcp);
 		drain_zonestat(zone, pset);
 		setup_pageset(pset, batch);
 		local_irq_restore(flags);
@@ -932,6 +932,8 @@ static struct page *shmem_swapin(swp_entry_t swap, gfp_t gfp,
 	pvma.vm_pgoff = index + info->vfs_inode.i_ino;
 	pvma.vm_ops = NULL;
 	pvma.vm_policy = mpol_shared_policy_lookup(&info->policy, index);
+	/* No mm: swap readahead falls back to its shared feedback */
+	pvma.vm_mm = NULL;
 
 	page = swapin_readahead(swap, gfp, &pvma, 0);
 
@@ -1128,7 +1130,7 @@ repeat:
 
 	if (swap.val) {
 		/* Look it up and read it in.. */
-		page = lookup_swap_cache(swap);
+		page = lookup_swap_cache(swap, NULL);
 		if (!page) {
 			/* here we actually do the io */
 			if (fault_type)
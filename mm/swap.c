@@ -491,6 +491,7 @@ void mark_page_accessed(struct page *page)
 			PageReferenced(page) && PageLRU(page)) {
 		activate_page(page);
 		ClearPageReferenced(page);
+		workingset_activation(page);
 	} else if (!PageReferenced(page)) {
 		SetPageReferenced(page);
 	}
@@ -921,15 +922,15 @@ void __init swap_setup(void)
 	}
 #endif
 
-	/* Use a smaller cluster for small-memory machines */
-#ifdef CONFIG_ZRAM
-	page_cluster = 0; // disable swap read-ahead
-#else	
+	/*
+	 * Use a smaller cluster for small-memory machines. This is only
+	 * the upper bound, swapin_readahead() shrinks the window itself
+	 * when read ahead pages go unused, as they mostly do on zram.
+	 */
 	if (megs < 16)
 		page_cluster = 2;
 	else
 		page_cluster = 3;
-#endif		
 	/*
 	 * Right now other parts of the system means that we
 	 * _really_ don't want to cluster much more
@@ -0,0 +1,340 @@
+/*
+ * Per-CPU swap slot caches
+ *
+ * Every swapout used to take swap_lock and the swap area lock to scan the
+ * swap map for a single entry, and every swap cache release took the area
+ * lock again to give a single entry back. With several CPUs reclaiming
+ * into zram at once those locks dominate.
+ *
+ * Each CPU now keeps up to SWAP_SLOTS_CACHE_SIZE entries allocated with
+ * SWAP_HAS_CACHE, refilled in one batch through get_swap_pages(), which
+ * takes them sequentially from the area's current cluster. Entries whose
+ * last user was the swap cache are likewise parked per CPU and returned in
+ * one batch by swapcache_free_entries().
+ *
+ * A parked entry has SWAP_HAS_CACHE set, no page and no references, so
+ * read_swap_cache_async() must not wait for it to show up in the swap
+ * cache, and swapoff drains the caches before it looks for users.
+ *
+ * Nothing may stay parked where it cannot be used: a CPU going offline
+ * gives its entries back, so does every CPU once free swap runs short
+ * enough to switch the cache off, and parked frees are flushed after
+ * SWAP_SLOTS_FLUSH_DELAY so that zram gets its memory back.
+ */
+#include <linux/mm.h>
+#include <linux/swap.h>
+#include <linux/swap_slots.h>
+#include <linux/percpu.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/cpumask.h>
+#include <linux/sched.h>
+#include <linux/math64.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/init.h>
+#include <linux/cpu.h>
+#include <linux/notifier.h>
+#include <linux/workqueue.h>
+
+/* Per online CPU cache sizes of free swap to switch the cache on and off */
+#define SWAP_SLOTS_ACTIVATE	4
+#define SWAP_SLOTS_DEACTIVATE	2
+
+#define SWAP_SLOTS_FLUSH_DELAY	(2 * HZ)
+
+struct swap_slots_cache {
+	struct mutex	alloc_lock;	/* protects slots, nr and cur */
+	swp_entry_t	slots[SWAP_SLOTS_CACHE_SIZE];
+	int		nr;		/* entries left in slots */
+	int		cur;		/* next entry to hand out */
+	spinlock_t	free_lock;	/* protects slots_ret and n_ret */
+	swp_entry_t	slots_ret[SWAP_SLOTS_CACHE_SIZE];
+	int		n_ret;
+};
+
+struct swap_slots_stat {
+	unsigned long	alloc_hit;	/* served from the cache */
+	unsigned long	alloc_refill;	/* batches taken from a swap area */
+	unsigned long	alloc_direct;	/* single allocations, cache off */
+	unsigned long	free_deferred;	/* parked for a batched free */
+	unsigned long	free_flush;	/* batches given back */
+	unsigned long	lock_count[SWAP_LOCK_NR];
+	unsigned long	lock_entries[SWAP_LOCK_NR];
+	u64		lock_ns[SWAP_LOCK_NR];
+	u64		lock_max_ns[SWAP_LOCK_NR];
+};
+
+static DEFINE_PER_CPU(struct swap_slots_cache, swp_slots);
+static DEFINE_PER_CPU(struct swap_slots_stat, swp_slots_stat);
+static bool swap_slots_ready __read_mostly;
+static bool swap_slots_enabled;		/* written under swap_slots_mutex */
+static DEFINE_MUTEX(swap_slots_mutex);
+
+static void swap_slots_flush(struct work_struct *work);
+static DECLARE_DEFERRABLE_WORK(swap_slots_flush_work, swap_slots_flush);
+
+static const char * const swap_lock_op_name[] = {
+	[SWAP_LOCK_ALLOC] = "alloc",
+	[SWAP_LOCK_FREE] = "free",
+};
+
+static int drain_slots_cache_cpu(int cpu, bool alloc)
+{
+	struct swap_slots_cache *cache = per_cpu_ptr(&swp_slots, cpu);
+	int drained = 0;
+
+	if (alloc) {
+		mutex_lock(&cache->alloc_lock);
+		if (cache->nr) {
+			swapcache_free_entries(cache->slots + cache->cur,
+					       cache->nr);
+			drained += cache->nr;
+			cache->nr = 0;
+			cache->cur = 0;
+		}
+		mutex_unlock(&cache->alloc_lock);
+	}
+
+	spin_lock(&cache->free_lock);
+	if (cache->n_ret) {
+		swapcache_free_entries(cache->slots_ret, cache->n_ret);
+		drained += cache->n_ret;
+		cache->n_ret = 0;
+	}
+	spin_unlock(&cache->free_lock);
+
+	return drained;
+}
+
+/*
+ * Parking entries takes them out of nr_swap_pages, so stop refilling
+ * once free swap gets short enough for that to matter, and hand back
+ * what is parked at that point. The gap between the two thresholds
+ * keeps a swap area hovering around one of them from draining the
+ * caches over and over.
+ */
+static bool swap_slots_cache_active(void)
+{
+	long pages = atomic_long_read(&nr_swap_pages);
+	long per_cpu = (long)num_online_cpus() * SWAP_SLOTS_CACHE_SIZE;
+	bool enable;
+
+	if (!swap_slots_ready)
+		return false;
+
+	enable = ACCESS_ONCE(swap_slots_enabled);
+	if (enable ? pages >= per_cpu * SWAP_SLOTS_DEACTIVATE :
+		     pages <= per_cpu * SWAP_SLOTS_ACTIVATE)
+		return enable;
+
+	mutex_lock(&swap_slots_mutex);
+	if (swap_slots_enabled == enable) {
+		swap_slots_enabled = !enable;
+		if (enable)
+			drain_swap_slots_caches();
+	}
+	mutex_unlock(&swap_slots_mutex);
+
+	return !enable;
+}
+
+/*
+ * @start is the sched_clock() value taken when the swap area lock was
+ * acquired for @entries entries.
+ */
+void swap_lock_account(enum swap_lock_op op, unsigned int entries, u64 start)
+{
+	u64 ns = sched_clock() - start;
+	struct swap_slots_stat *st = &get_cpu_var(swp_slots_stat);
+
+	st->lock_count[op]++;
+	st->lock_entries[op] += entries;
+	st->lock_ns[op] += ns;
+	if (ns > st->lock_max_ns[op])
+		st->lock_max_ns[op] = ns;
+	put_cpu_var(swp_slots_stat);
+}
+
+swp_entry_t get_swap_page(void)
+{
+	struct swap_slots_cache *cache;
+	swp_entry_t entry = { 0 };
+
+	if (swap_slots_cache_active()) {
+		cache = per_cpu_ptr(&swp_slots, raw_smp_processor_id());
+		mutex_lock(&cache->alloc_lock);
+		/* a refill after a deactivation drain would stay stranded */
+		if (!cache->nr && ACCESS_ONCE(swap_slots_enabled)) {
+			cache->cur = 0;
+			cache->nr = get_swap_pages(SWAP_SLOTS_CACHE_SIZE,
+						   cache->slots);
+			if (cache->nr)
+				this_cpu_inc(swp_slots_stat.alloc_refill);
+		}
+		if (cache->nr) {
+			entry = cache->slots[cache->cur];
+			cache->slots[cache->cur++].val = 0;
+			cache->nr--;
+		}
+		mutex_unlock(&cache->alloc_lock);
+		if (entry.val) {
+			this_cpu_inc(swp_slots_stat.alloc_hit);
+			return entry;
+		}
+	}
+
+	this_cpu_inc(swp_slots_stat.alloc_direct);
+	get_swap_pages(1, &entry);
+	return entry;
+}
+
+/**
+ * free_swap_slot - defer the release of a swap cache only entry
+ * @entry: entry only the swap cache was holding
+ *
+ * Returns %false if the caller has to free @entry itself.
+ */
+bool free_swap_slot(swp_entry_t entry)
+{
+	struct swap_slots_cache *cache;
+
+	if (!swap_slots_ready || !ACCESS_ONCE(swap_slots_enabled))
+		return false;
+
+	cache = &get_cpu_var(swp_slots);
+	spin_lock(&cache->free_lock);
+	if (cache->n_ret >= SWAP_SLOTS_CACHE_SIZE) {
+		swapcache_free_entries(cache->slots_ret, cache->n_ret);
+		cache->n_ret = 0;
+		this_cpu_inc(swp_slots_stat.free_flush);
+	}
+	cache->slots_ret[cache->n_ret++] = entry;
+	if (cache->n_ret == 1)
+		schedule_delayed_work(&swap_slots_flush_work,
+				      SWAP_SLOTS_FLUSH_DELAY);
+	spin_unlock(&cache->free_lock);
+	this_cpu_inc(swp_slots_stat.free_deferred);
+	put_cpu_var(swp_slots);
+
+	return true;
+}
+
+/**
+ * drain_swap_slots_caches - give every parked entry back to its swap area
+ *
+ * Used by swapoff, which cannot tell a parked entry from a leaked one,
+ * and when the cache switches off. Returns the number of entries released.
+ */
+int drain_swap_slots_caches(void)
+{
+	int cpu, drained = 0;
+
+	if (!swap_slots_ready)
+		return 0;
+
+	for_each_possible_cpu(cpu)
+		drained += drain_slots_cache_cpu(cpu, true);
+	return drained;
+}
+
+/* Parked frees hold zram memory, do not let them sit there */
+static void swap_slots_flush(struct work_struct *work)
+{
+	int cpu, flushed = 0;
+
+	for_each_possible_cpu(cpu)
+		flushed += drain_slots_cache_cpu(cpu, false);
+	if (flushed)
+		this_cpu_inc(swp_slots_stat.free_flush);
+}
+
+static int swap_slots_cpu_notify(struct notifier_block *self,
+				 unsigned long action, void *hcpu)
+{
+	int cpu = (unsigned long)hcpu;
+
+	if (action == CPU_DEAD || action == CPU_DEAD_FROZEN)
+		drain_slots_cache_cpu(cpu, true);
+	return NOTIFY_OK;
+}
+
+#ifdef CONFIG_DEBUG_FS
+static int swap_slots_show(struct seq_file *s, void *unused)
+{
+	struct swap_slots_stat sum = { 0 };
+	int cpu, op, parked = 0;
+
+	for_each_possible_cpu(cpu) {
+		struct swap_slots_stat *st = per_cpu_ptr(&swp_slots_stat, cpu);
+		struct swap_slots_cache *cache = per_cpu_ptr(&swp_slots, cpu);
+
+		parked += ACCESS_ONCE(cache->nr) + ACCESS_ONCE(cache->n_ret);
+		sum.alloc_hit += st->alloc_hit;
+		sum.alloc_refill += st->alloc_refill;
+		sum.alloc_direct += st->alloc_direct;
+		sum.free_deferred += st->free_deferred;
+		sum.free_flush += st->free_flush;
+		for (op = 0; op < SWAP_LOCK_NR; op++) {
+			sum.lock_count[op] += st->lock_count[op];
+			sum.lock_entries[op] += st->lock_entries[op];
+			sum.lock_ns[op] += st->lock_ns[op];
+			sum.lock_max_ns[op] = max(sum.lock_max_ns[op],
+						  st->lock_max_ns[op]);
+		}
+	}
+
+	seq_printf(s, "cache: %d slots per cpu, %s, %d parked\n",
+		   SWAP_SLOTS_CACHE_SIZE,
+		   swap_slots_cache_active() ? "active" : "inactive", parked);
+	seq_printf(s, "alloc: hit %lu refill %lu direct %lu\n",
+		   sum.alloc_hit, sum.alloc_refill, sum.alloc_direct);
+	seq_printf(s, "free: deferred %lu flush %lu\n",
+		   sum.free_deferred, sum.free_flush);
+	seq_printf(s, "%-6s %12s %12s %10s %10s\n",
+		   "lock", "acquired", "entries", "avg_ns", "max_ns");
+	for (op = 0; op < SWAP_LOCK_NR; op++) {
+		u64 avg = 0;
+
+		if (sum.lock_count[op])
+			avg = div64_u64(sum.lock_ns[op], sum.lock_count[op]);
+		seq_printf(s, "%-6s %12lu %12lu %10llu %10llu\n",
+			   swap_lock_op_name[op], sum.lock_count[op],
+			   sum.lock_entries[op], avg, sum.lock_max_ns[op]);
+	}
+	return 0;
+}
+
+static int swap_slots_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, swap_slots_show, NULL);
+}
+
+static const struct file_operations swap_slots_fops = {
+	.open		= swap_slots_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+#endif
+
+static int __init swap_slots_init(void)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct swap_slots_cache *cache = per_cpu_ptr(&swp_slots, cpu);
+
+		mutex_init(&cache->alloc_lock);
+		spin_lock_init(&cache->free_lock);
+	}
+	swap_slots_ready = true;
+	hotcpu_notifier(swap_slots_cpu_notify, 0);
+
+#ifdef CONFIG_DEBUG_FS
+	debugfs_create_file("swap_slots", S_IRUGO, NULL, NULL,
+			    &swap_slots_fops);
+#endif
+	return 0;
+}
+subsys_initcall(swap_slots_init);
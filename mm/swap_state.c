@@ -10,6 +10,7 @@
 #include <linux/gfp.h>
 #include <linux/kernel_stat.h>
 #include <linux/swap.h>
+#include <linux/swap_slots.h>
 #include <linux/swapops.h>
 #include <linux/init.h>
 #include <linux/pagemap.h>
@@ -293,20 +294,34 @@ void free_pages_and_swap_cache(struct page **pages, int nr)
 	}
 }
 
+/* Feedback for shmem and other swapins without a real vma */
+static struct swap_ra_info swap_ra_shared;
+
+static inline struct swap_ra_info *swap_ra_info(struct vm_area_struct *vma)
+{
+	return vma && vma->vm_mm ? &vma->swap_ra : &swap_ra_shared;
+}
+
 /*
  * Lookup a swap entry in the swap cache. A found page will be returned
  * unlocked and with its refcount incremented - we rely on the kernel
  * lock getting page table operations atomic even if we drop the page
- * lock before returning.
+ * lock before returning. A hit on a page brought in by readahead is
+ * credited to @vma, which may be NULL.
  */
-struct page * lookup_swap_cache(swp_entry_t entry)
+struct page * lookup_swap_cache(swp_entry_t entry, struct vm_area_struct *vma)
 {
 	struct page *page;
 
 	page = find_get_page(swap_address_space(entry), entry.val);
 
-	if (page)
+	if (page) {
 		INC_CACHE_INFO(find_success);
+		if (TestClearPageReadahead(page)) {
+			atomic_inc(&swap_ra_info(vma)->hits);
+			count_vm_event(SWAP_RA_HIT);
+		}
+	}
 
 	INC_CACHE_INFO(find_total);
 	return page;
@@ -357,6 +372,14 @@ struct page *read_swap_cache_async(swp_entry_t entry, gfp_t gfp_mask,
 		err = swapcache_prepare(entry);
 		if (err == -EEXIST) {
 			radix_tree_preload_end();
+			/*
+			 * Nobody but a swap cache holds the entry and the page
+			 * is not there: it was allocated or freed through the
+			 * per-cpu swap slot caches and nothing is ever going
+			 * to add it, which is what readahead runs into.
+			 */
+			if (swap_entry_cache_only(entry))
+				break;
 			/*
 			 * We might race against get_swap_page() and stumble
 			 * across a SWAP_HAS_CACHE swap_map entry whose page
@@ -389,7 +412,11 @@ struct page *read_swap_cache_async(swp_entry_t entry, gfp_t gfp_mask,
 			/*
 			 * Initiate read into locked page and return.
 			 */
-			lru_cache_add_anon(new_page);
+			if (workingset_refault(swap_address_space(entry),
+					       entry.val, false))
+				__lru_cache_add(new_page, LRU_ACTIVE_ANON);
+			else
+				lru_cache_add_anon(new_page);
 			swap_readpage(new_page);
 			return new_page;
 		}
@@ -408,6 +435,50 @@ struct page *read_swap_cache_async(swp_entry_t entry, gfp_t gfp_mask,
 	return found_page;
 }
 
+/*
+ * Size the readahead window from how many pages of the last one were used:
+ * without hits only a swapin next to the previous one reads ahead, with
+ * hits the window grows to the next power of two above them, and it never
+ * drops below half of the last window so one miss does not collapse it.
+ */
+static unsigned int swapin_nr_pages(struct swap_ra_info *ra,
+				    unsigned long offset)
+{
+	unsigned int hits, pages, max_pages, last_win;
+
+	max_pages = 1 << ACCESS_ONCE(page_cluster);
+	if (max_pages <= 1)
+		return 1;
+
+	hits = atomic_xchg(&ra->hits, 0);
+	if (ra->marked > hits)
+		count_vm_events(SWAP_RA_MISS, ra->marked - hits);
+
+	pages = hits + 2;
+	if (pages == 2) {
+		if (offset != ra->prev_offset + 1 &&
+		    offset != ra->prev_offset - 1)
+			pages = 1;
+	} else {
+		unsigned int roundup = 4;
+
+		while (roundup < pages)
+			roundup <<= 1;
+		pages = roundup;
+	}
+	ra->prev_offset = offset;
+
+	if (pages > max_pages)
+		pages = max_pages;
+
+	last_win = ra->win / 2;
+	if (pages < last_win)
+		pages = last_win;
+	ra->win = pages;
+
+	return pages;
+}
+
 /**
  * swapin_readahead - swap in pages in hope we need them soon
  * @entry: swap entry of this memory
@@ -418,9 +489,10 @@ struct page *read_swap_cache_async(swp_entry_t entry, gfp_t gfp_mask,
  * Returns the struct page for entry and addr, after queueing swapin.
  *
  * Primitive swap readahead code. We simply read an aligned block of
- * (1 << page_cluster) entries in the swap area. This method is chosen
- * because it doesn't cost us any seek time.  We also make sure to queue
- * the 'original' request together with the readahead ones...
+ * entries in the swap area, at most (1 << page_cluster) of them and fewer
+ * when the pages read ahead for @vma recently went unused. This method is
+ * chosen because it doesn't cost us any seek time.  We also make sure to
+ * queue the 'original' request together with the readahead ones...
  *
  * This has been extended to use the NUMA policies from the mm triggering
  * the readahead.
@@ -431,12 +503,19 @@ struct page *swapin_readahead(swp_entry_t entry, gfp_t gfp_mask,
 			struct vm_area_struct *vma, unsigned long addr)
 {
 	struct page *page;
-	unsigned long offset = swp_offset(entry);
+	struct swap_ra_info *ra = swap_ra_info(vma);
+	unsigned long entry_offset = swp_offset(entry);
+	unsigned long offset = entry_offset;
 	unsigned long start_offset, end_offset;
-	unsigned long mask = (1UL << page_cluster) - 1;
+	unsigned long mask;
+	unsigned int marked = 0;
 	struct blk_plug plug;
 
-	/* Read a page_cluster sized and aligned cluster around offset. */
+	mask = swapin_nr_pages(ra, offset) - 1;
+	if (!mask)
+		goto skip;
+
+	/* Read a window sized and aligned cluster around offset. */
 	start_offset = offset & ~mask;
 	end_offset = offset | mask;
 	if (!start_offset)	/* First page is swap header. */
@@ -449,10 +528,17 @@ struct page *swapin_readahead(swp_entry_t entry, gfp_t gfp_mask,
 						gfp_mask, vma, addr);
 		if (!page)
 			continue;
+		if (offset != entry_offset) {
+			SetPageReadahead(page);
+			marked++;
+		}
 		page_cache_release(page);
 	}
 	blk_finish_plug(&plug);
 
 	lru_add_drain();	/* Push any new pages onto the LRU now */
+	count_vm_events(SWAP_RA, marked);
+skip:
+	ra->marked = marked;
 	return read_swap_cache_async(entry, gfp_mask, vma, addr);
 }
@@ -34,6 +34,7 @@
 #include <linux/oom.h>
 #include <linux/frontswap.h>
 #include <linux/swapfile.h>
+#include <linux/swap_slots.h>
 #include <linux/export.h>
 
 #include <asm/pgtable.h>
@@ -413,18 +414,30 @@ no_page:
 	return 0;
 }
 
-swp_entry_t get_swap_page(void)
+/*
+ * Allocate up to @n entries with SWAP_HAS_CACHE set, all from the first
+ * usable swap area, and return how many were stored in @entries. Taking
+ * them under a single hold of the area lock lets scan_swap_map() hand out
+ * a sequential run from its current cluster.
+ */
+int get_swap_pages(int n, swp_entry_t entries[])
 {
 	struct swap_info_struct *si;
 	pgoff_t offset;
 	int type, next;
 	int wrapped = 0;
 	int hp_index;
+	int n_ret = 0;
+	long avail;
+	u64 start;
 
 	spin_lock(&swap_lock);
-	if (atomic_long_read(&nr_swap_pages) <= 0)
+	avail = atomic_long_read(&nr_swap_pages);
+	if (avail <= 0)
 		goto noswap;
-	atomic_long_dec(&nr_swap_pages);
+	if (n > avail)
+		n = avail;
+	atomic_long_sub(n, &nr_swap_pages);
 
 	for (type = swap_list.next; type >= 0 && wrapped < 2; type = next) {
 		hp_index = atomic_xchg(&highest_priority_index, -1);
@@ -468,19 +481,28 @@ swp_entry_t get_swap_page(void)
 		swap_list.next = next;
 
 		spin_unlock(&swap_lock);
+		start = sched_clock();
 		/* This is called for allocating swap entry for cache */
-		offset = scan_swap_map(si, SWAP_HAS_CACHE);
+		while (n_ret < n) {
+			offset = scan_swap_map(si, SWAP_HAS_CACHE);
+			if (!offset)
+				break;
+			entries[n_ret++] = swp_entry(type, offset);
+		}
 		spin_unlock(&si->lock);
-		if (offset)
-			return swp_entry(type, offset);
+		swap_lock_account(SWAP_LOCK_ALLOC, n_ret, start);
+		if (n_ret)
+			goto out;
 		spin_lock(&swap_lock);
 		next = swap_list.next;
 	}
 
-	atomic_long_inc(&nr_swap_pages);
 noswap:
 	spin_unlock(&swap_lock);
-	return (swp_entry_t) {0};
+out:
+	if (n_ret < n)
+		atomic_long_add(n - n_ret, &nr_swap_pages);
+	return n_ret;
 }
 
 /* The only caller of this function is now susupend routine */
@@ -744,14 +766,36 @@ static unsigned char swap_entry_free(struct swap_info_struct *p,
 void swap_free(swp_entry_t entry)
 {
 	struct swap_info_struct *p;
+	u64 start;
 
 	p = swap_info_get(entry);
 	if (p) {
+		start = sched_clock();
 		swap_entry_free(p, entry, 1);
 		spin_unlock(&p->lock);
+		swap_lock_account(SWAP_LOCK_FREE, 1, start);
 	}
 }
 
+/*
+ * Unlocked check whether only a swap cache holds @entry, either the page
+ * in the swap cache or one of the per-cpu swap slot caches. Nobody can
+ * take a new reference to such an entry through a page table.
+ */
+bool swap_entry_cache_only(swp_entry_t entry)
+{
+	struct swap_info_struct *p;
+	unsigned long type = swp_type(entry);
+	unsigned long offset = swp_offset(entry);
+
+	if (!entry.val || type >= nr_swapfiles)
+		return false;
+	p = swap_info[type];
+	if (!(p->flags & SWP_USED) || offset >= p->max)
+		return false;
+	return ACCESS_ONCE(p->swap_map[offset]) == SWAP_HAS_CACHE;
+}
+
 /*
  * Called after dropping swapcache to decrease refcnt to swap entries.
  */
@@ -759,13 +803,62 @@ void swapcache_free(swp_entry_t entry, struct page *page)
 {
 	struct swap_info_struct *p;
 	unsigned char count;
+	u64 start;
+
+	/*
+	 * The last reference goes back in a batch from the per-cpu slot
+	 * cache. While swapoff runs the entry has to be freed right away,
+	 * try_to_unuse() is waiting for it.
+	 */
+	if (swap_entry_cache_only(entry) &&
+	    (swap_info[swp_type(entry)]->flags & SWP_WRITEOK) &&
+	    free_swap_slot(entry)) {
+		if (page)
+			mem_cgroup_uncharge_swapcache(page, entry, false);
+		return;
+	}
 
 	p = swap_info_get(entry);
 	if (p) {
+		start = sched_clock();
 		count = swap_entry_free(p, entry, SWAP_HAS_CACHE);
 		if (page)
 			mem_cgroup_uncharge_swapcache(page, entry, count != 0);
 		spin_unlock(&p->lock);
+		swap_lock_account(SWAP_LOCK_FREE, 1, start);
+	}
+}
+
+/*
+ * Drop SWAP_HAS_CACHE from @n entries parked in a swap slot cache, taking
+ * each swap area lock once for every run of entries of the same type.
+ */
+void swapcache_free_entries(swp_entry_t *entries, int n)
+{
+	struct swap_info_struct *p = NULL;
+	unsigned int batch = 0;
+	u64 start = 0;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (p && swp_type(entries[i]) != p->type) {
+			spin_unlock(&p->lock);
+			swap_lock_account(SWAP_LOCK_FREE, batch, start);
+			p = NULL;
+		}
+		if (!p) {
+			p = swap_info_get(entries[i]);
+			if (!p)
+				continue;
+			start = sched_clock();
+			batch = 0;
+		}
+		swap_entry_free(p, entries[i], SWAP_HAS_CACHE);
+		batch++;
+	}
+	if (p) {
+		spin_unlock(&p->lock);
+		swap_lock_account(SWAP_LOCK_FREE, batch, start);
 	}
 }
 EXPORT_SYMBOL_GPL(swap_free);
@@ -902,12 +995,14 @@ int free_swap_and_cache(swp_entry_t entry)
 {
 	struct swap_info_struct *p;
 	struct page *page = NULL;
+	u64 start;
 
 	if (non_swap_entry(entry))
 		return 1;
 
 	p = swap_info_get(entry);
 	if (p) {
+		start = sched_clock();
 		if (swap_entry_free(p, entry, 1) == SWAP_HAS_CACHE) {
 			page = find_get_page(swap_address_space(entry),
 						entry.val);
@@ -917,6 +1012,7 @@ int free_swap_and_cache(swp_entry_t entry)
 			}
 		}
 		spin_unlock(&p->lock);
+		swap_lock_account(SWAP_LOCK_FREE, 1, start);
 	}
 	if (page) {
 		/*
@@ -1326,6 +1422,16 @@ int try_to_unuse(unsigned int type, bool frontswap,
 			 */
 			if (!*swap_map)
 				continue;
+			/*
+			 * Or only a swap cache holds it: parked in a per-cpu
+			 * swap slot cache, or its page is about to be added.
+			 */
+			if (*swap_map == SWAP_HAS_CACHE) {
+				drain_swap_slots_caches();
+				cond_resched();
+				i--;
+				continue;
+			}
 			retval = -ENOMEM;
 			break;
 		}
@@ -1795,6 +1901,8 @@ SYSCALL_DEFINE1(swapoff, const char __user *, specialfile)
 	spin_unlock(&p->lock);
 	spin_unlock(&swap_lock);
 
+	drain_swap_slots_caches();
+
 	set_current_oom_origin();
 	err = try_to_unuse(type, false, 0); /* force all pages to be unused */
 	clear_current_oom_origin();
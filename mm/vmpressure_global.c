@@ -0,0 +1,321 @@
+/*
+ * System wide memory pressure levels
+ *
+ * The same computation as the memory cgroup vmpressure, for kernels built
+ * without memory cgroups. Reclaim reports how many pages it scanned and how
+ * many of them it managed to reclaim; once a window of scanned pages has
+ * been collected, the share of scanned pages that could not be reclaimed is
+ * the pressure, which maps to the low, medium or critical level.
+ *
+ * Each window's level is passed to the in-kernel notifier chain and signals
+ * every eventfd registered for that level or a lower one. Userspace
+ * registers by writing "<eventfd> <low|medium|critical>" to /proc/vmpressure
+ * and keeps the file open for as long as it wants to be notified.
+ */
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/file.h>
+#include <linux/log2.h>
+#include <linux/mm.h>
+#include <linux/slab.h>
+#include <linux/swap.h>
+#include <linux/eventfd.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/uaccess.h>
+#include <linux/vmpressure.h>
+
+/*
+ * Pages to scan before the pressure is computed. Sixteen reclaim batches
+ * give a decent average without reacting too late.
+ */
+static unsigned int vmpressure_win = SWAP_CLUSTER_MAX * 16;
+module_param_named(window, vmpressure_win, uint, S_IRUGO | S_IWUSR);
+
+/* Pressure in percent from which a window counts as medium / critical */
+static unsigned int vmpressure_level_med = 60;
+module_param_named(level_medium, vmpressure_level_med, uint, S_IRUGO | S_IWUSR);
+static unsigned int vmpressure_level_critical = 95;
+module_param_named(level_critical, vmpressure_level_critical, uint,
+		   S_IRUGO | S_IWUSR);
+
+/*
+ * Reclaim priority from which the pressure is critical regardless of the
+ * ratio: with the default of 3 reclaim already went through 1/8 of the
+ * LRUs and still has not met its target.
+ */
+static int vmpressure_level_critical_prio = ilog2(100 / 10);
+module_param_named(critical_prio, vmpressure_level_critical_prio, int,
+		   S_IRUGO | S_IWUSR);
+
+static const char * const vmpressure_str_levels[] = {
+	[VMPRESSURE_LOW] = "low",
+	[VMPRESSURE_MEDIUM] = "medium",
+	[VMPRESSURE_CRITICAL] = "critical",
+};
+
+struct vmpressure_event {
+	struct eventfd_ctx *efd;
+	enum vmpressure_levels level;
+	struct file *owner;		/* the /proc/vmpressure open that added it */
+	struct list_head node;
+};
+
+static void vmpressure_work_fn(struct work_struct *work);
+
+static struct vmpressure vmpressure_global = {
+	.sr_lock = __MUTEX_INITIALIZER(vmpressure_global.sr_lock),
+	.events = LIST_HEAD_INIT(vmpressure_global.events),
+	.events_lock = __MUTEX_INITIALIZER(vmpressure_global.events_lock),
+	.work = __WORK_INITIALIZER(vmpressure_global.work, vmpressure_work_fn),
+};
+
+static BLOCKING_NOTIFIER_HEAD(vmpressure_notifier);
+
+/* Windows seen per level, and the last one, for /proc/vmpressure */
+static unsigned long vmpressure_windows[VMPRESSURE_NUM_LEVELS];
+static unsigned long vmpressure_last;
+
+int vmpressure_notifier_register(struct notifier_block *nb)
+{
+	return blocking_notifier_chain_register(&vmpressure_notifier, nb);
+}
+EXPORT_SYMBOL(vmpressure_notifier_register);
+
+int vmpressure_notifier_unregister(struct notifier_block *nb)
+{
+	return blocking_notifier_chain_unregister(&vmpressure_notifier, nb);
+}
+EXPORT_SYMBOL(vmpressure_notifier_unregister);
+
+static enum vmpressure_levels vmpressure_level(unsigned long pressure)
+{
+	if (pressure >= vmpressure_level_critical)
+		return VMPRESSURE_CRITICAL;
+	else if (pressure >= vmpressure_level_med)
+		return VMPRESSURE_MEDIUM;
+	return VMPRESSURE_LOW;
+}
+
+static unsigned long vmpressure_calc(unsigned long scanned,
+				     unsigned long reclaimed)
+{
+	unsigned long scale = scanned + reclaimed;
+	unsigned long pressure;
+
+	/* Slab shrinking can free more than the LRU scan looked at */
+	if (reclaimed >= scanned)
+		return 0;
+
+	/*
+	 * The scale spreads the result over a larger range so that the
+	 * integer division does not throw away most of the precision.
+	 */
+	pressure = scale - (reclaimed * scale / scanned);
+	return pressure * 100 / scale;
+}
+
+static void vmpressure_work_fn(struct work_struct *work)
+{
+	struct vmpressure *vmpr = container_of(work, struct vmpressure, work);
+	struct vmpressure_event *ev;
+	unsigned long scanned, reclaimed, pressure;
+	enum vmpressure_levels level;
+
+	mutex_lock(&vmpr->sr_lock);
+	scanned = vmpr->scanned;
+	reclaimed = vmpr->reclaimed;
+	vmpr->scanned = 0;
+	vmpr->reclaimed = 0;
+	mutex_unlock(&vmpr->sr_lock);
+
+	/* Several vmpressure() calls may have queued the same work */
+	if (!scanned)
+		return;
+
+	pressure = vmpressure_calc(scanned, reclaimed);
+	level = vmpressure_level(pressure);
+	vmpressure_windows[level]++;
+	vmpressure_last = pressure;
+
+	blocking_notifier_call_chain(&vmpressure_notifier, level, &pressure);
+
+	mutex_lock(&vmpr->events_lock);
+	list_for_each_entry(ev, &vmpr->events, node) {
+		if (level >= ev->level)
+			eventfd_signal(ev->efd, 1);
+	}
+	mutex_unlock(&vmpr->events_lock);
+}
+
+/**
+ * vmpressure() - Account memory pressure through scanned/reclaimed ratio
+ * @gfp:	reclaimer's gfp mask
+ * @memcg:	unused, pressure is always accounted system wide
+ * @scanned:	number of pages scanned
+ * @reclaimed:	number of pages reclaimed
+ *
+ * Called from reclaim after each zone has been shrunk. The work of
+ * computing and delivering the level is deferred to a workqueue once a
+ * full window has been scanned.
+ */
+void vmpressure(gfp_t gfp, struct mem_cgroup *memcg,
+		unsigned long scanned, unsigned long reclaimed)
+{
+	struct vmpressure *vmpr = &vmpressure_global;
+
+	/*
+	 * Only allocations that can use highmem, move, do I/O or go to
+	 * the filesystems put the LRUs under real pressure; atomic and
+	 * lowmem-only reclaim says little about the system as a whole.
+	 */
+	if (!(gfp & (__GFP_HIGHMEM | __GFP_MOVABLE | __GFP_IO | __GFP_FS)))
+		return;
+
+	if (!scanned)
+		return;
+
+	mutex_lock(&vmpr->sr_lock);
+	vmpr->scanned += scanned;
+	vmpr->reclaimed += reclaimed;
+	scanned = vmpr->scanned;
+	mutex_unlock(&vmpr->sr_lock);
+
+	if (scanned < vmpressure_win)
+		return;
+	schedule_work(&vmpr->work);
+}
+
+/**
+ * vmpressure_prio() - Account memory pressure through reclaimer priority level
+ * @gfp:	reclaimer's gfp mask
+ * @memcg:	unused, pressure is always accounted system wide
+ * @prio:	reclaimer's priority
+ *
+ * Reports a full window of unreclaimable pages once reclaim has to go
+ * below vmpressure_level_critical_prio, so the critical level is reached
+ * even when the zones scanned so far still gave back some pages.
+ */
+void vmpressure_prio(gfp_t gfp, struct mem_cgroup *memcg, int prio)
+{
+	if (prio > vmpressure_level_critical_prio)
+		return;
+
+	vmpressure(gfp, memcg, vmpressure_win, 0);
+}
+
+static int vmpressure_proc_show(struct seq_file *m, void *v)
+{
+	struct vmpressure_event *ev;
+	int i, listeners[VMPRESSURE_NUM_LEVELS] = { 0 };
+
+	mutex_lock(&vmpressure_global.events_lock);
+	list_for_each_entry(ev, &vmpressure_global.events, node)
+		listeners[ev->level]++;
+	mutex_unlock(&vmpressure_global.events_lock);
+
+	seq_printf(m, "window: %u pages, last pressure: %lu%%\n",
+		   vmpressure_win, vmpressure_last);
+	seq_printf(m, "%-10s %9s %10s %10s\n",
+		   "level", "threshold", "windows", "listeners");
+	for (i = 0; i < VMPRESSURE_NUM_LEVELS; i++) {
+		unsigned int threshold = 0;
+
+		if (i == VMPRESSURE_MEDIUM)
+			threshold = vmpressure_level_med;
+		else if (i == VMPRESSURE_CRITICAL)
+			threshold = vmpressure_level_critical;
+		seq_printf(m, "%-10s %8u%% %10lu %10d\n", vmpressure_str_levels[i],
+			   threshold, vmpressure_windows[i], listeners[i]);
+	}
+	return 0;
+}
+
+static int vmpressure_proc_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, vmpressure_proc_show, NULL);
+}
+
+static ssize_t vmpressure_proc_write(struct file *file, const char __user *buf,
+				     size_t count, loff_t *ppos)
+{
+	struct vmpressure_event *ev;
+	struct eventfd_ctx *efd;
+	char kbuf[32], level[16];
+	int fd, i;
+
+	if (count >= sizeof(kbuf))
+		return -EINVAL;
+	if (copy_from_user(kbuf, buf, count))
+		return -EFAULT;
+	kbuf[count] = '\0';
+
+	if (sscanf(kbuf, "%d %15s", &fd, level) != 2)
+		return -EINVAL;
+
+	for (i = 0; i < VMPRESSURE_NUM_LEVELS; i++) {
+		if (!strcmp(level, vmpressure_str_levels[i]))
+			break;
+	}
+	if (i == VMPRESSURE_NUM_LEVELS)
+		return -EINVAL;
+
+	efd = eventfd_ctx_fdget(fd);
+	if (IS_ERR(efd))
+		return PTR_ERR(efd);
+
+	ev = kzalloc(sizeof(*ev), GFP_KERNEL);
+	if (!ev) {
+		eventfd_ctx_put(efd);
+		return -ENOMEM;
+	}
+	ev->efd = efd;
+	ev->level = i;
+	ev->owner = file;
+
+	mutex_lock(&vmpressure_global.events_lock);
+	list_add(&ev->node, &vmpressure_global.events);
+	mutex_unlock(&vmpressure_global.events_lock);
+
+	return count;
+}
+
+static int vmpressure_proc_release(struct inode *inode, struct file *file)
+{
+	struct vmpressure_event *ev, *tmp;
+
+	mutex_lock(&vmpressure_global.events_lock);
+	list_for_each_entry_safe(ev, tmp, &vmpressure_global.events, node) {
+		if (ev->owner != file)
+			continue;
+		list_del(&ev->node);
+		eventfd_ctx_put(ev->efd);
+		kfree(ev);
+	}
+	mutex_unlock(&vmpressure_global.events_lock);
+
+	return single_release(inode, file);
+}
+
+static const struct file_operations vmpressure_proc_fops = {
+	.open		= vmpressure_proc_open,
+	.read		= seq_read,
+	.write		= vmpressure_proc_write,
+	.llseek		= seq_lseek,
+	.release	= vmpressure_proc_release,
+};
+
+static int __init vmpressure_global_init(void)
+{
+	struct proc_dir_entry *entry;
+
+	entry = proc_create("vmpressure", S_IRUGO | S_IWUSR | S_IWGRP, NULL,
+			    &vmpressure_proc_fops);
+	if (!entry)
+		return -ENOMEM;
+	/* system group so the activity manager can register */
+	proc_set_user(entry, 0, 1000);
+	return 0;
+}
+module_init(vmpressure_global_init);
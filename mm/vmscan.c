@@ -494,7 +494,8 @@ static pageout_t pageout(struct page *page, struct address_space *mapping,
  * Same as remove_mapping, but if the page is removed from the mapping, it
  * gets returned with a refcount of 0.
  */
-static int __remove_mapping(struct address_space *mapping, struct page *page)
+static int __remove_mapping(struct address_space *mapping, struct page *page,
+			    bool reclaimed)
 {
 	BUG_ON(!PageLocked(page));
 	BUG_ON(mapping != page_mapping(page));
@@ -535,6 +536,9 @@ static int __remove_mapping(struct address_space *mapping, struct page *page)
 
 	if (PageSwapCache(page)) {
 		swp_entry_t swap = { .val = page_private(page) };
+
+		if (reclaimed)
+			workingset_eviction(mapping, swap.val, page);
 		__delete_from_swap_cache(page);
 		spin_unlock_irq(&mapping->tree_lock);
 		swapcache_free(swap, page);
@@ -543,6 +547,13 @@ static int __remove_mapping(struct address_space *mapping, struct page *page)
 
 		freepage = mapping->a_ops->freepage;
 
+		/*
+		 * Only a page that reclaim decided to drop leaves a shadow,
+		 * invalidation says nothing about the workingset. shmem
+		 * pages never come back through add_to_page_cache_lru().
+		 */
+		if (reclaimed && !PageSwapBacked(page))
+			workingset_eviction(mapping, page->index, page);
 		__delete_from_page_cache(page);
 		spin_unlock_irq(&mapping->tree_lock);
 		mem_cgroup_uncharge_cache_page(page);
@@ -566,7 +577,7 @@ cannot_free:
  */
 int remove_mapping(struct address_space *mapping, struct page *page)
 {
-	if (__remove_mapping(mapping, page)) {
+	if (__remove_mapping(mapping, page, false)) {
 		/*
 		 * Unfreezing the refcount with 1 rather than 2 effectively
 		 * drops the pagecache ref for us without requiring another
@@ -948,7 +959,7 @@ static unsigned long shrink_page_list(struct list_head *page_list,
 			}
 		}
 
-		if (!mapping || !__remove_mapping(mapping, page))
+		if (!mapping || !__remove_mapping(mapping, page, true))
 			goto keep_locked;
 
 		/*
@@ -1037,6 +1048,57 @@ unsigned long reclaim_clean_pages_from_list(struct zone *zone,
 	return ret;
 }
 
+#ifdef CONFIG_PROCESS_RECLAIM
+/*
+ * Reclaim pages isolated by a /proc/<pid>/reclaim walk, whatever their
+ * activity: the caller already decided they are no longer needed. Pages
+ * must be accounted in NR_ISOLATED_* by the caller, they are unaccounted
+ * and whatever could not be reclaimed goes back on the LRU.
+ */
+unsigned long reclaim_pages_from_list(struct list_head *page_list)
+{
+	struct scan_control sc = {
+		.gfp_mask = GFP_KERNEL,
+		.priority = DEF_PRIORITY,
+		.may_writepage = 1,
+		.may_unmap = 1,
+		.may_swap = 1,
+	};
+	unsigned long nr_reclaimed = 0;
+	unsigned long dummy1, dummy2;
+	struct page *page, *next;
+
+	/* shrink_page_list() works on one zone at a time */
+	while (!list_empty(page_list)) {
+		struct zone *zone = page_zone(lru_to_page(page_list));
+		unsigned long nr_isolated[2] = { 0, };
+		LIST_HEAD(zone_pages);
+
+		list_for_each_entry_safe(page, next, page_list, lru) {
+			if (page_zone(page) != zone)
+				continue;
+			ClearPageActive(page);
+			nr_isolated[page_is_file_cache(page)]++;
+			list_move(&page->lru, &zone_pages);
+		}
+
+		nr_reclaimed += shrink_page_list(&zone_pages, zone, &sc,
+						 TTU_UNMAP|TTU_IGNORE_ACCESS,
+						 &dummy1, &dummy2, true);
+
+		while (!list_empty(&zone_pages)) {
+			page = lru_to_page(&zone_pages);
+			list_del(&page->lru);
+			putback_lru_page(page);
+		}
+		sub_zone_page_state(zone, NR_ISOLATED_ANON, nr_isolated[0]);
+		sub_zone_page_state(zone, NR_ISOLATED_FILE, nr_isolated[1]);
+	}
+
+	return nr_reclaimed;
+}
+#endif
+
 /*
  * Attempt to remove the specified page from its LRU.  Only take this page
  * if it is of the appropriate PageActive status.  Pages which are being
@@ -3128,6 +3190,12 @@ static void kswapd_try_to_sleep(pg_data_t *pgdat, int order, int classzone_idx)
 		 */
 		reset_isolation_suitable(pgdat);
 
+		/*
+		 * kswapd got the free pages, whatever high-order blocks
+		 * are still missing are for kcompactd to put together.
+		 */
+		wakeup_kcompactd(pgdat, order, classzone_idx);
+
 		if (!kthread_should_stop())
 			schedule();
 
@@ -4001,7 +4069,7 @@ int mtkpasr_drop_page(struct page *page)
 			}
 		}
 	}
-	if (!mapping || !__remove_mapping(mapping, page)) {
+	if (!mapping || !__remove_mapping(mapping, page, true)) {
 		goto unlock;
 	}
 		
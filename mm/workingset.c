@@ -0,0 +1,180 @@
+/*
+ * Workingset detection
+ *
+ * When a page is reclaimed from an inactive list, the current inactive age
+ * of its zone is remembered for it in a shadow entry. The inactive age ticks
+ * once per eviction and once per activation, so when the page is faulted
+ * back in, the difference between the ages at refault and at eviction is
+ * how much longer the inactive list would have needed to be for the page to
+ * still be resident: its refault distance.
+ *
+ * A page that refaults within the size of the active list could have stayed
+ * cached if the active list had given up that much room to the inactive one.
+ * Such pages are part of the working set and are activated right away, so
+ * they get protected instead of being evicted again in the next round.
+ *
+ * Shadow entries live in a direct-mapped hash table rather than in the page
+ * cache trees, so nothing walking a mapping has to know about them. A newer
+ * eviction simply replaces whatever older shadow shares its slot, and a tag
+ * from the key hash keeps mismatches rare.
+ */
+#include <linux/mm.h>
+#include <linux/mmzone.h>
+#include <linux/swap.h>
+#include <linux/hash.h>
+#include <linux/bootmem.h>
+#include <linux/atomic.h>
+#include <linux/vmstat.h>
+#include <linux/init.h>
+
+/*
+ * Shadow entry layout, 0 means empty:
+ *
+ *   63       valid
+ *   62..40   tag, the key hash bits just below those picking the slot
+ *   39..32   zone the page was evicted from
+ *   31..0    inactive age at eviction
+ */
+#define WS_AGE_BITS		32
+#define WS_ZONE_SHIFT		WS_AGE_BITS
+#define WS_ZONE_BITS		8
+#define WS_TAG_SHIFT		(WS_ZONE_SHIFT + WS_ZONE_BITS)
+#define WS_TAG_BITS		(63 - WS_TAG_SHIFT)
+#define WS_VALID		(1ULL << 63)
+
+#define WS_MASK(bits)		((1ULL << (bits)) - 1)
+
+static atomic64_t *shadow_table __read_mostly;
+static unsigned int shadow_shift __read_mostly;
+
+static u64 shadow_hash(struct address_space *mapping, pgoff_t index)
+{
+	u64 key = ((u64)(unsigned long)mapping << 32) ^ index;
+
+	return hash_64(key, 64);
+}
+
+static atomic64_t *shadow_slot(u64 hash)
+{
+	return &shadow_table[hash >> (64 - shadow_shift)];
+}
+
+static u64 shadow_tag(u64 hash)
+{
+	return (hash >> (64 - shadow_shift - WS_TAG_BITS)) & WS_MASK(WS_TAG_BITS);
+}
+
+static u64 pack_shadow(u64 hash, struct zone *zone, unsigned long eviction)
+{
+	u64 zoneid = zone->zone_pgdat->node_id * MAX_NR_ZONES + zone_idx(zone);
+
+	return WS_VALID |
+	       (shadow_tag(hash) << WS_TAG_SHIFT) |
+	       (zoneid << WS_ZONE_SHIFT) |
+	       (eviction & WS_MASK(WS_AGE_BITS));
+}
+
+static struct zone *shadow_zone(u64 shadow)
+{
+	unsigned int zoneid = (shadow >> WS_ZONE_SHIFT) & WS_MASK(WS_ZONE_BITS);
+
+	return &NODE_DATA(zoneid / MAX_NR_ZONES)->node_zones[zoneid % MAX_NR_ZONES];
+}
+
+/**
+ * workingset_eviction - note the eviction of a page from memory
+ * @mapping: address space the page was backing
+ * @index: offset of the page in @mapping, the swap entry for anon pages
+ * @page: the page being evicted
+ *
+ * Called from reclaim with the mapping's tree_lock held, just before
+ * @page is removed from @mapping.
+ */
+void workingset_eviction(struct address_space *mapping, pgoff_t index,
+			 struct page *page)
+{
+	struct zone *zone = page_zone(page);
+	unsigned long eviction;
+	u64 hash;
+
+	if (!shadow_table)
+		return;
+
+	eviction = atomic_long_inc_return(&zone->inactive_age);
+	hash = shadow_hash(mapping, index);
+	atomic64_set(shadow_slot(hash), pack_shadow(hash, zone, eviction));
+}
+
+/**
+ * workingset_refault - evaluate the refault of a previously evicted page
+ * @mapping: address space the page is being added to
+ * @index: offset of the page in @mapping, the swap entry for anon pages
+ * @file: whether this is a page cache page or an anon page
+ *
+ * Consumes the shadow entry left by workingset_eviction(), if any.
+ *
+ * Returns %true if the page should be activated, %false otherwise.
+ */
+bool workingset_refault(struct address_space *mapping, pgoff_t index,
+			bool file)
+{
+	unsigned long refault, distance, active;
+	atomic64_t *slot;
+	struct zone *zone;
+	u64 hash, shadow;
+
+	if (!shadow_table)
+		return false;
+
+	hash = shadow_hash(mapping, index);
+	slot = shadow_slot(hash);
+	shadow = atomic64_read(slot);
+	if (!shadow ||
+	    ((shadow >> WS_TAG_SHIFT) & WS_MASK(WS_TAG_BITS)) != shadow_tag(hash))
+		return false;
+
+	/* Lost against another refault or a newer eviction in this slot */
+	if (atomic64_cmpxchg(slot, shadow, 0) != shadow)
+		return false;
+
+	zone = shadow_zone(shadow);
+	refault = atomic_long_read(&zone->inactive_age);
+	distance = (refault - (unsigned long)shadow) & WS_MASK(WS_AGE_BITS);
+	active = zone_page_state(zone, file ? NR_ACTIVE_FILE : NR_ACTIVE_ANON);
+
+	inc_zone_state(zone, WORKINGSET_REFAULT);
+
+	if (distance <= active) {
+		inc_zone_state(zone, WORKINGSET_ACTIVATE);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * workingset_activation - note a page activation
+ * @page: page that is being activated
+ */
+void workingset_activation(struct page *page)
+{
+	/*
+	 * Activations shrink the inactive list just like evictions, so
+	 * they advance the age the same way.
+	 */
+	atomic_long_inc(&page_zone(page)->inactive_age);
+}
+
+static int __init workingset_init(void)
+{
+	BUILD_BUG_ON(MAX_NUMNODES * MAX_NR_ZONES > (1 << WS_ZONE_BITS));
+
+	/* One shadow entry for every four pages of memory */
+	shadow_table = alloc_large_system_hash("Workingset shadow",
+					       sizeof(atomic64_t),
+					       totalram_pages / 4,
+					       0, 0, &shadow_shift, NULL,
+					       0, 0);
+	memset(shadow_table, 0, sizeof(atomic64_t) << shadow_shift);
+	return 0;
+}
+module_init(workingset_init);
@@ -0,0 +1,405 @@
+/*
+ * Binary socket event log.
+ *
+ * Replaces the per-call KERN_INFO printks of MTK_NET_LOGGING on the socket
+ * and AF_UNIX paths. Events are fixed size records written lock free into
+ * a global ring, so logging costs no formatting and no console time:
+ *
+ *   /proc/mtk_net/events	text dump of the events still in the ring
+ *   /proc/mtk_net/raw		the same as struct mtk_net_event records; the
+ *				file position is the next sequence number, so
+ *				a reader can poll it without losing its place;
+ *				tools/net/mtk_net_log is such a reader
+ *   /proc/mtk_net/classes	per class sampling and rate limits, e.g.
+ *				"echo unix 4 100 1000 > classes" logs one in
+ *				four AF_UNIX events and at most 100 per second;
+ *				a sample rate of 0 turns the class off
+ *
+ * Every logged event also fires the mtk_net:mtk_net_event tracepoint.
+ */
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/atomic.h>
+#include <linux/jiffies.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/uaccess.h>
+#include <linux/sched.h>
+#include <net/mtk_net_log.h>
+
+#define CREATE_TRACE_POINTS
+#include <trace/events/mtk_net.h>
+
+#define MTK_NET_LOG_ORDER	10
+#define MTK_NET_LOG_SIZE	(1U << MTK_NET_LOG_ORDER)
+#define MTK_NET_LOG_MASK	(MTK_NET_LOG_SIZE - 1)
+
+struct mtk_net_class_state {
+	const char	*name;
+	unsigned int	sample;		/* log one in @sample events, 0 = off */
+	unsigned int	burst;		/* events per interval, 0 = no limit */
+	unsigned int	interval;	/* in jiffies */
+
+	unsigned long	window;
+	atomic_t	used;
+	atomic_t	count;
+
+	atomic_t	seen;
+	atomic_t	sampled;
+	atomic_t	limited;
+	atomic_t	logged;
+};
+
+static struct mtk_net_class_state mtk_net_classes[MTK_NET_CLASS_MAX] = {
+	[MTK_NET_CLASS_SOCK] = { .name = "sock", .sample = 1, .burst = 200 },
+	[MTK_NET_CLASS_UNIX] = { .name = "unix", .sample = 1, .burst = 100 },
+	[MTK_NET_CLASS_WMEM] = { .name = "wmem", .sample = 1, .burst = 20 },
+};
+
+static struct mtk_net_event mtk_net_ring[MTK_NET_LOG_SIZE];
+static atomic_t mtk_net_head = ATOMIC_INIT(0);
+static DEFINE_MUTEX(mtk_net_ctl_lock);
+
+unsigned long mtk_net_log_mask __read_mostly;
+EXPORT_SYMBOL(mtk_net_log_mask);
+
+static const char * const mtk_net_type_names[MTK_NET_CLASS_MAX][8] = {
+	[MTK_NET_CLASS_SOCK] = { "create", "close", "pair", "bind", "accept",
+				 "family_reg", "family_unreg" },
+	[MTK_NET_CLASS_UNIX] = { "connect", "send_peer_dead", "recv_shutdown",
+				 "recv_timeout", "release_alive" },
+	[MTK_NET_CLASS_WMEM] = { "wait", "done" },
+};
+
+static bool mtk_net_ratelimit(struct mtk_net_class_state *c)
+{
+	unsigned long start, now = jiffies;
+
+	if (!c->burst)
+		return true;
+
+	start = ACCESS_ONCE(c->window);
+	if (time_after(now, start + c->interval) &&
+	    cmpxchg(&c->window, start, now) == start)
+		atomic_set(&c->used, 0);
+
+	return atomic_inc_return(&c->used) <= c->burst;
+}
+
+void __mtk_net_log(unsigned int type, unsigned long ino, unsigned long peer,
+		   unsigned long bytes, int err)
+{
+	struct mtk_net_class_state *c;
+	struct mtk_net_event *ev;
+	unsigned int class = MTK_NET_EV_CLASS(type);
+	unsigned int sample;
+	u32 seq;
+
+	if (class >= MTK_NET_CLASS_MAX)
+		return;
+
+	c = &mtk_net_classes[class];
+	atomic_inc(&c->seen);
+
+	sample = ACCESS_ONCE(c->sample);
+	if (!sample)
+		return;
+	if (sample > 1 && atomic_inc_return(&c->count) % sample) {
+		atomic_inc(&c->sampled);
+		return;
+	}
+	if (!mtk_net_ratelimit(c)) {
+		atomic_inc(&c->limited);
+		return;
+	}
+	atomic_inc(&c->logged);
+
+	/*
+	 * seq 0 marks a slot that is being written, readers compare the
+	 * sequence number before and after copying a record out.
+	 */
+	seq = atomic_inc_return(&mtk_net_head);
+	ev = &mtk_net_ring[(seq - 1) & MTK_NET_LOG_MASK];
+
+	ACCESS_ONCE(ev->seq) = 0;
+	smp_wmb();
+	ev->ts_ns = local_clock();
+	ev->ino = ino;
+	ev->peer = peer;
+	ev->bytes = bytes;
+	ev->err = err;
+	ev->pid = task_pid_nr(current);
+	ev->type = type;
+	ev->cpu = raw_smp_processor_id();
+	ev->reserved = 0;
+	smp_wmb();
+	ACCESS_ONCE(ev->seq) = seq;
+
+	trace_mtk_net_event(ev);
+}
+EXPORT_SYMBOL(__mtk_net_log);
+
+static u32 mtk_net_oldest(void)
+{
+	u32 head = atomic_read(&mtk_net_head);
+
+	return head > MTK_NET_LOG_SIZE ? head - MTK_NET_LOG_SIZE + 1 : 1;
+}
+
+/*
+ * Copy out the event with sequence number @seq. Returns 0 on success,
+ * -EAGAIN if it was not logged yet and -ESTALE if it was overwritten.
+ */
+static int mtk_net_read_event(u32 seq, struct mtk_net_event *out)
+{
+	struct mtk_net_event *ev = &mtk_net_ring[(seq - 1) & MTK_NET_LOG_MASK];
+	u32 head = atomic_read(&mtk_net_head);
+	u32 s1, s2;
+
+	if ((s32)(seq - head) > 0)
+		return -EAGAIN;
+	if (head - seq >= MTK_NET_LOG_SIZE)
+		return -ESTALE;
+
+	/* pairs with the two smp_wmb() in __mtk_net_log() */
+	s1 = ACCESS_ONCE(ev->seq);
+	smp_rmb();
+	*out = *ev;
+	smp_rmb();
+	s2 = ACCESS_ONCE(ev->seq);
+	if (s1 == seq && s2 == seq) {
+		out->seq = seq;
+		return 0;
+	}
+
+	/* either still being written or already reused by a later event */
+	return (s32)(mtk_net_oldest() - seq) > 0 ? -ESTALE : -EAGAIN;
+}
+
+/* /proc/mtk_net/events */
+
+struct mtk_net_iter {
+	u32 first;
+	u32 end;
+	u32 cur;
+};
+
+static void *mtk_net_seq_at(struct mtk_net_iter *it, loff_t pos)
+{
+	it->cur = it->first + (u32)pos;
+	return (s32)(it->cur - it->end) < 0 ? it : NULL;
+}
+
+static void *mtk_net_seq_start(struct seq_file *m, loff_t *pos)
+{
+	struct mtk_net_iter *it = m->private;
+
+	if (!*pos) {
+		it->first = mtk_net_oldest();
+		it->end = atomic_read(&mtk_net_head) + 1;
+	}
+	return mtk_net_seq_at(it, *pos);
+}
+
+static void *mtk_net_seq_next(struct seq_file *m, void *v, loff_t *pos)
+{
+	return mtk_net_seq_at(m->private, ++*pos);
+}
+
+static void mtk_net_seq_stop(struct seq_file *m, void *v)
+{
+}
+
+static int mtk_net_seq_show(struct seq_file *m, void *v)
+{
+	struct mtk_net_iter *it = v;
+	struct mtk_net_event ev;
+	const char *name = NULL;
+	unsigned int class;
+	unsigned long rem;
+	u64 ts;
+
+	/* overwritten since the dump started */
+	if (mtk_net_read_event(it->cur, &ev))
+		return 0;
+
+	class = MTK_NET_EV_CLASS(ev.type);
+	if (class < MTK_NET_CLASS_MAX && (ev.type & 0xff) < 8)
+		name = mtk_net_type_names[class][ev.type & 0xff];
+
+	ts = ev.ts_ns;
+	rem = do_div(ts, NSEC_PER_SEC);
+	seq_printf(m, "%u [%5lu.%06lu] cpu%u pid %u %s/%s ino %u peer %u bytes %u err %d\n",
+		   ev.seq, (unsigned long)ts, rem / NSEC_PER_USEC, ev.cpu, ev.pid,
+		   class < MTK_NET_CLASS_MAX ? mtk_net_classes[class].name : "?",
+		   name ? : "?", ev.ino, ev.peer, ev.bytes, ev.err);
+	return 0;
+}
+
+static const struct seq_operations mtk_net_seq_ops = {
+	.start	= mtk_net_seq_start,
+	.next	= mtk_net_seq_next,
+	.stop	= mtk_net_seq_stop,
+	.show	= mtk_net_seq_show,
+};
+
+static int mtk_net_events_open(struct inode *inode, struct file *file)
+{
+	return seq_open_private(file, &mtk_net_seq_ops,
+				sizeof(struct mtk_net_iter));
+}
+
+static const struct file_operations mtk_net_events_fops = {
+	.owner		= THIS_MODULE,
+	.open		= mtk_net_events_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= seq_release_private,
+};
+
+/* /proc/mtk_net/raw */
+
+static ssize_t mtk_net_raw_read(struct file *file, char __user *buf,
+				size_t count, loff_t *ppos)
+{
+	struct mtk_net_event ev;
+	size_t done = 0;
+	u32 seq;
+	int ret;
+
+	/* the position is the next sequence number, 0 means oldest */
+	seq = *ppos ? (u32)*ppos : mtk_net_oldest();
+
+	while (count - done >= sizeof(ev)) {
+		ret = mtk_net_read_event(seq, &ev);
+		if (ret == -EAGAIN)
+			break;
+		if (ret == -ESTALE) {
+			/* overrun, skip to what is still there */
+			seq = mtk_net_oldest();
+			continue;
+		}
+		if (copy_to_user(buf + done, &ev, sizeof(ev))) {
+			if (!done)
+				return -EFAULT;
+			break;
+		}
+		done += sizeof(ev);
+		seq++;
+	}
+
+	*ppos = seq;
+	return done;
+}
+
+static const struct file_operations mtk_net_raw_fops = {
+	.owner		= THIS_MODULE,
+	.read		= mtk_net_raw_read,
+	.llseek		= default_llseek,
+};
+
+/* /proc/mtk_net/classes */
+
+static void mtk_net_update_mask(void)
+{
+	unsigned long mask = 0;
+	int i;
+
+	for (i = 0; i < MTK_NET_CLASS_MAX; i++)
+		if (mtk_net_classes[i].sample)
+			mask |= 1UL << i;
+	mtk_net_log_mask = mask;
+}
+
+static int mtk_net_classes_show(struct seq_file *m, void *v)
+{
+	int i;
+
+	seq_printf(m, "%-6s %6s %6s %8s %10s %10s %10s %10s\n",
+		   "class", "sample", "burst", "interval", "seen",
+		   "sampled", "limited", "logged");
+	for (i = 0; i < MTK_NET_CLASS_MAX; i++) {
+		struct mtk_net_class_state *c = &mtk_net_classes[i];
+
+		seq_printf(m, "%-6s %6u %6u %8u %10u %10u %10u %10u\n",
+			   c->name, c->sample, c->burst,
+			   jiffies_to_msecs(c->interval),
+			   atomic_read(&c->seen), atomic_read(&c->sampled),
+			   atomic_read(&c->limited), atomic_read(&c->logged));
+	}
+	seq_printf(m, "head %u size %u\n",
+		   atomic_read(&mtk_net_head), MTK_NET_LOG_SIZE);
+	return 0;
+}
+
+static ssize_t mtk_net_classes_write(struct file *file,
+				     const char __user *ubuf,
+				     size_t count, loff_t *ppos)
+{
+	struct mtk_net_class_state *c = NULL;
+	unsigned int sample, burst, interval;
+	char buf[64], name[16];
+	int i;
+
+	if (count >= sizeof(buf))
+		return -EINVAL;
+	if (copy_from_user(buf, ubuf, count))
+		return -EFAULT;
+	buf[count] = '\0';
+
+	if (sscanf(buf, "%15s %u %u %u", name, &sample, &burst, &interval) != 4)
+		return -EINVAL;
+
+	for (i = 0; i < MTK_NET_CLASS_MAX; i++)
+		if (!strcmp(name, mtk_net_classes[i].name))
+			c = &mtk_net_classes[i];
+	if (!c || !interval)
+		return -EINVAL;
+
+	mutex_lock(&mtk_net_ctl_lock);
+	c->burst = burst;
+	c->interval = msecs_to_jiffies(interval);
+	c->sample = sample;
+	mtk_net_update_mask();
+	mutex_unlock(&mtk_net_ctl_lock);
+
+	return count;
+}
+
+static int mtk_net_classes_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, mtk_net_classes_show, NULL);
+}
+
+static const struct file_operations mtk_net_classes_fops = {
+	.owner		= THIS_MODULE,
+	.open		= mtk_net_classes_open,
+	.read		= seq_read,
+	.write		= mtk_net_classes_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init mtk_net_log_init(void)
+{
+	struct proc_dir_entry *dir;
+	int i;
+
+	for (i = 0; i < MTK_NET_CLASS_MAX; i++) {
+		mtk_net_classes[i].interval = HZ;
+		mtk_net_classes[i].window = jiffies;
+	}
+	mtk_net_update_mask();
+
+	dir = proc_mkdir("mtk_net", NULL);
+	if (!dir)
+		return -ENOMEM;
+
+	proc_create("events", S_IRUSR, dir, &mtk_net_events_fops);
+	proc_create("raw", S_IRUSR, dir, &mtk_net_raw_fops);
+	proc_create("classes", S_IRUSR | S_IWUSR, dir, &mtk_net_classes_fops);
+	return 0;
+}
+fs_initcall(mtk_net_log_init);
@@ -136,6 +136,7 @@
 #include <trace/events/sock.h>
 
 #include <net/af_unix.h>
+#include <net/mtk_net_log.h>
 
 
 #ifdef CONFIG_INET
@@ -1754,112 +1755,14 @@ static long sock_wait_for_wmem(struct sock *sk, long timeo)
 	return timeo;
 }
 
-
-//debug funcion
-
-static int sock_dump_info(struct sock *sk)
-{
-    //dump receiver queue 128 bytes
-    //struct sk_buff *skb;
-    //char skbmsg[128];
-    //dump receiver queue 128 bytes end
-
-		if(sk->sk_family == AF_UNIX)
-		{
-		  struct unix_sock *u = unix_sk(sk);
-		  struct sock *other = NULL;
-		  if( (u->path.dentry !=NULL)&&(u->path.dentry->d_iname!=NULL))
-                  //if( (u->dentry !=NULL)&&(u->dentry->d_iname!=NULL))
-		  {
-		  	  #ifdef CONFIG_MTK_NET_LOGGING  
-		      printk(KERN_INFO "[mtk_net][sock]sockdbg: socket-Name:%s \n",u->path.dentry->d_iname);
-		      #endif
-		  }
-		   else
-		  {
-		  	   #ifdef CONFIG_MTK_NET_LOGGING  
-               printk(KERN_INFO "[mtk_net][sock]sockdbg:socket Name (NULL)\n" );
-               #endif
-		   }
-		   
-		   if(sk->sk_socket && SOCK_INODE(sk->sk_socket))
-		  {
-		   	  	#ifdef CONFIG_MTK_NET_LOGGING  
-		        printk(KERN_INFO "[mtk_net][sock]sockdbg:socket Inode[%lu]\n" ,SOCK_INODE(sk->sk_socket)->i_ino);
-		        #endif
-		   }		 
-
-		    other = unix_sk(sk)->peer ;
-			if (!other)
-			{
-				#ifdef CONFIG_MTK_NET_LOGGING  
-		        printk(KERN_INFO "[mtk_net][sock]sockdbg:peer is (NULL) \n");
-		        #endif
-			 } else{
-			 
-				if ((((struct unix_sock *)other)->path.dentry != NULL)&&(((struct unix_sock *)other)->path.dentry->d_iname != NULL))
-                                //if ((((struct unix_sock *)other)->dentry != NULL)&&(((struct unix_sock *)other)->dentry->d_iname != NULL))
-				{
-					#ifdef CONFIG_MTK_NET_LOGGING  
-		            printk(KERN_INFO "[mtk_net][sock]sockdbg: Peer Name:%s \n",((struct unix_sock *)other)->path.dentry->d_iname);
-		            #endif
-				 }				
-				else
-				{
-					#ifdef CONFIG_MTK_NET_LOGGING  
-                    printk(KERN_INFO "[mtk_net][sock]sockdbg: Peer Name (NULL) \n");
-                    #endif
-				}
-
-				if(other->sk_socket && SOCK_INODE(other->sk_socket))
-				   {
-					#ifdef CONFIG_MTK_NET_LOGGING  
-		            printk(KERN_INFO "[mtk_net][sock]sockdbg: Peer Inode [%lu] \n", SOCK_INODE(other->sk_socket)->i_ino);
-		            #endif
-				    }
-	            #ifdef CONFIG_MTK_NET_LOGGING  
-				printk(KERN_INFO "[mtk_net][sock]sockdbg: Peer Recieve Queue len:%d \n",other->sk_receive_queue.qlen);
-                #endif
-				 //dump receiver queue 128 bytes
-						/* if ((skb = skb_peek_tail(&other->sk_receive_queue)) == NULL) {
-		                        
-		                    printk(KERN_INFO "sockdbg: Peer Recieve Queue is null (warning) \n");
-						 }else{
-						       int i =0 ,len=0;
-		                      if((skb->len !=0) && (skb->data != NULL)){
-
-		                        if(skb->len >= 127){
-									len = 127 ;                          
-								 }else
-								 {
-		                           len = skb->len ;
-								 }
-		                        for (i=0;i<len;i++)
-								  sprintf(skbmsg+i, "%x", skb->data[i]);
-
-								skbmsg[len]= '\0' ;
-								
-		                        printk(KERN_INFO "sockdbg: Peer Recieve Queue dump(%d bytes):%s\n", len, skbmsg);
-												
-		                        
-							  }else{                
-		                        printk(KERN_INFO "sockdbg: Peer Recieve skb error \n");
-							  }*/
-                     //dump receiver queue 128 bytes end      
-
-				 //}
-				//dump receiver queue 128 bytes end				 
-
-			 }
-		}
-
-		return 0 ;	  
-
-	
+/* the receiver a blocked AF_UNIX sender is waiting on */
+static unsigned long sock_wmem_peer_ino(struct sock *sk)
+{
+	if (sk->sk_family != AF_UNIX)
+		return 0;
+	return mtk_net_sk_ino(unix_sk(sk)->peer);
 }
 
-
-
 /*
  *	Generic send/receive buffer handlers
  */
@@ -1936,16 +1839,13 @@ struct sk_buff *sock_alloc_send_pskb(struct sock *sk, unsigned long header_len,
 		if (signal_pending(current))
 			goto interrupted;
 
-        sock_dump_info(sk);
-        #ifdef CONFIG_MTK_NET_LOGGING  
-		printk(KERN_INFO "[mtk_net][sock]sockdbg: wait_for_wmem, timeo =%ld, wmem =%d, snd buf =%d \n",
-			 timeo, atomic_read(&sk->sk_wmem_alloc), sk->sk_sndbuf); 
-        #endif
+		mtk_net_log(MTK_NET_EV_WMEM_WAIT, mtk_net_sk_ino(sk),
+			    sock_wmem_peer_ino(sk),
+			    atomic_read(&sk->sk_wmem_alloc), 0);
 		timeo = sock_wait_for_wmem(sk, timeo);
-		#ifdef CONFIG_MTK_NET_LOGGING  
-		printk(KERN_INFO "[mtk_net][sock]sockdbg: wait_for_wmem done, header_len=0x%lx, data_len=0x%lx,timeo =%ld \n",
-			 header_len, data_len ,timeo);
-	    #endif
+		mtk_net_log(MTK_NET_EV_WMEM_DONE, mtk_net_sk_ino(sk),
+			    sock_wmem_peer_ino(sk), header_len + data_len,
+			    timeo ? 0 : -EAGAIN);
 	}
 
 	skb_set_owner_w(skb, sk);
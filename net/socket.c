@@ -98,6 +98,7 @@
 
 #include <net/sock.h>
 #include <net/inet_sock.h>
+#include <net/mtk_net_log.h>
 #include <linux/netfilter.h>
 
 #include <linux/if_tun.h>
@@ -1167,15 +1168,9 @@ static int sock_close(struct inode *inode, struct file *filp)
 	 *      closing an unfinished socket.
 	 */
 
-	if (!inode) {
-		#ifdef CONFIG_MTK_NET_LOGGING 
-		printk(KERN_DEBUG "[mtk_net][socket]sock_close: NULL inode\n");
-		#endif
+	if (!inode)
 		return 0;
-	}
-    #ifdef CONFIG_MTK_NET_LOGGING 
-	printk(KERN_INFO "[mtk_net][socekt]socket_close[%lu] \n",inode->i_ino); 
-	#endif
+	mtk_net_log(MTK_NET_EV_SOCK_CLOSE, inode->i_ino, 0, 0, 0);
 	sock_release(SOCKET_I(inode));
 	
 	return 0;
@@ -1404,21 +1399,10 @@ SYSCALL_DEFINE3(socket, int, family, int, type, int, protocol)
 	if (retval < 0)
 		goto out_release;
 
+	mtk_net_log(MTK_NET_EV_SOCK_CREATE, mtk_net_sock_ino(sock), family, 0,
+		    retval);
 out:
 	/* It may be already another descriptor 8) Not kernel problem. */
-
-	if((retval >= 0)&& sock && SOCK_INODE(sock) )
-	{
-	   #ifdef CONFIG_MTK_NET_LOGGING 
-	   printk(KERN_INFO "[mtk_net][socket]socket_create[%lu]:fd=%d \n",SOCK_INODE(sock)->i_ino,retval);
-	   #endif               
-	}
-	 else
-	 {
-	 	#ifdef CONFIG_MTK_NET_LOGGING 	
-	   printk(KERN_INFO "[mtk_net][socket]socket_create:fd=%d \n",retval); 
-	   #endif
-	 }
 	return retval;
 
 out_release:
@@ -1502,23 +1486,15 @@ SYSCALL_DEFINE4(socketpair, int, family, int, type, int, protocol,
 	err = put_user(fd1, &usockvec[0]);
 	if (!err)
 		err = put_user(fd2, &usockvec[1]);
-	if (!err)
-        {
-            if(sock1 && SOCK_INODE(sock1) && sock2&& SOCK_INODE(sock2) )
-            {
-       	        #ifdef CONFIG_MTK_NET_LOGGING 
-	            printk(KERN_INFO "[mtk_net][socket]socketpair:fd1[%lu]=%d, fd2[%lu]=%d \n", SOCK_INODE(sock1)->i_ino,fd1,SOCK_INODE(sock2)->i_ino,fd2);
-	            #endif             
-	     }
-	  
+	if (!err) {
+		mtk_net_log(MTK_NET_EV_SOCK_PAIR, mtk_net_sock_ino(sock1),
+			    mtk_net_sock_ino(sock2), 0, 0);
 		return 0;
-        }
+	}
 
 	sys_close(fd2);
 	sys_close(fd1);
-	#ifdef CONFIG_MTK_NET_LOGGING 
-	printk(KERN_INFO "[mtk_net][socket]socketpair fail1: %d \n", err);
-	#endif
+	mtk_net_log(MTK_NET_EV_SOCK_PAIR, 0, 0, 0, err);
 	return err;
 
 out_release_both:
@@ -1526,9 +1502,7 @@ out_release_both:
 out_release_1:
 	sock_release(sock1);
 out:
-	#ifdef CONFIG_MTK_NET_LOGGING 
-    printk(KERN_INFO "[mtk_net][socket]socketpair fail2: %d \n", err);
-    #endif
+	mtk_net_log(MTK_NET_EV_SOCK_PAIR, 0, 0, 0, err);
 	return err;
 }
 
@@ -1558,13 +1532,11 @@ SYSCALL_DEFINE3(bind, int, fd, struct sockaddr __user *, umyaddr, int, addrlen)
 				err = sock->ops->bind(sock,
 						      (struct sockaddr *)
 						      &address, addrlen);
-			
-      #ifdef CONFIG_MTK_NET_LOGGING 
-		    if((((struct sockaddr_in *)&address)->sin_family) != AF_UNIX)
-		    	{
-		    		 printk(KERN_WARNING "[mtk_net][socket] bind addr->sin_port:%d,err:%d \n",htons(((struct sockaddr_in *)&address)->sin_port),err);
-          }
-        #endif		      
+			if (address.ss_family != AF_UNIX)
+				mtk_net_log(MTK_NET_EV_SOCK_BIND,
+					    mtk_net_sock_ino(sock),
+					    ntohs(((struct sockaddr_in *)&address)->sin_port),
+					    0, err);
 		}
 		fput_light(sock->file, fput_needed);
 	}
@@ -1679,17 +1651,12 @@ SYSCALL_DEFINE4(accept4, int, fd, struct sockaddr __user *, upeer_sockaddr,
 
 	fd_install(newfd, newfile);
 	err = newfd;
+	mtk_net_log(MTK_NET_EV_SOCK_ACCEPT, mtk_net_sock_ino(newsock),
+		    mtk_net_sock_ino(sock), 0, err);
 
 out_put:
 	fput_light(sock->file, fput_needed);
 out:
-        if( (err>=0)&& newsock && SOCK_INODE(newsock) )
-      {
-	    	#ifdef CONFIG_MTK_NET_LOGGING 
-	        printk(KERN_INFO "[mtk_net][socket]socket_accept:fd=%d \n",err);
-	        #endif
-	    }  
-	    
 	return err;
 out_fd:
 	fput(newfile);
@@ -2653,9 +2620,7 @@ int sock_register(const struct net_proto_family *ops)
 		err = 0;
 	}
 	spin_unlock(&net_family_lock);
-    #ifdef CONFIG_MTK_NET_LOGGING 
-	printk(KERN_INFO "[mtk_net][socekt]NET: Registered protocol family %d\n", ops->family);
-	#endif
+	mtk_net_log(MTK_NET_EV_FAMILY_REG, 0, ops->family, 0, err);
 	return err;
 }
 EXPORT_SYMBOL(sock_register);
@@ -2682,9 +2647,7 @@ void sock_unregister(int family)
 	spin_unlock(&net_family_lock);
 
 	synchronize_rcu();
-    #ifdef CONFIG_MTK_NET_LOGGING 
-	printk(KERN_INFO "[mtk_net][socket]NET: Unregistered protocol family %d\n", family);
-	#endif
+	mtk_net_log(MTK_NET_EV_FAMILY_UNREG, 0, family, 0, 0);
 }
 EXPORT_SYMBOL(sock_unregister);
 
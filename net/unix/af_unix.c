@@ -105,6 +105,7 @@
 #include <net/sock.h>
 #include <net/tcp_states.h>
 #include <net/af_unix.h>
+#include <net/mtk_net_log.h>
 #include <linux/proc_fs.h>
 #include <linux/seq_file.h>
 #include <net/scm.h>
@@ -498,9 +499,7 @@ static void unix_sock_destructor(struct sock *sk)
 	WARN_ON(!sk_unhashed(sk));
 	WARN_ON(sk->sk_socket);
 	if (!sock_flag(sk, SOCK_DEAD)) {
-		#ifdef CONFIG_MTK_NET_LOGGING 
-		printk(KERN_INFO "[mtk_net][unix]Attempt to release alive unix socket: %p\n", sk);
-		#endif
+		mtk_net_log(MTK_NET_EV_UNIX_RELEASE_ALIVE, 0, 0, 0, 0);
 		return;
 	}
 
@@ -1171,14 +1170,9 @@ restart:
 		unix_peer(sk) = other;
 		unix_state_double_unlock(sk, other);
 	}
-	
-#ifdef CONFIG_MTK_NET_LOGGING 
-    if((SOCK_INODE(sock)!= NULL) && (sunaddr != NULL) && (other->sk_socket != NULL) && (SOCK_INODE(other->sk_socket) != NULL))
-    {
-	       printk(KERN_INFO "[mtk_net][socket]unix_dgram_connect[%lu]:connect [%s] other[%lu]\n",SOCK_INODE(sock)->i_ino,sunaddr->sun_path,SOCK_INODE(other->sk_socket)->i_ino);
-	  }
-#endif 
-            
+
+	mtk_net_log(MTK_NET_EV_UNIX_CONNECT, mtk_net_sock_ino(sock),
+		    mtk_net_sk_ino(other), 0, 0);
 	return 0;
 
 out_unlock:
@@ -1368,13 +1362,9 @@ restart:
 	__skb_queue_tail(&other->sk_receive_queue, skb);
 	spin_unlock(&other->sk_receive_queue.lock);
 	unix_state_unlock(other);
-	
-	#ifdef CONFIG_MTK_NET_LOGGING 
-	if((SOCK_INODE(sock)!= NULL) && (sunaddr != NULL) && (other->sk_socket != NULL) && (SOCK_INODE(other->sk_socket) != NULL))
-  {
-	  printk(KERN_INFO "[mtk_net][socket]unix_stream_connect[%lu ]: connect [%s] other[%lu] \n",SOCK_INODE(sock)->i_ino,sunaddr->sun_path,SOCK_INODE(other->sk_socket)->i_ino);
-	}
-  #endif 
+
+	mtk_net_log(MTK_NET_EV_UNIX_CONNECT, mtk_net_sock_ino(sock),
+		    mtk_net_sk_ino(other), 0, 0);
 
 	other->sk_data_ready(other, 0);
 	sock_put(other);
@@ -1903,32 +1893,10 @@ static int unix_stream_sendmsg(struct kiocb *kiocb, struct socket *sock,
 		unix_state_lock(other);
 
 		if (sock_flag(other, SOCK_DEAD) ||
-		    (other->sk_shutdown & RCV_SHUTDOWN))
-		{
-                    if( other->sk_socket )
-                    {
-                        if(sk->sk_socket)
-                        {
-                
-                         #ifdef CONFIG_MTK_NET_LOGGING 
-                         printk(KERN_INFO " [mtk_net][unix]: sendmsg[%lu:%lu]:peer close\n" ,SOCK_INODE(sk->sk_socket)->i_ino,SOCK_INODE(other->sk_socket)->i_ino);
-				         #endif
-		         }
-		         else{
-				   	    #ifdef CONFIG_MTK_NET_LOGGING 
-				        printk(KERN_INFO " [mtk_net][unix]: sendmsg[null:%lu]:peer close\n" ,SOCK_INODE(other->sk_socket)->i_ino);
-				        #endif
-		         }        
-
-		    }
-		    else	
-					{
-						#ifdef CONFIG_MTK_NET_LOGGING 	
-				        printk(KERN_INFO " [mtk_net][unix]: sendmsg:peer close \n" );
-				        #endif
-				}
-		   		
-          
+		    (other->sk_shutdown & RCV_SHUTDOWN)) {
+			mtk_net_log(MTK_NET_EV_UNIX_SEND_PEER_DEAD,
+				    mtk_net_sk_ino(sk), mtk_net_sk_ino(other),
+				    size, 0);
 			goto pipe_err_free;
 		}
 
@@ -2200,26 +2168,10 @@ again:
 			err = sock_error(sk);
 			if (err)
 				goto unlock;
-			if (sk->sk_shutdown & RCV_SHUTDOWN)
-			{
-                            if(sk && sk->sk_socket )
-                            {
-				   if(other && other->sk_socket ){
-				   	#ifdef CONFIG_MTK_NET_LOGGING 
-				   	
-                     printk(KERN_INFO " [mtk_net][unix]: recvmsg[%lu:%lu]:exit read due to peer shutdown  \n" ,SOCK_INODE(sk->sk_socket)->i_ino,SOCK_INODE(other->sk_socket)->i_ino);
-				   #endif
-				   }else{				   
-				   	#ifdef CONFIG_MTK_NET_LOGGING 				   
-                     printk(KERN_INFO "[mtk_net][unix]: recvmsg[%lu:null]:exit read due to peer shutdown  \n" ,SOCK_INODE(sk->sk_socket)->i_ino);
-                     #endif
-				   }
-				 }
-			    else{	
-					#ifdef CONFIG_MTK_NET_LOGGING 
-				   printk(KERN_INFO " [mtk_net][unix]: recvmsg: exit read due to peer shutdown \n" );
-				   #endif
-			    }
+			if (sk->sk_shutdown & RCV_SHUTDOWN) {
+				mtk_net_log(MTK_NET_EV_UNIX_RECV_SHUTDOWN,
+					    mtk_net_sk_ino(sk),
+					    mtk_net_sk_ino(other), copied, 0);
 				goto unlock;
 			}
 			unix_state_unlock(sk);
@@ -2229,28 +2181,10 @@ again:
 			mutex_unlock(&u->readlock);
 
 			timeo = unix_stream_data_wait(sk, timeo, last);
-                        if (!timeo)
-                        {
-                            if(sk && sk->sk_socket )
-                            {
-                                if(other && other->sk_socket ){
-				   	#ifdef CONFIG_MTK_NET_LOGGING 
-                     printk(KERN_INFO " [mtk_net][unix]: recvmsg[%lu:%lu]:exit read due to timeout  \n" ,SOCK_INODE(sk->sk_socket)->i_ino,SOCK_INODE(other->sk_socket)->i_ino);
-				   #endif
-				   }else{				   
-				   	#ifdef CONFIG_MTK_NET_LOGGING 				   
-                     printk(KERN_INFO " [mtk_net][unix]: recvmsg[%lu:null]:exit read due to timeout  \n" ,SOCK_INODE(sk->sk_socket)->i_ino);
-                     #endif
-				    }			  
-		           }
-			   else	
-					{
-						#ifdef CONFIG_MTK_NET_LOGGING 	
-				  printk(KERN_INFO " [mtk_net][unix]: recvmsg:exit read due to timeout \n" );
-				  #endif
-				}
-		   		  
-			 }
+			if (!timeo)
+				mtk_net_log(MTK_NET_EV_UNIX_RECV_TIMEOUT,
+					    mtk_net_sk_ino(sk),
+					    mtk_net_sk_ino(other), copied, 0);
 
 			if (signal_pending(current)
 			    ||  mutex_lock_interruptible(&u->readlock)) {
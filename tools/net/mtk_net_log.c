@@ -0,0 +1,165 @@
+/*
+ * mtk_net_log - read the binary socket event log
+ *
+ * Reads struct mtk_net_event records from /proc/mtk_net/raw and prints
+ * them in the same format as /proc/mtk_net/events. The file position of
+ * the raw file is the next sequence number, so with -f the reader keeps
+ * its place between polls and reports events lost to ring overruns.
+ *
+ * Usage: mtk_net_log [-f] [-i msecs] [-s seq] [-c class] [file]
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/types.h>
+
+#include "../../include/uapi/linux/mtk_net_log.h"
+
+#define DEFAULT_FILE	"/proc/mtk_net/raw"
+#define BATCH		64
+
+static const char * const class_names[MTK_NET_CLASS_MAX] = {
+	[MTK_NET_CLASS_SOCK] = "sock",
+	[MTK_NET_CLASS_UNIX] = "unix",
+	[MTK_NET_CLASS_WMEM] = "wmem",
+};
+
+/* must match mtk_net_type_names[] in net/core/mtk_net_log.c */
+static const char * const type_names[MTK_NET_CLASS_MAX][8] = {
+	[MTK_NET_CLASS_SOCK] = { "create", "close", "pair", "bind", "accept",
+				 "family_reg", "family_unreg" },
+	[MTK_NET_CLASS_UNIX] = { "connect", "send_peer_dead", "recv_shutdown",
+				 "recv_timeout", "release_alive" },
+	[MTK_NET_CLASS_WMEM] = { "wait", "done" },
+};
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [-f] [-i msecs] [-s seq] [-c class] [file]\n"
+		"  -f        keep polling for new events\n"
+		"  -i msecs  poll interval with -f (default 500)\n"
+		"  -s seq    start at sequence number seq (default oldest)\n"
+		"  -c class  only print sock, unix or wmem events\n"
+		"  file      raw event file (default " DEFAULT_FILE ")\n",
+		prog);
+	exit(2);
+}
+
+static int parse_class(const char *name)
+{
+	int i;
+
+	for (i = 0; i < MTK_NET_CLASS_MAX; i++)
+		if (!strcmp(name, class_names[i]))
+			return i;
+	fprintf(stderr, "unknown class '%s'\n", name);
+	exit(2);
+}
+
+static void print_event(const struct mtk_net_event *ev)
+{
+	unsigned int class = MTK_NET_EV_CLASS(ev->type);
+	unsigned int nr = ev->type & 0xff;
+	const char *name = NULL;
+
+	if (class < MTK_NET_CLASS_MAX && nr < 8)
+		name = type_names[class][nr];
+
+	printf("%u [%5llu.%06llu] cpu%u pid %u %s/%s ino %u peer %u bytes %u err %d\n",
+	       ev->seq, (unsigned long long)(ev->ts_ns / 1000000000ULL),
+	       (unsigned long long)(ev->ts_ns % 1000000000ULL) / 1000,
+	       ev->cpu, ev->pid,
+	       class < MTK_NET_CLASS_MAX ? class_names[class] : "?",
+	       name ? name : "?", ev->ino, ev->peer, ev->bytes, ev->err);
+}
+
+int main(int argc, char **argv)
+{
+	struct mtk_net_event ev[BATCH];
+	const char *path = DEFAULT_FILE;
+	unsigned int interval = 500;
+	unsigned long start = 0;
+	unsigned int next = 0;
+	int follow = 0, class = -1;
+	int fd, opt, i, n;
+	ssize_t len;
+
+	while ((opt = getopt(argc, argv, "fi:s:c:h")) != -1) {
+		switch (opt) {
+		case 'f':
+			follow = 1;
+			break;
+		case 'i':
+			interval = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			start = strtoul(optarg, NULL, 0);
+			break;
+		case 'c':
+			class = parse_class(optarg);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind < argc)
+		path = argv[optind++];
+	if (optind < argc)
+		usage(argv[0]);
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return 1;
+	}
+	if (start && lseek(fd, start, SEEK_SET) < 0) {
+		fprintf(stderr, "%s: seek: %s\n", path, strerror(errno));
+		return 1;
+	}
+
+	for (;;) {
+		len = read(fd, ev, sizeof(ev));
+		if (len < 0) {
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "%s: %s\n", path, strerror(errno));
+			return 1;
+		}
+		if (len % sizeof(ev[0])) {
+			fprintf(stderr, "%s: short record, header mismatch?\n",
+				path);
+			return 1;
+		}
+
+		n = len / sizeof(ev[0]);
+		for (i = 0; i < n; i++) {
+			if (next && ev[i].seq != next)
+				printf("--- %u events lost to overrun ---\n",
+				       ev[i].seq - next);
+			next = ev[i].seq + 1;
+			if (class >= 0 &&
+			    MTK_NET_EV_CLASS(ev[i].type) != (unsigned int)class)
+				continue;
+			print_event(&ev[i]);
+		}
+
+		if (n == BATCH)
+			continue;
+		if (!follow)
+			break;
+		fflush(stdout);
+		usleep(interval * 1000);
+	}
+
+	close(fd);
+	return 0;
+}
@@ -0,0 +1,274 @@
+/*
+ * edid_test - regression and fuzz harness for the mt8127 HDMI EDID parser
+ *
+ * Builds drivers/misc/mediatek/hdmi/internal_hdmi/mt8127/hdmiedid_parse.c
+ * in userspace and runs it over raw EDID blobs.
+ *
+ * Usage: edid_test file...            print the parsed capabilities
+ *        edid_test -f iters [-s seed] file...
+ *                                     parse iters mutated copies of each file
+ *
+ * Every parse is done on a heap buffer of exactly the blob's length, so with
+ * the sanitizers the Makefile enables any read past the EDID is reported.
+ * Each parse is also repeated and compared, and the result is checked for
+ * fields that must not depend on bytes outside the buffer.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hdmiedid_parse.h"
+
+#define BLOCK_LEN	128
+
+static unsigned int seed = 1;
+
+static unsigned int rnd(void)
+{
+	/* xorshift32, so a failing seed reproduces everywhere */
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+static int read_blob(const char *path, unsigned char *buf, size_t *len)
+{
+	FILE *f = fopen(path, "rb");
+
+	if (!f) {
+		perror(path);
+		return -1;
+	}
+	*len = fread(buf, 1, EDID_PARSE_MAX_LEN, f);
+	fclose(f);
+	return 0;
+}
+
+static void print_bytes(const char *name, const unsigned char *p, int n)
+{
+	int i;
+
+	printf("%s:", name);
+	for (i = 0; i < n; i++)
+		printf(" %02x", p[i]);
+	printf("\n");
+}
+
+static void dump(const char *name, unsigned char ok, const HDMI_EDID_CAPS_T *caps)
+{
+	const HDMI_SINK_AV_CAP_T *c = &caps->rSinkAvCap;
+	const char *base = strrchr(name, '/');
+
+	printf("# %s\n", base ? base + 1 : name);
+	printf("parse_ok: %u\n", ok);
+	printf("ext_blocks: %u\n", caps->ui1ExtBlockNo);
+	printf("vsdb: %u\n", caps->fgVsdbExist);
+	printf("edid_ready: %u\n", c->b_sink_edid_ready);
+	printf("hdmi_mode: %u\n", c->b_sink_support_hdmi_mode);
+	printf("version: %u.%u ext_rev: %u\n", c->ui1_Edid_Version,
+	       c->ui1_Edid_Revision, c->ui1_ExtEdid_Revision);
+	printf("size_cm: %ux%u\n", c->ui1_Display_Horizontal_Size,
+	       c->ui1_Display_Vertical_Size);
+	printf("cea_res: ntsc %08x pal %08x\n", c->ui4_sink_cea_ntsc_resolution,
+	       c->ui4_sink_cea_pal_resolution);
+	printf("dtd_res: ntsc %08x pal %08x\n", c->ui4_sink_dtd_ntsc_resolution,
+	       c->ui4_sink_dtd_pal_resolution);
+	printf("1st_dtd_res: ntsc %08x pal %08x\n",
+	       c->ui4_sink_1st_dtd_ntsc_resolution,
+	       c->ui4_sink_1st_dtd_pal_resolution);
+	printf("native_res: ntsc %08x pal %08x\n",
+	       c->ui4_sink_native_ntsc_resolution,
+	       c->ui4_sink_native_pal_resolution);
+	printf("3d: present %u res %08x\n", c->b_sink_3D_present,
+	       c->ui4_sink_cea_3D_resolution);
+	printf("colorimetry: %04x vcdb: %04x\n", c->ui2_sink_colorimetry,
+	       c->ui2_sink_vcdb_data);
+	printf("deep_color: rgb %x ycbcr %x\n", c->e_sink_rgb_color_bit,
+	       c->e_sink_ycbcr_color_bit);
+	printf("chksum_audio: %04x aud_dec: %04x spk: %02x\n",
+	       c->ui2_edid_chksum_and_audio_sup, c->ui2_sink_aud_dec,
+	       c->ui1_sink_spk_allocation);
+	print_bytes("pcm_sampling", c->ui1_sink_pcm_ch_sampling, 7);
+	print_bytes("pcm_bits", c->ui1_sink_pcm_bit_size, 7);
+	print_bytes("ac3_sampling", c->ui1_sink_ac3_ch_sampling, 7);
+	print_bytes("ec3_sampling", c->ui1_sink_ec3_ch_sampling, 7);
+	print_bytes("dsd_sampling", c->ui1_sink_dsd_ch_sampling, 7);
+	print_bytes("dst_sampling", c->ui1_sink_dst_ch_sampling, 7);
+	printf("cec: %04x ai: %u max_tmds: %u\n", c->ui2_sink_cec_address,
+	       c->ui1_sink_support_ai, c->ui1_sink_max_tmds_clock);
+	printf("latency: p %u %u/%u i %u %u/%u\n",
+	       c->ui1_sink_p_latency_present, c->ui1_sink_p_video_latency,
+	       c->ui1_sink_p_audio_latency, c->ui1_sink_i_latency_present,
+	       c->ui1_sink_i_video_latency, c->ui1_sink_i_audio_latency);
+	printf("video_present: %u cnc: %x\n", c->b_sink_hdmi_video_present,
+	       c->ui1_CNC);
+}
+
+/* Parse a private copy of exactly len bytes, twice, and compare the results. */
+static int parse_checked(const char *name, const unsigned char *edid,
+			 size_t len, HDMI_EDID_CAPS_T *caps, unsigned char *ok)
+{
+	HDMI_EDID_CAPS_T again;
+	unsigned char *buf;
+	int ret = 0;
+
+	buf = malloc(len ? len : 1);
+	if (!buf) {
+		perror("malloc");
+		exit(2);
+	}
+	memcpy(buf, edid, len);
+
+	memset(caps, 0xa5, sizeof(*caps));
+	*ok = fgHdmiEdidParse(buf, len, caps);
+	memset(&again, 0x5a, sizeof(again));
+	if (fgHdmiEdidParse(buf, len, &again) != *ok ||
+	    memcmp(caps, &again, sizeof(again))) {
+		fprintf(stderr, "%s: parse is not deterministic\n", name);
+		ret = -1;
+	}
+	if (memcmp(buf, edid, len)) {
+		fprintf(stderr, "%s: parser wrote to its input\n", name);
+		ret = -1;
+	}
+	if ((caps->ui1ExtBlockNo + 1) * BLOCK_LEN > len && caps->ui1ExtBlockNo) {
+		fprintf(stderr, "%s: walked %u extension blocks in %zu bytes\n",
+			name, caps->ui1ExtBlockNo, len);
+		ret = -1;
+	}
+	if (*ok && (len < BLOCK_LEN || !caps->rSinkAvCap.b_sink_edid_ready)) {
+		fprintf(stderr, "%s: accepted without a valid base block\n", name);
+		ret = -1;
+	}
+
+	free(buf);
+	return ret;
+}
+
+static void fix_checksum(unsigned char *block)
+{
+	unsigned char sum = 0;
+	int i;
+
+	for (i = 0; i < BLOCK_LEN - 1; i++)
+		sum += block[i];
+	block[BLOCK_LEN - 1] = -sum;
+}
+
+static int fuzz(const char *name, const unsigned char *edid, size_t len,
+		unsigned long iters)
+{
+	unsigned char buf[EDID_PARSE_MAX_LEN];
+	HDMI_EDID_CAPS_T caps;
+	unsigned char ok;
+	unsigned long n;
+	size_t mlen, b;
+	int i, flips, fails = 0;
+
+	for (n = 0; n < iters; n++) {
+		memset(buf, 0, sizeof(buf));
+		memcpy(buf, edid, len);
+		mlen = len;
+
+		flips = 1 + rnd() % 8;
+		for (i = 0; i < flips; i++) {
+			unsigned int r = rnd();
+
+			switch (r % 4) {
+			case 0:		/* anywhere */
+				buf[rnd() % EDID_PARSE_MAX_LEN] = rnd();
+				break;
+			case 1:		/* extension count, DTD offset, tag bytes */
+				buf[(r >> 8) % 2 ? 0x7e : BLOCK_LEN + 2] = rnd();
+				break;
+			case 2:		/* CEA data block area */
+				buf[BLOCK_LEN + 4 + rnd() % 48] = rnd();
+				break;
+			default:	/* single bit */
+				buf[rnd() % EDID_PARSE_MAX_LEN] ^= 1 << (rnd() % 8);
+				break;
+			}
+		}
+
+		/* most of the time keep the checksums right so parsing goes deep */
+		if (rnd() % 4)
+			for (b = 0; b < EDID_PARSE_MAX_LEN; b += BLOCK_LEN)
+				fix_checksum(buf + b);
+
+		switch (rnd() % 8) {
+		case 0:
+			mlen = rnd() % (EDID_PARSE_MAX_LEN + 1);
+			break;
+		case 1:
+			mlen = EDID_PARSE_MAX_LEN;
+			break;
+		default:
+			break;
+		}
+
+		if (parse_checked(name, buf, mlen, &caps, &ok)) {
+			fprintf(stderr, "%s: iteration %lu failed (len %zu)\n",
+				name, n, mlen);
+			if (++fails > 10)
+				break;
+		}
+	}
+	return fails;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned char edid[EDID_PARSE_MAX_LEN];
+	unsigned long iters = 0;
+	HDMI_EDID_CAPS_T caps;
+	unsigned char ok;
+	int opt, fails = 0;
+	size_t len;
+
+	while ((opt = getopt(argc, argv, "f:s:")) != -1) {
+		switch (opt) {
+		case 'f':
+			iters = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 0);
+			if (!seed)
+				seed = 1;
+			break;
+		default:
+			fprintf(stderr,
+				"usage: %s [-f iters] [-s seed] file...\n",
+				argv[0]);
+			return 2;
+		}
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "%s: no EDID files given\n", argv[0]);
+		return 2;
+	}
+
+	for (; optind < argc; optind++) {
+		const char *name = argv[optind];
+
+		if (read_blob(name, edid, &len))
+			return 2;
+
+		if (iters) {
+			fails += fuzz(name, edid, len, iters);
+			continue;
+		}
+		if (parse_checked(name, edid, len, &caps, &ok))
+			fails++;
+		dump(name, ok, &caps);
+	}
+
+	return fails ? 1 : 0;
+}
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+#
+# Regenerate the synthetic blobs in corpus/. sony_tv.bin is the dump the mt8127
+# driver carries as its built-in EDID (_bEdidData2 in hdmiedid.c); the others are
+# built here to reach parser paths that dump does not: DVI only sinks, 3D VIC lists
+# and masks, four block EDIDs with a block map, and broken checksums and lengths.
+#
+# Usage: mkcorpus.py [outdir]
+
+import os
+import sys
+
+HEADER = bytes([0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00])
+
+
+def checksum(block):
+    block = bytearray(block)
+    block[127] = (-sum(block[:127])) & 0xff
+    return bytes(block)
+
+
+def dtd(clk_khz, hact, hblank, vact, vblank, hso, hsw, vso, vsw, interlace=False):
+    clk = clk_khz // 10
+    d = bytearray(18)
+    d[0] = clk & 0xff
+    d[1] = clk >> 8
+    d[2] = hact & 0xff
+    d[3] = hblank & 0xff
+    d[4] = ((hact >> 8) << 4) | (hblank >> 8)
+    d[5] = vact & 0xff
+    d[6] = vblank & 0xff
+    d[7] = ((vact >> 8) << 4) | (vblank >> 8)
+    d[8] = hso & 0xff
+    d[9] = hsw & 0xff
+    d[10] = ((vso & 0xf) << 4) | (vsw & 0xf)
+    d[11] = ((hso >> 8) << 6) | ((hsw >> 8) << 4) | ((vso >> 4) << 2) | (vsw >> 4)
+    d[12] = 0x40
+    d[13] = 0x84
+    d[14] = 0x63
+    d[17] = 0x1e | (0x80 if interlace else 0)
+    return bytes(d)
+
+
+DTD_1080P60 = dtd(148500, 1920, 280, 1080, 45, 88, 44, 4, 5)
+DTD_1080P50 = dtd(148500, 1920, 720, 1080, 45, 528, 44, 4, 5)
+DTD_1080I60 = dtd(74250, 1920, 280, 540, 22, 88, 44, 2, 5, True)
+DTD_720P60 = dtd(74250, 1280, 370, 720, 30, 110, 40, 5, 5)
+DTD_720P50 = dtd(74250, 1280, 700, 720, 30, 440, 40, 5, 5)
+DTD_480P = dtd(27000, 720, 138, 480, 45, 16, 62, 9, 6)
+DTD_576P = dtd(27000, 720, 144, 576, 49, 12, 64, 5, 5)
+DTD_1680x1050 = dtd(146250, 1680, 560, 1050, 39, 104, 176, 3, 6)
+
+
+def name_desc(name):
+    s = name.encode()[:13]
+    if len(s) < 13:
+        s += b'\n' + b' ' * (12 - len(s))
+    return bytes([0, 0, 0, 0xfc, 0]) + s
+
+
+def range_desc(vmin, vmax, hmin, hmax, clk_mhz):
+    return bytes([0, 0, 0, 0xfd, 0, vmin, vmax, hmin, hmax, clk_mhz // 10,
+                  0, 0x0a]) + b' ' * 6
+
+
+def base_block(mfg, product, descs, ext, hsize=0x50, vsize=0x2d, version=(1, 3)):
+    b = bytearray(128)
+    b[0:8] = HEADER
+    m = ((ord(mfg[0]) - 64) << 10) | ((ord(mfg[1]) - 64) << 5) | (ord(mfg[2]) - 64)
+    b[8] = m >> 8
+    b[9] = m & 0xff
+    b[10] = product & 0xff
+    b[11] = product >> 8
+    b[12:16] = bytes([1, 0, 0, 0])
+    b[16] = 12
+    b[17] = 24
+    b[18], b[19] = version
+    b[20] = 0x80
+    b[21] = hsize
+    b[22] = vsize
+    b[23] = 0x78
+    b[24] = 0x0a
+    b[25:35] = bytes([0xee, 0x91, 0xa3, 0x54, 0x4c, 0x99, 0x26, 0x0f, 0x50, 0x54])
+    b[35:38] = bytes([0x21, 0x08, 0x00])
+    b[38:54] = bytes([0x01] * 16)
+    for i, d in enumerate(descs):
+        b[54 + 18 * i:72 + 18 * i] = d
+    b[126] = ext
+    return checksum(b)
+
+
+def cea_block(blocks, dtds, flags=0xf0, dtd_ofst=None, rev=3):
+    data = b''.join(blocks)
+    b = bytearray(128)
+    b[0] = 0x02
+    b[1] = rev
+    b[2] = (4 + len(data)) if dtd_ofst is None else dtd_ofst
+    b[3] = flags | len(dtds)
+    b[4:4 + len(data)] = data
+    p = 4 + len(data)
+    for d in dtds:
+        b[p:p + 18] = d
+        p += 18
+    assert p <= 127
+    return checksum(b)
+
+
+def db(tag, payload):
+    assert len(payload) < 32
+    return bytes([(tag << 5) | len(payload)]) + bytes(payload)
+
+
+def sad(code, ch, rates, byte3):
+    return [(code << 3) | (ch - 1), rates, byte3]
+
+
+def vsdb(pa, extra=()):
+    return db(3, [0x03, 0x0c, 0x00, pa >> 8, pa & 0xff] + list(extra))
+
+
+SONY_TV = bytes([
+    0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x4d, 0xd9, 0x02, 0xd7, 0x01, 0x01, 0x01, 0x01,
+    0x20, 0x16, 0x01, 0x03, 0x80, 0xa0, 0x5a, 0x78, 0x0a, 0x83, 0xad, 0xa2, 0x56, 0x49, 0x9b, 0x25,
+    0x0f, 0x47, 0x4a, 0x20, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x1d, 0x00, 0x72, 0x51, 0xd0, 0x1e, 0x20, 0x6e, 0x28,
+    0x55, 0x00, 0x40, 0x84, 0x63, 0x00, 0x00, 0x1e, 0x01, 0x1d, 0x80, 0x18, 0x71, 0x1c, 0x16, 0x20,
+    0x58, 0x2c, 0x25, 0x00, 0x40, 0x84, 0x63, 0x00, 0x00, 0x9e, 0x00, 0x00, 0x00, 0xfc, 0x00, 0x53,
+    0x4f, 0x4e, 0x59, 0x20, 0x54, 0x56, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0xfd,
+    0x00, 0x3a, 0x3e, 0x0f, 0x44, 0x0f, 0x00, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x01, 0x6b,
+    0x02, 0x03, 0x30, 0xf5, 0x45, 0x10, 0x04, 0x05, 0x03, 0x20, 0x35, 0x0f, 0x7f, 0x07, 0x15, 0x07,
+    0x55, 0x3d, 0x1f, 0xc0, 0x57, 0x07, 0x00, 0x67, 0x54, 0x00, 0x5f, 0x7e, 0x01, 0x4d, 0x02, 0x00,
+    0x83, 0x5f, 0x00, 0x00, 0x68, 0x03, 0x0c, 0x00, 0x21, 0x00, 0x80, 0x1e, 0x0f, 0xe2, 0x00, 0x7b,
+    0x02, 0x3a, 0x80, 0x18, 0x71, 0x38, 0x2d, 0x40, 0x58, 0x2c, 0x45, 0x00, 0x40, 0x84, 0x63, 0x00,
+    0x00, 0x1e, 0x8c, 0x0a, 0xd0, 0x8a, 0x20, 0xe0, 0x2d, 0x10, 0x10, 0x3e, 0x96, 0x00, 0x40, 0x84,
+    0x63, 0x00, 0x00, 0x18, 0x8c, 0x0a, 0xd0, 0x8a, 0x20, 0xe0, 0x2d, 0x10, 0x10, 0x3e, 0x96, 0x00,
+    0xb0, 0x84, 0x43, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4c,
+])
+
+
+def corpus():
+    c = {}
+    c['sony_tv'] = SONY_TV
+
+    # DVI monitor: one block, no CEA extension, non CEA preferred timing
+    c['dvi_monitor'] = base_block('DEL', 0xa07b, [
+        DTD_1680x1050, DTD_1080P60, name_desc('DVI MONITOR'),
+        range_desc(56, 76, 30, 83, 170)], 0)
+
+    # HDMI TV with 3D: VIC list with native flag, three SADs, speaker allocation,
+    # VSDB with latency, 3D_present, 3D_Multi_present=01 and 2D_VIC_order entries
+    vics = [0x90, 4, 5, 3, 2, 19, 20, 17, 32, 33, 34, 31, 6, 21]
+    sads = sad(1, 8, 0x7f, 0x07) + sad(2, 6, 0x07, 0x50) + sad(10, 8, 0x07, 0x01)
+    hdmi_3d = vsdb(0x1000, [0xb8, 0x3c, 0xa0, 0x10, 0x10, 0xa0, 0x06,
+                            0x00, 0x00, 0x00, 0x18, 0x10, 0x20])
+    c['hdmi_3d_tv'] = base_block('SAM', 0x0c4f, [
+        DTD_1080P60, DTD_720P60, name_desc('3D TV'),
+        range_desc(24, 75, 15, 81, 150)], 1) + cea_block([
+            db(2, vics), db(1, sads), db(4, [0x0f, 0x00, 0x00]), hdmi_3d,
+            db(7, [0x05, 0x03, 0x01]), db(7, [0x00, 0x40])],
+            [DTD_1080I60, DTD_720P50])
+
+    # 3D_Multi_present=10: structure plus mask selecting the first two VICs
+    mask_3d = vsdb(0x2000, [0x80, 0x2d, 0x20, 0xc0, 0x05, 0x00, 0x01, 0x00, 0x03, 0x20])
+    c['hdmi_3d_mask'] = base_block('LGD', 0x0133, [
+        DTD_1080P50, DTD_720P50, name_desc('3D MASK'),
+        range_desc(24, 75, 15, 81, 150)], 1) + cea_block([
+            db(2, [31, 19, 16, 4, 32]), db(1, sad(1, 2, 0x07, 0x07)), mask_3d],
+            [DTD_576P])
+
+    # AV receiver: four blocks, block map then two CEA extensions
+    bmap = bytearray(128)
+    bmap[0] = 0xf0
+    bmap[1] = 0x02
+    bmap[2] = 0x02
+    c['avr_4block'] = base_block('ONK', 0x0001, [
+        DTD_1080P60, DTD_480P, name_desc('AV RECEIVER'),
+        range_desc(23, 76, 15, 80, 160)], 3) + checksum(bmap) + cea_block([
+            db(2, [16, 31, 4, 19, 2, 17]),
+            db(1, sad(1, 8, 0x7f, 0x07) + sad(7, 6, 0x1f, 0xc0) + sad(9, 6, 0x07, 0x01)
+                  + sad(13, 6, 0x07, 0x00)),
+            db(4, [0x4f, 0x00, 0x00]), vsdb(0x3100, [0x78, 0x3c])],
+            [DTD_720P60]) + cea_block([
+                db(2, [5, 20, 6, 21]), vsdb(0x3100, [0x00])], [DTD_1080I60], flags=0x40)
+
+    # base block checksum off by one; the parser rejects it but the extension
+    # block is still walked
+    bad = bytearray(c['hdmi_3d_tv'])
+    bad[127] ^= 0x01
+    c['bad_base_checksum'] = bytes(bad)
+
+    # CEA extension whose last data block claims more bytes than there are
+    # before the DTDs, and a DTD offset outside the block
+    c['truncated_db'] = base_block('ACR', 0x0042, [
+        DTD_1080P60, name_desc('TRUNCATED'), range_desc(56, 76, 30, 83, 170),
+        bytes(18)], 2) + cea_block([db(2, [16, 4]), bytes([0x7f, 0x03, 0x0c])],
+                                   [DTD_720P60]) + cea_block([db(2, [3])], [], dtd_ofst=0xfe)
+
+    # header only, everything else zero
+    c['header_only'] = HEADER + bytes(120)
+    return c
+
+
+def main():
+    out = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), 'corpus')
+    for name, blob in corpus().items():
+        with open(os.path.join(out, name + '.bin'), 'wb') as f:
+            f.write(blob)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,8 @@
+/* Userspace stand-in for mach/sec_osal.h, see rsa_test.c */
+#ifndef SEC_OSAL_H
+#define SEC_OSAL_H
+
+extern void osal_kfree(void *buf);
+extern void *osal_kmalloc(unsigned int size);
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * Userspace stand-in for asf_inc/sec_osal_light.h, so that the masp bignum,
+ * Montgomery, sha1 and self-test sources build unchanged in rsa_test.
+ */
+#ifndef SEC_OSAL_LIGHT_H
+#define SEC_OSAL_LIGHT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef unsigned long ulong;
+
+#define printk		printf
+#define min(a, b)	((a) < (b) ? (a) : (b))
+
+#endif /* SEC_OSAL_LIGHT_H */
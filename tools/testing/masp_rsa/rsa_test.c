@@ -0,0 +1,368 @@
+/*
+ * rsa_test - randomized comparison harness for the masp RSA and sha1 code
+ *
+ * Builds drivers/misc/mediatek/masp/asf/crypto/{bgn_*,rsa_util,rsa_selftest}.c
+ * and asf/core/alg_sha1.c in userspace, against the stand-in headers in
+ * include/, and checks:
+ *
+ *  - rsa_selftest(), the in-kernel known answer test, passes;
+ *  - bgn_mont_exp_bin() agrees with the generic bgn_exp_mod() on random
+ *    moduli, exponents and inputs, with one context reused across moduli
+ *    the way rsa_ctx reuses it across keys, and rejects inputs >= N;
+ *  - sha1() and hash_starts/update/finish agree with the reference sha1
+ *    below on random messages fed in random pieces.
+ *
+ * Usage: rsa_test [-n iters] [-s seed] [-v]
+ *
+ * The limbs are unsigned long, so this covers 64 bit limbs on a 64 bit
+ * host and 32 bit limbs, as on the target, when built with -m32.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include "sec_osal_light.h"
+#include "bgn_internal.h"
+#include "alg_sha1.h"
+
+#define MAX_BYTES	(BGN_MONT_MAX_BITS / 8)
+#define MAX_MSG		4096
+
+extern int rsa_selftest(void);
+
+static unsigned int seed = 1;
+static int verbose;
+
+void *osal_kmalloc(unsigned int size)
+{
+	return malloc(size);
+}
+
+void osal_kfree(void *buf)
+{
+	free(buf);
+}
+
+static unsigned int rnd(void)
+{
+	/* xorshift32, so a failing seed reproduces everywhere */
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+static void rnd_bytes(unsigned char *buf, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		buf[i] = rnd();
+}
+
+static void dump(const char *name, const unsigned char *p, int len)
+{
+	int i;
+
+	fprintf(stderr, "  %s:", name);
+	for (i = 0; i < len; i++)
+		fprintf(stderr, "%s%02x", i % 32 ? "" : "\n    ", p[i]);
+	fprintf(stderr, "\n");
+}
+
+/*
+ * Reference sha1, written from FIPS 180-1 and sharing nothing with
+ * alg_sha1.c.
+ */
+#define ROL(x, n)	(((x) << (n)) | ((x) >> (32 - (n))))
+
+static void ref_sha1_block(uint32_t h[5], const unsigned char *p)
+{
+	uint32_t w[80], a, b, c, d, e, f, k, t;
+	int i;
+
+	for (i = 0; i < 16; i++)
+		w[i] = (uint32_t)p[4 * i] << 24 | (uint32_t)p[4 * i + 1] << 16 |
+		       (uint32_t)p[4 * i + 2] << 8 | p[4 * i + 3];
+	for (; i < 80; i++)
+		w[i] = ROL(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+	a = h[0]; b = h[1]; c = h[2]; d = h[3]; e = h[4];
+	for (i = 0; i < 80; i++) {
+		if (i < 20) {
+			f = (b & c) | (~b & d);
+			k = 0x5a827999;
+		} else if (i < 40) {
+			f = b ^ c ^ d;
+			k = 0x6ed9eba1;
+		} else if (i < 60) {
+			f = (b & c) | (b & d) | (c & d);
+			k = 0x8f1bbcdc;
+		} else {
+			f = b ^ c ^ d;
+			k = 0xca62c1d6;
+		}
+		t = ROL(a, 5) + f + e + k + w[i];
+		e = d; d = c; c = ROL(b, 30); b = a; a = t;
+	}
+	h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+}
+
+static void ref_sha1(const unsigned char *msg, size_t len, unsigned char md[20])
+{
+	uint32_t h[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476,
+			  0xc3d2e1f0 };
+	unsigned char tail[128];
+	uint64_t bits = (uint64_t)len * 8;
+	size_t off, rest, tlen;
+	int i;
+
+	for (off = 0; off + 64 <= len; off += 64)
+		ref_sha1_block(h, msg + off);
+
+	rest = len - off;
+	tlen = rest < 56 ? 64 : 128;
+	memset(tail, 0, sizeof(tail));
+	memcpy(tail, msg + off, rest);
+	tail[rest] = 0x80;
+	for (i = 0; i < 8; i++)
+		tail[tlen - 1 - i] = bits >> (8 * i);
+	for (off = 0; off < tlen; off += 64)
+		ref_sha1_block(h, tail + off);
+
+	for (i = 0; i < 20; i++)
+		md[i] = h[i / 4] >> (24 - 8 * (i % 4));
+}
+
+static int test_sha1(unsigned long n)
+{
+	static unsigned char msg[MAX_MSG];
+	unsigned char ref[20], md[20];
+	sha1_ctx ctx;
+	int len, off, step;
+
+	/* mostly short messages, where the padding cases are */
+	len = rnd() % 4 ? rnd() % 260 : rnd() % (MAX_MSG + 1);
+	rnd_bytes(msg, len);
+	ref_sha1(msg, len, ref);
+
+	sha1(msg, len, md);
+	if (memcmp(md, ref, 20)) {
+		fprintf(stderr, "sha1 %lu: sha1() of %d bytes differs\n", n, len);
+		return -1;
+	}
+
+	hash_starts(&ctx);
+	for (off = 0; off < len; off += step) {
+		step = 1 + rnd() % (rnd() % 2 ? 8 : 130);
+		step = min(step, len - off);
+		hash_update(&ctx, msg + off, step);
+	}
+	hash_finish(&ctx, md);
+	if (memcmp(md, ref, 20)) {
+		fprintf(stderr, "sha1 %lu: hash_update() of %d bytes in pieces differs\n",
+			n, len);
+		return -1;
+	}
+	return 0;
+}
+
+/* random big endian number of exactly bits bits in len bytes */
+static void rnd_num(unsigned char *buf, int len, int bits)
+{
+	int top = len - (bits + 7) / 8;
+
+	memset(buf, 0, len);
+	rnd_bytes(buf + top, len - top);
+	if (bits % 8)
+		buf[top] &= 0xff >> (8 - bits % 8);
+	buf[top] |= 1 << ((bits - 1) % 8);
+}
+
+static int rnd_bits(void)
+{
+	static const int sizes[] = { 2, 17, 63, 64, 65, 512, 521, 1016, 1023,
+				     1024, 1025, 2047, 2048 };
+
+	if (rnd() % 2)
+		return sizes[rnd() % (sizeof(sizes) / sizeof(sizes[0]))];
+	return 2 + rnd() % (BGN_MONT_MAX_BITS - 1);
+}
+
+static int rnd_exp(unsigned char *e, int bits)
+{
+	int ebits;
+
+	memset(e, 0, MAX_BYTES);
+	switch (rnd() % 6) {
+	case 0:
+		e[MAX_BYTES - 1] = 3;
+		break;
+	case 1:
+		e[MAX_BYTES - 3] = 1;
+		e[MAX_BYTES - 1] = 1;
+		break;
+	case 2:
+		e[MAX_BYTES - 1] = 1;
+		break;
+	case 3:
+		/* sparse, 2^k + 1 */
+		ebits = 1 + rnd() % bits;
+		e[MAX_BYTES - 1 - (ebits - 1) / 8] |= 1 << ((ebits - 1) % 8);
+		e[MAX_BYTES - 1] |= 1;
+		break;
+	default:
+		rnd_num(e, MAX_BYTES, 1 + rnd() % bits);
+		break;
+	}
+	return MAX_BYTES;
+}
+
+static int read_num(bgn *X, const unsigned char *buf, int len)
+{
+	int ret = bgn_read_bin(X, buf, len);
+
+	if (ret)
+		fprintf(stderr, "bgn_read_bin failed (%d)\n", ret);
+	return ret;
+}
+
+static int test_exp(bgn_mont *M, unsigned long n)
+{
+	unsigned char nb[MAX_BYTES], eb[MAX_BYTES], xb[MAX_BYTES];
+	unsigned char ref[MAX_BYTES], out[MAX_BYTES];
+	int bits, nlen, len, ret, fail = -1;
+	bgn N, E, X;
+
+	bgn_init(&N);
+	bgn_init(&E);
+	bgn_init(&X);
+
+	bits = rnd_bits();
+	nlen = (bits + 7) / 8;
+	/* the buffers may be wider than N, like a short key in rsa_ctx */
+	len = rnd() % 4 ? nlen : nlen + rnd() % (MAX_BYTES - nlen + 1);
+
+	rnd_num(nb, len, bits);
+	nb[len - 1] |= 1;
+	rnd_exp(eb, bits);
+
+	switch (rnd() % 8) {
+	case 0:
+		memset(xb, 0, len);
+		xb[len - 1] = rnd() % 2;
+		break;
+	case 1:
+		/* N - 1 */
+		memcpy(xb, nb, len);
+		xb[len - 1] &= ~1;
+		break;
+	default:
+		rnd_num(xb, len, 1 + rnd() % (bits - 1));
+		break;
+	}
+
+	if (read_num(&N, nb, len) || read_num(&E, eb, MAX_BYTES) ||
+	    read_num(&X, xb, len))
+		goto out;
+
+	ret = bgn_exp_mod(&X, &E, &N, NULL);
+	if (!ret)
+		ret = bgn_write_bin(&X, ref, len);
+	if (ret) {
+		fprintf(stderr, "exp %lu: bgn_exp_mod failed (%d)\n", n, ret);
+		goto out;
+	}
+
+	ret = bgn_mont_setup(M, &N);
+	if (!ret)
+		ret = bgn_mont_exp_bin(M, &E, xb, len, out, len);
+	if (ret) {
+		fprintf(stderr, "exp %lu: montgomery path failed (%d)\n", n, ret);
+		goto out_dump;
+	}
+	if (memcmp(ref, out, len)) {
+		fprintf(stderr, "exp %lu: montgomery path differs\n", n);
+		dump("montgomery", out, len);
+		goto out_dump;
+	}
+
+	/* x = N must be refused, the generic path's caller refuses it too */
+	ret = bgn_mont_exp_bin(M, &E, nb, len, out, len);
+	if (ret != E_BGN_BAD_INPUT_DATA) {
+		fprintf(stderr, "exp %lu: x = N gave %d\n", n, ret);
+		goto out_dump;
+	}
+
+	if (verbose)
+		printf("exp %lu: %d bits in %d bytes ok\n", n, bits, len);
+	fail = 0;
+	goto out;
+
+out_dump:
+	dump("n", nb, len);
+	dump("e", eb, MAX_BYTES);
+	dump("x", xb, len);
+	dump("expected", ref, len);
+out:
+	bgn_free(&N);
+	bgn_free(&E);
+	bgn_free(&X);
+	return fail;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long iters = 2000, i;
+	int opt, self_fail, exp_fails = 0, sha1_fails = 0;
+	bgn_mont *M;
+
+	while ((opt = getopt(argc, argv, "n:s:v")) != -1) {
+		switch (opt) {
+		case 'n':
+			iters = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 0);
+			if (!seed)
+				seed = 1;
+			break;
+		case 'v':
+			verbose = 1;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n iters] [-s seed] [-v]\n",
+				argv[0]);
+			return 2;
+		}
+	}
+
+	/* keep going on failure, the random comparisons tell more */
+	self_fail = rsa_selftest();
+	if (self_fail)
+		fprintf(stderr, "rsa_selftest() failed (%d)\n", self_fail);
+
+	M = calloc(1, sizeof(*M));
+	if (!M) {
+		perror("calloc");
+		return 2;
+	}
+
+	printf("seed %u, %lu iterations, %d bit limbs\n", seed, iters,
+	       (int)(8 * sizeof(unsigned long)));
+
+	for (i = 0; i < iters; i++) {
+		if (test_exp(M, i) && ++exp_fails > 10)
+			break;
+		if (test_sha1(i) && ++sha1_fails > 10)
+			break;
+	}
+
+	free(M);
+	printf("exp: %d failed, sha1: %d failed\n", exp_fails, sha1_fails);
+	return self_fail || exp_fails || sha1_fails ? 1 : 0;
+}